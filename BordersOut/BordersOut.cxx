@@ -1,14 +1,12 @@
 #include "BordersOutCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 //VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkTriangleFilter.h"
-#include "vtkNew.h"
-#include "vtkFeatureEdges.h"
-#include "vtkCleanPolyData.h"
 
 
 int main (int argc, char * argv[])
@@ -17,31 +15,32 @@ int main (int argc, char * argv[])
 
    try{
 
-    vtkSmartPointer<vtkPolyData> polyData;
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkNew<vtkCleanPolyData> meshinC;
-    meshinC->SetInputData(polyData);
-    meshinC->Update();
-
-    vtkNew<vtkFeatureEdges> boundaryEdges;
-    boundaryEdges->SetInputData(meshinC->GetOutput());
-    boundaryEdges->BoundaryEdgesOn();
-    boundaryEdges->FeatureEdgesOff();
-    boundaryEdges->NonManifoldEdgesOff();
-    boundaryEdges->ManifoldEdgesOff();
-    boundaryEdges->Update();
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::BordersParameters parameters;
+    parameters.MergeCoincidentPoints = !SkipMerging;
+    parameters.StatisticsFileName = Statistics;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunBordersOut(polyData, parameters);
+    if (!surface)
+      {
+      return EXIT_FAILURE;
+      }
+    std::cout << "Boundary loops: " << surface->GetNumberOfLines() << std::endl;
 
     //Write to file
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(boundaryEdges->GetOutput());
-    writer->Update();
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
   }
   catch (int e)
    {
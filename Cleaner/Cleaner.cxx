@@ -1,11 +1,12 @@
 #include "CleanerCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxPipeline.h"
+
 //VTK includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
-#include "vtkCleanPolyData.h"
-#include "vtkNew.h"
+#include "vtkPolyData.h"
 
 
 int main (int argc, char * argv[])
@@ -14,24 +15,32 @@ int main (int argc, char * argv[])
 
  try{
 
-  vtkSmartPointer<vtkPolyData> polyData;
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkNew<vtkCleanPolyData> cleaner;
-
-    cleaner->SetInputData(polyData);
-    cleaner->Update();
-
-
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(cleaner->GetOutput());
-    writer->Update();
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::PipelineParameters parameters;
+    parameters.Cleaner.Tolerance = Tolerance;
+    parameters.Tiles.TileSize = TileSize;
+    parameters.Tiles.HaloRings = TileHalo;
+    parameters.Tiles.MemoryBudget = TileMemory;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunStage("Cleaner", polyData, parameters);
+    if (!surface)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
 
   }
 catch (int e)
@@ -1,11 +1,12 @@
 #include "ConnectivityCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 //VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
-#include "vtkPolyDataConnectivityFilter.h"
-#include "vtkNew.h"
+#include "vtkPolyData.h"
 
 
 int main (int argc, char * argv[])
@@ -14,24 +15,34 @@ int main (int argc, char * argv[])
 
  try{
 
-  vtkSmartPointer<vtkPolyData> polyData;
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkNew<vtkPolyDataConnectivityFilter> connect;
-
-    connect->SetInputData(polyData);
-    connect->SetExtractionModeToLargestRegion();
-    connect->Update();
-
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(connect->GetOutput());
-    writer->Update();
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::ConnectivityParameters parameters;
+    parameters.Mode = Mode;
+    parameters.NumberOfRegions = NumberOfRegions;
+    parameters.MinimumNumberOfCells = MinimumCells;
+    parameters.MinimumArea = MinimumArea;
+    parameters.LabelRegions = Label;
+    parameters.StatisticsFileName = Statistics;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunConnectivity(polyData, parameters);
+    if (!surface)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
 
   }
 catch (int e)
@@ -1,15 +1,20 @@
 #include "DecimationCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxClustering.h"
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxPipeline.h"
+#include "SurfaceToolboxQuadricDecimation.h"
+#include "SurfaceToolboxStages.h"
+
 // VTK Includes
-#include "vtkDecimatePro.h"
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkTriangleFilter.h"
-#include "vtkNew.h"
-
+#include <vtksys/SystemTools.hxx>
 
+// STD includes
+#include <chrono>
+#include <vector>
 
 int main (int argc, char * argv[])
  {
@@ -17,35 +22,100 @@ int main (int argc, char * argv[])
 
    try{
 
-    vtkSmartPointer<vtkPolyData> inputPolyData;
-    vtkSmartPointer<vtkPolyData> polyData;
-
-
-    // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkNew<vtkTriangleFilter> triangles;
-    triangles->SetInputData(polyData);
-    triangles->Update();
-    // create poly data with triangle filter
-    inputPolyData = triangles->GetOutput();
+    SurfaceToolbox::DecimationParameters parameters;
+    parameters.TargetReduction = Decimate;
+    parameters.BoundaryVertexDeletion = Boundary;
+    parameters.Method = Method;
+    parameters.TargetNumberOfTriangles = TargetTriangles;
+    parameters.MaximumError = MaximumError;
+    parameters.ClusterSize = ClusterSize;
+    if (!Levels.empty() && Method != "Quadric")
+      {
+      std::cerr << "--levels requires the Quadric method" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (!Levels.empty() && TileSize > 0)
+      {
+      std::cerr << "--levels cannot be combined with --tileSize" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (!LevelsDirectory.empty() && !vtksys::SystemTools::MakeDirectory(LevelsDirectory))
+      {
+      std::cerr << "Cannot create the levels directory " << LevelsDirectory << std::endl;
+      return EXIT_FAILURE;
+      }
 
-    vtkNew<vtkDecimatePro> decimate;
+    // Clustering reads the file itself, streaming binary STL files
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    vtkSmartPointer<vtkPolyData> surface;
+    std::vector<vtkSmartPointer<vtkPolyData>> levels;
+    vtkIdType inputCells = 0;
+    if (Method == "Clustering")
+      {
+      surface = SurfaceToolbox::RunClusteringDecimation(inputVolume, parameters, inputCells);
+      }
+    else
+      {
+      vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+      if (polyData)
+        {
+        inputCells = polyData->GetNumberOfCells();
+        if (TileSize > 0)
+          {
+          SurfaceToolbox::PipelineParameters pipelineParameters;
+          pipelineParameters.Decimation = parameters;
+          pipelineParameters.Tiles.TileSize = TileSize;
+          pipelineParameters.Tiles.HaloRings = TileHalo;
+          pipelineParameters.Tiles.MemoryBudget = TileMemory;
+          surface = SurfaceToolbox::RunTiledStage("Decimation", polyData, pipelineParameters);
+          }
+        else if (Levels.empty())
+          {
+          surface = SurfaceToolbox::RunDecimation(polyData, parameters);
+          }
+        else
+          {
+          // The output gets the --decimate level, the additional files the --levels
+          std::vector<double> reductions(1, Decimate);
+          reductions.insert(reductions.end(), Levels.begin(), Levels.end());
+          levels = SurfaceToolbox::RunQuadricDecimationLevels(polyData, parameters, reductions);
+          surface = levels.front();
+          }
+        }
+      }
+    if (!surface)
+      {
+      return EXIT_FAILURE;
+      }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-    decimate->SetInputData(inputPolyData);
-    decimate->SetTargetReduction(Decimate);
-    decimate->SetBoundaryVertexDeletion(Boundary);
-    decimate->PreserveTopologyOn();
-    decimate->Update();
+    const vtkIdType outputCells = surface->GetNumberOfCells();
+    std::cout << Method << " decimation: " << inputCells << " -> " << outputCells << " cells";
+    if (inputCells > 0)
+      {
+      std::cout << " (reduction " << 1.0 - static_cast<double>(outputCells) / inputCells << ")";
+      }
+    std::cout << " in " << elapsed.count() << " s" << std::endl;
 
     //Write to file
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(decimate->GetOutput());
-    writer->Update();
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
+    for (size_t level = 1; level < levels.size(); ++level)
+      {
+      const std::string levelFileName = SurfaceToolbox::GetLevelFileName(outputVolume, LevelsDirectory, level);
+      std::cout << "Level " << level << " (reduction " << Levels[level - 1] << "): "
+                << levels[level]->GetNumberOfCells() << " cells" << std::endl;
+      if (!SurfaceToolbox::WritePolyData(levels[level], levelFileName, writeParameters))
+        {
+        return EXIT_FAILURE;
+        }
+      }
   }
   catch (int e)
    {
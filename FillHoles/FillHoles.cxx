@@ -1,13 +1,12 @@
 #include "FillHolesCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 //VTK Includes
-#include "vtkFillHolesFilter.h"
-#include "vtkPolyDataNormals.h"
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkNew.h"
 
 
 
@@ -17,36 +16,32 @@ int main (int argc, char * argv[])
 
  try{
 
-    vtkSmartPointer<vtkPolyData> polyData;
-
-
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-
-    vtkNew<vtkFillHolesFilter> fill;
-
-    fill->SetInputData(polyData);
-    fill->SetHoleSize(holes);
-    fill->Update();
-
-
-    // Need to auto-orient normals, otherwise holes could appear to be unfilled when only fron-facing elements are chosen to be visible
-
-    vtkNew<vtkPolyDataNormals> normals;
-
-    normals->SetInputData(fill->GetOutput());
-    normals->SetAutoOrientNormals(true);
-    normals->Update();
-
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(normals->GetOutput());
-    writer->Update();
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::FillHolesParameters parameters;
+    parameters.MaximumHoleSize = holes;
+    parameters.Triangulation = triangulation;
+    parameters.FairingIterations = fairing;
+    parameters.StatisticsFileName = Statistics;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunFillHoles(polyData, parameters);
+    if (!surface)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
   }
 catch (int e)
  {
@@ -1,14 +1,12 @@
 #include "MC2OriginCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 // VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkNew.h"
-#include "vtkTransformFilter.h"
-#include "vtkTransform.h"
-#include "vtkPoints.h"
 
 
 
@@ -17,66 +15,28 @@ int main (int argc, char * argv[])
    PARSE_ARGS;
 
    try{
-     //translate center of mesh to origin
-
-
-    vtkSmartPointer<vtkPolyData> polyData;
-
 
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    // sum of original points
-    double sum[3];
-    sum[0] = 0;
-    sum[1] = 0;
-    sum[2] = 0;
-
-    for (int i =0; i < polyData->GetNumberOfPoints(); i++)
-    {
-      double curPoint[3];
-      polyData->GetPoint(i, curPoint);
-      for(unsigned int dim = 0; dim < 3; dim++)
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
       {
-        sum[dim] += curPoint[dim];
+      return EXIT_FAILURE;
       }
-    }
 
-    // Calculate MC
-    double MC[3];
-    for(unsigned int dim = 0; dim < 3; dim++)
-    {
-      MC[dim] = (double) sum[dim] / (polyData->GetNumberOfPoints() + 1);
-    }
-    // create new point set of shifted values
-    vtkSmartPointer<vtkPoints> sftpoints;
-    sftpoints = polyData->GetPoints();
+    //translate center of mesh to origin
+    SurfaceToolbox::MC2OriginParameters parameters;
+    parameters.ExactMassCenter = ExactMassCenter;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunMC2Origin(polyData, parameters);
 
-    for(int pointID = 0; pointID < polyData->GetNumberOfPoints(); pointID++)
-    {
-      double curPoint[3];
-      polyData->GetPoint(pointID, curPoint);
-      double sftPoint[3];
-      for(unsigned int dim = 0; dim < 3; dim++)
+    //Write to file
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
       {
-        sftPoint[dim] = curPoint[dim] - MC[dim];
+      return EXIT_FAILURE;
       }
-      //shifting the points
-      sftpoints->SetPoint(pointID, sftPoint);
-    }
-    // shift the points
-    polyData->SetPoints(sftpoints);
-
-
-
-    //Write to file
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(polyData);
-    writer->Update();
   }
   catch (int e)
    {
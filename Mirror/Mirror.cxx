@@ -1,16 +1,12 @@
 #include "MirrorCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 //VTK Includes
-#include "vtkTransformPolyDataFilter.h"
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkTriangleFilter.h"
-#include "vtkReverseSense.h"
-#include "vtkSmartPointer.h"
-#include "vtkTransform.h"
-#include "vtkNew.h"
 
 
 int main (int argc, char * argv[])
@@ -19,37 +15,26 @@ int main (int argc, char * argv[])
 
  try{
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    vtkSmartPointer<vtkPolyData> polyData = reader->GetOutput();
-
-    vtkNew<vtkMatrix4x4> transformMatrix;
-    transformMatrix->SetElement(0, 0, xAxis ? -1 : 1);
-    transformMatrix->SetElement(1, 1, yAxis ? -1 : 1);
-    transformMatrix->SetElement(2, 2, zAxis ? -1 : 1);
-
-    vtkNew<vtkTransform> transform;
-    transform->SetMatrix(transformMatrix);
-
-    vtkNew<vtkTransformPolyDataFilter> transformFilter;
-    transformFilter->SetInputData(polyData);
-    transformFilter->SetTransform(transform);
-    transformFilter->Update();
-    vtkSmartPointer<vtkPolyData> surface = transformFilter->GetOutput();
-
-    if (transformMatrix->Determinant() < 0)
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
       {
-      vtkNew<vtkReverseSense> reverse;
-      reverse->SetInputData(surface);
-      reverse->Update();
-      surface = reverse->GetOutput();
+      return EXIT_FAILURE;
       }
 
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(surface);
-    writer->Update();
+    SurfaceToolbox::MirrorParameters parameters;
+    parameters.X = xAxis;
+    parameters.Y = yAxis;
+    parameters.Z = zAxis;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunMirror(polyData, parameters);
+
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
   }
 catch (int e)
  {
@@ -1,14 +1,12 @@
 #include "NormalsCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxPipeline.h"
+
 //VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkTriangleFilter.h"
-#include "vtkSmartPointer.h"
-#include "vtkPolyDataNormals.h"
-#include "vtkNew.h"
 
 
 int main (int argc, char * argv[])
@@ -17,34 +15,36 @@ int main (int argc, char * argv[])
 
  try{
 
-  vtkSmartPointer<vtkPolyData> polyData;
-
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-
-    vtkNew<vtkPolyDataNormals> normals;
-
-    normals->SetInputData(polyData);
-    normals->SetAutoOrientNormals(orient);
-    normals->SetFlipNormals(flip);
-    normals->SetSplitting(splitting);
-    if(splitting==true){
-      // only applicable if splitting is set
-      normals->SetFeatureAngle(angle);
-    }
-    normals->Update();
-
-
-
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(normals->GetOutput());
-    writer->Update();
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::PipelineParameters parameters;
+    parameters.Normals.AutoOrient = orient;
+    parameters.Normals.Flip = flip;
+    parameters.Normals.Splitting = splitting;
+    parameters.Normals.FeatureAngle = angle;
+    parameters.Normals.Weighting = weighting;
+    parameters.Tiles.TileSize = TileSize;
+    parameters.Tiles.HaloRings = TileHalo;
+    parameters.Tiles.MemoryBudget = TileMemory;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunStage("Normals", polyData, parameters);
+    if (!surface)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
   }
 catch (int e)
  {
@@ -1,12 +1,12 @@
 #include "SmoothingCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxPipeline.h"
+
 //VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
-#include "vtkSmoothPolyDataFilter.h"
-#include "vtkWindowedSincPolyDataFilter.h"
-#include "vtkNew.h"
+#include "vtkPolyData.h"
 
 
 int main (int argc, char * argv[])
@@ -15,41 +15,35 @@ int main (int argc, char * argv[])
 
  try{
 
-  vtkSmartPointer<vtkPolyData> polyData;
-
-  vtkNew<vtkXMLPolyDataReader> reader;
-  reader->SetFileName(inputVolume.c_str());
-  reader->Update();
-  polyData = reader->GetOutput();
-
-  // define default filter
-  vtkNew<vtkSmoothPolyDataFilter> smoothFilter;
-
-  if(typeFilter=="Laplace"){
-    // remain with defuault filter
-    ;
-
-  }
-  else if(typeFilter=="Taubin"){
-    // change filter type
-    vtkNew<vtkWindowedSincPolyDataFilter> smoothFilter;
-
-  }
-  smoothFilter->SetInputData(polyData);
-  smoothFilter->SetNumberOfIterations(Iterations);
-  smoothFilter->SetRelaxationFactor(Relaxation);
-  smoothFilter->FeatureEdgeSmoothingOff();
-  if(Boundary == true){
-
-    smoothFilter->BoundarySmoothingOn();
-  }
-
-  smoothFilter->Update();
-
-  vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(smoothFilter->GetOutput());
-    writer->Update();
+  vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+  if (!polyData)
+    {
+    return EXIT_FAILURE;
+    }
+
+  SurfaceToolbox::PipelineParameters parameters;
+  parameters.Smoothing.Method = typeFilter;
+  parameters.Smoothing.Iterations = Iterations;
+  parameters.Smoothing.Relaxation = Relaxation;
+  parameters.Smoothing.PassBand = PassBand;
+  parameters.Smoothing.BoundarySmoothing = Boundary;
+  parameters.Tiles.TileSize = TileSize;
+  parameters.Tiles.HaloRings = TileHalo;
+  parameters.Tiles.MemoryBudget = TileMemory;
+  vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunStage("Smoothing", polyData, parameters);
+  if (!surface)
+    {
+    return EXIT_FAILURE;
+    }
+
+  SurfaceToolbox::WriteParameters writeParameters;
+  writeParameters.Compression = Compression;
+  writeParameters.CompressionLevel = CompressionLevel;
+  writeParameters.ReportStatistics = true;
+  if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+    {
+    return EXIT_FAILURE;
+    }
   }
 catch (int e)
  {
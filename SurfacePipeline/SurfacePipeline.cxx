@@ -0,0 +1,138 @@
+#include "SurfacePipelineCLP.h"
+
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxPipeline.h"
+
+// VTK Includes
+#include "vtkSmartPointer.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+
+int main (int argc, char * argv[])
+ {
+ PARSE_ARGS;
+
+ try{
+
+    SurfaceToolbox::PipelineParameters parameters;
+
+    parameters.Decimation.TargetReduction = decimate;
+    parameters.Decimation.BoundaryVertexDeletion = decimateBoundary;
+    parameters.Decimation.Method = decimateMethod;
+    parameters.Decimation.TargetNumberOfTriangles = decimateTargetTriangles;
+    parameters.Decimation.MaximumError = decimateMaximumError;
+    parameters.Decimation.ClusterSize = decimateClusterSize;
+
+    parameters.Smoothing.Method = smoothingMethod;
+    parameters.Smoothing.Iterations = smoothingIterations;
+    parameters.Smoothing.Relaxation = smoothingRelaxation;
+    parameters.Smoothing.PassBand = smoothingPassBand;
+    parameters.Smoothing.BoundarySmoothing = smoothingBoundary;
+
+    parameters.Normals.AutoOrient = normalsOrient;
+    parameters.Normals.Flip = normalsFlip;
+    parameters.Normals.Splitting = normalsSplitting;
+    parameters.Normals.FeatureAngle = normalsAngle;
+    parameters.Normals.Weighting = normalsWeighting;
+
+    parameters.Mirror.X = mirrorX;
+    parameters.Mirror.Y = mirrorY;
+    parameters.Mirror.Z = mirrorZ;
+
+    parameters.Cleaner.Tolerance = cleanerTolerance;
+
+    parameters.FillHoles.MaximumHoleSize = holes;
+    parameters.FillHoles.Triangulation = holesTriangulation;
+    parameters.FillHoles.FairingIterations = holesFairing;
+    parameters.FillHoles.StatisticsFileName = holesStatistics;
+
+    parameters.Connectivity.Mode = connectivityMode;
+    parameters.Connectivity.NumberOfRegions = connectivityRegions;
+    parameters.Connectivity.MinimumNumberOfCells = connectivityMinimumCells;
+    parameters.Connectivity.MinimumArea = connectivityMinimumArea;
+    parameters.Connectivity.LabelRegions = connectivityLabel;
+    parameters.Connectivity.StatisticsFileName = connectivityStatistics;
+
+    parameters.Scale.X = scaleX;
+    parameters.Scale.Y = scaleY;
+    parameters.Scale.Z = scaleZ;
+
+    parameters.Translate.X = translateX;
+    parameters.Translate.Y = translateY;
+    parameters.Translate.Z = translateZ;
+
+    parameters.Relax.Iterations = relaxIterations;
+
+    parameters.Borders.MergeCoincidentPoints = !bordersSkipMerging;
+    parameters.Borders.StatisticsFileName = bordersStatistics;
+
+    parameters.Reorder.Curve = reorderCurve;
+
+    parameters.MC2Origin.ExactMassCenter = mc2OriginExactMassCenter;
+
+    parameters.Tiles.TileSize = tileSize;
+    parameters.Tiles.HaloRings = tileHalo;
+    parameters.Tiles.MemoryBudget = tileMemory;
+
+    if (numberOfThreads > 0)
+      {
+      vtkSMPTools::Initialize(numberOfThreads);
+      }
+
+    // Shared memory segments are given by name, as Slicer resolves geometry
+    // parameters to model nodes
+    const std::string inputFileName =
+      inputSharedMemory.empty() ? inputVolume : "shm:/" + inputSharedMemory;
+    const std::string outputFileName =
+      outputSharedMemory.empty() ? outputVolume : "shm:/" + outputSharedMemory;
+    if (inputFileName.empty() || outputFileName.empty())
+      {
+      std::cerr << "An input and an output surface are required" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // Read the file
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputFileName);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::CacheParameters cacheParameters;
+    cacheParameters.Directory = cacheDirectory;
+    cacheParameters.MaximumSize = cacheSize;
+
+    std::vector<std::string> pipelineStages = stages;
+    if (reorderFirst && !stages.empty() && !SurfaceToolbox::IsSameStage(stages.front(), "Reorder"))
+      {
+      pipelineStages.insert(pipelineStages.begin(), "Reorder");
+      }
+
+    vtkSmartPointer<vtkPolyData> surface =
+      SurfaceToolbox::RunCachedPipeline(polyData, pipelineStages, parameters, cacheParameters, &std::cout);
+    if (!surface)
+      {
+      return EXIT_FAILURE;
+      }
+
+    //Write to file
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputFileName, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
+  }
+catch (int e)
+ {
+   cout << "An exception occurred. Exception Nr. " << e << '\n';
+   return EXIT_FAILURE;
+ }
+
+ return EXIT_SUCCESS;
+
+ }
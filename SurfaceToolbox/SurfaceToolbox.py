@@ -1,7 +1,9 @@
 import os
 import csv
+import struct
 import unittest
 import string
+import uuid
 import vtk, qt, ctk, slicer
 from slicer.ScriptedLoadableModule import *
 from slicer.util import VTKObservationMixin
@@ -62,11 +64,15 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
     self.inputModelSelector = None
     self.outputModelSelector = None
     self.updateGUIFromState = None
+    self.preview = None
+    self.previewTimer = None
+    self.batch = None
 
   def setup(self):
     ScriptedLoadableModuleWidget.setup(self)
 
     self.logic = SurfaceToolboxLogic()
+    self.preview = SurfaceToolboxPreview()
 
     # Instantiate and connect widgets ...
     self.parameterNodeSelector = slicer.qMRMLNodeComboBox()
@@ -136,6 +142,15 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
     self.layout.addWidget(decimationFrame)
     decimationFormLayout = qt.QFormLayout(decimationFrame)
 
+    decimationMethodCombo = qt.QComboBox(decimationFrame)
+    decimationMethodCombo.addItem("DecimatePro")
+    decimationMethodCombo.addItem("Quadric")
+    decimationMethodCombo.addItem("Clustering")
+    decimationMethodCombo.setToolTip("DecimatePro: topology-preserving vertex removal."
+      " Quadric: multi-threaded edge collapse, faster on large models."
+      " Clustering: one vertex per grid cell, coarse but in a single pass over very large models.")
+    decimationFormLayout.addWidget(decimationMethodCombo)
+
     reductionFrame, reductionSlider, reductionSpinBox = numericInputFrame(
       self.parent, "Reduction:",
       "Specifies the desired reduction in the total number of polygons (e.g., if Reduction is set"
@@ -360,11 +375,55 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
     toggleModelsButton.toolTip = "Show original model."
     buttonFrame.layout().addWidget(toggleModelsButton)
 
+    previewCheckBox = qt.QCheckBox("Preview")
+    previewCheckBox.objectName = "PreviewCheckBox"
+    previewCheckBox.toolTip = ("Run the enabled stages on a decimated copy of the input model each time a parameter"
+      " changes, and show the result. Apply processes the full resolution model.")
+    buttonFrame.layout().addWidget(previewCheckBox)
+
     applyButton = qt.QPushButton("Apply")
     applyButton.objectName = "ApplyButton"
     applyButton.toolTip = "Filter surface."
     buttonFrame.layout().addWidget(applyButton)
 
+    # Batch
+    batchCollapsibleButton = ctk.ctkCollapsibleButton()
+    batchCollapsibleButton.text = "Batch"
+    batchCollapsibleButton.collapsed = True
+    self.layout.addWidget(batchCollapsibleButton)
+    batchFormLayout = qt.QFormLayout(batchCollapsibleButton)
+
+    batchModelsSelector = slicer.qMRMLCheckableNodeComboBox()
+    batchModelsSelector.objectName = "BatchModelsSelector"
+    batchModelsSelector.nodeTypes = ["vtkMRMLModelNode"]
+    batchModelsSelector.addEnabled = False
+    batchModelsSelector.removeEnabled = False
+    batchModelsSelector.showHidden = False
+    batchModelsSelector.showChildNodeTypes = False
+    batchModelsSelector.setMRMLScene(slicer.mrmlScene)
+    batchModelsSelector.setToolTip("Models to process. The output of each model is added to the scene as a new model.")
+    batchFormLayout.addRow("Models:", batchModelsSelector)
+
+    batchInputDirectoryEdit = ctk.ctkPathLineEdit()
+    batchInputDirectoryEdit.filters = ctk.ctkPathLineEdit.Dirs
+    batchInputDirectoryEdit.setToolTip("Directory of surface files to process, in addition to the models.")
+    batchFormLayout.addRow("Input directory:", batchInputDirectoryEdit)
+
+    batchOutputDirectoryEdit = ctk.ctkPathLineEdit()
+    batchOutputDirectoryEdit.filters = ctk.ctkPathLineEdit.Dirs
+    batchOutputDirectoryEdit.setToolTip("Directory the outputs of the input directory files are written to, with the same names.")
+    batchFormLayout.addRow("Output directory:", batchOutputDirectoryEdit)
+
+    batchApplyButton = qt.QPushButton("Apply to Batch")
+    batchApplyButton.objectName = "BatchApplyButton"
+    batchApplyButton.toolTip = ("Run the enabled stages on every model and file, several at a time,"
+      " without blocking the application.")
+    batchFormLayout.addRow(batchApplyButton)
+
+    batchProgressBar = qt.QProgressBar()
+    batchProgressBar.visible = False
+    batchFormLayout.addRow(batchProgressBar)
+
     self.layout.addStretch(1)
 
     class state(object):
@@ -375,6 +434,7 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
       inputModelNode = None
       outputModelNode = None
       decimation = False
+      decimationMethod = "DecimatePro"
       reduction = 0.8
       boundaryDeletion = False
       smoothing = False
@@ -409,21 +469,44 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
       relaxIterations = 0
       border = False
       origin = False
+      preview = False
 
     scope_locals = locals()
 
+    # Parameter changes are collected for a short time before a preview is run,
+    # so that dragging a slider does not start a run per value.
+    previewTimer = qt.QTimer()
+    previewTimer.singleShot = True
+    previewTimer.interval = 200
+    self.previewTimer = previewTimer
+
+    def requestPreview():
+      if state.preview and state.inputModelNode is not None and state.outputModelNode is not None:
+        previewTimer.start()
+      else:
+        previewTimer.stop()
+        self.preview.clear()
+
+    def onPreviewTimeout():
+      stages, parameters = self.logic.getRunParameters(state)
+      self.preview.request(state.inputModelNode, state.outputModelNode, stages, parameters)
+
+    previewTimer.connect('timeout()', onPreviewTimeout)
+
     def connect(obj, evt, cmd):
       def callback(*args):
         current_locals = scope_locals.copy()
         current_locals.update({'args': args})
         exec(cmd, globals(), current_locals)
         updateGUIFromState()
+        requestPreview()
       obj.connect(evt, callback)
 
     def updateGUIFromState():
 
       decimationButton.checked = state.decimation
       decimationFrame.visible = state.decimation
+      decimationMethodCombo.currentIndex = decimationMethodCombo.findText(state.decimationMethod)
       boundaryDeletionCheckBox.checked = state.boundaryDeletion
       reductionSlider.value = state.reduction
       reductionSpinBox.value = state.reduction
@@ -496,6 +579,8 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
 
       toggleModelsButton.enabled = state.inputModelNode is not None and state.outputModelNode is not None
       applyButton.enabled = state.inputModelNode is not None and state.outputModelNode is not None
+      previewCheckBox.checked = state.preview
+      previewCheckBox.enabled = state.inputModelNode is not None and state.outputModelNode is not None
 
     connect(inputModelSelector, 'currentNodeChanged(vtkMRMLNode*)', 'state.inputModelNode = args[0]')
     connect(outputModelSelector, 'currentNodeChanged(vtkMRMLNode*)', 'state.outputModelNode = args[0]')
@@ -514,6 +599,7 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
       if node is None:
         return
       state.decimation = checkDefine(state.decimation, node.GetParameter("Decimation"))
+      state.decimationMethod = checkDefine(state.decimationMethod, node.GetParameter("DecimateMethod"))
       state.reduction = float(checkDefine(state.reduction, node.GetParameter("DecimateReduction")))
       state.boundaryDeletion = checkDefine(state.boundaryDeletion, node.GetParameter("DecimateBoundary"))
       state.smoothing = checkDefine(state.smoothing, node.GetParameter("smoothing"))
@@ -568,6 +654,7 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
     outputModelSelector.connect('nodeAddedByUser(vtkMRMLNode*)', initializeModelNode)
 
     connect(decimationButton, 'clicked(bool)', 'state.decimation = args[0]')
+    connect(decimationMethodCombo, 'currentIndexChanged(QString)', 'state.decimationMethod = args[0]')
     connect(reductionSlider, 'valueChanged(double)', 'state.reduction = args[0]')
     connect(reductionSpinBox, 'valueChanged(double)', 'state.reduction = args[0]')
     connect(boundaryDeletionCheckBox, 'stateChanged(int)', 'state.boundaryDeletion = bool(args[0])')
@@ -631,6 +718,8 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
 
     connect(originButton, 'clicked(bool)', 'state.origin = args[0]')
 
+    connect(previewCheckBox, 'toggled(bool)', 'state.preview = bool(args[0])')
+
     def updateProcess(value):
       """Display changing process value"""
       updateGUIFromState()
@@ -640,6 +729,9 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
       return
 
     def onApply():
+      # Full resolution replaces the preview
+      previewTimer.stop()
+      self.preview.stop()
       logic = SurfaceToolboxLogic()
       result = logic.applyFilters(state, updateProcess)
       slicer.app.processEvents()
@@ -654,6 +746,43 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
 
     applyButton.connect('clicked()', onApply)
 
+    def onBatchProgress(progress, completed, failed, total):
+      batchProgressBar.value = int(100 * progress)
+      batchProgressBar.format = "{0} / {1} done, {2} failed".format(completed, total, failed) if failed else \
+        "{0} / {1} done".format(completed, total)
+
+    def onBatchFinished(batch):
+      self.batch = None
+      batchApplyButton.text = "Apply to Batch"
+      if batch.failedJobs:
+        slicer.util.warningDisplay("Processing failed for:\n" + "\n".join(batch.failedJobs), windowTitle="Surface Toolbox")
+
+    def onBatchApply():
+      if self.batch is not None:
+        self.batch.cancel()
+        return
+      stages, parameters = self.logic.getRunParameters(state)
+      if not stages:
+        slicer.util.errorDisplay("No stage is enabled.", windowTitle="Surface Toolbox")
+        return
+      batch = SurfaceToolboxBatch(stages, parameters, onBatchProgress, onBatchFinished)
+      for modelNode in batchModelsSelector.checkedNodes():
+        batch.addModelNode(modelNode)
+      if batchInputDirectoryEdit.currentPath:
+        if not batchOutputDirectoryEdit.currentPath:
+          slicer.util.errorDisplay("Select the output directory.", windowTitle="Surface Toolbox")
+          return
+        batch.addDirectory(batchInputDirectoryEdit.currentPath, batchOutputDirectoryEdit.currentPath)
+      if not batch.jobs:
+        slicer.util.errorDisplay("Select models or an input directory.", windowTitle="Surface Toolbox")
+        return
+      self.batch = batch
+      batchApplyButton.text = "Cancel Batch"
+      batchProgressBar.visible = True
+      batch.start()
+
+    batchApplyButton.connect('clicked()', onBatchApply)
+
     def onToggleModels():
       updateGUIFromState()
       if state.inputModelNode.GetModelDisplayNode().GetVisibility():
@@ -688,7 +817,10 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
       self.parameterNodeSelector.setCurrentNodeID(parameterNode.GetID())
 
   def onSceneStartClose(self, caller, event):
-    pass
+    self.previewTimer.stop()
+    self.preview.clear()
+    if self.batch:
+      self.batch.cancel()
 
   def onSceneEndClose(self, caller, event):
     if self.parent.isEntered:
@@ -700,6 +832,11 @@ class SurfaceToolboxWidget(ScriptedLoadableModuleWidget, VTKObservationMixin):
 
   def cleanup(self):
     self.removeObservers()
+    if self.batch:
+      self.batch.cancel()
+    if self.preview:
+      self.previewTimer.stop()
+      self.preview.clear()
 
 
 class SurfaceToolboxLogic(ScriptedLoadableModuleLogic):
@@ -709,6 +846,21 @@ class SurfaceToolboxLogic(ScriptedLoadableModuleLogic):
   def __init__(self, parent=None):
     ScriptedLoadableModuleLogic.__init__(self, parent)
     self.isSingletonParameterNode = False
+    # Pass the surfaces to the CLI through POSIX shared memory instead of temporary files
+    self.sharedMemoryTransport = os.name == "posix" and slicer.util.settingsValue(
+      "SurfaceToolbox/SharedMemoryTransport", False, converter=slicer.util.toBool)
+    # Outputs of the stages are cached on disk, so that Apply only reruns the stages
+    # after the first one whose parameters changed. 0 disables the cache.
+    self.cacheSize = slicer.util.settingsValue("SurfaceToolbox/CacheSize", 1024, converter=float)
+    self.cacheDirectory = os.path.join(slicer.app.temporaryPath, "SurfaceToolboxCache")
+    # Smoothing, Normals, Cleaner and Decimation run by tiles of at most this number of faces, in memory.
+    # 0 processes the whole surface at once.
+    self.tileSize = slicer.util.settingsValue("SurfaceToolbox/TileSize", 0, converter=int)
+    # Memory in MiB of the tiles processed at the same time. 0 processes one tile per thread.
+    self.tileMemory = slicer.util.settingsValue("SurfaceToolbox/TileMemory", 0, converter=float)
+    # Sort the points and cells of the input along a Hilbert curve before the enabled stages, so that
+    # they access nearby memory. Useful on surfaces from segmentations, which come in slice order.
+    self.reorderFirst = slicer.util.settingsValue("SurfaceToolbox/ReorderFirst", False, converter=slicer.util.toBool)
 
   @staticmethod
   def parameterDefine(state, parameter, value):
@@ -732,214 +884,623 @@ class SurfaceToolboxLogic(ScriptedLoadableModuleLogic):
       if not parameterName.startswith("ModuleName"): #and (state.parameterNode.GetParameter(str(i)) != state.parameterNode.GetParameter((str(i))))):
         state.parameterNode.SetAttribute(parameterName, state.parameterNode.GetParameter(str(parameterName)))
 
+  # Stages in the order they are applied, with the name of the state flag enabling them
+  stages = [
+    ("decimation", "Decimation"),
+    ("smoothing", "Smoothing"),
+    ("normals", "Normals"),
+    ("mirror", "Mirror"),
+    ("cleaner", "Cleaner"),
+    ("fillHoles", "FillHoles"),
+    ("connectivity", "Connectivity"),
+    ("scale", "scaleMesh"),
+    ("translate", "translateMesh"),
+    ("relax", "relaxPolygons"),
+    ("border", "BordersOut"),
+    ("origin", "MC2Origin"),
+    ]
+
+  def updateParameters(self, state):
+    """Store the state of the widget in the parameter node and return the names of the enabled stages
+    """
+    if state.outputModelNode is not None:
+      self.parameterDefine(state, "outputVolume", state.outputModelNode.GetID())
+
+    # define which selections were made
+    for flag, stage in self.stages:
+      self.parameterDefine(state, flag, getattr(state, flag))
+
+    self.parameterDefine(state, "DecimateMethod", str(state.decimationMethod))
+    self.parameterDefine(state, "DecimateReduction", str(state.reduction))
+    self.parameterDefine(state, "DecimateBoundary", str(state.boundaryDeletion))
+
+    self.parameterDefine(state, "SmoothingLaplaceBoundary", str(state.boundarySmoothing))
+    self.parameterDefine(state, "SmoothingLaplaceIterations", str(state.laplaceIterations))
+    self.parameterDefine(state, "SmoothingLaplaceRelaxation", str(state.laplaceRelaxation))
+    self.parameterDefine(state, "SmoothingTaubinBoundary", str(state.boundarySmoothing))
+    self.parameterDefine(state, "SmoothingTaubinIterations", str(state.taubinIterations))
+    self.parameterDefine(state, "SmoothingTaubinPassBand", str(state.taubinPassBand))
+    self.parameterDefine(state, "smoothingMethod", str(state.smoothingMethod))
+
+    self.parameterDefine(state, "NormalsOrient", str(state.autoOrientNormals))
+    self.parameterDefine(state, "NormalsFlip", str(state.flipNormals))
+    self.parameterDefine(state, "NormalsSplitting", str(state.splitting))
+    self.parameterDefine(state, "NormalsAngle", str(state.featureAngle))
+
+    self.parameterDefine(state, "MirrorxAxis", str(state.mirrorX))
+    self.parameterDefine(state, "MirroryAxis", str(state.mirrorY))
+    self.parameterDefine(state, "MirrorzAxis", str(state.mirrorZ))
+
+    self.parameterDefine(state, "HolesMaximum", str(state.fillHolesSize))
+
+    self.parameterDefine(state, "scale.dimX", str(state.scaleX))
+    self.parameterDefine(state, "scale.dimY", str(state.scaleY))
+    self.parameterDefine(state, "scale.dimZ", str(state.scaleZ))
+
+    self.parameterDefine(state, "trans.dimX", str(state.transX))
+    self.parameterDefine(state, "trans.dimY", str(state.transY))
+    self.parameterDefine(state, "trans.dimZ", str(state.transZ))
+
+    self.parameterDefine(state, "relax.Iterations", str(state.relaxIterations))
+
+    return [stage for flag, stage in self.stages if str(state.parameterNode.GetParameter(flag)) == "True"]
+
   def applyFilters(self, state, updateProcess):
     self.loadParameters(state)
 
-    surface = state.inputModelNode.GetPolyDataConnection()
+    stages = self.updateParameters(state)
+    if not stages:
+      if state.outputModelNode.GetPolyData() is None:
+        state.outputModelNode.SetAndObserveMesh(vtk.vtkPolyData())
+      state.outputModelNode.GetPolyData().DeepCopy(state.inputModelNode.GetPolyData())
+      self.saveParameters(state)
+      return True
 
-    if state.outputModelNode.GetPolyData() is None:
-      state.outputModelNode.SetAndObserveMesh(vtk.vtkPolyData())
-    state.outputModelNode.GetPolyData().DeepCopy(state.inputModelNode.GetPolyData())
+    state.processValue = ", ".join(stages) + "..."
+    updateProcess(state.processValue)
 
-    self.parameterDefine(state, "outputVolume", state.outputModelNode.GetID())
+    # All enabled stages run in a single SurfacePipeline process: the surface
+    # is transferred to the CLI once and read back once.
+    parameters = self.getPipelineParameters(state.parameterNode)
+    parameters["stages"] = ",".join(stages)
+    parameters["cacheDirectory"] = self.cacheDirectory
+    parameters["cacheSize"] = self.cacheSize
+    parameters["tileSize"] = self.tileSize
+    parameters["tileMemory"] = self.tileMemory
+    parameters["reorderFirst"] = self.reorderFirst
+    if self.sharedMemoryTransport:
+      success = self.runSharedMemoryPipeline(parameters, state.inputModelNode, state.outputModelNode)
+    else:
+      parameters["inputVolume"] = state.inputModelNode.GetID()
+      parameters["outputVolume"] = state.outputModelNode.GetID()
+      cliNode = slicer.cli.runSync(slicer.modules.surfacepipeline, None, parameters)
+      success = cliNode.GetStatus() & cliNode.ErrorsMask == 0
+      slicer.mrmlScene.RemoveNode(cliNode)
 
-    # define which selections were made
-    self.parameterDefine(state, "decimation", state.decimation)
-    self.parameterDefine(state, "smoothing", state.smoothing)
-    self.parameterDefine(state, "normals", state.normals)
-    self.parameterDefine(state, "mirror", state.mirror)
-    self.parameterDefine(state, "cleaner", state.cleaner)
-    self.parameterDefine(state, "fillHoles", state.fillHoles)
-    self.parameterDefine(state, "connectivity", state.connectivity)
-    self.parameterDefine(state, "scale", state.scale)
-    self.parameterDefine(state, "translate", state.translate)
-    self.parameterDefine(state, "relax", state.relax)
-    self.parameterDefine(state, "border", state.border)
-    self.parameterDefine(state, "origin", state.origin)
-
-    if str(state.parameterNode.GetParameter("decimation")) == "True":
-      state.processValue = "Decimation..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "DecimateReduction", str(state.reduction))
-      self.parameterDefine(state, "DecimateBoundary", str(state.boundaryDeletion))
-
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "Decimate": float(state.parameterNode.GetParameter("DecimateReduction")),
-                    "Boundary": bool(state.parameterNode.GetParameter("DecimateBoundary"))}
-      decimationMaker = slicer.modules.decimation
-      slicer.cli.runSync(decimationMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("smoothing")) == "True":
-      state.processValue = "Smoothing..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "SmoothingLaplaceBoundary", str(state.boundarySmoothing))
-      self.parameterDefine(state, "SmoothingLaplaceIterations", str(state.laplaceIterations))
-      self.parameterDefine(state, "SmoothingLaplaceRelaxation", str(state.laplaceRelaxation))
-
-      self.parameterDefine(state, "SmoothingTaubinBoundary", str(state.boundarySmoothing))
-      self.parameterDefine(state, "SmoothingTaubinIterations", str(state.taubinIterations))
-      self.parameterDefine(state, "SmoothingTaubinPassBand", str(state.taubinPassBand))
-      self.parameterDefine(state, "smoothingMethod", str(state.smoothingMethod))
-
-      # Keeping default python.
-      if state.parameterNode.GetParameter("smoothingMethod") == "Laplace":
-        smoothing = vtk.vtkSmoothPolyDataFilter()
-        smoothing.SetBoundarySmoothing(bool(state.parameterNode.GetParameter("SmoothingLaplaceBoundary") == "True"))
-        smoothing.SetNumberOfIterations(int(state.parameterNode.GetParameter("SmoothingLaplaceIterations")))
-        smoothing.SetRelaxationFactor(float(state.parameterNode.GetParameter("SmoothingLaplaceRelaxation")))
-        smoothing.SetInputConnection(surface)
-        surface = smoothing.GetOutputPort()
-      else:  # "Taubin"
-        smoothing = vtk.vtkWindowedSincPolyDataFilter()
-        smoothing.SetBoundarySmoothing(bool(state.parameterNode.GetParameter("SmoothingTaubinBoundary") == "True"))
-        smoothing.SetNumberOfIterations(int(state.parameterNode.GetParameter("SmoothingTaubinIterations")))
-        smoothing.SetPassBand(float(state.parameterNode.GetParameter("SmoothingTaubinPassBand")))
-        smoothing.SetInputConnection(surface)
-        surface = smoothing.GetOutputPort()
-
-    if str(state.parameterNode.GetParameter("normals")) == "True":
-      state.processValue = "Normals..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "NormalsOrient", str(state.autoOrientNormals))
-      self.parameterDefine(state, "NormalsFlip", str(state.flipNormals))
-      self.parameterDefine(state, "NormalsSplitting", str(state.splitting))
-      self.parameterDefine(state, "NormalsAngle", str(state.featureAngle))
-
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "orient": bool(state.parameterNode.GetParameter("NormalsOrient") == "True"),
-                    "flip": bool(state.parameterNode.GetParameter("NormalsFlip") == "True"),
-                    "splitting": bool(state.parameterNode.GetParameter("NormalsSplitting") == "True"),
-                    "angle": float(state.parameterNode.GetParameter("NormalsAngle"))}
-
-      normalsMaker = slicer.modules.normals
-      slicer.cli.runSync(normalsMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("mirror")) == "True":
-      state.processValue = "Mirror..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "MirrorxAxis", str(state.mirrorX))
-      self.parameterDefine(state, "MirroryAxis", str(state.mirrorY))
-      self.parameterDefine(state, "MirrorzAxis", str(state.mirrorZ))
-
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "xAxis": bool(state.parameterNode.GetParameter("MirrorxAxis") == "True"),
-                    "yAxis": bool(state.parameterNode.GetParameter("MirroryAxis") == "True"),
-                    "zAxis": bool(state.parameterNode.GetParameter("MirrorzAxis") == "True")}
-      mirrorMaker = slicer.modules.mirror
-      slicer.cli.runSync(mirrorMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("cleaner")) == "True":
-      state.processValue = "Cleaner..."
-      updateProcess(state.processValue)
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume")}
-      cleanerMaker = slicer.modules.cleaner
-      slicer.cli.runSync(cleanerMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("fillHoles")) == "True":
-      state.processValue = "Fill Holes..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "HolesMaximum", str(state.fillHolesSize))
-
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "holes": float(state.parameterNode.GetParameter("HolesMaximum"))}
-      fillHolesMaker = slicer.modules.fillholes
-      slicer.cli.runSync(fillHolesMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("connectivity")) == "True":
-      state.processValue = "Connectivity..."
-      updateProcess(state.processValue)
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume")}
-      connectivityMaker = slicer.modules.connectivity
-      slicer.cli.runSync(connectivityMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("scale")) == "True":
-      state.processValue = "Scale..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "scale.dimX", str(state.scaleX))
-      self.parameterDefine(state, "scale.dimY", str(state.scaleY))
-      self.parameterDefine(state, "scale.dimZ", str(state.scaleZ))
-
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "dimX": float(state.parameterNode.GetParameter("scale.dimX")),
-                    "dimY": float(state.parameterNode.GetParameter("scale.dimY")),
-                    "dimZ": float(state.parameterNode.GetParameter("scale.dimZ"))}
-      scaleMaker = slicer.modules.scalemesh
-      slicer.cli.runSync(scaleMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("translate")) == "True":
-      state.processValue = "Translating..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "trans.dimX", str(state.transX))
-      self.parameterDefine(state, "trans.dimY", str(state.transY))
-      self.parameterDefine(state, "trans.dimZ", str(state.transZ))
-
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "dimX": float(state.parameterNode.GetParameter("trans.DimX")),
-                    "dimY": float(state.parameterNode.GetParameter("trans.DimY")),
-                    "dimZ": float(state.parameterNode.GetParameter("trans.DimZ"))}
-      transMaker = slicer.modules.translatemesh
-      slicer.cli.runSync(transMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("relax")) == "True":
-      state.processValue = "Relaxing..."
-      updateProcess(state.processValue)
-
-      self.parameterDefine(state, "relax.Iterations", str(state.relaxIterations))
-
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "Iterations": float(state.parameterNode.GetParameter("relax.Iterations"))}
-      relaxMaker = slicer.modules.relaxpolygons
-      slicer.cli.runSync(relaxMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("border")) == "True":
-      state.processValue = "Changing Borders..."
-      updateProcess(state.processValue)
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume")}
-      borderMaker = slicer.modules.bordersout
-      slicer.cli.runSync(borderMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    if str(state.parameterNode.GetParameter("origin")) == "True":
-      state.processValue = "Moving Origin..."
-      updateProcess(state.processValue)
-      parameters = {"inputVolume": state.parameterNode.GetParameter("outputVolume"),
-                    "outputVolume": state.parameterNode.GetParameter("outputVolume")}
-      originMaker = slicer.modules.mc2origin
-      slicer.cli.runSync(originMaker, None, parameters)
-      surface = state.outputModelNode.GetPolyDataConnection()
-
-    state.outputModelNode.SetPolyDataConnection(surface)
     state.processValue = "Apply"
     updateProcess(state.processValue)
 
     self.saveParameters(state)
-    return True
+    return success
+
+  def getRunParameters(self, state):
+    """Return the names of the enabled stages and the SurfacePipeline CLI parameters of a preview or batch run
+    """
+    self.loadParameters(state)
+    stages = self.updateParameters(state)
+    self.saveParameters(state)
+    parameters = self.getPipelineParameters(state.parameterNode)
+    parameters["cacheDirectory"] = self.cacheDirectory
+    parameters["cacheSize"] = self.cacheSize
+    parameters["tileSize"] = self.tileSize
+    parameters["tileMemory"] = self.tileMemory
+    parameters["reorderFirst"] = self.reorderFirst
+    return stages, parameters
+
+  def runSharedMemoryPipeline(self, parameters, inputModelNode, outputModelNode):
+    """Run the SurfacePipeline CLI with the input and output surfaces in shared memory segments
+    instead of model nodes, which Slicer would write to and read from temporary files. The segment
+    names are passed as string parameters, as geometry parameters are model node IDs.
+    """
+    segmentName = "SurfaceToolbox-{0}-{1}".format(os.getpid(), uuid.uuid4().hex[:8])
+    inputName = segmentName + "-input"
+    outputName = segmentName + "-output"
+    self.writeSharedMemoryPolyData(inputModelNode.GetPolyData(), inputName)
+    try:
+      parameters["inputSharedMemory"] = inputName
+      parameters["outputSharedMemory"] = outputName
+      cliNode = slicer.cli.runSync(slicer.modules.surfacepipeline, None, parameters)
+      success = cliNode.GetStatus() & cliNode.ErrorsMask == 0
+      slicer.mrmlScene.RemoveNode(cliNode)
+      if success:
+        outputModelNode.SetAndObserveMesh(self.readSharedMemoryPolyData(outputName, unlink=True))
+    finally:
+      self.removeSharedMemory(inputName)
+      self.removeSharedMemory(outputName)
+    return success
+
+  # Layout of the shared memory segments, see SurfaceToolboxCore/SurfaceToolboxSharedMemory.h
+  sharedMemoryMagic = b"STSHM01\0"
+  sharedMemoryHeader = struct.Struct("=8sIIQ40x")
+  sharedMemoryArrayEntry = struct.Struct("=64siiiiqq")
+  sharedMemoryAlignment = 64
+  sharedMemoryPointsRole = 0
+  sharedMemoryCellsRole = 1  # offsets then connectivity of verts, lines, polys and strips
+  sharedMemoryPointDataRole = 9
+  sharedMemoryCellDataRole = 10
+
+  @classmethod
+  def writeSharedMemoryPolyData(cls, polyData, name):
+    """Create the shared memory segment called name holding the points, cells and numeric
+    point and cell data arrays of polyData. Raises ValueError if an array name is longer than
+    the 63 bytes of its entry.
+    """
+    import numpy as np
+    from multiprocessing import shared_memory
+    from vtk.util import numpy_support
+
+    arrays = []  # (array, role, attribute, data type)
+    if polyData.GetPoints():
+      points = polyData.GetPoints().GetData()
+      arrays.append((points, cls.sharedMemoryPointsRole, -1, points.GetDataType()))
+    cellArrays = [polyData.GetVerts(), polyData.GetLines(), polyData.GetPolys(), polyData.GetStrips()]
+    for cellType, cells in enumerate(cellArrays):
+      if cells.GetNumberOfCells() == 0:
+        continue
+      role = cls.sharedMemoryCellsRole + 2 * cellType
+      arrays.append((cells.GetOffsetsArray(), role, -1, cells.GetOffsetsArray().GetDataType()))
+      arrays.append((cells.GetConnectivityArray(), role + 1, -1, cells.GetConnectivityArray().GetDataType()))
+    for role, attributes in ((cls.sharedMemoryPointDataRole, polyData.GetPointData()),
+                             (cls.sharedMemoryCellDataRole, polyData.GetCellData())):
+      for index in range(attributes.GetNumberOfArrays()):
+        array = attributes.GetArray(index)
+        if array and array.HasStandardMemoryLayout():
+          arrays.append((array, role, attributes.IsArrayAnAttribute(index), array.GetDataType()))
+
+    def align(size):
+      return (size + cls.sharedMemoryAlignment - 1) // cls.sharedMemoryAlignment * cls.sharedMemoryAlignment
+
+    arrayNames = [(array.GetName() or "").encode("utf-8") for array, role, attribute, dataType in arrays]
+    for arrayName in arrayNames:
+      if len(arrayName) > 63:
+        raise ValueError("Array name longer than 63 bytes: " + arrayName.decode("utf-8"))
+    values = [numpy_support.vtk_to_numpy(array).reshape(-1) for array, role, attribute, dataType in arrays]
+    offsets = []
+    size = align(cls.sharedMemoryHeader.size + len(arrays) * cls.sharedMemoryArrayEntry.size)
+    for value in values:
+      offsets.append(size)
+      size += align(value.nbytes)
+
+    segment = shared_memory.SharedMemory(name=name, create=True, size=size)
+    try:
+      cls.sharedMemoryHeader.pack_into(segment.buf, 0, cls.sharedMemoryMagic, 1, len(arrays), size)
+      for index, ((array, role, attribute, dataType), arrayName, value, offset) in enumerate(
+          zip(arrays, arrayNames, values, offsets)):
+        cls.sharedMemoryArrayEntry.pack_into(
+          segment.buf, cls.sharedMemoryHeader.size + index * cls.sharedMemoryArrayEntry.size,
+          arrayName, role, attribute, dataType, array.GetNumberOfComponents(), array.GetNumberOfTuples(), offset)
+        segment.buf[offset:offset + value.nbytes] = value.view(np.uint8)
+    finally:
+      segment.close()
+
+  @classmethod
+  def readSharedMemoryPolyData(cls, name, unlink=False):
+    """Copy the surface stored in the shared memory segment called name into a new vtkPolyData.
+    Unlike the CLIs, which use the mapped values directly, the module copies them (numpy_to_vtk
+    with deep=1), as the segment is closed and removed once read.
+    """
+    import numpy as np
+    from multiprocessing import shared_memory
+    from vtk.util import numpy_support
+
+    segment = shared_memory.SharedMemory(name=name)
+    try:
+      magic, version, numberOfArrays, size = cls.sharedMemoryHeader.unpack_from(segment.buf, 0)
+      if magic != cls.sharedMemoryMagic or version != 1:
+        raise ValueError("Invalid shared memory surface " + name)
+      polyData = vtk.vtkPolyData()
+      cells = {}
+      for index in range(numberOfArrays):
+        arrayName, role, attribute, dataType, components, tuples, offset = cls.sharedMemoryArrayEntry.unpack_from(
+          segment.buf, cls.sharedMemoryHeader.size + index * cls.sharedMemoryArrayEntry.size)
+        dtype = numpy_support.get_numpy_array_type(dataType)
+        # numpy_to_vtk copies the values, the view must be released before the segment is closed
+        value = np.frombuffer(segment.buf, dtype=dtype, count=tuples * components, offset=offset)
+        array = numpy_support.numpy_to_vtk(value.reshape(tuples, components) if components > 1 else value,
+                                           deep=1, array_type=dataType)
+        del value
+        arrayName = arrayName.rstrip(b"\0").decode("utf-8")
+        if arrayName:
+          array.SetName(arrayName)
+        if role == cls.sharedMemoryPointsRole:
+          points = vtk.vtkPoints()
+          points.SetData(array)
+          polyData.SetPoints(points)
+        elif role in (cls.sharedMemoryPointDataRole, cls.sharedMemoryCellDataRole):
+          attributes = polyData.GetPointData() if role == cls.sharedMemoryPointDataRole else polyData.GetCellData()
+          arrayIndex = attributes.AddArray(array)
+          if attribute >= 0:
+            attributes.SetActiveAttribute(arrayIndex, attribute)
+        else:
+          cells.setdefault((role - cls.sharedMemoryCellsRole) // 2, [None, None])[(role - cls.sharedMemoryCellsRole) % 2] = array
+      setCells = [polyData.SetVerts, polyData.SetLines, polyData.SetPolys, polyData.SetStrips]
+      for cellType, (offsets, connectivity) in cells.items():
+        cellArray = vtk.vtkCellArray()
+        cellArray.SetData(offsets, connectivity)
+        setCells[cellType](cellArray)
+    finally:
+      segment.close()
+      if unlink:
+        segment.unlink()
+    return polyData
+
+  @staticmethod
+  def removeSharedMemory(name):
+    from multiprocessing import shared_memory
+    try:
+      segment = shared_memory.SharedMemory(name=name)
+    except FileNotFoundError:
+      return
+    segment.close()
+    segment.unlink()
+
+  @staticmethod
+  def getPipelineParameters(parameterNode):
+    """Convert the stage parameters stored in the parameter node to SurfacePipeline CLI parameters
+    """
+    def isTrue(name):
+      return parameterNode.GetParameter(name) == "True"
+
+    smoothingMethod = parameterNode.GetParameter("smoothingMethod")
+    if smoothingMethod == "Laplace":
+      smoothingIterations = parameterNode.GetParameter("SmoothingLaplaceIterations")
+      smoothingBoundary = isTrue("SmoothingLaplaceBoundary")
+    else:
+      smoothingIterations = parameterNode.GetParameter("SmoothingTaubinIterations")
+      smoothingBoundary = isTrue("SmoothingTaubinBoundary")
+
+    return {
+      "decimate": float(parameterNode.GetParameter("DecimateReduction")),
+      "decimateBoundary": isTrue("DecimateBoundary"),
+      "decimateMethod": parameterNode.GetParameter("DecimateMethod") or "DecimatePro",
+      "smoothingMethod": smoothingMethod,
+      "smoothingIterations": int(float(smoothingIterations)),
+      "smoothingRelaxation": float(parameterNode.GetParameter("SmoothingLaplaceRelaxation")),
+      "smoothingPassBand": float(parameterNode.GetParameter("SmoothingTaubinPassBand")),
+      "smoothingBoundary": smoothingBoundary,
+      "normalsOrient": isTrue("NormalsOrient"),
+      "normalsFlip": isTrue("NormalsFlip"),
+      "normalsSplitting": isTrue("NormalsSplitting"),
+      "normalsAngle": float(parameterNode.GetParameter("NormalsAngle")),
+      "mirrorX": isTrue("MirrorxAxis"),
+      "mirrorY": isTrue("MirroryAxis"),
+      "mirrorZ": isTrue("MirrorzAxis"),
+      "holes": float(parameterNode.GetParameter("HolesMaximum")),
+      "scaleX": float(parameterNode.GetParameter("scale.dimX")),
+      "scaleY": float(parameterNode.GetParameter("scale.dimY")),
+      "scaleZ": float(parameterNode.GetParameter("scale.dimZ")),
+      "translateX": float(parameterNode.GetParameter("trans.dimX")),
+      "translateY": float(parameterNode.GetParameter("trans.dimY")),
+      "translateZ": float(parameterNode.GetParameter("trans.dimZ")),
+      "relaxIterations": int(float(parameterNode.GetParameter("relax.Iterations"))),
+      }
+
+
+class SurfaceToolboxBatch(object):
+  """Run the same stages on many models or surface files with the SurfacePipeline CLI, several at a
+  time and without waiting for them, so that the application stays responsive. The number of CLIs
+  running at the same time is limited by the number of cores, and by the available memory. The cores
+  are shared between the CLIs running at the same time: each runs its stages on its share of them.
+  """
+
+  surfaceFileExtensions = (".vtk", ".vtp", ".stl", ".ply", ".obj")
+
+  # Memory used by a CLI, as a multiple of the size of its input surface: input, output,
+  # temporary files and intermediate surfaces of the stages.
+  memoryFactor = 6
+
+  def __init__(self, stages, parameters, progressCallback=None, finishedCallback=None, maximumNumberOfJobs=None):
+    """progressCallback(progress, completed, failed, total) is called when a job progresses, with progress
+    from 0 to 1, and finishedCallback(batch) once all jobs are done or cancelled.
+    """
+    self.parameters = dict(parameters)
+    self.parameters["stages"] = ",".join(stages)
+    self.progressCallback = progressCallback
+    self.finishedCallback = finishedCallback
+    self.numberOfCores = max(1, qt.QThread.idealThreadCount())
+    self.maximumNumberOfJobs = maximumNumberOfJobs or self.numberOfCores
+    self.threadsPerJob = 0
+    self.jobs = []
+    self.pendingJobs = []
+    self.runningJobs = []
+    self.completedJobs = []
+    self.failedJobs = []
+    self.cancelled = False
+
+  def addModelNode(self, inputModelNode, outputModelNode=None):
+    """Process inputModelNode into outputModelNode, or into a new model node if it is None
+    """
+    self.jobs.append({
+      "name": inputModelNode.GetName(),
+      "inputModelNode": inputModelNode,
+      "outputModelNode": outputModelNode,
+      "size": inputModelNode.GetPolyData().GetActualMemorySize() * 1024 if inputModelNode.GetPolyData() else 0,
+      })
+
+  def addFile(self, inputFileName, outputFileName):
+    """Process the surface file inputFileName into outputFileName. The models are loaded when the job
+    starts and removed from the scene once the output is written.
+    """
+    self.jobs.append({
+      "name": os.path.basename(inputFileName),
+      "inputFileName": inputFileName,
+      "outputFileName": outputFileName,
+      "size": os.path.getsize(inputFileName),
+      })
+
+  def addDirectory(self, inputDirectory, outputDirectory):
+    """Process every surface file of inputDirectory into the file of the same name in outputDirectory
+    """
+    for fileName in sorted(os.listdir(inputDirectory)):
+      if os.path.splitext(fileName)[1].lower() in self.surfaceFileExtensions:
+        self.addFile(os.path.join(inputDirectory, fileName), os.path.join(outputDirectory, fileName))
+
+  def start(self):
+    self.pendingJobs = list(self.jobs)
+    # Each CLI would otherwise run its multi-threaded stages on all the cores
+    numberOfConcurrentJobs = max(1, min(self.maximumNumberOfJobs, len(self.jobs)))
+    self.threadsPerJob = max(1, self.numberOfCores // numberOfConcurrentJobs)
+    self.scheduleJobs()
+
+  def cancel(self):
+    """Cancel the running jobs and do not start the pending ones
+    """
+    self.cancelled = True
+    self.pendingJobs = []
+    for job in list(self.runningJobs):
+      job["cliNode"].Cancel()
+    if not self.runningJobs:
+      self.scheduleJobs()
+
+  @staticmethod
+  def getAvailableMemory():
+    """Available physical memory in bytes, or None if unknown
+    """
+    try:
+      with open("/proc/meminfo") as meminfo:
+        for line in meminfo:
+          if line.startswith("MemAvailable:"):
+            return int(line.split()[1]) * 1024
+    except (IOError, OSError, ValueError):
+      pass
+    try:
+      return os.sysconf("SC_AVPHYS_PAGES") * os.sysconf("SC_PAGE_SIZE")
+    except (AttributeError, ValueError, OSError):
+      return None
+
+  def scheduleJobs(self):
+    # The memory of the running CLIs may not be used yet, so it is estimated from their inputs
+    availableMemory = self.getAvailableMemory()
+    if availableMemory is not None:
+      availableMemory -= sum(self.memoryFactor * job["size"] for job in self.runningJobs)
+    while self.pendingJobs and len(self.runningJobs) < self.maximumNumberOfJobs:
+      job = self.pendingJobs[0]
+      requiredMemory = self.memoryFactor * job["size"]
+      if self.runningJobs and availableMemory is not None and requiredMemory > availableMemory:
+        break
+      self.pendingJobs.pop(0)
+      if availableMemory is not None:
+        availableMemory -= requiredMemory
+      self.startJob(job)
+    self.reportProgress()
+    if not self.runningJobs and not self.pendingJobs and self.finishedCallback:
+      self.finishedCallback(self)
+
+  def startJob(self, job):
+    if "inputFileName" in job:
+      try:
+        job["inputModelNode"] = slicer.util.loadModel(job["inputFileName"])
+      except RuntimeError:
+        job["inputModelNode"] = None
+      if job["inputModelNode"] is None:
+        self.failedJobs.append(job["name"])
+        return
+    if job.get("outputModelNode") is None:
+      job["outputModelNode"] = slicer.mrmlScene.AddNewNodeByClass(
+        "vtkMRMLModelNode", slicer.mrmlScene.GenerateUniqueName(job["inputModelNode"].GetName() + " processed"))
+      job["outputModelNode"].CreateDefaultDisplayNodes()
+    parameters = dict(self.parameters)
+    parameters["inputVolume"] = job["inputModelNode"].GetID()
+    parameters["outputVolume"] = job["outputModelNode"].GetID()
+    parameters["numberOfThreads"] = self.threadsPerJob
+    job["cliNode"] = slicer.cli.run(slicer.modules.surfacepipeline, None, parameters, wait_for_completion=False)
+    job["cliObserver"] = job["cliNode"].AddObserver(
+      slicer.vtkMRMLCommandLineModuleNode.StatusModifiedEvent,
+      lambda caller, event, job=job: self.onStatusModified(job))
+    self.runningJobs.append(job)
+
+  def onStatusModified(self, job):
+    cliNode = job["cliNode"]
+    if cliNode.IsBusy():
+      self.reportProgress()
+      return
+    cliNode.RemoveObserver(job["cliObserver"])
+    success = cliNode.GetStatus() == cliNode.Completed
+    slicer.mrmlScene.RemoveNode(cliNode)
+    self.runningJobs.remove(job)
+    if "inputFileName" in job:
+      if success:
+        success = slicer.util.saveNode(job["outputModelNode"], job["outputFileName"])
+      slicer.mrmlScene.RemoveNode(job["inputModelNode"])
+      slicer.mrmlScene.RemoveNode(job["outputModelNode"])
+    if success:
+      self.completedJobs.append(job["name"])
+    elif not self.cancelled:
+      self.failedJobs.append(job["name"])
+    # Called from the observer of the CLI node: start the next jobs once it has returned
+    qt.QTimer.singleShot(0, self.scheduleJobs)
+
+  def reportProgress(self):
+    if not self.progressCallback or not self.jobs:
+      return
+    done = len(self.completedJobs) + len(self.failedJobs)
+    running = sum(job["cliNode"].GetProgress() / 100.0 for job in self.runningJobs)
+    self.progressCallback((done + running) / len(self.jobs), len(self.completedJobs), len(self.failedJobs), len(self.jobs))
+
+
+class SurfaceToolboxPreview(object):
+  """Run the enabled stages on a decimated proxy of the input model in the background and show the
+  result in a preview model node. Only the latest request is run: a request made while a run is in
+  progress cancels that run, and starts once it has stopped.
+  """
+
+  # Number of triangles of the proxy. Smaller inputs are previewed at full resolution.
+  proxyTriangles = 50000
+
+  def __init__(self):
+    self.proxyKey = None
+    self.proxyNode = None
+    self.previewNode = None
+    self.cliNode = None
+    self.cliObserver = None
+    self.cliProxyKey = None
+    self.cliModelNodes = None
+    self.pendingRequest = None
+    self.hiddenDisplayNodes = []
+
+  def request(self, inputModelNode, outputModelNode, stages, parameters):
+    """Preview stages run with parameters (SurfacePipeline CLI parameters) on inputModelNode,
+    shown in place of inputModelNode and outputModelNode
+    """
+    self.pendingRequest = (inputModelNode, outputModelNode, stages, parameters)
+    if self.cliNode is not None:
+      # Started by onStatusModified once the running CLI has stopped. A superseded
+      # preview is cancelled, the proxy is always built to completion.
+      if self.cliProxyKey is None:
+        self.cliNode.Cancel()
+      return
+    self.runPendingRequest()
+
+  def stop(self):
+    """Cancel the running preview and remove the preview node. The proxy is kept for the next requests.
+    """
+    self.pendingRequest = None
+    if self.cliNode is not None:
+      self.cliNode.Cancel()
+      self.removeCliNode()
+    if self.previewNode is not None and slicer.mrmlScene.IsNodePresent(self.previewNode):
+      slicer.mrmlScene.RemoveNode(self.previewNode)
+    self.previewNode = None
+    for displayNode in self.hiddenDisplayNodes:
+      displayNode.VisibilityOn()
+    self.hiddenDisplayNodes = []
+
+  def clear(self):
+    """Stop the preview and remove the proxy
+    """
+    self.stop()
+    if self.proxyNode is not None and slicer.mrmlScene.IsNodePresent(self.proxyNode):
+      slicer.mrmlScene.RemoveNode(self.proxyNode)
+    self.proxyNode = None
+    self.proxyKey = None
+
+  def runPendingRequest(self):
+    if self.pendingRequest is None:
+      return
+    inputModelNode, outputModelNode, stages, parameters = self.pendingRequest
+    if inputModelNode is None or inputModelNode.GetPolyData() is None:
+      self.pendingRequest = None
+      return
+    # The proxy is built once per input surface, then reused by the following requests
+    key = (inputModelNode.GetID(), inputModelNode.GetPolyData().GetMTime())
+    if self.proxyKey != key:
+      self.runProxy(inputModelNode, key)
+      return
+    self.pendingRequest = None
+    if self.previewNode is None:
+      self.previewNode = self.createModelNode(inputModelNode.GetName() + " preview")
+      self.previewNode.CreateDefaultDisplayNodes()
+    if not stages:
+      polyData = vtk.vtkPolyData()
+      polyData.ShallowCopy(self.proxyNode.GetPolyData())
+      self.previewNode.SetAndObserveMesh(polyData)
+      self.showPreview(inputModelNode, outputModelNode)
+      return
+    parameters = dict(parameters)
+    parameters["stages"] = ",".join(stages)
+    parameters["inputVolume"] = self.proxyNode.GetID()
+    parameters["outputVolume"] = self.previewNode.GetID()
+    self.runCli(parameters, modelNodes=(inputModelNode, outputModelNode))
+
+  def runProxy(self, inputModelNode, key):
+    if self.proxyNode is None:
+      self.proxyNode = self.createModelNode(inputModelNode.GetName() + " preview proxy")
+    self.proxyKey = None
+    polyData = inputModelNode.GetPolyData()
+    if polyData.GetNumberOfCells() <= self.proxyTriangles:
+      proxy = vtk.vtkPolyData()
+      proxy.ShallowCopy(polyData)
+      self.proxyNode.SetAndObserveMesh(proxy)
+      self.proxyKey = key
+      self.runPendingRequest()
+      return
+    parameters = {
+      "inputVolume": inputModelNode.GetID(),
+      "outputVolume": self.proxyNode.GetID(),
+      "stages": "Decimation",
+      "decimateMethod": "Quadric",
+      "decimateTargetTriangles": self.proxyTriangles,
+      }
+    self.runCli(parameters, proxyKey=key)
+
+  def runCli(self, parameters, proxyKey=None, modelNodes=None):
+    """Run the SurfacePipeline CLI without waiting, to build the proxy of key proxyKey or to preview
+    the stages in place of modelNodes
+    """
+    self.cliProxyKey = proxyKey
+    self.cliModelNodes = modelNodes
+    self.cliNode = slicer.cli.run(slicer.modules.surfacepipeline, None, parameters, wait_for_completion=False)
+    self.cliObserver = self.cliNode.AddObserver(
+      slicer.vtkMRMLCommandLineModuleNode.StatusModifiedEvent, self.onStatusModified)
+
+  def onStatusModified(self, cliNode, event):
+    if cliNode is not self.cliNode or cliNode.IsBusy():
+      return
+    completed = cliNode.GetStatus() == cliNode.Completed
+    proxyKey = self.cliProxyKey
+    modelNodes = self.cliModelNodes
+    self.removeCliNode()
+    if completed:
+      if proxyKey is not None:
+        self.proxyKey = proxyKey
+      elif self.pendingRequest is None:
+        self.showPreview(*modelNodes)
+    self.runPendingRequest()
+
+  def removeCliNode(self):
+    self.cliNode.RemoveObserver(self.cliObserver)
+    slicer.mrmlScene.RemoveNode(self.cliNode)
+    self.cliNode = None
+    self.cliObserver = None
+    self.cliProxyKey = None
+    self.cliModelNodes = None
+
+  def showPreview(self, inputModelNode, outputModelNode):
+    """Show the preview in place of the input and output models
+    """
+    for modelNode in (inputModelNode, outputModelNode):
+      displayNode = modelNode.GetDisplayNode()
+      if displayNode is not None and displayNode.GetVisibility():
+        displayNode.VisibilityOff()
+        self.hiddenDisplayNodes.append(displayNode)
+    self.previewNode.GetDisplayNode().VisibilityOn()
+
+  @staticmethod
+  def createModelNode(name):
+    modelNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLModelNode", slicer.mrmlScene.GenerateUniqueName(name))
+    modelNode.SetHideFromEditors(True)
+    modelNode.SetSaveWithScene(False)
+    return modelNode
 
 
 class SurfaceToolboxTest(ScriptedLoadableModuleTest):
@@ -959,6 +1520,12 @@ class SurfaceToolboxTest(ScriptedLoadableModuleTest):
     self.test_SurfaceToolbox1()
     self.setUp()
     self.test_SurfaceToolbox2()
+    self.setUp()
+    self.test_SurfaceToolboxPreview()
+    self.setUp()
+    self.test_SurfaceToolboxBatch()
+    self.setUp()
+    self.test_SurfaceToolboxSharedMemory()
 
   def test_SurfaceToolbox1(self):
     """ Ideally you should have several levels of tests.  At the lowest level
@@ -1022,3 +1589,93 @@ class SurfaceToolboxTest(ScriptedLoadableModuleTest):
   def test_SurfaceToolbox2(self):
     """Re-run first test to ensure using the module after clearing the scene works as expected"""
     self.test_SurfaceToolbox1()
+
+  def test_SurfaceToolboxPreview(self):
+    """Preview smoothing, then apply it at full resolution"""
+    self.delayDisplay("Starting the preview test")
+    import SampleData
+    SampleData.downloadFromURL(
+      nodeNames='cow',
+      fileNames='cow.vtp',
+      loadFileTypes='ModelFile',
+      uris='https://github.com/Slicer/SlicerTestingData/releases/download/SHA256/d5aa4901d186902f90e17bf3b5917541cb6cb8cf223bfeea736631df4c047652',
+      checksums='SHA256:d5aa4901d186902f90e17bf3b5917541cb6cb8cf223bfeea736631df4c047652')
+    modelNode = slicer.util.getNode(pattern="cow_1")
+
+    widget = slicer.modules.SurfaceToolboxWidget
+    slicer.util.selectModule(slicer.modules.surfacetoolbox)
+    widget.inputModelSelector.setCurrentNode(modelNode)
+    outputModelNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLModelNode", "output")
+    widget.outputModelSelector.setCurrentNode(outputModelNode)
+
+    smoothingButton = slicer.util.findChild(widget.parent, "SmoothingButton")
+    if not smoothingButton.checked:
+      smoothingButton.click()
+    slicer.util.findChild(widget.parent, "PreviewCheckBox").checked = True
+
+    # The preview runs in the background, after the parameters stopped changing
+    for attempt in range(600):
+      slicer.app.processEvents()
+      previewNode = widget.preview.previewNode
+      if widget.preview.cliNode is None and not widget.previewTimer.active and previewNode is not None:
+        break
+      qt.QThread.msleep(100)
+    self.assertIsNotNone(widget.preview.previewNode)
+    self.assertGreater(widget.preview.previewNode.GetPolyData().GetNumberOfPoints(), 0)
+
+    slicer.util.findChild(widget.parent, "ApplyButton").click()
+    self.assertIsNone(widget.preview.previewNode)
+    self.assertEqual(outputModelNode.GetPolyData().GetNumberOfPoints(), modelNode.GetPolyData().GetNumberOfPoints())
+
+    slicer.util.findChild(widget.parent, "PreviewCheckBox").checked = False
+    self.delayDisplay('Test passed!')
+
+  def test_SurfaceToolboxBatch(self):
+    """Clean and decimate several models at the same time"""
+    self.delayDisplay("Starting the batch test")
+    modelNodes = []
+    for index in range(4):
+      sphere = vtk.vtkSphereSource()
+      sphere.SetThetaResolution(40 + 10 * index)
+      sphere.SetPhiResolution(40 + 10 * index)
+      sphere.Update()
+      modelNodes.append(slicer.modules.models.logic().AddModel(sphere.GetOutput()))
+
+    finished = []
+    batch = SurfaceToolboxBatch(["Cleaner", "Decimation"], {"decimate": 0.5},
+      finishedCallback=finished.append, maximumNumberOfJobs=2)
+    for modelNode in modelNodes:
+      batch.addModelNode(modelNode)
+    batch.start()
+    for attempt in range(600):
+      if finished:
+        break
+      slicer.app.processEvents()
+      qt.QThread.msleep(100)
+
+    self.assertEqual(len(finished), 1)
+    self.assertEqual(len(batch.completedJobs), len(modelNodes))
+    self.assertEqual(batch.failedJobs, [])
+    for job in batch.jobs:
+      self.assertLess(job["outputModelNode"].GetPolyData().GetNumberOfCells(),
+                      job["inputModelNode"].GetPolyData().GetNumberOfCells())
+    self.delayDisplay('Test passed!')
+
+  def test_SurfaceToolboxSharedMemory(self):
+    """Pass the surfaces of a SurfacePipeline run through shared memory segments"""
+    if os.name != "posix":
+      self.skipTest("Shared memory transport is only available on Linux and macOS")
+    self.delayDisplay("Starting the shared memory test")
+    sphere = vtk.vtkSphereSource()
+    sphere.SetThetaResolution(40)
+    sphere.SetPhiResolution(40)
+    sphere.Update()
+    inputModelNode = slicer.modules.models.logic().AddModel(sphere.GetOutput())
+    outputModelNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLModelNode", "output")
+
+    logic = SurfaceToolboxLogic()
+    success = logic.runSharedMemoryPipeline({"stages": "Decimation", "decimate": 0.5}, inputModelNode, outputModelNode)
+    self.assertTrue(success)
+    self.assertGreater(outputModelNode.GetPolyData().GetNumberOfCells(), 0)
+    self.assertLess(outputModelNode.GetPolyData().GetNumberOfCells(), sphere.GetOutput().GetNumberOfCells())
+    self.delayDisplay('Test passed!')
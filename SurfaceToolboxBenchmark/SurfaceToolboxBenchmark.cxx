@@ -0,0 +1,464 @@
+// Time the stages of the surface toolbox on deterministic synthetic surfaces
+// and report the results as JSON, so that runs can be compared.
+//
+// Usage: SurfaceToolboxBenchmark [--sizes all|n1,n2,...] [--meshes sphere,torus,islands]
+//                                [--modules Name1,Name2,...] [--repeat n] [--threads n]
+//                                [--reorder Hilbert|Morton] [--output results.json]
+
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxMassProperties.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxMeshValues.h"
+#include "SurfaceToolboxPipeline.h"
+#include "SurfaceToolboxReorder.h"
+
+#include "SurfaceToolboxSyntheticMeshes.h"
+
+// VTK includes
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const char* MassPropertiesModule = "volumePolyData";
+const char* MeshValuesModule = "meshValues";
+// Text file written by the meshValues module in the current directory, and
+// removed after each run
+const char* MeshValuesFileName = "SurfaceToolboxBenchmark_meshValues.csv";
+
+struct BenchmarkResult
+{
+  std::string Mesh;
+  // "input", or the curve along which the mesh was reordered
+  std::string Order;
+  std::string Module;
+  vtkIdType RequestedTriangles = 0;
+  vtkIdType NumberOfPoints = 0;
+  vtkIdType NumberOfTriangles = 0;
+  vtkIdType NumberOfOutputTriangles = 0;
+  double Seconds = 0.0;
+  long long PeakMemory = 0;
+  // -1 if hardware counters are not available, or with several threads
+  long long CacheMisses = -1;
+  // Relative to the same module on the input order, for reordered meshes
+  double CacheMissReduction = 0.0;
+  bool Succeeded = false;
+};
+
+//----------------------------------------------------------------------------
+// Cache misses of the calling thread, from the hardware counters of Linux
+// perf events, in user space. The worker threads kept by the SMP backend
+// cannot be counted, so the counter is only opened if \a enabled, when the
+// stages run on one thread (--threads 1). Read returns -1 otherwise, on other
+// systems, or if perf events are not permitted (kernel.perf_event_paranoid).
+class CacheMissCounter
+{
+public:
+  explicit CacheMissCounter(bool enabled)
+  {
+#ifdef __linux__
+    if (!enabled)
+      {
+      return;
+      }
+    perf_event_attr attributes;
+    std::fill(reinterpret_cast<char*>(&attributes), reinterpret_cast<char*>(&attributes) + sizeof(attributes), 0);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    this->FileDescriptor = static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+    (void)enabled;
+#endif
+  }
+
+  ~CacheMissCounter()
+  {
+#ifdef __linux__
+    if (this->FileDescriptor >= 0)
+      {
+      close(this->FileDescriptor);
+      }
+#endif
+  }
+
+  long long Read() const
+  {
+#ifdef __linux__
+    std::uint64_t count = 0;
+    if (this->FileDescriptor >= 0 && read(this->FileDescriptor, &count, sizeof(count)) == sizeof(count))
+      {
+      return static_cast<long long>(count);
+      }
+#endif
+    return -1;
+  }
+
+private:
+  int FileDescriptor = -1;
+};
+
+//----------------------------------------------------------------------------
+std::vector<std::string> Split(const std::string& text)
+{
+  std::vector<std::string> items;
+  std::istringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ','))
+    {
+    if (!item.empty())
+      {
+      items.push_back(item);
+      }
+    }
+  return items;
+}
+
+//----------------------------------------------------------------------------
+// Reset the peak resident set size of the process to its current size, so
+// that the peak of each run can be measured. Only possible on Linux; returns
+// false elsewhere, where the peak is the peak since the process started.
+bool ResetPeakMemory()
+{
+#ifdef __linux__
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+  clearRefs.close();
+  return static_cast<bool>(clearRefs);
+#else
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// Peak resident set size of the process, in bytes
+long long GetPeakMemory()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+    return static_cast<long long>(counters.PeakWorkingSetSize);
+    }
+  return 0;
+#else
+#ifdef __linux__
+  // VmHWM follows the resets of ResetPeakMemory, ru_maxrss does not
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    {
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      {
+      return std::atoll(line.c_str() + 6) * 1024;
+      }
+    }
+#endif
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return static_cast<long long>(usage.ru_maxrss);
+#else
+  return static_cast<long long>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+//----------------------------------------------------------------------------
+vtkIdType GetNumberOfTriangles(vtkPolyData* polyData)
+{
+  return polyData ? polyData->GetNumberOfPolys() + polyData->GetNumberOfStrips() : 0;
+}
+
+//----------------------------------------------------------------------------
+// Run \a module once on a copy of \a mesh. The copy is not timed.
+void RunModule(const std::string& module, vtkPolyData* mesh, const SurfaceToolbox::PipelineParameters& parameters,
+               const CacheMissCounter& cacheMisses, BenchmarkResult& result)
+{
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->DeepCopy(mesh);
+  ResetPeakMemory();
+  const long long firstCacheMisses = cacheMisses.Read();
+  auto start = std::chrono::steady_clock::now();
+  if (module == MassPropertiesModule)
+    {
+    SurfaceToolbox::MassProperties properties;
+    result.Succeeded = SurfaceToolbox::ComputeMassProperties(input, properties);
+    result.NumberOfOutputTriangles = 0;
+    }
+  else if (module == MeshValuesModule)
+    {
+    // As the meshValues CLI once its input is read: flat arrays written as text
+    SurfaceToolbox::MeshValues values;
+    std::vector<double> coordinates;
+    SurfaceToolbox::GetPointCoordinates(input, coordinates);
+    values.Points.assign(coordinates.begin(), coordinates.end());
+    std::vector<vtkIdType> triangles;
+    SurfaceToolbox::GetTriangles(input, triangles);
+    values.Triangles.assign(triangles.begin(), triangles.end());
+    result.Succeeded = SurfaceToolbox::WriteMeshValuesCSV(values, MeshValuesFileName);
+    result.NumberOfOutputTriangles = values.GetNumberOfTriangles();
+    }
+  else
+    {
+    vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::RunStage(module, input, parameters);
+    result.Succeeded = output != nullptr;
+    result.NumberOfOutputTriangles = GetNumberOfTriangles(output);
+    }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  const long long lastCacheMisses = cacheMisses.Read();
+  result.Seconds = elapsed.count();
+  result.PeakMemory = GetPeakMemory();
+  result.CacheMisses = firstCacheMisses >= 0 && lastCacheMisses >= 0 ? lastCacheMisses - firstCacheMisses : -1;
+  if (module == MeshValuesModule)
+    {
+    std::remove(MeshValuesFileName);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Run \a module \a repeat times on \a mesh and return the fastest run, with
+// the largest peak memory and the fewest cache misses.
+BenchmarkResult RunBenchmark(const std::string& meshName, const std::string& order, vtkIdType size,
+                             const std::string& module, vtkPolyData* mesh,
+                             const SurfaceToolbox::PipelineParameters& parameters, int repeat,
+                             const CacheMissCounter& cacheMisses)
+{
+  BenchmarkResult best;
+  long long peakMemory = 0;
+  long long fewestCacheMisses = -1;
+  for (int run = 0; run < repeat; ++run)
+    {
+    BenchmarkResult result;
+    result.Mesh = meshName;
+    result.Order = order;
+    result.Module = module;
+    result.RequestedTriangles = size;
+    result.NumberOfPoints = mesh->GetNumberOfPoints();
+    result.NumberOfTriangles = GetNumberOfTriangles(mesh);
+    RunModule(module, mesh, parameters, cacheMisses, result);
+    peakMemory = std::max(peakMemory, result.PeakMemory);
+    if (result.CacheMisses >= 0 && (fewestCacheMisses < 0 || result.CacheMisses < fewestCacheMisses))
+      {
+      fewestCacheMisses = result.CacheMisses;
+      }
+    if (run == 0 || result.Seconds < best.Seconds)
+      {
+      best = result;
+      }
+    }
+  best.PeakMemory = peakMemory;
+  best.CacheMisses = fewestCacheMisses;
+  return best;
+}
+
+//----------------------------------------------------------------------------
+void WriteResults(const std::vector<BenchmarkResult>& results, bool peakMemoryPerRun, std::ostream& output)
+{
+  output.precision(std::numeric_limits<double>::max_digits10);
+  output << "{\n"
+         << "  \"backend\": \"" << vtkSMPTools::GetBackend() << "\",\n"
+         << "  \"threads\": " << vtkSMPTools::GetEstimatedNumberOfThreads() << ",\n"
+         << "  \"peakMemoryPerRun\": " << (peakMemoryPerRun ? "true" : "false") << ",\n"
+         << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i)
+    {
+    const BenchmarkResult& result = results[i];
+    const double trianglesPerSecond = result.Seconds > 0.0 ? result.NumberOfTriangles / result.Seconds : 0.0;
+    output << (i == 0 ? "\n" : ",\n")
+           << "    {\"mesh\": \"" << result.Mesh << "\", \"order\": \"" << result.Order << "\""
+           << ", \"module\": \"" << result.Module << "\""
+           << ", \"requestedTriangles\": " << result.RequestedTriangles
+           << ", \"points\": " << result.NumberOfPoints
+           << ", \"triangles\": " << result.NumberOfTriangles
+           << ", \"outputTriangles\": " << result.NumberOfOutputTriangles
+           << ", \"seconds\": " << result.Seconds
+           << ", \"trianglesPerSecond\": " << trianglesPerSecond
+           << ", \"peakRSSBytes\": " << result.PeakMemory
+           << ", \"cacheMisses\": " << result.CacheMisses;
+    if (result.Order != "input")
+      {
+      output << ", \"cacheMissReduction\": " << result.CacheMissReduction;
+      }
+    output
+           << ", \"succeeded\": " << (result.Succeeded ? "true" : "false") << "}";
+    }
+  output << "\n  ]\n}\n";
+}
+
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  std::vector<vtkIdType> sizes = { 10000, 100000, 1000000 };
+  std::vector<std::string> meshes = SurfaceToolbox::GetSyntheticMeshNames();
+  std::vector<std::string> modules = SurfaceToolbox::GetStageNames();
+  modules.push_back(MassPropertiesModule);
+  modules.push_back(MeshValuesModule);
+  int repeat = 1;
+  std::string reorderCurve;
+  std::string outputFileName;
+
+  for (int i = 1; i < argc; ++i)
+    {
+    const std::string argument = argv[i];
+    if (i + 1 >= argc)
+      {
+      std::cerr << "Missing value for " << argument << std::endl;
+      return EXIT_FAILURE;
+      }
+    const std::string value = argv[++i];
+    if (argument == "--sizes")
+      {
+      sizes.clear();
+      for (const std::string& size : Split(value == "all" ? "10000,100000,1000000,10000000,50000000" : value))
+        {
+        sizes.push_back(std::atoll(size.c_str()));
+        }
+      }
+    else if (argument == "--meshes")
+      {
+      meshes = Split(value);
+      }
+    else if (argument == "--modules")
+      {
+      modules = Split(value);
+      }
+    else if (argument == "--repeat")
+      {
+      repeat = std::max(1, std::atoi(value.c_str()));
+      }
+    else if (argument == "--threads")
+      {
+      vtkSMPTools::Initialize(std::atoi(value.c_str()));
+      }
+    else if (argument == "--reorder")
+      {
+      reorderCurve = value;
+      }
+    else if (argument == "--output")
+      {
+      outputFileName = value;
+      }
+    else
+      {
+      std::cerr << "Unknown argument " << argument << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  for (const std::string& module : modules)
+    {
+    if (module != MassPropertiesModule && module != MeshValuesModule && !SurfaceToolbox::IsStage(module))
+      {
+      std::cerr << "Unknown module " << module << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (!reorderCurve.empty() && reorderCurve != "Hilbert" && reorderCurve != "Morton")
+    {
+    std::cerr << "Unknown reordering curve " << reorderCurve << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const bool peakMemoryPerRun = ResetPeakMemory();
+  // Cache misses are only counted on one thread, see CacheMissCounter
+  const bool singleThread = vtkSMPTools::GetEstimatedNumberOfThreads() == 1;
+  if (!singleThread)
+    {
+    std::cerr << "Cache misses are only counted with --threads 1" << std::endl;
+    }
+  const CacheMissCounter cacheMisses(singleThread);
+  const SurfaceToolbox::PipelineParameters parameters;
+  std::vector<BenchmarkResult> results;
+  for (const std::string& meshName : meshes)
+    {
+    for (vtkIdType size : sizes)
+      {
+      vtkSmartPointer<vtkPolyData> mesh = SurfaceToolbox::CreateSyntheticMesh(meshName, size);
+      if (!mesh)
+        {
+        std::cerr << "Unknown mesh " << meshName << std::endl;
+        return EXIT_FAILURE;
+        }
+      // With --reorder, every module also runs on the mesh sorted along the
+      // curve, which is not timed, to measure the effect of the point order
+      vtkSmartPointer<vtkPolyData> reorderedMesh;
+      if (!reorderCurve.empty())
+        {
+        SurfaceToolbox::ReorderParameters reorderParameters;
+        reorderParameters.Curve = reorderCurve;
+        reorderedMesh = SurfaceToolbox::RunReorder(mesh, reorderParameters);
+        }
+      for (const std::string& module : modules)
+        {
+        BenchmarkResult best = RunBenchmark(meshName, "input", size, module, mesh, parameters, repeat, cacheMisses);
+        std::cerr << meshName << " " << best.NumberOfTriangles << " " << module << ": " << best.Seconds << " s"
+                  << std::endl;
+        results.push_back(best);
+        if (!reorderedMesh)
+          {
+          continue;
+          }
+        BenchmarkResult reordered =
+          RunBenchmark(meshName, reorderCurve, size, module, reorderedMesh, parameters, repeat, cacheMisses);
+        std::cerr << meshName << " " << reordered.NumberOfTriangles << " " << module << " (" << reorderCurve
+                  << "): " << reordered.Seconds << " s";
+        if (best.CacheMisses > 0 && reordered.CacheMisses >= 0)
+          {
+          reordered.CacheMissReduction = 1.0 - static_cast<double>(reordered.CacheMisses) / best.CacheMisses;
+          std::cerr << ", " << 100.0 * reordered.CacheMissReduction << "% fewer cache misses";
+          }
+        std::cerr << std::endl;
+        results.push_back(reordered);
+        }
+      }
+    }
+
+  // Failed runs are reported, and make the benchmark fail once written
+  const bool succeeded = std::all_of(results.begin(), results.end(), [](const BenchmarkResult& result)
+    {
+    return result.Succeeded;
+    });
+  if (outputFileName.empty())
+    {
+    WriteResults(results, peakMemoryPerRun, std::cout);
+    return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  std::ofstream output(outputFileName.c_str());
+  WriteResults(results, peakMemoryPerRun, output);
+  if (!output)
+    {
+    std::cerr << "Cannot write " << outputFileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,305 @@
+#include "SurfaceToolboxSyntheticMeshes.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+
+const double Pi = 3.14159265358979323846;
+
+//----------------------------------------------------------------------------
+// Value in [-1, 1) derived from (seed, id) by the splitmix64 finalizer
+double Hash(std::uint64_t seed, std::uint64_t id)
+{
+  std::uint64_t x = seed * 0x9E3779B97F4A7C15ull + id + 1;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return static_cast<double>(x >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+//----------------------------------------------------------------------------
+// Latitude-longitude sphere: a pole, NumberOfRings - 1 rings of
+// NumberOfSectors points, and the other pole.
+struct SphereGrid
+{
+  vtkIdType NumberOfSectors;
+  vtkIdType NumberOfRings;
+
+  explicit SphereGrid(vtkIdType numberOfTriangles)
+  {
+    // 2 * sectors * (rings - 1) triangles, with twice as many sectors as rings
+    this->NumberOfRings = std::max<vtkIdType>(3, static_cast<vtkIdType>(
+      std::lround(0.5 + std::sqrt(static_cast<double>(numberOfTriangles) / 4.0))));
+    this->NumberOfSectors = 2 * this->NumberOfRings;
+  }
+
+  vtkIdType GetNumberOfPoints() const { return this->NumberOfSectors * (this->NumberOfRings - 1) + 2; }
+  vtkIdType GetNumberOfTriangles() const { return 2 * this->NumberOfSectors * (this->NumberOfRings - 1); }
+};
+
+//----------------------------------------------------------------------------
+// Fill the points and triangles of a sphere, whose point ids start at
+// firstPointId.
+void FillSphere(const SphereGrid& grid, const double center[3], double radius, double noise, std::uint64_t seed,
+                vtkIdType firstPointId, float* points, vtkIdType* connectivity)
+{
+  const vtkIdType sectors = grid.NumberOfSectors;
+  const vtkIdType rings = grid.NumberOfRings;
+  const vtkIdType southPole = grid.GetNumberOfPoints() - 1;
+  vtkSMPTools::For(0, grid.GetNumberOfPoints(), [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      double theta = 0.0;
+      double phi = 0.0;
+      if (pointId == southPole)
+        {
+        theta = Pi;
+        }
+      else if (pointId > 0)
+        {
+        theta = Pi * static_cast<double>(1 + (pointId - 1) / sectors) / rings;
+        phi = 2.0 * Pi * static_cast<double>((pointId - 1) % sectors) / sectors;
+        }
+      const double r = radius * (1.0 + noise * Hash(seed, pointId));
+      float* point = points + 3 * pointId;
+      point[0] = static_cast<float>(center[0] + r * std::sin(theta) * std::cos(phi));
+      point[1] = static_cast<float>(center[1] + r * std::sin(theta) * std::sin(phi));
+      point[2] = static_cast<float>(center[2] + r * std::cos(theta));
+      }
+    });
+
+  auto ringPoint = [&](vtkIdType ring, vtkIdType sector)
+    {
+    return firstPointId + 1 + (ring - 1) * sectors + sector % sectors;
+    };
+  const vtkIdType bandTriangles = 2 * sectors * (rings - 2);
+  vtkSMPTools::For(0, grid.GetNumberOfTriangles(), [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType triangleId = begin; triangleId < end; ++triangleId)
+      {
+      vtkIdType* triangle = connectivity + 3 * triangleId;
+      if (triangleId < sectors)
+        {
+        triangle[0] = firstPointId;
+        triangle[1] = ringPoint(1, triangleId);
+        triangle[2] = ringPoint(1, triangleId + 1);
+        }
+      else if (triangleId < sectors + bandTriangles)
+        {
+        const vtkIdType quad = (triangleId - sectors) / 2;
+        const vtkIdType ring = 1 + quad / sectors;
+        const vtkIdType sector = quad % sectors;
+        const vtkIdType a = ringPoint(ring, sector);
+        const vtkIdType b = ringPoint(ring, sector + 1);
+        const vtkIdType c = ringPoint(ring + 1, sector);
+        const vtkIdType d = ringPoint(ring + 1, sector + 1);
+        if ((triangleId - sectors) % 2 == 0)
+          {
+          triangle[0] = a;
+          triangle[1] = c;
+          triangle[2] = d;
+          }
+        else
+          {
+          triangle[0] = a;
+          triangle[1] = d;
+          triangle[2] = b;
+          }
+        }
+      else
+        {
+        const vtkIdType sector = triangleId - sectors - bandTriangles;
+        triangle[0] = firstPointId + southPole;
+        triangle[1] = ringPoint(rings - 1, sector + 1);
+        triangle[2] = ringPoint(rings - 1, sector);
+        }
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+// Surface made of numberOfTriangles triangles whose points and connectivity
+// are filled by the caller.
+struct TriangleMesh
+{
+  vtkSmartPointer<vtkFloatArray> Points = vtkSmartPointer<vtkFloatArray>::New();
+  vtkSmartPointer<vtkIdTypeArray> Connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+
+  TriangleMesh(vtkIdType numberOfPoints, vtkIdType numberOfTriangles)
+  {
+    this->Points->SetNumberOfComponents(3);
+    this->Points->SetNumberOfTuples(numberOfPoints);
+    this->Connectivity->SetNumberOfValues(3 * numberOfTriangles);
+  }
+
+  vtkSmartPointer<vtkPolyData> CreatePolyData()
+  {
+    const vtkIdType numberOfTriangles = this->Connectivity->GetNumberOfValues() / 3;
+    vtkSmartPointer<vtkIdTypeArray> offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(numberOfTriangles + 1);
+    vtkIdType* offset = offsets->GetPointer(0);
+    vtkSMPTools::For(0, numberOfTriangles + 1, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        offset[i] = 3 * i;
+        }
+      });
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, this->Connectivity);
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(this->Points);
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(polys);
+    return polyData;
+  }
+};
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+const std::vector<std::string>& GetSyntheticMeshNames()
+{
+  static const std::vector<std::string> names = { "sphere", "torus", "islands" };
+  return names;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> CreateSyntheticMesh(const std::string& name, vtkIdType numberOfTriangles)
+{
+  if (name == "sphere")
+    {
+    return CreateSphereMesh(numberOfTriangles);
+    }
+  if (name == "torus")
+    {
+    return CreateTorusMesh(numberOfTriangles);
+    }
+  if (name == "islands")
+    {
+    return CreateIslandsMesh(numberOfTriangles);
+    }
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> CreateSphereMesh(vtkIdType numberOfTriangles)
+{
+  const SphereGrid grid(numberOfTriangles);
+  TriangleMesh mesh(grid.GetNumberOfPoints(), grid.GetNumberOfTriangles());
+  const double center[3] = { 0.0, 0.0, 0.0 };
+  FillSphere(grid, center, 1.0, 0.0, 0, 0, mesh.Points->GetPointer(0), mesh.Connectivity->GetPointer(0));
+  return mesh.CreatePolyData();
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> CreateTorusMesh(vtkIdType numberOfTriangles, double noise)
+{
+  // 2 * sectors * rings triangles, with three times as many sectors around
+  // the axis as around the tube
+  const vtkIdType rings = std::max<vtkIdType>(3, static_cast<vtkIdType>(
+    std::lround(std::sqrt(static_cast<double>(numberOfTriangles) / 6.0))));
+  const vtkIdType sectors = 3 * rings;
+  const double majorRadius = 1.0;
+  const double minorRadius = 0.35;
+  TriangleMesh mesh(sectors * rings, 2 * sectors * rings);
+
+  float* points = mesh.Points->GetPointer(0);
+  vtkSMPTools::For(0, sectors * rings, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      const double phi = 2.0 * Pi * static_cast<double>(pointId / rings) / sectors;
+      const double theta = 2.0 * Pi * static_cast<double>(pointId % rings) / rings;
+      const double r = minorRadius * (1.0 + noise * Hash(1, pointId));
+      float* point = points + 3 * pointId;
+      point[0] = static_cast<float>((majorRadius + r * std::cos(theta)) * std::cos(phi));
+      point[1] = static_cast<float>((majorRadius + r * std::cos(theta)) * std::sin(phi));
+      point[2] = static_cast<float>(r * std::sin(theta));
+      }
+    });
+
+  vtkIdType* connectivity = mesh.Connectivity->GetPointer(0);
+  vtkSMPTools::For(0, 2 * sectors * rings, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType triangleId = begin; triangleId < end; ++triangleId)
+      {
+      const vtkIdType quad = triangleId / 2;
+      const vtkIdType sector = quad / rings;
+      const vtkIdType ring = quad % rings;
+      const vtkIdType nextSector = (sector + 1) % sectors;
+      const vtkIdType nextRing = (ring + 1) % rings;
+      const vtkIdType a = sector * rings + ring;
+      const vtkIdType b = nextSector * rings + ring;
+      const vtkIdType c = sector * rings + nextRing;
+      const vtkIdType d = nextSector * rings + nextRing;
+      vtkIdType* triangle = connectivity + 3 * triangleId;
+      triangle[0] = a;
+      triangle[1] = triangleId % 2 == 0 ? b : d;
+      triangle[2] = triangleId % 2 == 0 ? d : c;
+      }
+    });
+  return mesh.CreatePolyData();
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> CreateIslandsMesh(vtkIdType numberOfTriangles, int numberOfIslands)
+{
+  numberOfIslands = std::max(1, numberOfIslands);
+  int gridSize = 1;
+  while (gridSize * gridSize * gridSize < numberOfIslands)
+    {
+    ++gridSize;
+    }
+
+  // Islands get between a third and the whole of the largest share of the
+  // triangles
+  std::vector<double> weights(numberOfIslands);
+  double totalWeight = 0.0;
+  for (int island = 0; island < numberOfIslands; ++island)
+    {
+    weights[island] = 2.0 + Hash(2, island);
+    totalWeight += weights[island];
+    }
+  std::vector<SphereGrid> grids;
+  std::vector<vtkIdType> firstPointIds(1, 0);
+  std::vector<vtkIdType> firstTriangleIds(1, 0);
+  for (int island = 0; island < numberOfIslands; ++island)
+    {
+    grids.emplace_back(static_cast<vtkIdType>(numberOfTriangles * weights[island] / totalWeight));
+    firstPointIds.push_back(firstPointIds.back() + grids.back().GetNumberOfPoints());
+    firstTriangleIds.push_back(firstTriangleIds.back() + grids.back().GetNumberOfTriangles());
+    }
+
+  TriangleMesh mesh(firstPointIds.back(), firstTriangleIds.back());
+  for (int island = 0; island < numberOfIslands; ++island)
+    {
+    const double center[3] = { static_cast<double>(island % gridSize),
+                               static_cast<double>((island / gridSize) % gridSize),
+                               static_cast<double>(island / (gridSize * gridSize)) };
+    const double radius = 0.25 * std::sqrt(weights[island] / 3.0) + 0.1;
+    FillSphere(grids[island], center, radius, 0.05, 3 + island, firstPointIds[island],
+               mesh.Points->GetPointer(3 * firstPointIds[island]),
+               mesh.Connectivity->GetPointer(3 * firstTriangleIds[island]));
+    }
+  return mesh.CreatePolyData();
+}
+
+}
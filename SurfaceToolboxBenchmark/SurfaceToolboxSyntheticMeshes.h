@@ -0,0 +1,41 @@
+#ifndef SurfaceToolboxSyntheticMeshes_h
+#define SurfaceToolboxSyntheticMeshes_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+class vtkPolyData;
+
+// Deterministic synthetic surfaces for the benchmark. The same arguments give
+// the same surface on every platform and with any number of threads: the
+// noise is a hash of the point id, not a random generator. All surfaces are
+// closed, consistently oriented triangle meshes with float points.
+namespace SurfaceToolbox
+{
+
+/// Names of the synthetic surfaces: "sphere", "torus" and "islands".
+const std::vector<std::string>& GetSyntheticMeshNames();
+
+/// Create the synthetic surface called \a name with about \a numberOfTriangles
+/// triangles. Returns nullptr if \a name is unknown.
+vtkSmartPointer<vtkPolyData> CreateSyntheticMesh(const std::string& name, vtkIdType numberOfTriangles);
+
+/// Unit latitude-longitude sphere.
+vtkSmartPointer<vtkPolyData> CreateSphereMesh(vtkIdType numberOfTriangles);
+
+/// Torus of radii 1 and 0.35 whose points are moved along the normal of the
+/// tube by up to \a noise times the tube radius.
+vtkSmartPointer<vtkPolyData> CreateTorusMesh(vtkIdType numberOfTriangles, double noise = 0.1);
+
+/// Noisy spheres of different sizes on a 3x3x3 grid, as the surfaces of a
+/// segmentation with many islands, that share the triangles between them.
+vtkSmartPointer<vtkPolyData> CreateIslandsMesh(vtkIdType numberOfTriangles, int numberOfIslands = 27);
+
+}
+
+#endif
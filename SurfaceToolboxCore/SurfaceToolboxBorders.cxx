@@ -0,0 +1,528 @@
+#include "SurfaceToolboxBorders.h"
+#include "SurfaceToolboxCleaner.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxTopology.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Lock-free open-addressing hash table counting the uses of undirected edges.
+// The key of an edge packs its sorted point ids, so point ids must fit in 32
+// bits. Each edge remembers the face and position of the use that inserted
+// it, which is its only use for boundary edges.
+class EdgeUseTable
+{
+public:
+  EdgeUseTable(vtkIdType numberOfPoints, vtkIdType maximumNumberOfEdges)
+  {
+    size_t size = 16;
+    while (size <= static_cast<size_t>(maximumNumberOfEdges))
+      {
+      size *= 2;
+      }
+    this->Mask = size - 1;
+    this->SlotsPerPoint = static_cast<double>(size) / numberOfPoints;
+    this->Slots = std::vector<Slot>(size);
+  }
+
+  static vtkTypeUInt64 GetKey(vtkIdType a, vtkIdType b)
+  {
+    if (a > b)
+      {
+      std::swap(a, b);
+      }
+    // a < b, so the key is never EmptyKey
+    return (static_cast<vtkTypeUInt64>(a) << 32) | static_cast<vtkTypeUInt64>(b);
+  }
+
+  void Insert(vtkTypeUInt64 key, vtkIdType face, int position)
+  {
+    // Edges are placed near their smallest point id, so that the edges of
+    // nearby faces, which usually have close point ids, share cache lines.
+    const vtkTypeUInt64 smallestPointId = key >> 32;
+    const size_t start = static_cast<size_t>(smallestPointId * this->SlotsPerPoint);
+    for (size_t index = start & this->Mask; ; index = (index + 1) & this->Mask)
+      {
+      Slot& slot = this->Slots[index];
+      vtkTypeUInt64 slotKey = slot.Key.load(std::memory_order_relaxed);
+      if (slotKey == EmptyKey && slot.Key.compare_exchange_strong(slotKey, key, std::memory_order_relaxed))
+        {
+        slot.Face = face;
+        slot.Position = position;
+        slot.Uses.fetch_add(1, std::memory_order_relaxed);
+        return;
+        }
+      // slotKey now holds the key of the slot, possibly just inserted by another thread
+      if (slotKey == key)
+        {
+        slot.Uses.fetch_add(1, std::memory_order_relaxed);
+        return;
+        }
+      }
+  }
+
+  size_t GetSize() const
+  {
+    return this->Slots.size();
+  }
+
+  int GetUses(size_t index) const
+  {
+    return this->Slots[index].Uses.load(std::memory_order_relaxed);
+  }
+
+  vtkIdType GetFace(size_t index) const
+  {
+    return this->Slots[index].Face;
+  }
+
+  int GetPosition(size_t index) const
+  {
+    return this->Slots[index].Position;
+  }
+
+private:
+  static const vtkTypeUInt64 EmptyKey = 0;
+
+  // All the fields of an edge in one cache line
+  struct Slot
+  {
+    std::atomic<vtkTypeUInt64> Key{ EmptyKey };
+    std::atomic<int> Uses{ 0 };
+    int Position = 0;
+    vtkIdType Face = -1;
+  };
+
+  size_t Mask;
+  double SlotsPerPoint;
+  std::vector<Slot> Slots;
+};
+
+//----------------------------------------------------------------------------
+struct BoundaryEdge
+{
+  vtkIdType Face;
+  int Position;
+  vtkIdType From;
+  vtkIdType To;
+
+  bool operator<(const BoundaryEdge& other) const
+  {
+    return this->Face < other.Face || (this->Face == other.Face && this->Position < other.Position);
+  }
+};
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+bool GetBoundaryLoops(vtkPolyData* input, bool mergeCoincidentPoints, std::vector<BoundaryLoop>& loops,
+                      std::vector<vtkIdType>& loopOffsets, std::vector<vtkIdType>& loopPoints)
+{
+  loops.clear();
+  loopOffsets.assign(1, 0);
+  loopPoints.clear();
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  if (numberOfPoints == 0)
+    {
+    return true;
+    }
+  if (mergeCoincidentPoints && static_cast<vtkTypeUInt64>(numberOfPoints) > std::numeric_limits<vtkTypeUInt32>::max())
+    {
+    std::cerr << "Cannot merge the boundary points of a surface with more than 2^32 points" << std::endl;
+    return false;
+    }
+
+  std::vector<vtkIdType> pointIds;
+  if (mergeCoincidentPoints)
+    {
+    pointIds = ComputePointMergeMap(input->GetPoints(), 0.0);
+    }
+  else
+    {
+    pointIds.resize(numberOfPoints);
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType pointId = begin; pointId < end; ++pointId)
+        {
+        pointIds[pointId] = pointId;
+        }
+      });
+    }
+
+  std::shared_ptr<const SurfaceTopology> topology = GetSurfaceTopology(input);
+  const SurfaceTopology& faces = *topology;
+  const vtkIdType numberOfFaces = faces.GetNumberOfFaces();
+
+  // Edges of the faces, in the orientation of the face: polygon edge j goes
+  // from point j to point j + 1, edge j of strip triangle k is edge 3k + j.
+  auto getNumberOfEdges = [&](vtkIdType face) -> int
+    {
+    const vtkIdType numberOfFacePoints = faces.FaceOffsets[face + 1] - faces.FaceOffsets[face];
+    if (!faces.IsStrip(face))
+      {
+      return numberOfFacePoints > 2 ? static_cast<int>(numberOfFacePoints) : 0;
+      }
+    return numberOfFacePoints > 2 ? static_cast<int>(3 * (numberOfFacePoints - 2)) : 0;
+    };
+  auto getEdge = [&](vtkIdType face, int position, vtkIdType& from, vtkIdType& to)
+    {
+    const vtkIdType* facePoints = faces.FaceConnectivity.data() + faces.FaceOffsets[face];
+    if (!faces.IsStrip(face))
+      {
+      const int numberOfFacePoints = static_cast<int>(faces.FaceOffsets[face + 1] - faces.FaceOffsets[face]);
+      from = pointIds[facePoints[position]];
+      to = pointIds[facePoints[(position + 1) % numberOfFacePoints]];
+      return;
+      }
+    const int triangle = position / 3;
+    const int edge = position % 3;
+    vtkIdType trianglePoints[3] = { facePoints[triangle], facePoints[triangle + 1], facePoints[triangle + 2] };
+    if (trianglePoints[0] == trianglePoints[1] || trianglePoints[1] == trianglePoints[2]
+        || trianglePoints[2] == trianglePoints[0])
+      {
+      // Degenerate triangle, used to change the parity of the next ones: its
+      // edges are reported as a single point, as the edges between merged points
+      from = to = pointIds[trianglePoints[0]];
+      return;
+      }
+    if (triangle % 2)
+      {
+      std::swap(trianglePoints[0], trianglePoints[1]);
+      }
+    from = pointIds[trianglePoints[edge]];
+    to = pointIds[trianglePoints[(edge + 1) % 3]];
+    };
+
+  // Boundary edges found by blocks of items, in parallel
+  const vtkIdType blockSize = 65536;
+  std::vector<std::vector<BoundaryEdge>> blockEdges;
+  auto findBoundaryEdges = [&](vtkIdType numberOfItems, auto find)
+    {
+    const vtkIdType numberOfBlocks = (numberOfItems + blockSize - 1) / blockSize;
+    blockEdges.resize(numberOfBlocks);
+    vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType beginBlock, vtkIdType endBlock)
+      {
+      for (vtkIdType block = beginBlock; block < endBlock; ++block)
+        {
+        const vtkIdType end = std::min(numberOfItems, (block + 1) * blockSize);
+        for (vtkIdType item = block * blockSize; item < end; ++item)
+          {
+          find(item, blockEdges[block]);
+          }
+        }
+      });
+    };
+
+  if (!mergeCoincidentPoints)
+    {
+    // The edges used by a single face are known from the topology. Find that
+    // face among the faces of their smallest point.
+    const EdgeAdjacency& adjacency = faces.Edges;
+    findBoundaryEdges(numberOfPoints, [&](vtkIdType pointId, std::vector<BoundaryEdge>& boundaryEdges)
+      {
+      for (vtkIdType i = adjacency.Offsets[pointId]; i < adjacency.Offsets[pointId + 1]; ++i)
+        {
+        const vtkIdType neighbor = adjacency.Neighbors[i];
+        if (neighbor < pointId || adjacency.EdgeUses[i] != 1)
+          {
+          continue;
+          }
+        BoundaryEdge edge;
+        edge.Face = -1;
+        for (vtkIdType link = faces.LinkOffsets[pointId]; link < faces.LinkOffsets[pointId + 1] && edge.Face < 0; ++link)
+          {
+          const vtkIdType face = faces.Links[link];
+          const int numberOfEdges = getNumberOfEdges(face);
+          for (int position = 0; position < numberOfEdges; ++position)
+            {
+            getEdge(face, position, edge.From, edge.To);
+            if ((edge.From == pointId && edge.To == neighbor) || (edge.From == neighbor && edge.To == pointId))
+              {
+              edge.Face = face;
+              edge.Position = position;
+              break;
+              }
+            }
+          }
+        if (edge.Face >= 0)
+          {
+          boundaryEdges.push_back(edge);
+          }
+        }
+      });
+    }
+  else
+    {
+    // Count the uses of every edge between merged points
+    vtkIdType numberOfFaceEdges = 0;
+    for (vtkIdType face = 0; face < numberOfFaces; ++face)
+      {
+      numberOfFaceEdges += getNumberOfEdges(face);
+      }
+    EdgeUseTable edgeUses(numberOfPoints, numberOfFaceEdges);
+    vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+      {
+      vtkIdType from, to;
+      for (vtkIdType face = begin; face < end; ++face)
+        {
+        const int numberOfEdges = getNumberOfEdges(face);
+        for (int position = 0; position < numberOfEdges; ++position)
+          {
+          getEdge(face, position, from, to);
+          if (from != to)
+            {
+            edgeUses.Insert(EdgeUseTable::GetKey(from, to), face, position);
+            }
+          }
+        }
+      });
+    findBoundaryEdges(static_cast<vtkIdType>(edgeUses.GetSize()),
+      [&](vtkIdType index, std::vector<BoundaryEdge>& boundaryEdges)
+      {
+      if (edgeUses.GetUses(index) == 1)
+        {
+        BoundaryEdge edge;
+        edge.Face = edgeUses.GetFace(index);
+        edge.Position = edgeUses.GetPosition(index);
+        getEdge(edge.Face, edge.Position, edge.From, edge.To);
+        boundaryEdges.push_back(edge);
+        }
+      });
+    }
+
+  // Boundary edges in face order, so that the result does not depend on the
+  // order in which they were found.
+  std::vector<BoundaryEdge> edges;
+  for (const std::vector<BoundaryEdge>& block : blockEdges)
+    {
+    edges.insert(edges.end(), block.begin(), block.end());
+    }
+  vtkSMPTools::Sort(edges.begin(), edges.end());
+  const vtkIdType numberOfEdges = static_cast<vtkIdType>(edges.size());
+
+  // Boundary edges around each point
+  std::vector<vtkIdType> pointEdgeOffsets(numberOfPoints + 1, 0);
+  for (const BoundaryEdge& edge : edges)
+    {
+    ++pointEdgeOffsets[edge.From + 1];
+    ++pointEdgeOffsets[edge.To + 1];
+    }
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    pointEdgeOffsets[pointId + 1] += pointEdgeOffsets[pointId];
+    }
+  std::vector<vtkIdType> pointEdges(2 * numberOfEdges);
+  std::vector<vtkIdType> remainingEdges(numberOfPoints);
+  for (vtkIdType edgeId = 0; edgeId < numberOfEdges; ++edgeId)
+    {
+    pointEdges[pointEdgeOffsets[edges[edgeId].From] + remainingEdges[edges[edgeId].From]++] = edgeId;
+    pointEdges[pointEdgeOffsets[edges[edgeId].To] + remainingEdges[edges[edgeId].To]++] = edgeId;
+    }
+
+  // Chain the edges. At points with more than two boundary edges, the edge
+  // leaving the point in the orientation of its face is preferred.
+  std::vector<unsigned char> visited(numberOfEdges, 0);
+  auto getNextEdge = [&](vtkIdType pointId) -> vtkIdType
+    {
+    vtkIdType next = -1;
+    for (vtkIdType i = pointEdgeOffsets[pointId]; i < pointEdgeOffsets[pointId + 1]; ++i)
+      {
+      const vtkIdType edgeId = pointEdges[i];
+      if (!visited[edgeId])
+        {
+        if (edges[edgeId].From == pointId)
+          {
+          return edgeId;
+          }
+        next = next < 0 ? edgeId : next;
+        }
+      }
+    return next;
+    };
+  vtkPoints* inputPoints = input->GetPoints();
+  auto chain = [&](vtkIdType edgeId, vtkIdType pointId)
+    {
+    BoundaryLoop loop;
+    loopPoints.push_back(pointId);
+    double previous[3], current[3];
+    inputPoints->GetPoint(pointId, previous);
+    while (edgeId >= 0)
+      {
+      visited[edgeId] = 1;
+      --remainingEdges[edges[edgeId].From];
+      --remainingEdges[edges[edgeId].To];
+      pointId = edges[edgeId].From == pointId ? edges[edgeId].To : edges[edgeId].From;
+      loopPoints.push_back(pointId);
+      inputPoints->GetPoint(pointId, current);
+      loop.Perimeter += std::sqrt(vtkMath::Distance2BetweenPoints(previous, current));
+      std::copy(current, current + 3, previous);
+      ++loop.NumberOfEdges;
+      edgeId = getNextEdge(pointId);
+      }
+    loop.Closed = loopPoints[loopOffsets.back()] == pointId;
+    loopOffsets.push_back(static_cast<vtkIdType>(loopPoints.size()));
+    loops.push_back(loop);
+    };
+  // Open chains start and end at points with an odd number of remaining edges
+  for (vtkIdType edgeId = 0; edgeId < numberOfEdges; ++edgeId)
+    {
+    if (!visited[edgeId] && remainingEdges[edges[edgeId].From] % 2)
+      {
+      chain(edgeId, edges[edgeId].From);
+      }
+    else if (!visited[edgeId] && remainingEdges[edges[edgeId].To] % 2)
+      {
+      chain(edgeId, edges[edgeId].To);
+      }
+    }
+  for (vtkIdType edgeId = 0; edgeId < numberOfEdges; ++edgeId)
+    {
+    if (!visited[edgeId])
+      {
+      chain(edgeId, edges[edgeId].From);
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ExtractBoundaryLoops(vtkPolyData* input, const BordersParameters& parameters,
+                                                  std::vector<BoundaryLoop>& loops)
+{
+  std::vector<vtkIdType> loopOffsets;
+  std::vector<vtkIdType> loopPoints;
+  if (!GetBoundaryLoops(input, parameters.MergeCoincidentPoints, loops, loopOffsets, loopPoints))
+    {
+    return nullptr;
+    }
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  if (numberOfPoints == 0)
+    {
+    return output;
+    }
+  vtkPoints* inputPoints = input->GetPoints();
+
+  // Output points in order of first use
+  std::vector<vtkIdType> pointMap(numberOfPoints, -1);
+  std::vector<vtkIdType> outputPointIds;
+  for (vtkIdType& pointId : loopPoints)
+    {
+    if (pointMap[pointId] < 0)
+      {
+      pointMap[pointId] = static_cast<vtkIdType>(outputPointIds.size());
+      outputPointIds.push_back(pointId);
+      }
+    pointId = pointMap[pointId];
+    }
+  const vtkIdType numberOfOutputPoints = static_cast<vtkIdType>(outputPointIds.size());
+  vtkNew<vtkPoints> points;
+  points->SetDataType(inputPoints->GetDataType());
+  points->SetNumberOfPoints(numberOfOutputPoints);
+  vtkSMPTools::For(0, numberOfOutputPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    double point[3];
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      inputPoints->GetPoint(outputPointIds[i], point);
+      points->SetPoint(i, point);
+      }
+    });
+  output->SetPoints(points);
+  vtkPointData* outputPointData = output->GetPointData();
+  outputPointData->CopyAllocate(input->GetPointData(), numberOfOutputPoints);
+  for (vtkIdType i = 0; i < numberOfOutputPoints; ++i)
+    {
+    outputPointData->CopyData(input->GetPointData(), outputPointIds[i], i);
+    }
+
+  const vtkIdType numberOfLoops = static_cast<vtkIdType>(loops.size());
+  vtkNew<vtkIdTypeArray> lineOffsets;
+  lineOffsets->SetNumberOfValues(numberOfLoops + 1);
+  std::copy(loopOffsets.begin(), loopOffsets.end(), lineOffsets->GetPointer(0));
+  vtkNew<vtkIdTypeArray> lineConnectivity;
+  lineConnectivity->SetNumberOfValues(static_cast<vtkIdType>(loopPoints.size()));
+  std::copy(loopPoints.begin(), loopPoints.end(), lineConnectivity->GetPointer(0));
+  vtkNew<vtkCellArray> lines;
+  lines->SetData(lineOffsets, lineConnectivity);
+  output->SetLines(lines);
+
+  vtkNew<vtkIdTypeArray> numberOfEdgesArray;
+  numberOfEdgesArray->SetName("NumberOfEdges");
+  numberOfEdgesArray->SetNumberOfValues(numberOfLoops);
+  vtkNew<vtkDoubleArray> perimeterArray;
+  perimeterArray->SetName("Perimeter");
+  perimeterArray->SetNumberOfValues(numberOfLoops);
+  vtkNew<vtkUnsignedCharArray> closedArray;
+  closedArray->SetName("Closed");
+  closedArray->SetNumberOfValues(numberOfLoops);
+  for (vtkIdType loopId = 0; loopId < numberOfLoops; ++loopId)
+    {
+    numberOfEdgesArray->SetValue(loopId, loops[loopId].NumberOfEdges);
+    perimeterArray->SetValue(loopId, loops[loopId].Perimeter);
+    closedArray->SetValue(loopId, loops[loopId].Closed ? 1 : 0);
+    }
+  output->GetCellData()->AddArray(numberOfEdgesArray);
+  output->GetCellData()->AddArray(perimeterArray);
+  output->GetCellData()->AddArray(closedArray);
+  return output;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunParallelBordersOut(vtkPolyData* input, const BordersParameters& parameters)
+{
+  std::vector<BoundaryLoop> loops;
+  vtkSmartPointer<vtkPolyData> output = ExtractBoundaryLoops(input, parameters, loops);
+  if (output && !parameters.StatisticsFileName.empty() &&
+      !WriteBoundaryLoops(loops, parameters.StatisticsFileName))
+    {
+    return nullptr;
+    }
+  return output;
+}
+
+//----------------------------------------------------------------------------
+bool WriteBoundaryLoops(const std::vector<BoundaryLoop>& loops, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str());
+  if (!file)
+    {
+    std::cerr << "Cannot write boundary loops to " << fileName << std::endl;
+    return false;
+    }
+  file.precision(10);
+  file << "LoopId,NumberOfEdges,Perimeter,Closed\n";
+  for (size_t loopId = 0; loopId < loops.size(); ++loopId)
+    {
+    const BoundaryLoop& loop = loops[loopId];
+    file << loopId << ',' << loop.NumberOfEdges << ',' << loop.Perimeter << ',' << (loop.Closed ? 1 : 0) << '\n';
+    }
+  return static_cast<bool>(file);
+}
+
+}
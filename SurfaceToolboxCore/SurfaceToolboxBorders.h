@@ -0,0 +1,59 @@
+#ifndef SurfaceToolboxBorders_h
+#define SurfaceToolboxBorders_h
+
+#include "SurfaceToolboxStages.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace SurfaceToolbox
+{
+
+struct BoundaryLoop
+{
+  vtkIdType NumberOfEdges = 0;
+  double Perimeter = 0.0;
+  bool Closed = false;
+};
+
+/// Extract the boundary edges of the polygons and strips of \a input, i.e.
+/// the edges used by a single face, as vtkFeatureEdges with only boundary
+/// edges, chained into polylines.
+///
+/// The edges used once are read from the edge adjacency of the topology of
+/// \a input (see GetSurfaceTopology), shared with the other stages. The
+/// boundary edges are then chained: every loop becomes one polyline cell that
+/// follows the orientation of the faces, closed loops repeating their first
+/// point at the end. Edges ending at a point shared by an odd number of
+/// boundary edges give open polylines. The output only has the boundary
+/// points, with their point data, and "NumberOfEdges", "Perimeter" and
+/// "Closed" cell arrays. \a loops receives the same values.
+///
+/// If MergeCoincidentPoints is set, points at the same location are treated
+/// as one, as vtkCleanPolyData would merge them, without rebuilding the cells.
+/// Edge uses are then counted in one parallel pass over the faces, in a
+/// lock-free open-addressing hash table keyed by the sorted point ids of the
+/// edges.
+vtkSmartPointer<vtkPolyData> ExtractBoundaryLoops(vtkPolyData* input, const BordersParameters& parameters,
+                                                  std::vector<BoundaryLoop>& loops);
+
+/// Chain the boundary edges of \a input into loops as ExtractBoundaryLoops,
+/// given as input point ids (the smallest id of coincident points if
+/// \a mergeCoincidentPoints is set): the points of loop i are
+/// loopPoints[loopOffsets[i]] to loopPoints[loopOffsets[i + 1] - 1].
+/// Returns false if \a mergeCoincidentPoints is set and \a input has more
+/// than 2^32 points.
+bool GetBoundaryLoops(vtkPolyData* input, bool mergeCoincidentPoints, std::vector<BoundaryLoop>& loops,
+                      std::vector<vtkIdType>& loopOffsets, std::vector<vtkIdType>& loopPoints);
+
+/// Extract the boundary loops and write their statistics if requested.
+/// Returns nullptr if the statistics file cannot be written.
+vtkSmartPointer<vtkPolyData> RunParallelBordersOut(vtkPolyData* input, const BordersParameters& parameters);
+
+/// Write boundary loop statistics as CSV, one line per loop.
+bool WriteBoundaryLoops(const std::vector<BoundaryLoop>& loops, const std::string& fileName);
+
+}
+
+#endif
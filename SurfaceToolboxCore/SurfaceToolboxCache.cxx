@@ -0,0 +1,501 @@
+#include "SurfaceToolboxCache.h"
+#include "SurfaceToolboxIO.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkFieldData.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkStringArray.h"
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+const vtkTypeUInt64 Prime1 = 0x9E3779B185EBCA87ULL;
+const vtkTypeUInt64 Prime2 = 0xC2B2AE3D27D4EB4FULL;
+const vtkTypeUInt64 Prime3 = 0x165667B19E3779F9ULL;
+const vtkTypeUInt64 Prime4 = 0x85EBCA77C2B2AE63ULL;
+const vtkTypeUInt64 Prime5 = 0x27D4EB2F165667C5ULL;
+
+// Arrays are hashed in blocks of this size, in parallel
+const size_t HashBlockSize = 1 << 20;
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 RotateLeft(vtkTypeUInt64 value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 ReadWord(const unsigned char* data)
+{
+  vtkTypeUInt64 word;
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 Round(vtkTypeUInt64 accumulator, vtkTypeUInt64 word)
+{
+  accumulator += word * Prime2;
+  return RotateLeft(accumulator, 31) * Prime1;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 Merge(vtkTypeUInt64 hash, vtkTypeUInt64 value)
+{
+  hash ^= Round(0, value);
+  return hash * Prime1 + Prime4;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 Avalanche(vtkTypeUInt64 hash)
+{
+  hash ^= hash >> 33;
+  hash *= Prime2;
+  hash ^= hash >> 29;
+  hash *= Prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+//----------------------------------------------------------------------------
+// 64-bit hash of \a size bytes, in the manner of XXH64: four lanes of 8-byte
+// words, so that the loop is bound by memory bandwidth rather than latency.
+// The words are read in the byte order of the host, which is fine for a cache
+// local to the machine.
+vtkTypeUInt64 HashBytes(const unsigned char* data, size_t size, vtkTypeUInt64 seed)
+{
+  const unsigned char* end = data + size;
+  vtkTypeUInt64 hash;
+  if (size >= 32)
+    {
+    vtkTypeUInt64 lanes[4] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+    for (; data + 32 <= end; data += 32)
+      {
+      for (int lane = 0; lane < 4; ++lane)
+        {
+        lanes[lane] = Round(lanes[lane], ReadWord(data + 8 * lane));
+        }
+      }
+    hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+    for (int lane = 0; lane < 4; ++lane)
+      {
+      hash = Merge(hash, lanes[lane]);
+      }
+    }
+  else
+    {
+    hash = seed + Prime5;
+    }
+  hash += static_cast<vtkTypeUInt64>(size);
+  for (; data + 8 <= end; data += 8)
+    {
+    hash = RotateLeft(hash ^ Round(0, ReadWord(data)), 27) * Prime1 + Prime4;
+    }
+  for (; data < end; ++data)
+    {
+    hash = RotateLeft(hash ^ (*data * Prime5), 11) * Prime1;
+    }
+  return Avalanche(hash);
+}
+
+//----------------------------------------------------------------------------
+// Contiguous memory of an array to hash, with a description of the array so
+// that the same values in arrays of another name, type or shape do not hash
+// the same.
+struct HashedBuffer
+{
+  const unsigned char* Data;
+  size_t Size;
+  std::string Description;
+};
+
+//----------------------------------------------------------------------------
+class HashedBuffers
+{
+public:
+  void AddDataArray(vtkDataArray* array, const std::string& role, int attribute)
+  {
+    if (!array)
+      {
+      this->AddDescription(role + " none");
+      return;
+      }
+    if (!array->HasStandardMemoryLayout())
+      {
+      // Implicit and structure of arrays layouts are hashed from a copy
+      vtkSmartPointer<vtkDataArray> copy = vtkSmartPointer<vtkDataArray>::Take(
+        vtkDataArray::CreateDataArray(array->GetDataType()));
+      copy->DeepCopy(array);
+      this->Copies.push_back(copy);
+      array = copy;
+      }
+    std::ostringstream description;
+    description << role << " " << (array->GetName() ? array->GetName() : "") << " " << array->GetDataType()
+                << " " << array->GetNumberOfComponents() << " " << array->GetNumberOfTuples() << " " << attribute;
+    HashedBuffer buffer;
+    buffer.Data = static_cast<const unsigned char*>(array->GetVoidPointer(0));
+    buffer.Size = array->GetDataType() == VTK_BIT
+      ? static_cast<size_t>((array->GetNumberOfValues() + 7) / 8)
+      : static_cast<size_t>(array->GetNumberOfValues()) * array->GetDataTypeSize();
+    buffer.Description = description.str();
+    this->Buffers.push_back(buffer);
+  }
+
+  void AddFieldData(vtkFieldData* fieldData, const std::string& role)
+  {
+    vtkDataSetAttributes* attributes = vtkDataSetAttributes::SafeDownCast(fieldData);
+    for (int i = 0; i < fieldData->GetNumberOfArrays(); ++i)
+      {
+      vtkAbstractArray* array = fieldData->GetAbstractArray(i);
+      const int attribute = attributes ? attributes->IsArrayAnAttribute(i) : -1;
+      if (vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array))
+        {
+        this->AddDataArray(dataArray, role, attribute);
+        }
+      else if (vtkStringArray* stringArray = vtkStringArray::SafeDownCast(array))
+        {
+        // String arrays are small (labels, names): hashed with their description
+        std::ostringstream description;
+        description << role << " " << (array->GetName() ? array->GetName() : "") << " string "
+                    << stringArray->GetNumberOfValues() << " " << attribute;
+        for (vtkIdType value = 0; value < stringArray->GetNumberOfValues(); ++value)
+          {
+          description << " " << stringArray->GetValue(value).size() << ":" << stringArray->GetValue(value);
+          }
+        this->AddDescription(description.str());
+        }
+      else if (array)
+        {
+        this->AddDescription(role + " " + (array->GetName() ? array->GetName() : "") + " " + array->GetClassName());
+        }
+      }
+  }
+
+  void AddDescription(const std::string& description)
+  {
+    HashedBuffer buffer;
+    buffer.Data = nullptr;
+    buffer.Size = 0;
+    buffer.Description = description;
+    this->Buffers.push_back(buffer);
+  }
+
+  vtkTypeUInt64 Hash() const
+  {
+    struct Block
+    {
+      size_t Buffer;
+      size_t Offset;
+      size_t Size;
+    };
+    std::vector<Block> blocks;
+    for (size_t buffer = 0; buffer < this->Buffers.size(); ++buffer)
+      {
+      for (size_t offset = 0; offset < this->Buffers[buffer].Size; offset += HashBlockSize)
+        {
+        blocks.push_back({ buffer, offset, std::min(HashBlockSize, this->Buffers[buffer].Size - offset) });
+        }
+      }
+
+    std::vector<vtkTypeUInt64> blockHashes(blocks.size());
+    vtkSMPTools::For(0, static_cast<vtkIdType>(blocks.size()), 1, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType blockIndex = begin; blockIndex < end; ++blockIndex)
+        {
+        const Block& block = blocks[blockIndex];
+        blockHashes[blockIndex] = HashBytes(this->Buffers[block.Buffer].Data + block.Offset, block.Size, 0);
+        }
+    });
+
+    // Combine in order, independently of how the blocks were shared between threads
+    vtkTypeUInt64 hash = 0;
+    size_t blockIndex = 0;
+    for (size_t buffer = 0; buffer < this->Buffers.size(); ++buffer)
+      {
+      hash = SurfaceToolbox::HashString(hash, this->Buffers[buffer].Description);
+      for (; blockIndex < blocks.size() && blocks[blockIndex].Buffer == buffer; ++blockIndex)
+        {
+        hash = Avalanche(Merge(hash, blockHashes[blockIndex]));
+        }
+      }
+    return hash;
+  }
+
+private:
+  std::vector<HashedBuffer> Buffers;
+  std::vector<vtkSmartPointer<vtkDataArray>> Copies;
+};
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> CopyPolyData(vtkPolyData* polyData)
+{
+  vtkSmartPointer<vtkPolyData> copy = vtkSmartPointer<vtkPolyData>::New();
+  copy->DeepCopy(polyData);
+  return copy;
+}
+
+//----------------------------------------------------------------------------
+double GetMaximumSize(const SurfaceToolbox::CacheParameters& parameters)
+{
+  return parameters.MaximumSize * 1024.0 * 1024.0;
+}
+
+//----------------------------------------------------------------------------
+// Surfaces cached in memory, most recently used first.
+struct MemoryCacheEntry
+{
+  vtkTypeUInt64 Key;
+  vtkSmartPointer<vtkPolyData> PolyData;
+  double Size;
+};
+
+std::mutex MemoryCacheMutex;
+std::list<MemoryCacheEntry> MemoryCache;
+double MemoryCacheSize = 0.0;
+
+//----------------------------------------------------------------------------
+std::list<MemoryCacheEntry>::iterator FindMemoryCacheEntry(vtkTypeUInt64 key)
+{
+  return std::find_if(MemoryCache.begin(), MemoryCache.end(),
+    [key](const MemoryCacheEntry& entry) { return entry.Key == key; });
+}
+
+//----------------------------------------------------------------------------
+void EvictMemoryCache(double maximumSize)
+{
+  while (!MemoryCache.empty() && MemoryCacheSize > maximumSize)
+    {
+    MemoryCacheSize -= MemoryCache.back().Size;
+    MemoryCache.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
+std::string GetCacheFileName(vtkTypeUInt64 key, const SurfaceToolbox::CacheParameters& parameters)
+{
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.vtp", static_cast<unsigned long long>(key));
+  return parameters.Directory + "/" + name;
+}
+
+//----------------------------------------------------------------------------
+bool IsCacheFileName(const std::string& name)
+{
+  return name.size() == 20 && name.compare(16, 4, ".vtp") == 0
+    && name.find_first_not_of("0123456789abcdef") == 16;
+}
+
+//----------------------------------------------------------------------------
+// Remove the least recently used files of the cache directory until it is
+// smaller than the maximum size. Files are touched when they are read, so
+// that their modification time is their last use.
+void EvictDirectoryCache(const SurfaceToolbox::CacheParameters& parameters)
+{
+  struct CacheFile
+  {
+    std::string FileName;
+    long ModifiedTime;
+    double Size;
+  };
+  std::vector<CacheFile> files;
+  double size = 0.0;
+  vtksys::Directory directory;
+  if (!directory.Load(parameters.Directory))
+    {
+    return;
+    }
+  for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i)
+    {
+    const std::string name = directory.GetFile(i);
+    if (!IsCacheFileName(name))
+      {
+      continue;
+      }
+    CacheFile file;
+    file.FileName = parameters.Directory + "/" + name;
+    file.ModifiedTime = vtksys::SystemTools::ModifiedTime(file.FileName);
+    file.Size = static_cast<double>(vtksys::SystemTools::FileLength(file.FileName));
+    size += file.Size;
+    files.push_back(file);
+    }
+
+  const double maximumSize = GetMaximumSize(parameters);
+  if (size <= maximumSize)
+    {
+    return;
+    }
+  std::sort(files.begin(), files.end(),
+    [](const CacheFile& a, const CacheFile& b) { return a.ModifiedTime < b.ModifiedTime; });
+  for (const CacheFile& file : files)
+    {
+    if (size <= maximumSize)
+      {
+      break;
+      }
+    // Another process sharing the directory may have removed it already
+    vtksys::SystemTools::RemoveFile(file.FileName);
+    size -= file.Size;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Unique name of the temporary file a surface is written to before being
+// renamed, so that processes sharing the directory never read partial files.
+// It keeps the .vtp extension for WritePolyData.
+std::string GetTemporaryFileName(vtkTypeUInt64 key, const SurfaceToolbox::CacheParameters& parameters)
+{
+  static std::atomic<unsigned long long> counter(std::random_device{}());
+  char name[64];
+  std::snprintf(name, sizeof(name), "%016llx-%llx.tmp.vtp", static_cast<unsigned long long>(key), counter++);
+  return parameters.Directory + "/" + name;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 HashPolyData(vtkPolyData* polyData)
+{
+  HashedBuffers buffers;
+  buffers.AddDataArray(polyData->GetPoints() ? polyData->GetPoints()->GetData() : nullptr, "points", -1);
+  const char* cellRoles[4] = { "verts", "lines", "polys", "strips" };
+  vtkCellArray* cellArrays[4] = { polyData->GetVerts(), polyData->GetLines(), polyData->GetPolys(), polyData->GetStrips() };
+  for (int cellType = 0; cellType < 4; ++cellType)
+    {
+    vtkCellArray* cells = cellArrays[cellType];
+    if (!cells || cells->GetNumberOfCells() == 0)
+      {
+      buffers.AddDescription(std::string(cellRoles[cellType]) + " none");
+      continue;
+      }
+    buffers.AddDataArray(cells->GetOffsetsArray(), std::string(cellRoles[cellType]) + " offsets", -1);
+    buffers.AddDataArray(cells->GetConnectivityArray(), std::string(cellRoles[cellType]) + " connectivity", -1);
+    }
+  buffers.AddFieldData(polyData->GetPointData(), "point data");
+  buffers.AddFieldData(polyData->GetCellData(), "cell data");
+  buffers.AddFieldData(polyData->GetFieldData(), "field data");
+  return buffers.Hash();
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 HashString(vtkTypeUInt64 hash, const std::string& text)
+{
+  return HashBytes(reinterpret_cast<const unsigned char*>(text.data()), text.size(), hash);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadCachedPolyData(vtkTypeUInt64 key, const CacheParameters& parameters)
+{
+  if (parameters.MaximumSize <= 0.0)
+    {
+    return nullptr;
+    }
+
+  if (parameters.Directory.empty())
+    {
+    std::lock_guard<std::mutex> lock(MemoryCacheMutex);
+    auto entry = FindMemoryCacheEntry(key);
+    if (entry == MemoryCache.end())
+      {
+      return nullptr;
+      }
+    MemoryCache.splice(MemoryCache.begin(), MemoryCache, entry);
+    // Stages may modify their input in place: never hand out the cached surface
+    return CopyPolyData(entry->PolyData);
+    }
+
+  const std::string fileName = GetCacheFileName(key, parameters);
+  if (!vtksys::SystemTools::FileExists(fileName, true))
+    {
+    return nullptr;
+    }
+  vtkSmartPointer<vtkPolyData> polyData = ReadPolyData(fileName);
+  if (!polyData)
+    {
+    vtksys::SystemTools::RemoveFile(fileName);
+    return nullptr;
+    }
+  vtksys::SystemTools::Touch(fileName, false);
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+bool WriteCachedPolyData(vtkTypeUInt64 key, vtkPolyData* polyData, const CacheParameters& parameters)
+{
+  const double maximumSize = GetMaximumSize(parameters);
+  if (maximumSize <= 0.0)
+    {
+    return false;
+    }
+
+  if (parameters.Directory.empty())
+    {
+    const double size = static_cast<double>(polyData->GetActualMemorySize()) * 1024.0;
+    if (size > maximumSize)
+      {
+      return false;
+      }
+    vtkSmartPointer<vtkPolyData> copy = CopyPolyData(polyData);
+    std::lock_guard<std::mutex> lock(MemoryCacheMutex);
+    auto entry = FindMemoryCacheEntry(key);
+    if (entry != MemoryCache.end())
+      {
+      MemoryCache.splice(MemoryCache.begin(), MemoryCache, entry);
+      return true;
+      }
+    MemoryCache.push_front({ key, copy, size });
+    MemoryCacheSize += size;
+    EvictMemoryCache(maximumSize);
+    return true;
+    }
+
+  const std::string fileName = GetCacheFileName(key, parameters);
+  if (vtksys::SystemTools::FileExists(fileName, true))
+    {
+    vtksys::SystemTools::Touch(fileName, false);
+    return true;
+    }
+  if (!vtksys::SystemTools::MakeDirectory(parameters.Directory))
+    {
+    std::cerr << "Cannot create cache directory " << parameters.Directory << std::endl;
+    return false;
+    }
+  // Raw appended arrays: the fastest to read back
+  const std::string temporaryFileName = GetTemporaryFileName(key, parameters);
+  if (!WritePolyData(polyData, temporaryFileName))
+    {
+    vtksys::SystemTools::RemoveFile(temporaryFileName);
+    return false;
+    }
+  if (static_cast<double>(vtksys::SystemTools::FileLength(temporaryFileName)) > maximumSize
+      || !vtksys::SystemTools::RenameFile(temporaryFileName, fileName))
+    {
+    vtksys::SystemTools::RemoveFile(temporaryFileName);
+    return false;
+    }
+  EvictDirectoryCache(parameters);
+  return true;
+}
+
+}
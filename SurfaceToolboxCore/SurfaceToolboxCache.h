@@ -0,0 +1,52 @@
+#ifndef SurfaceToolboxCache_h
+#define SurfaceToolboxCache_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+// STD includes
+#include <string>
+
+class vtkPolyData;
+
+// Content-addressed cache of surfaces, used by RunCachedPipeline to keep the
+// output of each stage under a key combining the hash of the input surface
+// with the names and parameters of the stages that produced it.
+//
+// Surfaces are kept in a directory, one raw .vtp file named after the key per
+// surface, or in memory if no directory is given, for the lifetime of the
+// process. The least recently used surfaces are removed to keep the cache
+// under its maximum size.
+namespace SurfaceToolbox
+{
+
+struct CacheParameters
+{
+  /// Directory of the cached surfaces, created if needed. If empty, surfaces
+  /// are kept in the memory of the process.
+  std::string Directory;
+  /// Maximum size of the cache in MiB, 0 to disable it
+  double MaximumSize = 0.0;
+};
+
+/// Hash of the points, cells, and numeric point, cell and field data of
+/// \a polyData, with the names and types of the arrays. The blocks of the
+/// arrays are hashed in parallel and their hashes combined in order, so the
+/// hash does not depend on the number of threads.
+vtkTypeUInt64 HashPolyData(vtkPolyData* polyData);
+
+/// Combine \a hash with \a text.
+vtkTypeUInt64 HashString(vtkTypeUInt64 hash, const std::string& text);
+
+/// Return a copy of the surface cached under \a key, or nullptr if there is none.
+vtkSmartPointer<vtkPolyData> ReadCachedPolyData(vtkTypeUInt64 key, const CacheParameters& parameters);
+
+/// Cache a copy of \a polyData under \a key, removing the least recently used
+/// surfaces if the cache gets larger than its maximum size. Surfaces larger
+/// than the cache are not cached. Returns false if \a polyData is not cached.
+bool WriteCachedPolyData(vtkTypeUInt64 key, vtkPolyData* polyData, const CacheParameters& parameters);
+
+}
+
+#endif
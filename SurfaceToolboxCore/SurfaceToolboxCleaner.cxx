@@ -0,0 +1,386 @@
+#include "SurfaceToolboxCleaner.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxTopology.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+enum CellType
+{
+  Vertex = 0,
+  Line,
+  Polygon,
+  Strip,
+  NumberOfCellTypes,
+  Removed = -1
+};
+
+//----------------------------------------------------------------------------
+// Quantized point location. Points with equal keys are merged.
+struct PointKey
+{
+  vtkTypeInt64 Key[3];
+  vtkIdType PointId;
+
+  bool SameLocation(const PointKey& other) const
+  {
+    return this->Key[0] == other.Key[0] && this->Key[1] == other.Key[1] && this->Key[2] == other.Key[2];
+  }
+
+  bool operator<(const PointKey& other) const
+  {
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      if (this->Key[axis] != other.Key[axis])
+        {
+        return this->Key[axis] < other.Key[axis];
+        }
+      }
+    return this->PointId < other.PointId;
+  }
+};
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+std::vector<vtkIdType> ComputePointMergeMap(vtkPoints* points, double tolerance)
+{
+  const vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  double bounds[6];
+  points->GetBounds(bounds);
+  const double origin[3] = { bounds[0], bounds[2], bounds[4] };
+  std::vector<vtkIdType> pointIds(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      pointIds[pointId] = pointId;
+      }
+    });
+  std::vector<vtkIdType> mergeMap(numberOfPoints);
+  ComputePointMergeMap(points, pointIds, tolerance, origin, mergeMap);
+  return mergeMap;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeInt64 GetPointMergeKey(double coordinate, double tolerance, double origin)
+{
+  if (tolerance > 0.0)
+    {
+    return static_cast<vtkTypeInt64>(std::floor((coordinate - origin) / tolerance));
+    }
+  // Exact comparison; +0 and -0 are the same location
+  vtkTypeInt64 key;
+  coordinate = coordinate == 0.0 ? 0.0 : coordinate;
+  std::memcpy(&key, &coordinate, sizeof(coordinate));
+  return key;
+}
+
+//----------------------------------------------------------------------------
+void ComputePointMergeMap(vtkPoints* points, const std::vector<vtkIdType>& pointIds, double tolerance,
+                          const double origin[3], std::vector<vtkIdType>& mergeMap)
+{
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(pointIds.size());
+  std::vector<PointKey> keys(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    double point[3];
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      points->GetPoint(pointIds[i], point);
+      PointKey& key = keys[i];
+      key.PointId = pointIds[i];
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        key.Key[axis] = GetPointMergeKey(point[axis], tolerance, origin[axis]);
+        }
+      }
+    });
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+
+  // Keys are sorted by location then id, so the first point of each run of
+  // equal locations has the smallest id.
+  vtkIdType target = 0;
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+    if (i == 0 || !keys[i].SameLocation(keys[i - 1]))
+      {
+      target = keys[i].PointId;
+      }
+    mergeMap[keys[i].PointId] = target;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunParallelCleaner(vtkPolyData* input, const CleanerParameters& parameters)
+{
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  if (numberOfPoints == 0)
+    {
+    output->ShallowCopy(input);
+    return output;
+    }
+  return MergePoints(input, ComputePointMergeMap(input->GetPoints(), parameters.Tolerance));
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> MergePoints(vtkPolyData* input, const std::vector<vtkIdType>& mergeMap)
+{
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+
+  std::vector<vtkIdType> offsets;
+  std::vector<vtkIdType> connectivity;
+  GetCells(input, offsets, connectivity);
+  const vtkIdType numberOfCells = static_cast<vtkIdType>(offsets.size()) - 1;
+  vtkIdType firstCellOfType[NumberOfCellTypes + 1];
+  firstCellOfType[Vertex] = 0;
+  firstCellOfType[Line] = input->GetNumberOfVerts();
+  firstCellOfType[Polygon] = firstCellOfType[Line] + input->GetNumberOfLines();
+  firstCellOfType[Strip] = firstCellOfType[Polygon] + input->GetNumberOfPolys();
+  firstCellOfType[NumberOfCellTypes] = numberOfCells;
+
+  // Merged points of a cell without repetitions, written to cellPoints, and
+  // the type of cell they make, as vtkCleanPolyData.
+  auto cleanCell = [&](vtkIdType cellId, vtkIdType* cellPoints, vtkIdType& size) -> int
+    {
+    size = 0;
+    for (vtkIdType i = offsets[cellId]; i < offsets[cellId + 1]; ++i)
+      {
+      const vtkIdType pointId = mergeMap[connectivity[i]];
+      if (size == 0 || cellPoints[size - 1] != pointId)
+        {
+        cellPoints[size++] = pointId;
+        }
+      }
+    if (cellId < firstCellOfType[Line])
+      {
+      return size > 0 ? Vertex : Removed;
+      }
+    if (cellId < firstCellOfType[Polygon])
+      {
+      return size > 1 ? Line : (size == 1 ? Vertex : Removed);
+      }
+    if (cellId < firstCellOfType[Strip])
+      {
+      if (size > 1 && cellPoints[0] == cellPoints[size - 1])
+        {
+        --size;
+        }
+      return size > 2 ? Polygon : (size == 2 ? Line : (size == 1 ? Vertex : Removed));
+      }
+    return size > 3 ? Strip : (size == 3 ? Polygon : (size == 2 ? Line : (size == 1 ? Vertex : Removed)));
+    };
+
+  // Clean each cell once, in place of its input points: cleaning only
+  // removes points
+  std::vector<vtkIdType> cleanedConnectivity(connectivity.size());
+  std::vector<signed char> cellTypes(numberOfCells);
+  std::vector<vtkIdType> cellSizes(numberOfCells);
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      cellTypes[cellId] = static_cast<signed char>(
+        cleanCell(cellId, cleanedConnectivity.data() + offsets[cellId], cellSizes[cellId]));
+      }
+    });
+
+  // Nothing to merge nor remove: pass the input, with its topology if it
+  // was built, so that the next stages do not rebuild it.
+  std::vector<std::atomic<unsigned char>> usedPoints(numberOfPoints);
+  std::atomic<bool> changed(false);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end && !changed.load(std::memory_order_relaxed); ++pointId)
+      {
+      if (mergeMap[pointId] != pointId)
+        {
+        changed.store(true, std::memory_order_relaxed);
+        }
+      }
+    });
+  for (int type = 0; type < NumberOfCellTypes && !changed; ++type)
+    {
+    vtkSMPTools::For(firstCellOfType[type], firstCellOfType[type + 1], [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType cellId = begin; cellId < end && !changed.load(std::memory_order_relaxed); ++cellId)
+        {
+        if (cellTypes[cellId] != type || cellSizes[cellId] != offsets[cellId + 1] - offsets[cellId])
+          {
+          changed.store(true, std::memory_order_relaxed);
+          }
+        for (vtkIdType i = offsets[cellId]; i < offsets[cellId + 1]; ++i)
+          {
+          usedPoints[connectivity[i]].store(1, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+  if (!changed)
+    {
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType pointId = begin; pointId < end && !changed.load(std::memory_order_relaxed); ++pointId)
+        {
+        if (!usedPoints[pointId].load(std::memory_order_relaxed))
+          {
+          changed.store(true, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+  if (!changed)
+    {
+    output->ShallowCopy(input);
+    PassSurfaceTopology(input, output);
+    return output;
+    }
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      usedPoints[pointId].store(0, std::memory_order_relaxed);
+      }
+    });
+
+  // Output cells of each type, in input order, numbered by prefix sums
+  std::vector<vtkIdType> outputCells[NumberOfCellTypes];
+  std::vector<vtkIdType> outputCellIds(numberOfCells);
+  for (int type = 0; type < NumberOfCellTypes; ++type)
+    {
+    vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType cellId = begin; cellId < end; ++cellId)
+        {
+        outputCellIds[cellId] = cellTypes[cellId] == type;
+        }
+      });
+    outputCells[type].resize(ComputePrefixSums(outputCellIds.data(), numberOfCells));
+    vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType cellId = begin; cellId < end; ++cellId)
+        {
+        if (cellTypes[cellId] == type)
+          {
+          outputCells[type][outputCellIds[cellId]] = cellId;
+          }
+        }
+      });
+    }
+
+  // Merged connectivity, using merged (input) point ids
+  vtkSmartPointer<vtkIdTypeArray> outputOffsets[NumberOfCellTypes];
+  vtkSmartPointer<vtkIdTypeArray> outputConnectivity[NumberOfCellTypes];
+  for (int type = 0; type < NumberOfCellTypes; ++type)
+    {
+    const std::vector<vtkIdType>& cellIds = outputCells[type];
+    const vtkIdType numberOfOutputCells = static_cast<vtkIdType>(cellIds.size());
+    outputOffsets[type] = vtkSmartPointer<vtkIdTypeArray>::New();
+    outputOffsets[type]->SetNumberOfValues(numberOfOutputCells + 1);
+    vtkIdType* cellOffsets = outputOffsets[type]->GetPointer(0);
+    vtkSMPTools::For(0, numberOfOutputCells, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        cellOffsets[i] = cellSizes[cellIds[i]];
+        }
+      });
+    cellOffsets[numberOfOutputCells] = 0;
+    ComputePrefixSums(cellOffsets, numberOfOutputCells + 1);
+    outputConnectivity[type] = vtkSmartPointer<vtkIdTypeArray>::New();
+    outputConnectivity[type]->SetNumberOfValues(cellOffsets[numberOfOutputCells]);
+    vtkIdType* cellConnectivity = outputConnectivity[type]->GetPointer(0);
+    vtkSMPTools::For(0, numberOfOutputCells, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        const vtkIdType* cellPoints = cleanedConnectivity.data() + offsets[cellIds[i]];
+        for (vtkIdType j = 0; j < cellSizes[cellIds[i]]; ++j)
+          {
+          cellConnectivity[cellOffsets[i] + j] = cellPoints[j];
+          usedPoints[cellPoints[j]].store(1, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+  cleanedConnectivity.clear();
+  cleanedConnectivity.shrink_to_fit();
+
+  // Remove unused points and renumber
+  std::vector<vtkIdType> pointMap(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      pointMap[pointId] = usedPoints[pointId].load(std::memory_order_relaxed);
+      }
+    });
+  std::vector<vtkIdType> pointIds(ComputePrefixSums(pointMap.data(), numberOfPoints));
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      if (usedPoints[pointId].load(std::memory_order_relaxed))
+        {
+        pointIds[pointMap[pointId]] = pointId;
+        }
+      }
+    });
+  vtkSmartPointer<vtkCellArray> cellArrays[NumberOfCellTypes];
+  for (int type = 0; type < NumberOfCellTypes; ++type)
+    {
+    vtkIdType* cellConnectivity = outputConnectivity[type]->GetPointer(0);
+    vtkSMPTools::For(0, outputConnectivity[type]->GetNumberOfValues(), [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        cellConnectivity[i] = pointMap[cellConnectivity[i]];
+        }
+      });
+    cellArrays[type] = vtkSmartPointer<vtkCellArray>::New();
+    cellArrays[type]->SetData(outputOffsets[type], outputConnectivity[type]);
+    }
+
+  vtkNew<vtkPoints> points;
+  points->SetData(vtkDataArray::SafeDownCast(CopyTuples(input->GetPoints()->GetData(), pointIds)));
+  output->SetPoints(points);
+  output->SetVerts(cellArrays[Vertex]);
+  output->SetLines(cellArrays[Line]);
+  output->SetPolys(cellArrays[Polygon]);
+  output->SetStrips(cellArrays[Strip]);
+
+  // Point and cell data, copied in parallel array by array
+  CopyTuples(input->GetPointData(), output->GetPointData(), pointIds);
+  std::vector<vtkIdType> cellIds;
+  cellIds.reserve(numberOfCells);
+  for (const std::vector<vtkIdType>& typeCellIds : outputCells)
+    {
+    cellIds.insert(cellIds.end(), typeCellIds.begin(), typeCellIds.end());
+    }
+  CopyTuples(input->GetCellData(), output->GetCellData(), cellIds);
+  return output;
+}
+
+}
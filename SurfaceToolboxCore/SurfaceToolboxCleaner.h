@@ -0,0 +1,54 @@
+#ifndef SurfaceToolboxCleaner_h
+#define SurfaceToolboxCleaner_h
+
+#include "SurfaceToolboxStages.h"
+
+// STD includes
+#include <vector>
+
+class vtkPoints;
+
+namespace SurfaceToolbox
+{
+
+/// Multi-threaded point merging and degenerate cell removal, equivalent to
+/// vtkCleanPolyData with its default settings.
+///
+/// Points are quantized into a grid of spacing Tolerance (or compared
+/// exactly if it is 0), and the keys are sorted in parallel: points with the
+/// same key are merged into the one with the smallest id, which keeps its
+/// coordinates and point data. The cells are then remapped in one parallel
+/// sweep that also removes repeated consecutive points and degenerate cells:
+/// polygons and strips reduced to two points become lines, cells reduced to
+/// one point become vertices, and strips of three points become triangles.
+/// Unused points are removed.
+///
+/// Unlike vtkCleanPolyData with a tolerance, merging does not depend on the
+/// point order, but points closer than the tolerance on both sides of a grid
+/// plane are not merged.
+vtkSmartPointer<vtkPolyData> RunParallelCleaner(vtkPolyData* input, const CleanerParameters& parameters);
+
+/// Id of the point each point of \a points is merged into by the cleaner:
+/// the smallest id of the points with the same grid key. The grid starts at
+/// the lower corner of the bounds of \a points.
+std::vector<vtkIdType> ComputePointMergeMap(vtkPoints* points, double tolerance);
+
+/// Grid key of \a coordinate along one axis, for a grid starting at \a origin.
+/// Points are merged if their keys are equal along the three axes.
+vtkTypeInt64 GetPointMergeKey(double coordinate, double tolerance, double origin);
+
+/// Set mergeMap[pointIds[i]] to the id of the point of \a pointIds that
+/// pointIds[i] is merged into, for a grid starting at \a origin. Used to merge
+/// the points of a surface by parts holding all the points of their keys.
+void ComputePointMergeMap(vtkPoints* points, const std::vector<vtkIdType>& pointIds, double tolerance,
+                          const double origin[3], std::vector<vtkIdType>& mergeMap);
+
+/// Merge the points of \a input as given by \a mergeMap (see
+/// ComputePointMergeMap), then remove degenerate cells and unused points as
+/// RunParallelCleaner. If nothing changes, the output is a shallow copy of
+/// \a input that keeps its topology (see PassSurfaceTopology).
+vtkSmartPointer<vtkPolyData> MergePoints(vtkPolyData* input, const std::vector<vtkIdType>& mergeMap);
+
+}
+
+#endif
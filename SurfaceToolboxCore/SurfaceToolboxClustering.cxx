@@ -0,0 +1,497 @@
+#include "SurfaceToolboxClustering.h"
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxMeshFiles.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Triangles sampled at the start of the stream to choose the cluster size
+const vtkIdType SampleSize = 65536;
+// Triangles of binary STL files decoded and clustered at a time
+const vtkIdType StreamBlockSize = 1 << 20;
+// Cluster keys pack three grid indices of 21 bits, offset by this value
+const vtkTypeInt64 GridIndexOffset = vtkTypeInt64(1) << 20;
+
+//----------------------------------------------------------------------------
+// Sum of the squared distances to the planes of the triangles around the
+// corners of a cluster, stored as a2 ab ac ad b2 bc bd c2 cd d2, and the sum
+// of these corners.
+struct Cluster
+{
+  double A[10] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  double Sum[3] = { 0.0, 0.0, 0.0 };
+  vtkIdType NumberOfCorners = 0;
+
+  void AddPlane(const double n[3], double d)
+  {
+    this->A[0] += n[0] * n[0]; this->A[1] += n[0] * n[1]; this->A[2] += n[0] * n[2]; this->A[3] += n[0] * d;
+    this->A[4] += n[1] * n[1]; this->A[5] += n[1] * n[2]; this->A[6] += n[1] * d;
+    this->A[7] += n[2] * n[2]; this->A[8] += n[2] * d;
+    this->A[9] += d * d;
+  }
+
+  void Add(const Cluster& other)
+  {
+    for (int i = 0; i < 10; ++i)
+      {
+      this->A[i] += other.A[i];
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      this->Sum[axis] += other.Sum[axis];
+      }
+    this->NumberOfCorners += other.NumberOfCorners;
+  }
+
+  // Position minimizing the quadric. Returns false if the system is singular,
+  // which happens on flat areas and along ridges.
+  bool Minimize(double p[3]) const
+  {
+    const double* a = this->A;
+    const double c00 = a[4] * a[7] - a[5] * a[5];
+    const double c01 = a[2] * a[5] - a[1] * a[7];
+    const double c02 = a[1] * a[5] - a[4] * a[2];
+    const double c11 = a[0] * a[7] - a[2] * a[2];
+    const double c12 = a[1] * a[2] - a[0] * a[5];
+    const double c22 = a[0] * a[4] - a[1] * a[1];
+    const double det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+    const double trace = a[0] + a[4] + a[7];
+    if (std::fabs(det) <= 1e-10 * trace * trace * trace)
+      {
+      return false;
+      }
+    const double r[3] = { -a[3], -a[6], -a[8] };
+    p[0] = (c00 * r[0] + c01 * r[1] + c02 * r[2]) / det;
+    p[1] = (c01 * r[0] + c11 * r[1] + c12 * r[2]) / det;
+    p[2] = (c02 * r[0] + c12 * r[1] + c22 * r[2]) / det;
+    return true;
+  }
+};
+
+typedef std::array<vtkTypeUInt64, 3> TriangleKey;
+
+struct TriangleKeyHash
+{
+  size_t operator()(const TriangleKey& key) const
+  {
+    return std::hash<vtkTypeUInt64>()(key[0] * 0x9E3779B97F4A7C15ull ^ key[1] * 0xC2B2AE3D27D4EB4Full ^ key[2]);
+  }
+};
+
+//----------------------------------------------------------------------------
+// Cluster keys of a triangle in the orientation of the input triangle of
+// smallest Order, its position in the input, that was clustered to it
+struct ClusterTriangle
+{
+  TriangleKey Keys;
+  vtkTypeInt64 Order;
+};
+
+//----------------------------------------------------------------------------
+// Keep the orientation of the first input triangle of \a triangle in
+// \a triangles, so that it does not depend on the threads.
+void InsertTriangle(std::unordered_map<TriangleKey, ClusterTriangle, TriangleKeyHash>& triangles,
+                    const TriangleKey& sortedKeys, const ClusterTriangle& triangle)
+{
+  auto inserted = triangles.emplace(sortedKeys, triangle);
+  if (!inserted.second && triangle.Order < inserted.first->second.Order)
+    {
+    inserted.first->second = triangle;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Clusters and triangles seen by one thread
+struct ClusterTable
+{
+  std::unordered_map<vtkTypeUInt64, Cluster> Clusters;
+  // Triangles between three different clusters, keyed by their sorted
+  // cluster keys
+  std::unordered_map<TriangleKey, ClusterTriangle, TriangleKeyHash> Triangles;
+  bool OutOfGrid = false;
+};
+
+//----------------------------------------------------------------------------
+class VertexClustering
+{
+public:
+  VertexClustering(double clusterSize, const double origin[3])
+    : ClusterSize(clusterSize)
+  {
+    std::copy(origin, origin + 3, this->Origin);
+  }
+
+  ClusterTable& GetLocalTable() { return this->Tables.Local(); }
+
+  /// Add the triangle of corners x, y, z of the three corners to \a table.
+  /// \a order is the position of the triangle in the input: a triangle
+  /// between three clusters keeps the orientation of the first input triangle
+  /// clustered to it.
+  void AddTriangle(const double corners[9], vtkTypeInt64 order, ClusterTable& table) const;
+
+  /// Merge the tables of the threads into the clustered surface, with points
+  /// of the given VTK data type. Returns nullptr if the surface extends too
+  /// far from the origin for the grid.
+  vtkSmartPointer<vtkPolyData> GetOutput(int dataType);
+
+private:
+  bool GetKey(const double point[3], vtkTypeUInt64& key) const;
+  void GetCellOrigin(vtkTypeUInt64 key, double origin[3]) const;
+
+  double ClusterSize;
+  double Origin[3];
+  vtkSMPThreadLocal<ClusterTable> Tables;
+};
+
+//----------------------------------------------------------------------------
+bool VertexClustering::GetKey(const double point[3], vtkTypeUInt64& key) const
+{
+  key = 0;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    const double index = std::floor((point[axis] - this->Origin[axis]) / this->ClusterSize);
+    if (!(std::fabs(index) < static_cast<double>(GridIndexOffset)))
+      {
+      return false;
+      }
+    key = (key << 21) | static_cast<vtkTypeUInt64>(static_cast<vtkTypeInt64>(index) + GridIndexOffset);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void VertexClustering::GetCellOrigin(vtkTypeUInt64 key, double origin[3]) const
+{
+  for (int axis = 2; axis >= 0; --axis)
+    {
+    const vtkTypeInt64 index = static_cast<vtkTypeInt64>(key & ((vtkTypeUInt64(1) << 21) - 1)) - GridIndexOffset;
+    origin[axis] = this->Origin[axis] + index * this->ClusterSize;
+    key >>= 21;
+    }
+}
+
+//----------------------------------------------------------------------------
+void VertexClustering::AddTriangle(const double corners[9], vtkTypeInt64 order, ClusterTable& table) const
+{
+  TriangleKey keys;
+  for (int k = 0; k < 3; ++k)
+    {
+    if (!this->GetKey(corners + 3 * k, keys[k]))
+      {
+      table.OutOfGrid = true;
+      return;
+      }
+    }
+
+  double e1[3], e2[3], normal[3];
+  vtkMath::Subtract(corners + 3, corners, e1);
+  vtkMath::Subtract(corners + 6, corners, e2);
+  vtkMath::Cross(e1, e2, normal);
+  const bool degenerate = vtkMath::Normalize(normal) == 0.0;
+  const double d = -vtkMath::Dot(normal, corners);
+  for (int k = 0; k < 3; ++k)
+    {
+    Cluster& cluster = table.Clusters[keys[k]];
+    if (!degenerate)
+      {
+      cluster.AddPlane(normal, d);
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      cluster.Sum[axis] += corners[3 * k + axis];
+      }
+    ++cluster.NumberOfCorners;
+    }
+
+  if (keys[0] != keys[1] && keys[1] != keys[2] && keys[2] != keys[0])
+    {
+    TriangleKey sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    InsertTriangle(table.Triangles, sorted, ClusterTriangle{ keys, order });
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> VertexClustering::GetOutput(int dataType)
+{
+  // Merge the tables of the threads, the triangles in the order of their
+  // sorted keys so that the output does not depend on the threads.
+  std::unordered_map<vtkTypeUInt64, Cluster> clusters;
+  std::unordered_map<TriangleKey, ClusterTriangle, TriangleKeyHash> uniqueTriangles;
+  for (ClusterTable& table : this->Tables)
+    {
+    if (table.OutOfGrid)
+      {
+      std::cerr << "Clustering decimation: the surface is too large for a cluster size of " << this->ClusterSize
+                << std::endl;
+      return nullptr;
+      }
+    for (const auto& entry : table.Clusters)
+      {
+      clusters[entry.first].Add(entry.second);
+      }
+    for (const auto& triangle : table.Triangles)
+      {
+      InsertTriangle(uniqueTriangles, triangle.first, triangle.second);
+      }
+    table = ClusterTable();
+    }
+  std::vector<std::pair<TriangleKey, ClusterTriangle>> triangles(uniqueTriangles.begin(), uniqueTriangles.end());
+  uniqueTriangles.clear();
+  std::sort(triangles.begin(), triangles.end(),
+            [](const std::pair<TriangleKey, ClusterTriangle>& a, const std::pair<TriangleKey, ClusterTriangle>& b)
+            { return a.first < b.first; });
+
+  // Clusters used by triangles, in key order
+  std::vector<vtkTypeUInt64> keys;
+  keys.reserve(3 * triangles.size());
+  for (const auto& triangle : triangles)
+    {
+    keys.insert(keys.end(), triangle.first.begin(), triangle.first.end());
+    }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(keys.size());
+  std::vector<const Cluster*> pointClusters(numberOfPoints);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    pointClusters[pointId] = &clusters[keys[pointId]];
+    }
+  std::vector<double> coordinates(3 * numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      const Cluster& cluster = *pointClusters[pointId];
+      double* p = &coordinates[3 * pointId];
+      double cellOrigin[3];
+      this->GetCellOrigin(keys[pointId], cellOrigin);
+      bool inCell = cluster.Minimize(p);
+      for (int axis = 0; axis < 3 && inCell; ++axis)
+        {
+        inCell = p[axis] >= cellOrigin[axis] && p[axis] <= cellOrigin[axis] + this->ClusterSize;
+        }
+      if (!inCell)
+        {
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          p[axis] = cluster.Sum[axis] / cluster.NumberOfCorners;
+          }
+        }
+      }
+    });
+
+  const vtkIdType numberOfTriangles = static_cast<vtkIdType>(triangles.size());
+  std::vector<vtkIdType> pointIds(3 * numberOfTriangles);
+  vtkSMPTools::For(0, numberOfTriangles, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType triangleId = begin; triangleId < end; ++triangleId)
+      {
+      for (int k = 0; k < 3; ++k)
+        {
+        const vtkTypeUInt64 key = triangles[triangleId].second.Keys[k];
+        pointIds[3 * triangleId + k] = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+        }
+      }
+    });
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->SetPoints(SurfaceToolbox::CreatePoints(coordinates, dataType));
+  output->SetPolys(SurfaceToolbox::CreateTriangleCells(pointIds.data(), numberOfTriangles));
+  return output;
+}
+
+//----------------------------------------------------------------------------
+// Size of the cells holding about 1 / (1 - targetReduction) vertices of a
+// surface whose mean edge length is the one of the sampled triangles. On a
+// regular triangulation there are about two triangles per vertex, and a cell
+// crossed by the surface holds a patch of about its face area. Returns 0 if
+// the sampled triangles are degenerate.
+template <typename Corners>
+double ChooseClusterSize(vtkIdType numberOfTriangles, Corners getCorners, double targetReduction)
+{
+  const vtkIdType numberOfSamples = std::min(numberOfTriangles, SampleSize);
+  double sum = 0.0;
+  double corners[9];
+  for (vtkIdType triangleId = 0; triangleId < numberOfSamples; ++triangleId)
+    {
+    getCorners(triangleId, corners);
+    for (int k = 0; k < 3; ++k)
+      {
+      sum += std::sqrt(vtkMath::Distance2BetweenPoints(corners + 3 * k, corners + 3 * ((k + 1) % 3)));
+      }
+    }
+  if (numberOfSamples == 0)
+    {
+    return 0.0;
+    }
+  const double meanEdgeLength = sum / (3 * numberOfSamples);
+  const double verticesPerCluster = 1.0 / (1.0 - std::min(targetReduction, 0.9999));
+  return meanEdgeLength * std::sqrt(verticesPerCluster * std::sqrt(3.0) / 2.0);
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunClusteringDecimation(vtkPolyData* input, const DecimationParameters& parameters)
+{
+  std::vector<vtkIdType> faceOffsets;
+  std::vector<vtkIdType> faceConnectivity;
+  const vtkIdType numberOfPolys = GetFaceCells(input, faceOffsets, faceConnectivity);
+  const vtkIdType numberOfFaces = static_cast<vtkIdType>(faceOffsets.size()) - 1;
+  if (numberOfFaces <= 0 || (parameters.ClusterSize <= 0.0 && parameters.TargetReduction <= 0.0))
+    {
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->ShallowCopy(input);
+    return output;
+    }
+  vtkPoints* points = input->GetPoints();
+
+  double clusterSize = parameters.ClusterSize;
+  if (clusterSize <= 0.0)
+    {
+    // Sample the first triangle of each face
+    clusterSize = ChooseClusterSize(numberOfFaces, [&](vtkIdType faceId, double corners[9])
+      {
+      const vtkIdType size = faceOffsets[faceId + 1] - faceOffsets[faceId];
+      for (vtkIdType k = 0; k < 3; ++k)
+        {
+        points->GetPoint(faceConnectivity[faceOffsets[faceId] + std::min(k, size - 1)], corners + 3 * k);
+        }
+      }, parameters.TargetReduction);
+    if (clusterSize <= 0.0)
+      {
+      std::cerr << "Clustering decimation: cannot choose a cluster size from degenerate triangles" << std::endl;
+      return nullptr;
+      }
+    }
+
+  double origin[3];
+  points->GetPoint(faceConnectivity[0], origin);
+  VertexClustering clustering(clusterSize, origin);
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    ClusterTable& table = clustering.GetLocalTable();
+    double corners[9];
+    for (vtkIdType faceId = begin; faceId < end; ++faceId)
+      {
+      const vtkIdType* face = &faceConnectivity[faceOffsets[faceId]];
+      const vtkIdType size = faceOffsets[faceId + 1] - faceOffsets[faceId];
+      const bool strip = faceId >= numberOfPolys;
+      for (vtkIdType i = 0; i + 2 < size; ++i)
+        {
+        // Fans for polygons, strip triangles alternating their orientation.
+        // A face has fewer triangles than connectivity ids, so the offset of
+        // the face plus the triangle index orders the triangles.
+        points->GetPoint(strip ? face[i + (i % 2)] : face[0], corners);
+        points->GetPoint(strip ? face[i + 1 - (i % 2)] : face[i + 1], corners + 3);
+        points->GetPoint(face[i + 2], corners + 6);
+        clustering.AddTriangle(corners, faceOffsets[faceId] + i, table);
+        }
+      }
+    });
+  return clustering.GetOutput(points->GetDataType());
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunClusteringDecimation(const std::string& fileName,
+                                                     const DecimationParameters& parameters,
+                                                     vtkIdType& numberOfInputTriangles)
+{
+  numberOfInputTriangles = 0;
+  if (!IsBinarySTLFile(fileName) || (parameters.ClusterSize <= 0.0 && parameters.TargetReduction <= 0.0))
+    {
+    vtkSmartPointer<vtkPolyData> input = ReadPolyData(fileName);
+    if (!input)
+      {
+      return nullptr;
+      }
+    std::vector<vtkIdType> faceOffsets;
+    std::vector<vtkIdType> faceConnectivity;
+    GetFaceCells(input, faceOffsets, faceConnectivity);
+    for (size_t faceId = 0; faceId + 1 < faceOffsets.size(); ++faceId)
+      {
+      numberOfInputTriangles += std::max<vtkIdType>(0, faceOffsets[faceId + 1] - faceOffsets[faceId] - 2);
+      }
+    return RunClusteringDecimation(input, parameters);
+    }
+
+  // The clusters are set up from the first block, then every block is
+  // clustered in parallel once decoded.
+  std::unique_ptr<VertexClustering> clustering;
+  bool degenerate = false;
+  const bool read = StreamSTLTriangles(fileName, StreamBlockSize, [&](const std::vector<float>& corners)
+    {
+    const vtkIdType numberOfTriangles = static_cast<vtkIdType>(corners.size() / 9);
+    auto getCorners = [&](vtkIdType triangleId, double triangle[9])
+      {
+      std::copy(corners.begin() + 9 * triangleId, corners.begin() + 9 * triangleId + 9, triangle);
+      };
+    const vtkIdType firstTriangleId = numberOfInputTriangles;
+    numberOfInputTriangles += numberOfTriangles;
+    if (!clustering)
+      {
+      double clusterSize = parameters.ClusterSize;
+      if (clusterSize <= 0.0)
+        {
+        clusterSize = ChooseClusterSize(numberOfTriangles, getCorners, parameters.TargetReduction);
+        }
+      if (clusterSize <= 0.0)
+        {
+        degenerate = true;
+        return;
+        }
+      const double origin[3] = { corners[0], corners[1], corners[2] };
+      clustering.reset(new VertexClustering(clusterSize, origin));
+      }
+    vtkSMPTools::For(0, numberOfTriangles, [&](vtkIdType begin, vtkIdType end)
+      {
+      ClusterTable& table = clustering->GetLocalTable();
+      double triangle[9];
+      for (vtkIdType triangleId = begin; triangleId < end; ++triangleId)
+        {
+        getCorners(triangleId, triangle);
+        clustering->AddTriangle(triangle, firstTriangleId + triangleId, table);
+        }
+      });
+    });
+  if (!read)
+    {
+    return nullptr;
+    }
+  if (degenerate)
+    {
+    std::cerr << "Clustering decimation: cannot choose a cluster size from degenerate triangles" << std::endl;
+    return nullptr;
+    }
+  if (!clustering)
+    {
+    return vtkSmartPointer<vtkPolyData>::New();
+    }
+  return clustering->GetOutput(VTK_FLOAT);
+}
+
+}
@@ -0,0 +1,46 @@
+#ifndef SurfaceToolboxClustering_h
+#define SurfaceToolboxClustering_h
+
+#include "SurfaceToolboxStages.h"
+
+// STD includes
+#include <string>
+
+namespace SurfaceToolbox
+{
+
+/// Vertex clustering decimation, for a coarse reduction of very large
+/// surfaces in time linear in their number of triangles.
+///
+/// Triangles are streamed once through a uniform grid of cubic cells of size
+/// ClusterSize, hashed so that only the cells reached by the surface take
+/// memory. Each thread accumulates, in its own tables, the quadric of the
+/// triangle planes around the corners in each cell, the sum of these corners,
+/// and the triangles whose corners are in three different cells. The tables
+/// are then merged, and every cell used by a triangle becomes one vertex,
+/// placed at the minimum of its quadric, or at the mean of its corners if the
+/// quadric is singular or its minimum is out of the cell. Triangles collapsed
+/// to an edge or a point, and duplicate triangles, are removed: of the input
+/// triangles clustered to the same three cells, the first one in the input
+/// gives the orientation of the output triangle, whatever the threads.
+///
+/// If ClusterSize is 0, it is chosen from the mean edge length of the first
+/// 65536 triangles so that cells hold about 1 / (1 - TargetReduction)
+/// vertices; the reduction is only approximate. Topology is not preserved.
+/// Polygons are split into fans of triangles and strips into their triangles;
+/// vertices, lines, point and cell data are not passed.
+vtkSmartPointer<vtkPolyData> RunClusteringDecimation(vtkPolyData* input, const DecimationParameters& parameters);
+
+/// Clustering decimation of the surface in \a fileName in a single pass over
+/// the file. Binary STL files are streamed: their triangles are decoded and
+/// clustered by blocks, so that the input surface is never held in memory.
+/// Other files are read with ReadPolyData first. \a numberOfInputTriangles
+/// receives the number of triangles read.
+/// Returns nullptr if the file cannot be read.
+vtkSmartPointer<vtkPolyData> RunClusteringDecimation(const std::string& fileName,
+                                                     const DecimationParameters& parameters,
+                                                     vtkIdType& numberOfInputTriangles);
+
+}
+
+#endif
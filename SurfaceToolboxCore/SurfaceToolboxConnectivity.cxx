@@ -0,0 +1,332 @@
+#include "SurfaceToolboxConnectivity.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxTopology.h"
+
+// VTK includes
+#include "vtkCellData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Disjoint sets of points that can be merged concurrently. A set is
+// identified by its smallest point id.
+class ConcurrentUnionFind
+{
+public:
+  explicit ConcurrentUnionFind(vtkIdType size)
+    : Parent(size)
+  {
+    vtkSMPTools::For(0, size, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        this->Parent[i].store(i, std::memory_order_relaxed);
+        }
+      });
+  }
+
+  vtkIdType Find(vtkIdType i)
+  {
+    while (true)
+      {
+      vtkIdType parent = this->Parent[i].load(std::memory_order_relaxed);
+      if (parent == i)
+        {
+        return i;
+        }
+      const vtkIdType grandParent = this->Parent[parent].load(std::memory_order_relaxed);
+      if (grandParent != parent)
+        {
+        // Path halving. Failing is fine, another thread updated the parent.
+        this->Parent[i].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+        }
+      i = grandParent;
+      }
+  }
+
+  void Union(vtkIdType i, vtkIdType j)
+  {
+    while (true)
+      {
+      i = this->Find(i);
+      j = this->Find(j);
+      if (i == j)
+        {
+        return;
+        }
+      if (i < j)
+        {
+        std::swap(i, j);
+        }
+      // Link the larger root below the smaller one, unless it is not a root
+      // anymore, in which case try again.
+      vtkIdType expected = i;
+      if (this->Parent[i].compare_exchange_strong(expected, j, std::memory_order_relaxed))
+        {
+        return;
+        }
+      }
+  }
+
+private:
+  std::vector<std::atomic<vtkIdType>> Parent;
+};
+
+//----------------------------------------------------------------------------
+double ComputeTriangleArea(const double p0[3], const double p1[3], const double p2[3])
+{
+  double e1[3], e2[3], normal[3];
+  vtkMath::Subtract(p1, p0, e1);
+  vtkMath::Subtract(p2, p0, e2);
+  vtkMath::Cross(e1, e2, normal);
+  return 0.5 * vtkMath::Norm(normal);
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+std::vector<vtkIdType> LabelConnectedRegions(vtkPolyData* input, std::vector<vtkIdType>& cellRegions,
+                                             std::vector<RegionStatistics>& statistics)
+{
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  // Faces from the shared topology, vertices and lines copied as they come first
+  std::shared_ptr<const SurfaceTopology> topology = GetSurfaceTopology(input);
+  std::vector<vtkIdType> lineOffsets;
+  std::vector<vtkIdType> lineConnectivity;
+  GetVertexAndLineCells(input, lineOffsets, lineConnectivity);
+  const vtkIdType firstPolygon = topology->FirstFaceCellId;
+  const vtkIdType firstStrip = firstPolygon + topology->NumberOfPolys;
+  const vtkIdType numberOfCells = firstPolygon + topology->GetNumberOfFaces();
+  auto getCell = [&](vtkIdType cellId, const vtkIdType*& cellPoints, vtkIdType& numberOfCellPoints)
+    {
+    if (cellId < firstPolygon)
+      {
+      cellPoints = lineConnectivity.data() + lineOffsets[cellId];
+      numberOfCellPoints = lineOffsets[cellId + 1] - lineOffsets[cellId];
+      }
+    else
+      {
+      const vtkIdType face = cellId - firstPolygon;
+      cellPoints = topology->FaceConnectivity.data() + topology->FaceOffsets[face];
+      numberOfCellPoints = topology->FaceOffsets[face + 1] - topology->FaceOffsets[face];
+      }
+    };
+
+  // Merge the points of each cell
+  ConcurrentUnionFind sets(numberOfPoints);
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      getCell(cellId, cellPoints, numberOfCellPoints);
+      for (vtkIdType i = 1; i < numberOfCellPoints; ++i)
+        {
+        sets.Union(cellPoints[0], cellPoints[i]);
+        }
+      }
+    });
+  std::vector<vtkIdType> pointRoots(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      pointRoots[pointId] = sets.Find(pointId);
+      }
+    });
+
+  // Size of each cell
+  std::vector<double> cellAreas(numberOfCells, 0.0);
+  vtkPoints* points = input->GetPoints();
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    double p0[3], p1[3], p2[3];
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    for (vtkIdType cellId = std::max(begin, firstPolygon); cellId < end; ++cellId)
+      {
+      getCell(cellId, cellPoints, numberOfCellPoints);
+      double area = 0.0;
+      for (vtkIdType k = 0; k + 2 < numberOfCellPoints; ++k)
+        {
+        // Fan triangulation of polygons, consecutive triangles of strips
+        points->GetPoint(cellId < firstStrip ? cellPoints[0] : cellPoints[k], p0);
+        points->GetPoint(cellPoints[k + 1], p1);
+        points->GetPoint(cellPoints[k + 2], p2);
+        area += ComputeTriangleArea(p0, p1, p2);
+        }
+      cellAreas[cellId] = area;
+      }
+    });
+
+  // Number the regions in order of their first cell and accumulate their size
+  std::vector<vtkIdType> rootRegions(numberOfPoints, -1);
+  std::vector<RegionStatistics> regions;
+  cellRegions.assign(numberOfCells, -1);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    getCell(cellId, cellPoints, numberOfCellPoints);
+    if (numberOfCellPoints == 0)
+      {
+      continue;
+      }
+    vtkIdType& region = rootRegions[pointRoots[cellPoints[0]]];
+    if (region < 0)
+      {
+      region = static_cast<vtkIdType>(regions.size());
+      regions.emplace_back();
+      }
+    cellRegions[cellId] = region;
+    RegionStatistics& regionStatistics = regions[region];
+    ++regionStatistics.NumberOfCells;
+    if (cellId >= firstPolygon)
+      {
+      regionStatistics.NumberOfTriangles += std::max<vtkIdType>(0, numberOfCellPoints - 2);
+      }
+    regionStatistics.Area += cellAreas[cellId];
+    }
+  std::vector<vtkIdType> pointRegions(numberOfPoints, -1);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    const vtkIdType region = rootRegions[pointRoots[pointId]];
+    if (region >= 0)
+      {
+      ++regions[region].NumberOfPoints;
+      pointRegions[pointId] = region;
+      }
+    }
+
+  // Renumber the regions by decreasing number of cells
+  std::vector<vtkIdType> order(regions.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](vtkIdType a, vtkIdType b)
+    {
+    return regions[a].NumberOfCells > regions[b].NumberOfCells;
+    });
+  std::vector<vtkIdType> rank(regions.size());
+  statistics.resize(regions.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    {
+    rank[order[i]] = static_cast<vtkIdType>(i);
+    statistics[i] = regions[order[i]];
+    }
+  vtkSMPTools::For(0, std::max(numberOfPoints, numberOfCells), [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      if (i < numberOfPoints && pointRegions[i] >= 0)
+        {
+        pointRegions[i] = rank[pointRegions[i]];
+        }
+      if (i < numberOfCells && cellRegions[i] >= 0)
+        {
+        cellRegions[i] = rank[cellRegions[i]];
+        }
+      }
+    });
+  return pointRegions;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunParallelConnectivity(vtkPolyData* input, const ConnectivityParameters& parameters)
+{
+  std::vector<vtkIdType> cellRegions;
+  std::vector<RegionStatistics> statistics;
+  std::vector<vtkIdType> pointRegions = LabelConnectedRegions(input, cellRegions, statistics);
+  const vtkIdType numberOfRegions = static_cast<vtkIdType>(statistics.size());
+
+  for (vtkIdType region = 0; region < numberOfRegions; ++region)
+    {
+    RegionStatistics& regionStatistics = statistics[region];
+    if (parameters.Mode == "All")
+      {
+      regionStatistics.Extracted = true;
+      }
+    else if (parameters.Mode == "MinimumSize")
+      {
+      regionStatistics.Extracted = regionStatistics.NumberOfCells >= parameters.MinimumNumberOfCells &&
+                                   regionStatistics.Area >= parameters.MinimumArea;
+      }
+    else
+      {
+      regionStatistics.Extracted = region < parameters.NumberOfRegions;
+      }
+    }
+
+  if (!parameters.StatisticsFileName.empty() &&
+      !WriteRegionStatistics(statistics, parameters.StatisticsFileName))
+    {
+    return nullptr;
+    }
+
+  vtkSmartPointer<vtkPolyData> surface = input;
+  if (parameters.LabelRegions)
+    {
+    surface = vtkSmartPointer<vtkPolyData>::New();
+    surface->ShallowCopy(input);
+    vtkNew<vtkIdTypeArray> pointRegionArray;
+    pointRegionArray->SetName("RegionId");
+    pointRegionArray->SetNumberOfValues(static_cast<vtkIdType>(pointRegions.size()));
+    std::copy(pointRegions.begin(), pointRegions.end(), pointRegionArray->GetPointer(0));
+    surface->GetPointData()->AddArray(pointRegionArray);
+    vtkNew<vtkIdTypeArray> cellRegionArray;
+    cellRegionArray->SetName("RegionId");
+    cellRegionArray->SetNumberOfValues(static_cast<vtkIdType>(cellRegions.size()));
+    std::copy(cellRegions.begin(), cellRegions.end(), cellRegionArray->GetPointer(0));
+    surface->GetCellData()->AddArray(cellRegionArray);
+    }
+
+  std::vector<unsigned char> keepCell(cellRegions.size());
+  vtkSMPTools::For(0, static_cast<vtkIdType>(cellRegions.size()), [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      keepCell[cellId] = cellRegions[cellId] >= 0 && statistics[cellRegions[cellId]].Extracted;
+      }
+    });
+  return ExtractCells(surface, keepCell);
+}
+
+//----------------------------------------------------------------------------
+bool WriteRegionStatistics(const std::vector<RegionStatistics>& statistics, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str());
+  if (!file)
+    {
+    std::cerr << "Cannot write region statistics to " << fileName << std::endl;
+    return false;
+    }
+  file.precision(10);
+  file << "RegionId,NumberOfPoints,NumberOfCells,NumberOfTriangles,Area,Extracted\n";
+  for (size_t region = 0; region < statistics.size(); ++region)
+    {
+    const RegionStatistics& regionStatistics = statistics[region];
+    file << region << ',' << regionStatistics.NumberOfPoints << ',' << regionStatistics.NumberOfCells << ','
+         << regionStatistics.NumberOfTriangles << ',' << regionStatistics.Area << ','
+         << (regionStatistics.Extracted ? 1 : 0) << '\n';
+    }
+  return static_cast<bool>(file);
+}
+
+}
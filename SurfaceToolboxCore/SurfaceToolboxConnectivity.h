@@ -0,0 +1,40 @@
+#ifndef SurfaceToolboxConnectivity_h
+#define SurfaceToolboxConnectivity_h
+
+#include "SurfaceToolboxStages.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace SurfaceToolbox
+{
+
+struct RegionStatistics
+{
+  vtkIdType NumberOfPoints = 0;
+  vtkIdType NumberOfCells = 0;
+  vtkIdType NumberOfTriangles = 0; // polygons and strips split into triangles
+  double Area = 0.0;
+  bool Extracted = false;
+};
+
+/// Label the connected regions of \a input, i.e. the groups of cells sharing
+/// points, as vtkPolyDataConnectivityFilter does. All regions are labelled in
+/// one parallel pass with a lock-free union-find over the points of the
+/// cells. Regions are numbered by decreasing number of cells, ties broken by
+/// their first cell. Returns the region of each point (-1 for unused points)
+/// and fills \a statistics with one entry per region.
+std::vector<vtkIdType> LabelConnectedRegions(vtkPolyData* input, std::vector<vtkIdType>& cellRegions,
+                                             std::vector<RegionStatistics>& statistics);
+
+/// Extract the regions selected by \a parameters, see ConnectivityParameters.
+/// Returns nullptr if the statistics file cannot be written.
+vtkSmartPointer<vtkPolyData> RunParallelConnectivity(vtkPolyData* input, const ConnectivityParameters& parameters);
+
+/// Write region statistics as CSV, one line per region.
+bool WriteRegionStatistics(const std::vector<RegionStatistics>& statistics, const std::string& fileName);
+
+}
+
+#endif
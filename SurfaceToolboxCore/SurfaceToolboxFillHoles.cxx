@@ -0,0 +1,630 @@
+#include "SurfaceToolboxFillHoles.h"
+#include "SurfaceToolboxBorders.h"
+
+// VTK includes
+#include "vtkAbstractArray.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+typedef std::array<double, 3> Point;
+typedef std::array<int, 3> Triangle;
+
+// Loops with more points are triangulated by ear clipping, the minimum area
+// triangulation taking cubic time and quadratic memory
+const int MaximumMinimumAreaLoopSize = 150;
+// Bounds on the refinement rounds and flip passes of fairing
+const int MaximumRefinementRounds = 10;
+const int MaximumFlipPasses = 10;
+
+struct Cap
+{
+  std::vector<Point> AddedPoints;
+  // Input point id, or -1 - i for added point i
+  std::vector<vtkIdType> Triangles;
+};
+
+//----------------------------------------------------------------------------
+double GetTriangleArea(const Point& a, const Point& b, const Point& c)
+{
+  double ab[3], ac[3], normal[3];
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    ab[axis] = b[axis] - a[axis];
+    ac[axis] = c[axis] - a[axis];
+    }
+  vtkMath::Cross(ab, ac, normal);
+  return 0.5 * vtkMath::Norm(normal);
+}
+
+//----------------------------------------------------------------------------
+// Angle at \a apex of the triangle (apex, a, b).
+double GetAngle(const Point& apex, const Point& a, const Point& b)
+{
+  double u[3], v[3];
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    u[axis] = a[axis] - apex[axis];
+    v[axis] = b[axis] - apex[axis];
+    }
+  return vtkMath::AngleBetweenVectors(u, v);
+}
+
+//----------------------------------------------------------------------------
+// Triangulation of the polygon of points 0 to n - 1 of minimum total area.
+void TriangulateMinimumArea(const std::vector<Point>& points, int n, std::vector<Triangle>& triangles)
+{
+  // Minimum area of the polygon i, i + 1, ..., j and the apex of its triangle on edge (i, j)
+  std::vector<double> area(n * n, 0.0);
+  std::vector<int> apex(n * n, -1);
+  for (int length = 2; length < n; ++length)
+    {
+    for (int i = 0; i + length < n; ++i)
+      {
+      const int j = i + length;
+      double minimumArea = std::numeric_limits<double>::max();
+      for (int m = i + 1; m < j; ++m)
+        {
+        const double a = area[i * n + m] + area[m * n + j] + GetTriangleArea(points[i], points[m], points[j]);
+        if (a < minimumArea)
+          {
+          minimumArea = a;
+          apex[i * n + j] = m;
+          }
+        }
+      area[i * n + j] = minimumArea;
+      }
+    }
+
+  std::vector<std::pair<int, int>> polygons(1, std::make_pair(0, n - 1));
+  while (!polygons.empty())
+    {
+    const int i = polygons.back().first;
+    const int j = polygons.back().second;
+    polygons.pop_back();
+    if (j - i < 2)
+      {
+      continue;
+      }
+    const int m = apex[i * n + j];
+    triangles.push_back({ { i, m, j } });
+    polygons.push_back(std::make_pair(i, m));
+    polygons.push_back(std::make_pair(m, j));
+    }
+}
+
+//----------------------------------------------------------------------------
+// Ear clipping of the polygon of points 0 to n - 1, projected on the plane of
+// its Newell normal. If no ear is left, as in self-intersecting projections,
+// the next vertex is clipped anyway.
+void TriangulateEarClipping(const std::vector<Point>& points, int n, std::vector<Triangle>& triangles)
+{
+  double normal[3] = { 0.0, 0.0, 0.0 };
+  for (int i = 0; i < n; ++i)
+    {
+    const Point& p = points[i];
+    const Point& q = points[(i + 1) % n];
+    normal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+    normal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+    normal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+    }
+  if (vtkMath::Normalize(normal) == 0.0)
+    {
+    normal[2] = 1.0;
+    }
+  double u[3], v[3];
+  vtkMath::Perpendiculars(normal, u, v, 0.0);
+
+  std::vector<double> x(n), y(n);
+  std::vector<int> previous(n), next(n);
+  for (int i = 0; i < n; ++i)
+    {
+    x[i] = vtkMath::Dot(points[i].data(), u);
+    y[i] = vtkMath::Dot(points[i].data(), v);
+    previous[i] = (i + n - 1) % n;
+    next[i] = (i + 1) % n;
+    }
+  auto cross = [&](int a, int b, int c)
+    {
+    return (x[b] - x[a]) * (y[c] - y[a]) - (y[b] - y[a]) * (x[c] - x[a]);
+    };
+  auto isEar = [&](int i)
+    {
+    const int a = previous[i];
+    const int c = next[i];
+    if (cross(a, i, c) <= 0.0)
+      {
+      return false;
+      }
+    for (int k = next[c]; k != a; k = next[k])
+      {
+      if (cross(a, i, k) >= 0.0 && cross(i, c, k) >= 0.0 && cross(c, a, k) >= 0.0)
+        {
+        return false;
+        }
+      }
+    return true;
+    };
+
+  int remaining = n;
+  int i = 0;
+  int failures = 0;
+  while (remaining > 3)
+    {
+    if (failures < remaining && !isEar(i))
+      {
+      ++failures;
+      i = next[i];
+      continue;
+      }
+    triangles.push_back({ { previous[i], i, next[i] } });
+    next[previous[i]] = next[i];
+    previous[next[i]] = previous[i];
+    i = next[i];
+    --remaining;
+    failures = 0;
+    }
+  triangles.push_back({ { previous[i], i, next[i] } });
+}
+
+//----------------------------------------------------------------------------
+// Flip the interior edges of the cap whose opposite angles add up to more
+// than pi, towards a Delaunay triangulation.
+void FlipEdges(const std::vector<Point>& points, std::vector<Triangle>& triangles)
+{
+  for (int pass = 0; pass < MaximumFlipPasses; ++pass)
+    {
+    // Triangle and position of every directed edge
+    std::map<std::pair<int, int>, std::pair<size_t, int>> edges;
+    for (size_t t = 0; t < triangles.size(); ++t)
+      {
+      for (int k = 0; k < 3; ++k)
+        {
+        edges[std::make_pair(triangles[t][k], triangles[t][(k + 1) % 3])] = std::make_pair(t, k);
+        }
+      }
+
+    std::vector<unsigned char> changed(triangles.size(), 0);
+    bool flipped = false;
+    for (const auto& edge : edges)
+      {
+      const int a = edge.first.first;
+      const int b = edge.first.second;
+      if (a > b)
+        {
+        continue;
+        }
+      const auto opposite = edges.find(std::make_pair(b, a));
+      if (opposite == edges.end())
+        {
+        continue;
+        }
+      const size_t t1 = edge.second.first;
+      const size_t t2 = opposite->second.first;
+      if (changed[t1] || changed[t2])
+        {
+        continue;
+        }
+      // t1 is (a, b, c) and t2 is (b, a, d)
+      const int c = triangles[t1][(edge.second.second + 2) % 3];
+      const int d = triangles[t2][(opposite->second.second + 2) % 3];
+      if (c == d || edges.count(std::make_pair(c, d)) || edges.count(std::make_pair(d, c)))
+        {
+        continue;
+        }
+      if (GetAngle(points[c], points[a], points[b]) + GetAngle(points[d], points[b], points[a]) <= vtkMath::Pi() + 1e-12)
+        {
+        continue;
+        }
+      triangles[t1] = { { c, a, d } };
+      triangles[t2] = { { d, b, c } };
+      changed[t1] = changed[t2] = 1;
+      // Record the new edge so that no later flip of this pass duplicates it
+      edges[std::make_pair(d, c)] = std::make_pair(t1, 2);
+      edges[std::make_pair(c, d)] = std::make_pair(t2, 2);
+      flipped = true;
+      }
+    if (!flipped)
+      {
+      break;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Refine the cap until its triangles are smaller than an equilateral triangle
+// of side \a edgeLength, then smooth the added points, the points from
+// \a numberOfBoundaryPoints on.
+void FairCap(std::vector<Point>& points, int numberOfBoundaryPoints, double edgeLength, int iterations,
+             std::vector<Triangle>& triangles)
+{
+  const double maximumArea = std::sqrt(3.0) / 4.0 * edgeLength * edgeLength;
+  for (int round = 0; round < MaximumRefinementRounds; ++round)
+    {
+    bool split = false;
+    const size_t numberOfTriangles = triangles.size();
+    for (size_t t = 0; t < numberOfTriangles; ++t)
+      {
+      const Triangle triangle = triangles[t];
+      if (GetTriangleArea(points[triangle[0]], points[triangle[1]], points[triangle[2]]) <= maximumArea)
+        {
+        continue;
+        }
+      Point centroid;
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        centroid[axis] = (points[triangle[0]][axis] + points[triangle[1]][axis] + points[triangle[2]][axis]) / 3.0;
+        }
+      const int c = static_cast<int>(points.size());
+      points.push_back(centroid);
+      triangles[t] = { { triangle[0], triangle[1], c } };
+      triangles.push_back({ { triangle[1], triangle[2], c } });
+      triangles.push_back({ { triangle[2], triangle[0], c } });
+      split = true;
+      }
+    if (!split)
+      {
+      break;
+      }
+    FlipEdges(points, triangles);
+    }
+
+  const int numberOfPoints = static_cast<int>(points.size());
+  if (numberOfPoints == numberOfBoundaryPoints)
+    {
+    return;
+    }
+  std::vector<std::set<int>> neighbors(numberOfPoints - numberOfBoundaryPoints);
+  for (const Triangle& triangle : triangles)
+    {
+    for (int k = 0; k < 3; ++k)
+      {
+      if (triangle[k] >= numberOfBoundaryPoints)
+        {
+        neighbors[triangle[k] - numberOfBoundaryPoints].insert(triangle[(k + 1) % 3]);
+        neighbors[triangle[k] - numberOfBoundaryPoints].insert(triangle[(k + 2) % 3]);
+        }
+      }
+    }
+  std::vector<Point> smoothed(points);
+  for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+    for (int i = numberOfBoundaryPoints; i < numberOfPoints; ++i)
+      {
+      Point average = { { 0.0, 0.0, 0.0 } };
+      for (int neighbor : neighbors[i - numberOfBoundaryPoints])
+        {
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          average[axis] += points[neighbor][axis];
+          }
+        }
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        smoothed[i][axis] = average[axis] / neighbors[i - numberOfBoundaryPoints].size();
+        }
+      }
+    points.swap(smoothed);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Cap the loop given by \a capIds and \a capPoints, in cap order. Returns
+// false if it is not filled.
+bool BuildCap(const std::vector<vtkIdType>& capIds, std::vector<Point>& capPoints,
+              const SurfaceToolbox::FillHolesParameters& parameters, SurfaceToolbox::HoleStatistics& hole, Cap& cap)
+{
+  const int n = static_cast<int>(capIds.size());
+  Point centroid = { { 0.0, 0.0, 0.0 } };
+  for (const Point& point : capPoints)
+    {
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      centroid[axis] += point[axis] / n;
+      }
+    }
+  for (const Point& point : capPoints)
+    {
+    hole.Radius = std::max(hole.Radius, std::sqrt(vtkMath::Distance2BetweenPoints(point.data(), centroid.data())));
+    }
+  if (n < 3 || hole.Radius > parameters.MaximumHoleSize)
+    {
+    return false;
+    }
+  std::vector<vtkIdType> sortedIds(capIds);
+  std::sort(sortedIds.begin(), sortedIds.end());
+  if (std::adjacent_find(sortedIds.begin(), sortedIds.end()) != sortedIds.end())
+    {
+    return false;
+    }
+
+  std::vector<Triangle> triangles;
+  if (parameters.Triangulation == "MinimumArea" && n <= MaximumMinimumAreaLoopSize)
+    {
+    TriangulateMinimumArea(capPoints, n, triangles);
+    }
+  else
+    {
+    TriangulateEarClipping(capPoints, n, triangles);
+    }
+  if (parameters.FairingIterations > 0)
+    {
+    FairCap(capPoints, n, hole.Perimeter / hole.NumberOfEdges, parameters.FairingIterations, triangles);
+    }
+
+  cap.AddedPoints.assign(capPoints.begin() + n, capPoints.end());
+  cap.Triangles.reserve(3 * triangles.size());
+  for (const Triangle& triangle : triangles)
+    {
+    for (int k = 0; k < 3; ++k)
+      {
+      cap.Triangles.push_back(triangle[k] < n ? capIds[triangle[k]] : -1 - (triangle[k] - n));
+      }
+    hole.Area += GetTriangleArea(capPoints[triangle[0]], capPoints[triangle[1]], capPoints[triangle[2]]);
+    }
+  hole.Filled = true;
+  hole.NumberOfTriangles = static_cast<vtkIdType>(triangles.size());
+  hole.NumberOfAddedPoints = static_cast<vtkIdType>(cap.AddedPoints.size());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Copy of \a input with numberOfInserted tuples inserted at \a insertAt, the
+// following tuples moving up. Inserted tuples of data arrays are zero.
+vtkSmartPointer<vtkAbstractArray> InsertTuples(vtkAbstractArray* input, vtkIdType insertAt, vtkIdType numberOfInserted)
+{
+  const vtkIdType numberOfTuples = input->GetNumberOfTuples();
+  vtkSmartPointer<vtkAbstractArray> output = vtkSmartPointer<vtkAbstractArray>::Take(input->NewInstance());
+  output->SetName(input->GetName());
+  output->SetNumberOfComponents(input->GetNumberOfComponents());
+  output->SetNumberOfTuples(numberOfTuples + numberOfInserted);
+  output->InsertTuples(0, insertAt, 0, input);
+  if (numberOfTuples > insertAt)
+    {
+    output->InsertTuples(insertAt + numberOfInserted, numberOfTuples - insertAt, insertAt, input);
+    }
+  vtkDataArray* data = vtkDataArray::SafeDownCast(output);
+  if (data)
+    {
+    for (vtkIdType i = insertAt; i < insertAt + numberOfInserted; ++i)
+      {
+      for (int component = 0; component < data->GetNumberOfComponents(); ++component)
+        {
+        data->SetComponent(i, component, 0.0);
+        }
+      }
+    }
+  return output;
+}
+
+//----------------------------------------------------------------------------
+// Replace the arrays of \a output by copies of the arrays of \a input with
+// tuples inserted, keeping the active attributes.
+void InsertTuples(vtkDataSetAttributes* input, vtkDataSetAttributes* output, vtkIdType insertAt,
+                  vtkIdType numberOfInserted)
+{
+  output->Initialize();
+  for (int arrayIndex = 0; arrayIndex < input->GetNumberOfArrays(); ++arrayIndex)
+    {
+    vtkAbstractArray* inputArray = input->GetAbstractArray(arrayIndex);
+    output->AddArray(InsertTuples(inputArray, insertAt, numberOfInserted));
+    for (int attribute = 0; attribute < vtkDataSetAttributes::NUM_ATTRIBUTES; ++attribute)
+      {
+      if (input->GetAbstractAttribute(attribute) == inputArray)
+        {
+        output->SetActiveAttribute(output->GetNumberOfArrays() - 1, attribute);
+        }
+      }
+    }
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> FillHoles(vtkPolyData* input, const FillHolesParameters& parameters,
+                                       std::vector<HoleStatistics>& holes)
+{
+  holes.clear();
+  std::vector<BoundaryLoop> loops;
+  std::vector<vtkIdType> loopOffsets;
+  std::vector<vtkIdType> loopPoints;
+  if (!GetBoundaryLoops(input, false, loops, loopOffsets, loopPoints))
+    {
+    return nullptr;
+    }
+
+  const vtkIdType numberOfLoops = static_cast<vtkIdType>(loops.size());
+  holes.resize(numberOfLoops);
+  std::vector<Cap> caps(numberOfLoops);
+  vtkPoints* inputPoints = input->GetPoints();
+  vtkSMPTools::For(0, numberOfLoops, [&](vtkIdType begin, vtkIdType end)
+    {
+    std::vector<vtkIdType> capIds;
+    std::vector<Point> capPoints;
+    for (vtkIdType loopId = begin; loopId < end; ++loopId)
+      {
+      const BoundaryLoop& loop = loops[loopId];
+      HoleStatistics& hole = holes[loopId];
+      hole.NumberOfEdges = loop.NumberOfEdges;
+      hole.Perimeter = loop.Perimeter;
+
+      // The cap traverses the loop backwards, without the repeated first point of closed loops
+      const vtkIdType first = loopOffsets[loopId];
+      const vtkIdType size = loopOffsets[loopId + 1] - first - (loop.Closed ? 1 : 0);
+      capIds.resize(size);
+      capPoints.resize(size);
+      for (vtkIdType i = 0; i < size; ++i)
+        {
+        capIds[i] = loopPoints[first + (size - i) % size];
+        inputPoints->GetPoint(capIds[i], capPoints[i].data());
+        }
+      if (loop.Closed)
+        {
+        BuildCap(capIds, capPoints, parameters, hole, caps[loopId]);
+        }
+      }
+    });
+
+  std::vector<vtkIdType> firstAddedPoint(numberOfLoops + 1, 0);
+  std::vector<vtkIdType> firstCapCell(numberOfLoops + 1, 0);
+  for (vtkIdType loopId = 0; loopId < numberOfLoops; ++loopId)
+    {
+    firstAddedPoint[loopId + 1] = firstAddedPoint[loopId] + holes[loopId].NumberOfAddedPoints;
+    firstCapCell[loopId + 1] = firstCapCell[loopId] + holes[loopId].NumberOfTriangles;
+    }
+  const vtkIdType numberOfAddedPoints = firstAddedPoint[numberOfLoops];
+  const vtkIdType numberOfCapCells = firstCapCell[numberOfLoops];
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(input);
+  if (numberOfCapCells == 0)
+    {
+    return output;
+    }
+
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  if (numberOfAddedPoints > 0)
+    {
+    vtkNew<vtkPoints> points;
+    points->SetData(vtkDataArray::SafeDownCast(InsertTuples(inputPoints->GetData(), numberOfPoints, numberOfAddedPoints)));
+    InsertTuples(input->GetPointData(), output->GetPointData(), numberOfPoints, numberOfAddedPoints);
+    vtkPointData* inputPointData = input->GetPointData();
+    vtkPointData* outputPointData = output->GetPointData();
+    vtkSMPTools::For(0, numberOfLoops, [&](vtkIdType begin, vtkIdType end)
+      {
+      std::vector<double> average;
+      for (vtkIdType loopId = begin; loopId < end; ++loopId)
+        {
+        const Cap& cap = caps[loopId];
+        const vtkIdType firstPoint = numberOfPoints + firstAddedPoint[loopId];
+        for (size_t i = 0; i < cap.AddedPoints.size(); ++i)
+          {
+          points->SetPoint(firstPoint + i, cap.AddedPoints[i].data());
+          }
+        if (cap.AddedPoints.empty())
+          {
+          continue;
+          }
+
+        // Added points get the average of the data of the loop points
+        const vtkIdType first = loopOffsets[loopId];
+        const vtkIdType size = loopOffsets[loopId + 1] - first - 1;
+        for (int arrayIndex = 0; arrayIndex < inputPointData->GetNumberOfArrays(); ++arrayIndex)
+          {
+          vtkAbstractArray* inputArray = inputPointData->GetAbstractArray(arrayIndex);
+          vtkAbstractArray* outputArray = outputPointData->GetAbstractArray(arrayIndex);
+          vtkDataArray* inputData = vtkDataArray::SafeDownCast(inputArray);
+          vtkDataArray* outputData = vtkDataArray::SafeDownCast(outputArray);
+          if (!inputData)
+            {
+            for (size_t i = 0; i < cap.AddedPoints.size(); ++i)
+              {
+              outputArray->SetTuple(firstPoint + i, loopPoints[first], inputArray);
+              }
+            continue;
+            }
+          const int numberOfComponents = inputData->GetNumberOfComponents();
+          average.assign(numberOfComponents, 0.0);
+          for (vtkIdType k = 0; k < size; ++k)
+            {
+            for (int component = 0; component < numberOfComponents; ++component)
+              {
+              average[component] += inputData->GetComponent(loopPoints[first + k], component) / size;
+              }
+            }
+          for (size_t i = 0; i < cap.AddedPoints.size(); ++i)
+            {
+            for (int component = 0; component < numberOfComponents; ++component)
+              {
+              outputData->SetComponent(firstPoint + i, component, average[component]);
+              }
+            }
+          }
+        }
+      });
+    output->SetPoints(points);
+    }
+
+  vtkNew<vtkCellArray> polys;
+  polys->DeepCopy(input->GetPolys());
+  for (vtkIdType loopId = 0; loopId < numberOfLoops; ++loopId)
+    {
+    const Cap& cap = caps[loopId];
+    for (size_t i = 0; i < cap.Triangles.size(); i += 3)
+      {
+      vtkIdType pointIds[3];
+      for (int k = 0; k < 3; ++k)
+        {
+        const vtkIdType pointId = cap.Triangles[i + k];
+        pointIds[k] = pointId >= 0 ? pointId : numberOfPoints + firstAddedPoint[loopId] + (-1 - pointId);
+        }
+      polys->InsertNextCell(3, pointIds);
+      }
+    }
+  output->SetPolys(polys);
+
+  // Cells are ordered as verts, lines, polys and strips, so the caps are inserted before the strips
+  const vtkIdType firstCap = input->GetNumberOfVerts() + input->GetNumberOfLines() + input->GetNumberOfPolys();
+  InsertTuples(input->GetCellData(), output->GetCellData(), firstCap, numberOfCapCells);
+  return output;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunParallelFillHoles(vtkPolyData* input, const FillHolesParameters& parameters)
+{
+  std::vector<HoleStatistics> holes;
+  vtkSmartPointer<vtkPolyData> output = FillHoles(input, parameters, holes);
+  if (output && !parameters.StatisticsFileName.empty() &&
+      !WriteHoleStatistics(holes, parameters.StatisticsFileName))
+    {
+    return nullptr;
+    }
+  return output;
+}
+
+//----------------------------------------------------------------------------
+bool WriteHoleStatistics(const std::vector<HoleStatistics>& holes, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str());
+  if (!file)
+    {
+    std::cerr << "Cannot write hole statistics to " << fileName << std::endl;
+    return false;
+    }
+  file.precision(10);
+  file << "HoleId,NumberOfEdges,Perimeter,Radius,Filled,NumberOfTriangles,NumberOfAddedPoints,Area\n";
+  for (size_t holeId = 0; holeId < holes.size(); ++holeId)
+    {
+    const HoleStatistics& hole = holes[holeId];
+    file << holeId << ',' << hole.NumberOfEdges << ',' << hole.Perimeter << ',' << hole.Radius << ','
+         << (hole.Filled ? 1 : 0) << ',' << hole.NumberOfTriangles << ',' << hole.NumberOfAddedPoints << ','
+         << hole.Area << '\n';
+    }
+  return static_cast<bool>(file);
+}
+
+}
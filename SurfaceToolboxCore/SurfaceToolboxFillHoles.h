@@ -0,0 +1,58 @@
+#ifndef SurfaceToolboxFillHoles_h
+#define SurfaceToolboxFillHoles_h
+
+#include "SurfaceToolboxStages.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace SurfaceToolbox
+{
+
+struct HoleStatistics
+{
+  vtkIdType NumberOfEdges = 0;
+  double Perimeter = 0.0;
+  // Largest distance from the centroid of the hole points to its points
+  double Radius = 0.0;
+  bool Filled = false;
+  vtkIdType NumberOfTriangles = 0;
+  vtkIdType NumberOfAddedPoints = 0;
+  double Area = 0.0;
+};
+
+/// Multi-threaded hole filling, replacing vtkFillHolesFilter.
+///
+/// The boundary loops of the surface are extracted with GetBoundaryLoops from
+/// the shared surface topology, and every closed loop whose radius is at most
+/// MaximumHoleSize is capped, the caps being triangulated in parallel, one
+/// hole per task. Triangulation is "MinimumArea", the triangulation of the
+/// loop of minimum total area by dynamic programming, for loops of up to 150
+/// points, or "EarClipping" in the best-fit plane of the loop, used for
+/// larger loops as well. With FairingIterations, cap triangles larger than an
+/// equilateral triangle of the mean boundary edge length are split at their
+/// centroid, edges are flipped towards a Delaunay triangulation, and the
+/// added points are moved by this number of Laplacian smoothing iterations.
+///
+/// Loops follow the orientation of the faces along them, so caps traverse
+/// them backwards to be oriented like their neighbors, and no global
+/// orientation pass is needed. Loops that are open or go through a point
+/// twice are not filled.
+///
+/// The cap triangles are appended to the polygons. Added points get the
+/// average point data of their hole's points, cap cells get zero cell data.
+/// \a holes receives the statistics of every boundary loop.
+vtkSmartPointer<vtkPolyData> FillHoles(vtkPolyData* input, const FillHolesParameters& parameters,
+                                       std::vector<HoleStatistics>& holes);
+
+/// Fill the holes and write their statistics if requested.
+/// Returns nullptr if the statistics file cannot be written.
+vtkSmartPointer<vtkPolyData> RunParallelFillHoles(vtkPolyData* input, const FillHolesParameters& parameters);
+
+/// Write hole statistics as CSV, one line per boundary loop.
+bool WriteHoleStatistics(const std::vector<HoleStatistics>& holes, const std::string& fileName);
+
+}
+
+#endif
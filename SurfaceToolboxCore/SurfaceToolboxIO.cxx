@@ -0,0 +1,170 @@
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxMeshFiles.h"
+#include "SurfaceToolboxPieces.h"
+#include "SurfaceToolboxSharedMemory.h"
+#include "SurfaceToolboxXMLWriter.h"
+
+// VTK includes
+#include "vtkDataCompressor.h"
+#include "vtkErrorCode.h"
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkXMLPolyDataReader.h"
+#include "vtkXMLPolyDataWriter.h"
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Reader and writer kept between calls, for processes reading and writing
+// many surfaces such as SurfaceToolboxWorker.
+vtkXMLPolyDataReader* GetReader()
+{
+  thread_local vtkNew<vtkXMLPolyDataReader> reader;
+  return reader;
+}
+
+//----------------------------------------------------------------------------
+vtkXMLPolyDataWriter* GetWriter()
+{
+  thread_local vtkNew<vtkXMLPolyDataWriter> writer;
+  // Appended binary: the values are written as they are in memory, without
+  // base64 encoding
+  writer->SetDataModeToAppended();
+  writer->EncodeAppendedDataOff();
+  writer->SetHeaderTypeToUInt64();
+  return writer;
+}
+
+//----------------------------------------------------------------------------
+// Write with vtkXMLPolyDataWriter, which compresses the blocks one at a time
+bool WriteXMLPolyData(vtkPolyData* polyData, const std::string& fileName,
+                      const SurfaceToolbox::WriteParameters& parameters)
+{
+  vtkXMLPolyDataWriter* writer = GetWriter();
+  vtkSmartPointer<vtkDataCompressor> compressor =
+    SurfaceToolbox::CreateCompressor(parameters.Compression, parameters.CompressionLevel);
+  writer->SetCompressor(compressor);
+  writer->SetFileName(fileName.c_str());
+  writer->SetInputData(polyData);
+  const bool written = writer->Write() != 0;
+  writer->SetInputData(nullptr);
+  if (!written)
+    {
+    std::cerr << "Failed to write " << fileName << ": "
+              << vtkErrorCode::GetStringFromErrorCode(writer->GetErrorCode()) << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Size of a written file, with its pieces for .pvtp files
+unsigned long long GetWrittenSize(const std::string& fileName)
+{
+  unsigned long long size = vtksys::SystemTools::FileLength(fileName);
+  if (SurfaceToolbox::IsPiecesFileName(fileName))
+    {
+    for (const std::string& pieceFileName : SurfaceToolbox::GetPieceFileNames(fileName))
+      {
+      size += vtksys::SystemTools::FileLength(pieceFileName);
+      }
+    }
+  return size;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadPolyData(const std::string& fileName)
+{
+  if (IsSharedMemoryName(fileName))
+    {
+    return ReadSharedMemoryPolyData(fileName);
+    }
+  if (IsPiecesFileName(fileName))
+    {
+    return ReadPolyDataPieces(fileName);
+    }
+  if (IsMeshFileName(fileName))
+    {
+    return ReadMeshFile(fileName);
+    }
+  vtkXMLPolyDataReader* reader = GetReader();
+  reader->SetFileName(fileName.c_str());
+  // The file may have changed since it was last read
+  reader->Modified();
+  reader->Update();
+  if (reader->GetErrorCode() != vtkErrorCode::NoError)
+    {
+    std::cerr << "Failed to read " << fileName << ": "
+              << vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()) << std::endl;
+    reader->GetOutput()->Initialize();
+    return nullptr;
+    }
+  // The reader creates new arrays on every read: the surface keeps them and
+  // the reader does not hold on to them until the next read.
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->ShallowCopy(reader->GetOutput());
+  reader->GetOutput()->Initialize();
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+bool WritePolyData(vtkPolyData* polyData, const std::string& fileName, const WriteParameters& parameters)
+{
+  if (IsSharedMemoryName(fileName))
+    {
+    return WriteSharedMemoryPolyData(polyData, fileName);
+    }
+  if (!IsCompression(parameters.Compression))
+    {
+    std::cerr << "Failed to write " << fileName << ": unknown compression " << parameters.Compression << std::endl;
+    return false;
+    }
+  const auto start = std::chrono::steady_clock::now();
+  bool written = false;
+  const bool meshFile = IsMeshFileName(fileName);
+  if (meshFile)
+    {
+    written = WriteMeshFile(polyData, fileName);
+    }
+  else if (IsPiecesFileName(fileName))
+    {
+    written = WritePolyDataPieces(polyData, fileName, parameters);
+    }
+  else if (parameters.Compression != "none" && CanWriteCompressedPolyData(polyData))
+    {
+    written = WriteCompressedPolyData(polyData, fileName, parameters.Compression, parameters.CompressionLevel);
+    }
+  else
+    {
+    written = WriteXMLPolyData(polyData, fileName, parameters);
+    }
+  if (written && parameters.ReportStatistics)
+    {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Wrote " << fileName << ": " << GetWrittenSize(fileName) << " bytes in " << elapsed.count() << " s";
+    if (!meshFile)
+      {
+      std::cout << " (compression " << parameters.Compression;
+      if (parameters.Compression != "none")
+        {
+        std::cout << ", level " << parameters.CompressionLevel;
+        }
+      std::cout << ")";
+      }
+    std::cout << std::endl;
+    }
+  return written;
+}
+
+}
@@ -0,0 +1,46 @@
+#ifndef SurfaceToolboxIO_h
+#define SurfaceToolboxIO_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+
+// STD includes
+#include <string>
+
+class vtkPolyData;
+
+namespace SurfaceToolbox
+{
+
+/// Options of the surface files written by WritePolyData.
+struct WriteParameters
+{
+  /// "none", "lz4", "zlib" or "lzma" (see SurfaceToolboxXMLWriter.h)
+  std::string Compression = "none";
+  /// From 1 (fastest) to 9 (smallest)
+  int CompressionLevel = 5;
+  /// Number of pieces of .pvtp files, 0 for one per thread
+  int NumberOfPieces = 0;
+  /// Print the size of the written files and the time taken to write them
+  bool ReportStatistics = false;
+};
+
+/// Read the surface stored in \a fileName, or in the shared memory segment
+/// it names if it is of the form "shm:/name" (see SurfaceToolboxSharedMemory.h).
+/// The pieces listed by .pvtp files are read in parallel (see SurfaceToolboxPieces.h),
+/// and .stl, .ply and .obj files through a memory mapping (see SurfaceToolboxMeshFiles.h).
+/// Returns nullptr if the file could not be read.
+vtkSmartPointer<vtkPolyData> ReadPolyData(const std::string& fileName);
+
+/// Write \a polyData to \a fileName as appended binary XML, raw or with the
+/// blocks compressed in parallel, or to a shared memory segment if it is of
+/// the form "shm:/name". .pvtp files are written as one piece per thread, in
+/// parallel. .stl, .ply and .obj files are written in their own format, without
+/// compression.
+/// Returns false if the file could not be written.
+bool WritePolyData(vtkPolyData* polyData, const std::string& fileName,
+                   const WriteParameters& parameters = WriteParameters());
+
+}
+
+#endif
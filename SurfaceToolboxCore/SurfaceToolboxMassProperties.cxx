@@ -0,0 +1,290 @@
+#include "SurfaceToolboxMassProperties.h"
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Neumaier compensated sum
+struct CompensatedSum
+{
+  double Sum = 0.0;
+  double Compensation = 0.0;
+
+  void Add(double value)
+  {
+    const double sum = this->Sum + value;
+    if (std::fabs(this->Sum) >= std::fabs(value))
+      {
+      this->Compensation += (this->Sum - sum) + value;
+      }
+    else
+      {
+      this->Compensation += (value - sum) + this->Sum;
+      }
+    this->Sum = sum;
+  }
+
+  void Add(const CompensatedSum& other)
+  {
+    this->Add(other.Sum);
+    this->Add(other.Compensation);
+  }
+
+  double GetValue() const
+  {
+    return this->Sum + this->Compensation;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Integrals over the enclosed volume of 1, x, y, z, x^2, y^2, z^2, xy, yz, zx
+// (before the constant factors), and the surface area.
+enum Integral
+{
+  IntegralOne = 0,
+  IntegralX,
+  IntegralY,
+  IntegralZ,
+  IntegralXX,
+  IntegralYY,
+  IntegralZZ,
+  IntegralXY,
+  IntegralYZ,
+  IntegralZX,
+  Area,
+  NumberOfIntegrals
+};
+
+struct Integrals
+{
+  CompensatedSum Values[NumberOfIntegrals];
+};
+
+//----------------------------------------------------------------------------
+void ComputeSubexpressions(double w0, double w1, double w2, double& f1, double& f2, double& f3,
+                           double& g0, double& g1, double& g2)
+{
+  const double temp0 = w0 + w1;
+  f1 = temp0 + w2;
+  const double temp1 = w0 * w0;
+  const double temp2 = temp1 + w1 * temp0;
+  f2 = temp2 + w2 * f1;
+  f3 = w0 * temp1 + w1 * temp2 + w2 * f2;
+  g0 = f2 + w0 * (f1 + w0);
+  g1 = f2 + w1 * (f1 + w1);
+  g2 = f2 + w2 * (f1 + w2);
+}
+
+//----------------------------------------------------------------------------
+// Contribution of one triangle, from Eberly, "Polyhedral Mass Properties
+// (Revisited)", with coordinates relative to a reference point.
+void AddTriangle(const double* p0, const double* p1, const double* p2, Integrals& integrals)
+{
+  const double a1 = p1[0] - p0[0], b1 = p1[1] - p0[1], c1 = p1[2] - p0[2];
+  const double a2 = p2[0] - p0[0], b2 = p2[1] - p0[1], c2 = p2[2] - p0[2];
+  const double d0 = b1 * c2 - b2 * c1;
+  const double d1 = a2 * c1 - a1 * c2;
+  const double d2 = a1 * b2 - a2 * b1;
+
+  double f1x, f2x, f3x, g0x, g1x, g2x;
+  double f1y, f2y, f3y, g0y, g1y, g2y;
+  double f1z, f2z, f3z, g0z, g1z, g2z;
+  ComputeSubexpressions(p0[0], p1[0], p2[0], f1x, f2x, f3x, g0x, g1x, g2x);
+  ComputeSubexpressions(p0[1], p1[1], p2[1], f1y, f2y, f3y, g0y, g1y, g2y);
+  ComputeSubexpressions(p0[2], p1[2], p2[2], f1z, f2z, f3z, g0z, g1z, g2z);
+
+  CompensatedSum* values = integrals.Values;
+  values[IntegralOne].Add(d0 * f1x);
+  values[IntegralX].Add(d0 * f2x);
+  values[IntegralY].Add(d1 * f2y);
+  values[IntegralZ].Add(d2 * f2z);
+  values[IntegralXX].Add(d0 * f3x);
+  values[IntegralYY].Add(d1 * f3y);
+  values[IntegralZZ].Add(d2 * f3z);
+  values[IntegralXY].Add(d0 * (p0[1] * g0x + p1[1] * g1x + p2[1] * g2x));
+  values[IntegralYZ].Add(d1 * (p0[2] * g0y + p1[2] * g1y + p2[2] * g2y));
+  values[IntegralZX].Add(d2 * (p0[0] * g0z + p1[0] * g1z + p2[0] * g2z));
+  values[Area].Add(0.5 * std::sqrt(d0 * d0 + d1 * d1 + d2 * d2));
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+bool ComputeMassProperties(vtkPolyData* input, MassProperties& properties)
+{
+  properties = MassProperties();
+  std::vector<vtkIdType> triangles;
+  vtkSmartPointer<vtkPolyData> surface = GetTriangulatedSurface(input, triangles);
+  const vtkIdType numberOfTriangles = static_cast<vtkIdType>(triangles.size() / 3);
+  if (numberOfTriangles == 0)
+    {
+    std::cerr << "Cannot compute mass properties: the surface has no triangles" << std::endl;
+    return false;
+    }
+
+  // Coordinates relative to the center of the bounding box, to limit the
+  // cancellation in the second order moments of surfaces far from the origin.
+  std::vector<double> coordinates;
+  GetPointCoordinates(surface, coordinates);
+  double bounds[6];
+  surface->GetPoints()->GetBounds(bounds);
+  const double reference[3] = { 0.5 * (bounds[0] + bounds[1]), 0.5 * (bounds[2] + bounds[3]),
+                                0.5 * (bounds[4] + bounds[5]) };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(coordinates.size() / 3), [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      coordinates[3 * i] -= reference[0];
+      coordinates[3 * i + 1] -= reference[1];
+      coordinates[3 * i + 2] -= reference[2];
+      }
+    });
+
+  // Sums over fixed-size blocks of triangles, added in order
+  const vtkIdType blockSize = 4096;
+  const vtkIdType numberOfBlocks = (numberOfTriangles + blockSize - 1) / blockSize;
+  std::vector<Integrals> blockIntegrals(numberOfBlocks);
+  vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType beginBlock, vtkIdType endBlock)
+    {
+    for (vtkIdType block = beginBlock; block < endBlock; ++block)
+      {
+      const vtkIdType end = std::min(numberOfTriangles, (block + 1) * blockSize);
+      for (vtkIdType triangleId = block * blockSize; triangleId < end; ++triangleId)
+        {
+        const vtkIdType* triangle = &triangles[3 * triangleId];
+        AddTriangle(&coordinates[3 * triangle[0]], &coordinates[3 * triangle[1]], &coordinates[3 * triangle[2]],
+                    blockIntegrals[block]);
+        }
+      }
+    });
+  Integrals total;
+  for (const Integrals& integrals : blockIntegrals)
+    {
+    for (int i = 0; i < NumberOfIntegrals; ++i)
+      {
+      total.Values[i].Add(integrals.Values[i]);
+      }
+    }
+
+  const double factors[NumberOfIntegrals] = { 1.0 / 6.0, 1.0 / 24.0, 1.0 / 24.0, 1.0 / 24.0, 1.0 / 60.0,
+                                              1.0 / 60.0, 1.0 / 60.0, 1.0 / 120.0, 1.0 / 120.0, 1.0 / 120.0,
+                                              1.0 };
+  double integral[NumberOfIntegrals];
+  for (int i = 0; i < NumberOfIntegrals; ++i)
+    {
+    integral[i] = total.Values[i].GetValue() * factors[i];
+    }
+  // Inward-facing surfaces have all volume integrals negated
+  if (integral[IntegralOne] < 0.0)
+    {
+    for (int i = IntegralOne; i <= IntegralZX; ++i)
+      {
+      integral[i] = -integral[i];
+      }
+    }
+
+  properties.NumberOfTriangles = numberOfTriangles;
+  properties.Volume = integral[IntegralOne];
+  properties.SurfaceArea = integral[Area];
+  double center[3] = { 0.0, 0.0, 0.0 };
+  if (properties.Volume > 0.0)
+    {
+    center[0] = integral[IntegralX] / properties.Volume;
+    center[1] = integral[IntegralY] / properties.Volume;
+    center[2] = integral[IntegralZ] / properties.Volume;
+    }
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    properties.Centroid[axis] = center[axis] + reference[axis];
+    }
+
+  // Inertia about the centroid, which does not depend on the reference point
+  const double mass = properties.Volume;
+  double* inertia = properties.Inertia;
+  inertia[0] = integral[IntegralYY] + integral[IntegralZZ] - mass * (center[1] * center[1] + center[2] * center[2]);
+  inertia[4] = integral[IntegralXX] + integral[IntegralZZ] - mass * (center[2] * center[2] + center[0] * center[0]);
+  inertia[8] = integral[IntegralXX] + integral[IntegralYY] - mass * (center[0] * center[0] + center[1] * center[1]);
+  inertia[1] = inertia[3] = -(integral[IntegralXY] - mass * center[0] * center[1]);
+  inertia[5] = inertia[7] = -(integral[IntegralYZ] - mass * center[1] * center[2]);
+  inertia[2] = inertia[6] = -(integral[IntegralZX] - mass * center[2] * center[0]);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool WriteMassProperties(const MassProperties& properties, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str());
+  if (!file)
+    {
+    std::cerr << "Cannot write mass properties to " << fileName << std::endl;
+    return false;
+    }
+  auto endsWith = [&](const std::string& extension)
+    {
+    if (fileName.size() < extension.size())
+      {
+      return false;
+      }
+    std::string end = fileName.substr(fileName.size() - extension.size());
+    std::transform(end.begin(), end.end(), end.begin(),
+      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return end == extension;
+    };
+  const double* centroid = properties.Centroid;
+  const double* inertia = properties.Inertia;
+  if (endsWith(".json"))
+    {
+    file.precision(std::numeric_limits<double>::max_digits10);
+    file << "{\n"
+         << "  \"NumberOfTriangles\": " << properties.NumberOfTriangles << ",\n"
+         << "  \"Volume\": " << properties.Volume << ",\n"
+         << "  \"SurfaceArea\": " << properties.SurfaceArea << ",\n"
+         << "  \"Centroid\": [" << centroid[0] << ", " << centroid[1] << ", " << centroid[2] << "],\n"
+         << "  \"Inertia\": [\n"
+         << "    [" << inertia[0] << ", " << inertia[1] << ", " << inertia[2] << "],\n"
+         << "    [" << inertia[3] << ", " << inertia[4] << ", " << inertia[5] << "],\n"
+         << "    [" << inertia[6] << ", " << inertia[7] << ", " << inertia[8] << "]\n"
+         << "  ]\n"
+         << "}\n";
+    }
+  else if (endsWith(".csv"))
+    {
+    file.precision(std::numeric_limits<double>::max_digits10);
+    file << "NumberOfTriangles,Volume,SurfaceArea,CentroidX,CentroidY,CentroidZ,Ixx,Iyy,Izz,Ixy,Iyz,Ixz\n"
+         << properties.NumberOfTriangles << ',' << properties.Volume << ',' << properties.SurfaceArea << ','
+         << centroid[0] << ',' << centroid[1] << ',' << centroid[2] << ','
+         << inertia[0] << ',' << inertia[4] << ',' << inertia[8] << ','
+         << inertia[1] << ',' << inertia[5] << ',' << inertia[2] << '\n';
+    }
+  else
+    {
+    file << "Volume: " << properties.Volume << '\n'
+         << "SurfaceArea: " << properties.SurfaceArea << '\n'
+         << "Centroid: " << centroid[0] << ' ' << centroid[1] << ' ' << centroid[2] << '\n'
+         << "Inertia: " << inertia[0] << ' ' << inertia[1] << ' ' << inertia[2] << ' '
+         << inertia[3] << ' ' << inertia[4] << ' ' << inertia[5] << ' '
+         << inertia[6] << ' ' << inertia[7] << ' ' << inertia[8] << '\n'
+         << "NumberOfTriangles: " << properties.NumberOfTriangles << '\n';
+    }
+  return static_cast<bool>(file);
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef SurfaceToolboxMassProperties_h
+#define SurfaceToolboxMassProperties_h
+
+// VTK includes
+#include "vtkType.h"
+
+// STD includes
+#include <string>
+
+class vtkPolyData;
+
+namespace SurfaceToolbox
+{
+
+/// Volume, area and moments of a closed surface, as a solid of unit density.
+struct MassProperties
+{
+  vtkIdType NumberOfTriangles = 0;
+  double Volume = 0.0;
+  double SurfaceArea = 0.0;
+  double Centroid[3] = { 0.0, 0.0, 0.0 };
+  /// Inertia tensor about the centroid, row-major:
+  /// Ixx, Ixy, Ixz, Iyx, Iyy, Iyz, Izx, Izy, Izz.
+  double Inertia[9] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+};
+
+/// Compute the mass properties of \a input in one multi-threaded pass over
+/// its triangles, using the divergence theorem to turn the volume integrals
+/// into sums over the triangles. Polygons and strips are triangulated first.
+///
+/// The sums are accumulated with compensated (Neumaier) summation over fixed
+/// blocks of triangles which are then added in order, so the result does not
+/// depend on the number of threads. As vtkMassProperties, the volume is
+/// positive whatever the orientation of the surface, which must be closed and
+/// consistently oriented. Returns false if \a input has no triangles.
+bool ComputeMassProperties(vtkPolyData* input, MassProperties& properties);
+
+/// Write \a properties to \a fileName: as a JSON object if the file name ends
+/// with .json, as a CSV header and row if it ends with .csv, and as
+/// "Name: value" lines otherwise.
+bool WriteMassProperties(const MassProperties& properties, const std::string& fileName);
+
+}
+
+#endif
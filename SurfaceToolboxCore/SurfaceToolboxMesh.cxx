@@ -0,0 +1,588 @@
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkAbstractArray.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetAttributes.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkTriangleFilter.h"
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+void CopyCoordinates(const ValueType* source, vtkIdType numberOfPoints, double* destination)
+{
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = 3 * begin; i < 3 * end; ++i)
+      {
+      destination[i] = static_cast<double>(source[i]);
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+template <typename OffsetsArrayType, typename ConnectivityArrayType>
+bool CopyTriangles(OffsetsArrayType* offsetsArray, ConnectivityArrayType* connectivityArray,
+                   vtkIdType numberOfCells, std::vector<vtkIdType>& triangles)
+{
+  const auto* offsets = offsetsArray->GetPointer(0);
+  const auto* connectivity = connectivityArray->GetPointer(0);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    if (offsets[cellId + 1] - offsets[cellId] != 3)
+      {
+      return false;
+      }
+    }
+  triangles.resize(3 * numberOfCells);
+  vtkIdType* destination = triangles.data();
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = 3 * begin; i < 3 * end; ++i)
+      {
+      destination[i] = static_cast<vtkIdType>(connectivity[i]);
+      }
+    });
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Copy cells after the firstCell cells already in offsets and connectivity,
+// which have room for them.
+template <typename OffsetsArrayType, typename ConnectivityArrayType>
+void CopyCells(OffsetsArrayType* offsetsArray, ConnectivityArrayType* connectivityArray, vtkIdType numberOfCells,
+               vtkIdType firstCell, vtkIdType* offsets, vtkIdType* connectivity)
+{
+  if (numberOfCells == 0)
+    {
+    return;
+    }
+  const auto* sourceOffsets = offsetsArray->GetPointer(0);
+  const auto* sourceConnectivity = connectivityArray->GetPointer(0);
+  const vtkIdType first = offsets[firstCell];
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      offsets[firstCell + cellId + 1] = first + static_cast<vtkIdType>(sourceOffsets[cellId + 1]);
+      for (auto i = sourceOffsets[cellId]; i < sourceOffsets[cellId + 1]; ++i)
+        {
+        connectivity[first + i] = static_cast<vtkIdType>(sourceConnectivity[i]);
+        }
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+void CopyCells(vtkCellArray* cells, vtkIdType firstCell, vtkIdType* offsets, vtkIdType* connectivity)
+{
+  if (cells->IsStorage64Bit())
+    {
+    CopyCells(cells->GetOffsetsArray64(), cells->GetConnectivityArray64(), cells->GetNumberOfCells(),
+              firstCell, offsets, connectivity);
+    }
+  else
+    {
+    CopyCells(cells->GetOffsetsArray32(), cells->GetConnectivityArray32(), cells->GetNumberOfCells(),
+              firstCell, offsets, connectivity);
+    }
+}
+
+//----------------------------------------------------------------------------
+void AppendCells(vtkCellArray* cells, std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& connectivity)
+{
+  const vtkIdType firstCell = static_cast<vtkIdType>(offsets.size()) - 1;
+  offsets.resize(offsets.size() + cells->GetNumberOfCells());
+  connectivity.resize(connectivity.size() + cells->GetNumberOfConnectivityIds());
+  CopyCells(cells, firstCell, offsets.data(), connectivity.data());
+}
+
+//----------------------------------------------------------------------------
+// Copy the kept cells of a cell array, starting at cell id firstCellId of the
+// dataset, with their point ids renumbered.
+vtkSmartPointer<vtkCellArray> ExtractCellArray(vtkCellArray* cells, vtkIdType firstCellId,
+                                               const std::vector<unsigned char>& keepCell,
+                                               const std::vector<vtkIdType>& pointMap,
+                                               std::vector<vtkIdType>& keptCellIds)
+{
+  std::vector<vtkIdType> offsets(1, 0);
+  std::vector<vtkIdType> connectivity;
+  AppendCells(cells, offsets, connectivity);
+  const vtkIdType numberOfCells = static_cast<vtkIdType>(offsets.size()) - 1;
+
+  std::vector<vtkIdType> cellIds;
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    if (keepCell[firstCellId + cellId])
+      {
+      cellIds.push_back(cellId);
+      }
+    }
+  const vtkIdType numberOfKeptCells = static_cast<vtkIdType>(cellIds.size());
+
+  vtkNew<vtkIdTypeArray> newOffsets;
+  newOffsets->SetNumberOfValues(numberOfKeptCells + 1);
+  vtkIdType* newOffsetsPointer = newOffsets->GetPointer(0);
+  newOffsetsPointer[0] = 0;
+  for (vtkIdType i = 0; i < numberOfKeptCells; ++i)
+    {
+    newOffsetsPointer[i + 1] = newOffsetsPointer[i] + offsets[cellIds[i] + 1] - offsets[cellIds[i]];
+    }
+  vtkNew<vtkIdTypeArray> newConnectivity;
+  newConnectivity->SetNumberOfValues(newOffsetsPointer[numberOfKeptCells]);
+  vtkIdType* newConnectivityPointer = newConnectivity->GetPointer(0);
+  vtkSMPTools::For(0, numberOfKeptCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      vtkIdType* destination = newConnectivityPointer + newOffsetsPointer[i];
+      for (vtkIdType j = offsets[cellIds[i]]; j < offsets[cellIds[i] + 1]; ++j)
+        {
+        *destination++ = pointMap[connectivity[j]];
+        }
+      }
+    });
+
+  for (vtkIdType cellId : cellIds)
+    {
+    keptCellIds.push_back(firstCellId + cellId);
+    }
+  vtkSmartPointer<vtkCellArray> newCells = vtkSmartPointer<vtkCellArray>::New();
+  newCells->SetData(newOffsets, newConnectivity);
+  return newCells;
+}
+
+//----------------------------------------------------------------------------
+// Copy the polygons, then the strips of polyData in compressed sparse row
+// form. Returns the number of polygons.
+vtkIdType GetFaces(vtkPolyData* polyData, std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& connectivity)
+{
+  offsets.assign(1, 0);
+  connectivity.clear();
+  AppendCells(polyData->GetPolys(), offsets, connectivity);
+  const vtkIdType numberOfPolys = static_cast<vtkIdType>(offsets.size()) - 1;
+  AppendCells(polyData->GetStrips(), offsets, connectivity);
+  return numberOfPolys;
+}
+
+//----------------------------------------------------------------------------
+// Point-to-cell links in compressed sparse row form. getCell(cellId, points,
+// numberOfPoints) gives the points of a cell. offsets has room for
+// numberOfPoints + 1 values and links for all the point uses of the cells.
+template <typename GetCellFunctor>
+void BuildLinks(vtkIdType numberOfPoints, vtkIdType numberOfCells, const GetCellFunctor& getCell,
+                vtkIdType* offsets, vtkIdType* links)
+{
+  // Count the uses of each point
+  std::vector<std::atomic<vtkIdType>> cursors(numberOfPoints);
+  for (std::atomic<vtkIdType>& cursor : cursors)
+    {
+    cursor.store(0, std::memory_order_relaxed);
+    }
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      const vtkIdType* cellPoints;
+      vtkIdType numberOfCellPoints;
+      getCell(cellId, cellPoints, numberOfCellPoints);
+      for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+        {
+        cursors[cellPoints[i]].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+
+  offsets[0] = 0;
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    offsets[pointId + 1] = offsets[pointId] + cursors[pointId].load(std::memory_order_relaxed);
+    cursors[pointId].store(offsets[pointId], std::memory_order_relaxed);
+    }
+
+  // Scatter the cell ids, then sort each list so the result does not
+  // depend on thread scheduling.
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      const vtkIdType* cellPoints;
+      vtkIdType numberOfCellPoints;
+      getCell(cellId, cellPoints, numberOfCellPoints);
+      for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+        {
+        links[cursors[cellPoints[i]].fetch_add(1, std::memory_order_relaxed)] = cellId;
+        }
+      }
+    });
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      std::sort(links + offsets[pointId], links + offsets[pointId + 1]);
+      }
+    });
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+void GetPointCoordinates(vtkPolyData* polyData, std::vector<double>& coordinates)
+{
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  coordinates.resize(3 * numberOfPoints);
+  if (numberOfPoints == 0)
+    {
+    return;
+    }
+  vtkDataArray* data = polyData->GetPoints()->GetData();
+  if (vtkFloatArray* floatData = vtkFloatArray::SafeDownCast(data))
+    {
+    CopyCoordinates(floatData->GetPointer(0), numberOfPoints, coordinates.data());
+    }
+  else if (vtkDoubleArray* doubleData = vtkDoubleArray::SafeDownCast(data))
+    {
+    CopyCoordinates(doubleData->GetPointer(0), numberOfPoints, coordinates.data());
+    }
+  else
+    {
+    for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+      {
+      data->GetTuple(pointId, &coordinates[3 * pointId]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool GetTriangles(vtkPolyData* polyData, std::vector<vtkIdType>& triangles)
+{
+  triangles.clear();
+  if (polyData->GetNumberOfStrips() > 0)
+    {
+    return false;
+    }
+  vtkCellArray* polys = polyData->GetPolys();
+  const vtkIdType numberOfCells = polys->GetNumberOfCells();
+  if (polys->IsStorage64Bit())
+    {
+    return CopyTriangles(polys->GetOffsetsArray64(), polys->GetConnectivityArray64(), numberOfCells, triangles);
+    }
+  return CopyTriangles(polys->GetOffsetsArray32(), polys->GetConnectivityArray32(), numberOfCells, triangles);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> GetTriangulatedSurface(vtkPolyData* polyData, std::vector<vtkIdType>& triangles)
+{
+  if (GetTriangles(polyData, triangles))
+    {
+    return polyData;
+    }
+  vtkNew<vtkTriangleFilter> triangleFilter;
+  triangleFilter->SetInputData(polyData);
+  triangleFilter->PassVertsOff();
+  triangleFilter->PassLinesOff();
+  triangleFilter->Update();
+  vtkSmartPointer<vtkPolyData> triangulated = triangleFilter->GetOutput();
+  GetTriangles(triangulated, triangles);
+  return triangulated;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkCellArray> CreateTriangleCells(const vtkIdType* triangles, vtkIdType numberOfTriangles)
+{
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(numberOfTriangles + 1);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(3 * numberOfTriangles);
+  vtkIdType* offsetsPointer = offsets->GetPointer(0);
+  vtkIdType* connectivityPointer = connectivity->GetPointer(0);
+  vtkSMPTools::For(0, numberOfTriangles + 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      offsetsPointer[cellId] = 3 * cellId;
+      }
+    });
+  std::copy(triangles, triangles + 3 * numberOfTriangles, connectivityPointer);
+
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  cells->SetData(offsets, connectivity);
+  return cells;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPoints> CreatePoints(const std::vector<double>& coordinates, int dataType)
+{
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(coordinates.size() / 3);
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  if (dataType == VTK_DOUBLE)
+    {
+    points->SetDataTypeToDouble();
+    points->SetNumberOfPoints(numberOfPoints);
+    double* destination = vtkDoubleArray::SafeDownCast(points->GetData())->GetPointer(0);
+    std::copy(coordinates.begin(), coordinates.end(), destination);
+    }
+  else
+    {
+    points->SetDataTypeToFloat();
+    points->SetNumberOfPoints(numberOfPoints);
+    float* destination = vtkFloatArray::SafeDownCast(points->GetData())->GetPointer(0);
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = 3 * begin; i < 3 * end; ++i)
+        {
+        destination[i] = static_cast<float>(coordinates[i]);
+        }
+      });
+    }
+  return points;
+}
+
+//----------------------------------------------------------------------------
+void GetCells(vtkPolyData* polyData, std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& connectivity)
+{
+  offsets.assign(1, 0);
+  connectivity.clear();
+  AppendCells(polyData->GetVerts(), offsets, connectivity);
+  AppendCells(polyData->GetLines(), offsets, connectivity);
+  AppendCells(polyData->GetPolys(), offsets, connectivity);
+  AppendCells(polyData->GetStrips(), offsets, connectivity);
+}
+
+//----------------------------------------------------------------------------
+void GetVertexAndLineCells(vtkPolyData* polyData, std::vector<vtkIdType>& offsets,
+                           std::vector<vtkIdType>& connectivity)
+{
+  offsets.assign(1, 0);
+  connectivity.clear();
+  AppendCells(polyData->GetVerts(), offsets, connectivity);
+  AppendCells(polyData->GetLines(), offsets, connectivity);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ExtractCells(vtkPolyData* polyData, const std::vector<unsigned char>& keepCell)
+{
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  vtkCellArray* cellArrays[4] = { polyData->GetVerts(), polyData->GetLines(), polyData->GetPolys(), polyData->GetStrips() };
+
+  // Mark the points used by the kept cells, then number them in order
+  std::vector<unsigned char> usedPoints(numberOfPoints, 0);
+  vtkIdType firstCellId = 0;
+  for (vtkCellArray* cells : cellArrays)
+    {
+    std::vector<vtkIdType> offsets(1, 0);
+    std::vector<vtkIdType> connectivity;
+    AppendCells(cells, offsets, connectivity);
+    const vtkIdType numberOfCells = static_cast<vtkIdType>(offsets.size()) - 1;
+    for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+      {
+      if (keepCell[firstCellId + cellId])
+        {
+        for (vtkIdType j = offsets[cellId]; j < offsets[cellId + 1]; ++j)
+          {
+          usedPoints[connectivity[j]] = 1;
+          }
+        }
+      }
+    firstCellId += numberOfCells;
+    }
+  std::vector<vtkIdType> pointMap(numberOfPoints, -1);
+  std::vector<vtkIdType> pointIds;
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    if (usedPoints[pointId])
+      {
+      pointMap[pointId] = static_cast<vtkIdType>(pointIds.size());
+      pointIds.push_back(pointId);
+      }
+    }
+  const vtkIdType numberOfNewPoints = static_cast<vtkIdType>(pointIds.size());
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetDataType(polyData->GetPoints() ? polyData->GetPoints()->GetDataType() : VTK_FLOAT);
+  points->SetNumberOfPoints(numberOfNewPoints);
+  vtkSMPTools::For(0, numberOfNewPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    double point[3];
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      polyData->GetPoints()->GetPoint(pointIds[i], point);
+      points->SetPoint(i, point);
+      }
+    });
+  output->SetPoints(points);
+
+  std::vector<vtkIdType> keptCellIds;
+  firstCellId = 0;
+  vtkSmartPointer<vtkCellArray> newCellArrays[4];
+  for (int type = 0; type < 4; ++type)
+    {
+    newCellArrays[type] = ExtractCellArray(cellArrays[type], firstCellId, keepCell, pointMap, keptCellIds);
+    firstCellId += cellArrays[type]->GetNumberOfCells();
+    }
+  output->SetVerts(newCellArrays[0]);
+  output->SetLines(newCellArrays[1]);
+  output->SetPolys(newCellArrays[2]);
+  output->SetStrips(newCellArrays[3]);
+
+  vtkPointData* outputPointData = output->GetPointData();
+  outputPointData->CopyAllocate(polyData->GetPointData(), numberOfNewPoints);
+  for (vtkIdType i = 0; i < numberOfNewPoints; ++i)
+    {
+    outputPointData->CopyData(polyData->GetPointData(), pointIds[i], i);
+    }
+  vtkCellData* outputCellData = output->GetCellData();
+  const vtkIdType numberOfNewCells = static_cast<vtkIdType>(keptCellIds.size());
+  outputCellData->CopyAllocate(polyData->GetCellData(), numberOfNewCells);
+  for (vtkIdType i = 0; i < numberOfNewCells; ++i)
+    {
+    outputCellData->CopyData(polyData->GetCellData(), keptCellIds[i], i);
+    }
+  return output;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType ComputePrefixSums(vtkIdType* values, vtkIdType numberOfValues)
+{
+  // Sum the blocks, then scan each block from the sum of the blocks before it
+  const vtkIdType blockSize = 65536;
+  const vtkIdType numberOfBlocks = (numberOfValues + blockSize - 1) / blockSize;
+  std::vector<vtkIdType> blockOffsets(numberOfBlocks + 1, 0);
+  vtkSMPTools::For(0, numberOfBlocks, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType block = begin; block < end; ++block)
+      {
+      blockOffsets[block + 1] = std::accumulate(values + block * blockSize,
+        values + std::min(numberOfValues, (block + 1) * blockSize), vtkIdType(0));
+      }
+    });
+  for (vtkIdType block = 0; block < numberOfBlocks; ++block)
+    {
+    blockOffsets[block + 1] += blockOffsets[block];
+    }
+  vtkSMPTools::For(0, numberOfBlocks, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType block = begin; block < end; ++block)
+      {
+      vtkIdType sum = blockOffsets[block];
+      const vtkIdType last = std::min(numberOfValues, (block + 1) * blockSize);
+      for (vtkIdType i = block * blockSize; i < last; ++i)
+        {
+        const vtkIdType value = values[i];
+        values[i] = sum;
+        sum += value;
+        }
+      }
+    });
+  return blockOffsets[numberOfBlocks];
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkAbstractArray> CopyTuples(vtkAbstractArray* input, const std::vector<vtkIdType>& sourceIds)
+{
+  const vtkIdType numberOfTuples = static_cast<vtkIdType>(sourceIds.size());
+  vtkSmartPointer<vtkAbstractArray> output = vtkSmartPointer<vtkAbstractArray>::Take(input->NewInstance());
+  output->SetName(input->GetName());
+  output->SetNumberOfComponents(input->GetNumberOfComponents());
+  output->SetNumberOfTuples(numberOfTuples);
+  if (!vtkDataArray::SafeDownCast(input))
+    {
+    // String and variant arrays update their lookup on every change
+    for (vtkIdType i = 0; i < numberOfTuples; ++i)
+      {
+      output->SetTuple(i, sourceIds[i], input);
+      }
+    return output;
+    }
+  vtkSMPTools::For(0, numberOfTuples, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      output->SetTuple(i, sourceIds[i], input);
+      }
+    });
+  return output;
+}
+
+//----------------------------------------------------------------------------
+void CopyTuples(vtkDataSetAttributes* input, vtkDataSetAttributes* output, const std::vector<vtkIdType>& sourceIds)
+{
+  output->Initialize();
+  for (int arrayIndex = 0; arrayIndex < input->GetNumberOfArrays(); ++arrayIndex)
+    {
+    vtkAbstractArray* inputArray = input->GetAbstractArray(arrayIndex);
+    output->AddArray(CopyTuples(inputArray, sourceIds));
+    for (int attribute = 0; attribute < vtkDataSetAttributes::NUM_ATTRIBUTES; ++attribute)
+      {
+      if (input->GetAbstractAttribute(attribute) == inputArray)
+        {
+        output->SetActiveAttribute(output->GetNumberOfArrays() - 1, attribute);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void BuildPointTriangleLinks(vtkIdType numberOfPoints, const std::vector<vtkIdType>& triangles,
+                             std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& links)
+{
+  offsets.resize(numberOfPoints + 1);
+  links.resize(triangles.size());
+  BuildLinks(numberOfPoints, static_cast<vtkIdType>(triangles.size() / 3),
+    [&](vtkIdType cellId, const vtkIdType*& cellPoints, vtkIdType& numberOfCellPoints)
+    {
+    cellPoints = &triangles[3 * cellId];
+    numberOfCellPoints = 3;
+    }, offsets.data(), links.data());
+}
+
+//----------------------------------------------------------------------------
+vtkIdType GetFaceCells(vtkPolyData* polyData, std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& connectivity)
+{
+  return GetFaces(polyData, offsets, connectivity);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType GetFaceCells(vtkPolyData* polyData, vtkIdType* offsets, vtkIdType* connectivity)
+{
+  offsets[0] = 0;
+  CopyCells(polyData->GetPolys(), 0, offsets, connectivity);
+  const vtkIdType numberOfPolys = polyData->GetNumberOfPolys();
+  CopyCells(polyData->GetStrips(), numberOfPolys, offsets, connectivity);
+  return numberOfPolys;
+}
+
+//----------------------------------------------------------------------------
+void BuildPointCellLinks(vtkIdType numberOfPoints, vtkIdType numberOfCells, const vtkIdType* offsets,
+                         const vtkIdType* connectivity, vtkIdType* linkOffsets, vtkIdType* links)
+{
+  BuildLinks(numberOfPoints, numberOfCells,
+    [&](vtkIdType cellId, const vtkIdType*& cellPoints, vtkIdType& numberOfCellPoints)
+    {
+    cellPoints = connectivity + offsets[cellId];
+    numberOfCellPoints = offsets[cellId + 1] - offsets[cellId];
+    }, linkOffsets, links);
+}
+
+}
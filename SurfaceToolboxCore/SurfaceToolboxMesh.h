@@ -0,0 +1,93 @@
+#ifndef SurfaceToolboxMesh_h
+#define SurfaceToolboxMesh_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+// STD includes
+#include <vector>
+
+class vtkAbstractArray;
+class vtkCellArray;
+class vtkDataSetAttributes;
+class vtkPoints;
+class vtkPolyData;
+
+// Flat-buffer access to surfaces, used by the parallel stage engines.
+namespace SurfaceToolbox
+{
+
+/// Copy the point coordinates of \a polyData as interleaved x, y, z values.
+void GetPointCoordinates(vtkPolyData* polyData, std::vector<double>& coordinates);
+
+/// Copy the point ids of the polygons of \a polyData, three per triangle.
+/// Returns false if \a polyData has triangle strips or a polygon that is not a triangle.
+bool GetTriangles(vtkPolyData* polyData, std::vector<vtkIdType>& triangles);
+
+/// Return \a polyData if all its polygons are triangles, or a triangulated copy otherwise,
+/// and fill \a triangles with the triangle point ids of the returned surface.
+vtkSmartPointer<vtkPolyData> GetTriangulatedSurface(vtkPolyData* polyData, std::vector<vtkIdType>& triangles);
+
+/// Create a cell array holding \a numberOfTriangles triangles from \a triangles.
+vtkSmartPointer<vtkCellArray> CreateTriangleCells(const vtkIdType* triangles, vtkIdType numberOfTriangles);
+
+/// Create points of the given VTK data type from interleaved x, y, z values.
+vtkSmartPointer<vtkPoints> CreatePoints(const std::vector<double>& coordinates, int dataType);
+
+/// Copy the point ids of all the cells of \a polyData (vertices, lines,
+/// polygons then strips, which is the cell id order) in compressed sparse row
+/// form: the points of cell i are connectivity[offsets[i]] to
+/// connectivity[offsets[i + 1] - 1].
+void GetCells(vtkPolyData* polyData, std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& connectivity);
+
+/// Copy the point ids of the vertices, then the lines, of \a polyData in
+/// compressed sparse row form, which are the first cells of \a polyData.
+void GetVertexAndLineCells(vtkPolyData* polyData, std::vector<vtkIdType>& offsets,
+                           std::vector<vtkIdType>& connectivity);
+
+/// Create a surface made of the cells of \a polyData for which \a keepCell is
+/// not zero, indexed by cell id (vertices, lines, polygons then strips).
+/// Points not used by the kept cells are removed. Point and cell data are
+/// passed.
+vtkSmartPointer<vtkPolyData> ExtractCells(vtkPolyData* polyData, const std::vector<unsigned char>& keepCell);
+
+/// Replace the \a numberOfValues first \a values by their exclusive prefix
+/// sums, computed in parallel by blocks, and return their total. Sizes
+/// followed by one more value turn into compressed sparse row offsets.
+vtkIdType ComputePrefixSums(vtkIdType* values, vtkIdType numberOfValues);
+
+/// Copy of \a input whose tuple i is tuple sourceIds[i] of \a input, copied
+/// in parallel for data arrays.
+vtkSmartPointer<vtkAbstractArray> CopyTuples(vtkAbstractArray* input, const std::vector<vtkIdType>& sourceIds);
+
+/// Replace the arrays of \a output by the copies of the arrays of \a input
+/// given by CopyTuples, keeping the active attributes.
+void CopyTuples(vtkDataSetAttributes* input, vtkDataSetAttributes* output, const std::vector<vtkIdType>& sourceIds);
+
+/// Copy the point ids of the polygons, then the triangle strips, of
+/// \a polyData in compressed sparse row form. Returns the number of polygons.
+vtkIdType GetFaceCells(vtkPolyData* polyData, std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& connectivity);
+
+/// Same as above, into \a offsets and \a connectivity allocated by the
+/// caller for the number of faces plus one and the number of their point ids,
+/// as given by the polygon and strip cell arrays.
+vtkIdType GetFaceCells(vtkPolyData* polyData, vtkIdType* offsets, vtkIdType* connectivity);
+
+/// Build the point-to-cell links of \a numberOfCells cells in compressed
+/// sparse row form (see GetCells): the cells using point i are
+/// links[linkOffsets[i]] to links[linkOffsets[i + 1] - 1], in increasing
+/// order. \a linkOffsets has room for numberOfPoints + 1 values and \a links
+/// for offsets[numberOfCells] values.
+void BuildPointCellLinks(vtkIdType numberOfPoints, vtkIdType numberOfCells, const vtkIdType* offsets,
+                         const vtkIdType* connectivity, vtkIdType* linkOffsets, vtkIdType* links);
+
+/// Build the point-to-triangle links in compressed sparse row form: the
+/// triangles using point i are links[offsets[i]] to links[offsets[i + 1] - 1],
+/// in increasing order.
+void BuildPointTriangleLinks(vtkIdType numberOfPoints, const std::vector<vtkIdType>& triangles,
+                             std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& links);
+
+}
+
+#endif
@@ -0,0 +1,1676 @@
+#include "SurfaceToolboxMeshFiles.h"
+#include "SurfaceToolboxCleaner.h"
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkDataArray.h"
+#include "vtkErrorCode.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkOBJReader.h"
+#include "vtkPLYReader.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkSTLReader.h"
+#include "vtkUnsignedCharArray.h"
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+enum MeshFormat
+{
+  STL,
+  PLY,
+  OBJ,
+  UnknownFormat
+};
+
+const size_t STLHeaderSize = 84;
+const size_t STLTriangleSize = 50;
+
+/// Size of the chunks of lines of OBJ files parsed in parallel
+const size_t OBJChunkSize = 4 << 20;
+
+/// Records formatted at once by a thread of the writers
+const vtkIdType RecordsPerBlock = 65536;
+
+//----------------------------------------------------------------------------
+MeshFormat GetMeshFormat(const std::string& fileName)
+{
+  const std::string extension =
+    vtksys::SystemTools::LowerCase(vtksys::SystemTools::GetFilenameLastExtension(fileName));
+  if (extension == ".stl")
+    {
+    return STL;
+    }
+  if (extension == ".ply")
+    {
+    return PLY;
+    }
+  if (extension == ".obj")
+    {
+    return OBJ;
+    }
+  return UnknownFormat;
+}
+
+//----------------------------------------------------------------------------
+// Read-only mapping of a whole file. The readers decode the values from the
+// pages of the file cache, from several threads, without reading the file
+// into a buffer first.
+class MappedFile
+{
+public:
+  /// If \a sequential is set, the file is read ahead as it is traversed
+  /// instead of as a whole, for files read once from start to end.
+  explicit MappedFile(const std::string& fileName, bool sequential = false);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// Return false if the file could not be mapped, see GetError.
+  bool IsValid() const { return this->Data != nullptr; }
+  const char* GetData() const { return this->Data; }
+  size_t GetSize() const { return this->Size; }
+  const std::string& GetError() const { return this->Error; }
+
+private:
+  const char* Data = nullptr;
+  size_t Size = 0;
+  std::string Error;
+#ifdef _WIN32
+  HANDLE File = INVALID_HANDLE_VALUE;
+  HANDLE Mapping = nullptr;
+#endif
+};
+
+//----------------------------------------------------------------------------
+MappedFile::MappedFile(const std::string& fileName, bool sequential)
+{
+#ifdef _WIN32
+  (void)sequential;
+  this->File = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  LARGE_INTEGER size;
+  if (this->File == INVALID_HANDLE_VALUE || !GetFileSizeEx(this->File, &size))
+    {
+    this->Error = "cannot open the file";
+    return;
+    }
+  if (size.QuadPart == 0)
+    {
+    this->Error = "empty file";
+    return;
+    }
+  this->Mapping = CreateFileMappingA(this->File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  this->Data = this->Mapping ? static_cast<const char*>(MapViewOfFile(this->Mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+  if (!this->Data)
+    {
+    this->Error = "cannot map the file";
+    return;
+    }
+  this->Size = static_cast<size_t>(size.QuadPart);
+#else
+  const int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+    this->Error = std::strerror(errno);
+    return;
+    }
+  struct stat status;
+  if (fstat(fd, &status) != 0)
+    {
+    this->Error = std::strerror(errno);
+    }
+  else if (status.st_size == 0)
+    {
+    this->Error = "empty file";
+    }
+  else
+    {
+    const size_t size = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+      {
+      this->Error = std::strerror(errno);
+      }
+    else
+      {
+      // The whole file is decoded: let the system read it ahead
+      madvise(mapped, size, sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+      this->Data = static_cast<const char*>(mapped);
+      this->Size = size;
+      }
+    }
+  close(fd);
+#endif
+}
+
+//----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+  if (this->Data)
+    {
+    UnmapViewOfFile(this->Data);
+    }
+  if (this->Mapping)
+    {
+    CloseHandle(this->Mapping);
+    }
+  if (this->File != INVALID_HANDLE_VALUE)
+    {
+    CloseHandle(this->File);
+    }
+#else
+  if (this->Data)
+    {
+    munmap(const_cast<char*>(this->Data), this->Size);
+    }
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool IsBigEndianHost()
+{
+  const vtkTypeUInt16 one = 1;
+  unsigned char firstByte = 0;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 0;
+}
+
+//----------------------------------------------------------------------------
+// Value of type T stored at data, which may not be aligned, with its bytes in
+// reverse order if swap is true.
+template <typename T>
+T Decode(const char* data, bool swap)
+{
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, data, sizeof(T));
+  if (swap)
+    {
+    std::reverse(bytes, bytes + sizeof(T));
+    }
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+//----------------------------------------------------------------------------
+template <typename T>
+void Encode(T value, bool swap, std::string& buffer)
+{
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  if (swap)
+    {
+    std::reverse(bytes, bytes + sizeof(T));
+    }
+  buffer.append(bytes, sizeof(T));
+}
+
+//----------------------------------------------------------------------------
+// Read a file with a VTK reader, for the variants of the formats that are not
+// read here.
+template <typename ReaderType>
+vtkSmartPointer<vtkPolyData> ReadWithVTKReader(const std::string& fileName)
+{
+  vtkNew<ReaderType> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  if (reader->GetErrorCode() != vtkErrorCode::NoError)
+    {
+    std::cerr << "Failed to read " << fileName << ": "
+              << vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()) << std::endl;
+    return nullptr;
+    }
+  vtkSmartPointer<vtkPolyData> polyData = reader->GetOutput();
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkFloatArray> CreateFloatArray(const char* name, int numberOfComponents, vtkIdType numberOfTuples)
+{
+  vtkSmartPointer<vtkFloatArray> array = vtkSmartPointer<vtkFloatArray>::New();
+  if (name)
+    {
+    array->SetName(name);
+    }
+  array->SetNumberOfComponents(numberOfComponents);
+  array->SetNumberOfTuples(numberOfTuples);
+  return array;
+}
+
+//----------------------------------------------------------------------------
+// Binary STL: 80 bytes of header, the number of triangles, then 50 bytes per
+// triangle: normal, three vertices and a 16-bit attribute. Files starting with
+// "solid" are ASCII, unless their size is the one of a binary file, which some
+// writers also start with "solid".
+bool IsBinarySTL(const MappedFile& file)
+{
+  if (file.GetSize() < STLHeaderSize)
+    {
+    return std::strncmp(file.GetData(), "solid", std::min<size_t>(5, file.GetSize())) != 0;
+    }
+  const size_t numberOfTriangles = Decode<vtkTypeUInt32>(file.GetData() + 80, IsBigEndianHost());
+  return file.GetSize() == STLHeaderSize + STLTriangleSize * numberOfTriangles
+    || std::strncmp(file.GetData(), "solid", 5) != 0;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadBinarySTL(const MappedFile& file, const std::string& fileName)
+{
+  const bool swap = IsBigEndianHost();
+  const vtkIdType numberOfTriangles =
+    file.GetSize() < STLHeaderSize ? 0 : Decode<vtkTypeUInt32>(file.GetData() + 80, swap);
+  if (file.GetSize() < STLHeaderSize + STLTriangleSize * static_cast<size_t>(numberOfTriangles))
+    {
+    std::cerr << "Failed to read " << fileName << ": truncated binary STL file" << std::endl;
+    return nullptr;
+    }
+
+  // Corners of the triangles, before merging
+  vtkNew<vtkPoints> corners;
+  vtkSmartPointer<vtkFloatArray> cornerCoordinates = CreateFloatArray(nullptr, 3, 3 * numberOfTriangles);
+  corners->SetData(cornerCoordinates);
+  float* cornerPointer = cornerCoordinates->GetPointer(0);
+  const char* triangleData = file.GetData() + STLHeaderSize;
+  vtkSMPTools::For(0, numberOfTriangles, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType triangleId = begin; triangleId < end; ++triangleId)
+      {
+      // Skip the normal, computed from the vertices when needed
+      const char* vertices = triangleData + STLTriangleSize * triangleId + 3 * sizeof(float);
+      for (int i = 0; i < 9; ++i)
+        {
+        cornerPointer[9 * triangleId + i] = Decode<float>(vertices + i * sizeof(float), swap);
+        }
+      }
+    });
+
+  // Merge equal corners as vtkSTLReader: points are numbered in order of
+  // first use, and triangles using a point twice are removed.
+  const std::vector<vtkIdType> mergeMap = SurfaceToolbox::ComputePointMergeMap(corners, 0.0);
+  std::vector<vtkIdType> pointIds(3 * numberOfTriangles);
+  std::vector<vtkIdType> triangles;
+  triangles.reserve(3 * numberOfTriangles);
+  vtkIdType numberOfPoints = 0;
+  for (vtkIdType triangleId = 0; triangleId < numberOfTriangles; ++triangleId)
+    {
+    vtkIdType* triangle = &pointIds[3 * triangleId];
+    for (int i = 0; i < 3; ++i)
+      {
+      const vtkIdType corner = 3 * triangleId + i;
+      // Corners are merged into the corner with the smallest id
+      triangle[i] = mergeMap[corner] == corner ? numberOfPoints++ : pointIds[mergeMap[corner]];
+      }
+    if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[2] != triangle[0])
+      {
+      triangles.insert(triangles.end(), triangle, triangle + 3);
+      }
+    }
+
+  vtkSmartPointer<vtkFloatArray> coordinates = CreateFloatArray(nullptr, 3, numberOfPoints);
+  float* coordinatePointer = coordinates->GetPointer(0);
+  vtkSMPTools::For(0, 3 * numberOfTriangles, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType corner = begin; corner < end; ++corner)
+      {
+      if (mergeMap[corner] == corner)
+        {
+        std::copy(cornerPointer + 3 * corner, cornerPointer + 3 * corner + 3, coordinatePointer + 3 * pointIds[corner]);
+        }
+      }
+    });
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetData(coordinates);
+  polyData->SetPoints(points);
+  polyData->SetPolys(SurfaceToolbox::CreateTriangleCells(triangles.data(), static_cast<vtkIdType>(triangles.size() / 3)));
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+enum PLYType
+{
+  PLYInt8,
+  PLYUInt8,
+  PLYInt16,
+  PLYUInt16,
+  PLYInt32,
+  PLYUInt32,
+  PLYFloat32,
+  PLYFloat64,
+  PLYUnknown
+};
+
+//----------------------------------------------------------------------------
+PLYType GetPLYType(const std::string& name)
+{
+  const char* names[][2] = { { "char", "int8" }, { "uchar", "uint8" }, { "short", "int16" }, { "ushort", "uint16" },
+                             { "int", "int32" }, { "uint", "uint32" }, { "float", "float32" }, { "double", "float64" } };
+  for (int type = PLYInt8; type < PLYUnknown; ++type)
+    {
+    if (name == names[type][0] || name == names[type][1])
+      {
+      return static_cast<PLYType>(type);
+      }
+    }
+  return PLYUnknown;
+}
+
+//----------------------------------------------------------------------------
+size_t GetPLYTypeSize(PLYType type)
+{
+  const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+  return sizes[type];
+}
+
+//----------------------------------------------------------------------------
+// Value of type type at data, converted to T
+template <typename T>
+T DecodePLY(const char* data, PLYType type, bool swap)
+{
+  switch (type)
+    {
+    case PLYInt8: return static_cast<T>(Decode<vtkTypeInt8>(data, swap));
+    case PLYUInt8: return static_cast<T>(Decode<vtkTypeUInt8>(data, swap));
+    case PLYInt16: return static_cast<T>(Decode<vtkTypeInt16>(data, swap));
+    case PLYUInt16: return static_cast<T>(Decode<vtkTypeUInt16>(data, swap));
+    case PLYInt32: return static_cast<T>(Decode<vtkTypeInt32>(data, swap));
+    case PLYUInt32: return static_cast<T>(Decode<vtkTypeUInt32>(data, swap));
+    case PLYFloat32: return static_cast<T>(Decode<vtkTypeFloat32>(data, swap));
+    case PLYFloat64: return static_cast<T>(Decode<vtkTypeFloat64>(data, swap));
+    default: return T();
+    }
+}
+
+//----------------------------------------------------------------------------
+struct PLYProperty
+{
+  std::string Name;
+  PLYType Type = PLYUnknown;
+  /// Type of the number of values of list properties, PLYUnknown for other properties
+  PLYType CountType = PLYUnknown;
+};
+
+//----------------------------------------------------------------------------
+struct PLYElement
+{
+  std::string Name;
+  vtkIdType Count = 0;
+  std::vector<PLYProperty> Properties;
+
+  /// Size of the records of the element, 0 if it has list properties
+  size_t GetRecordSize() const
+  {
+    size_t size = 0;
+    for (const PLYProperty& property : this->Properties)
+      {
+      if (property.CountType != PLYUnknown)
+        {
+        return 0;
+        }
+      size += GetPLYTypeSize(property.Type);
+      }
+    return size;
+  }
+
+  /// Offset of the property name in the records of the element and its type,
+  /// or -1 if the element has no such property or a list before it.
+  int GetPropertyOffset(const std::string& name, PLYType& type) const
+  {
+    size_t offset = 0;
+    for (const PLYProperty& property : this->Properties)
+      {
+      if (property.Name == name && property.CountType == PLYUnknown)
+        {
+        type = property.Type;
+        return static_cast<int>(offset);
+        }
+      if (property.CountType != PLYUnknown)
+        {
+        return -1;
+        }
+      offset += GetPLYTypeSize(property.Type);
+      }
+    return -1;
+  }
+};
+
+//----------------------------------------------------------------------------
+struct PLYHeader
+{
+  std::vector<PLYElement> Elements;
+  bool Binary = false;
+  /// True if the values are not stored in the byte order of this computer
+  bool Swap = false;
+  /// Offset of the first element in the file
+  size_t DataOffset = 0;
+};
+
+//----------------------------------------------------------------------------
+bool ReadPLYHeader(const MappedFile& file, PLYHeader& header)
+{
+  const char* data = file.GetData();
+  const char* end = data + file.GetSize();
+  const char endHeader[] = "end_header";
+  const char* endHeaderPosition = std::search(data, end, endHeader, endHeader + sizeof(endHeader) - 1);
+  const char* dataStart = static_cast<const char*>(
+    endHeaderPosition == end ? nullptr : std::memchr(endHeaderPosition, '\n', end - endHeaderPosition));
+  if (file.GetSize() < 3 || std::strncmp(data, "ply", 3) != 0 || !dataStart)
+    {
+    return false;
+    }
+  header.DataOffset = static_cast<size_t>(dataStart + 1 - data);
+
+  std::istringstream lines(std::string(data, endHeaderPosition));
+  std::string line;
+  bool hasFormat = false;
+  while (std::getline(lines, line))
+    {
+    std::istringstream words(line);
+    std::string keyword;
+    words >> keyword;
+    if (keyword == "format")
+      {
+      std::string format;
+      words >> format;
+      header.Binary = format != "ascii";
+      header.Swap = (format == "binary_big_endian") != IsBigEndianHost();
+      hasFormat = format == "ascii" || format == "binary_little_endian" || format == "binary_big_endian";
+      }
+    else if (keyword == "element")
+      {
+      PLYElement element;
+      if (!(words >> element.Name >> element.Count) || element.Count < 0)
+        {
+        return false;
+        }
+      header.Elements.push_back(element);
+      }
+    else if (keyword == "property")
+      {
+      PLYProperty property;
+      std::string type;
+      words >> type;
+      if (type == "list")
+        {
+        std::string countType;
+        words >> countType >> type;
+        property.CountType = GetPLYType(countType);
+        if (property.CountType == PLYUnknown)
+          {
+          return false;
+          }
+        }
+      words >> property.Name;
+      property.Type = GetPLYType(type);
+      if (property.Type == PLYUnknown || header.Elements.empty())
+        {
+        return false;
+        }
+      header.Elements.back().Properties.push_back(property);
+      }
+    }
+  return hasFormat;
+}
+
+//----------------------------------------------------------------------------
+// Find the start of the records of element at position, and move position
+// past them. Record starts are only stored if recordStarts is not null.
+// Returns false if the file ends before the last record.
+bool ScanPLYRecords(const MappedFile& file, const PLYElement& element, bool swap, size_t& position,
+                    std::vector<size_t>* recordStarts)
+{
+  const size_t recordSize = element.GetRecordSize();
+  if (recordSize > 0 && !recordStarts)
+    {
+    if ((file.GetSize() - position) / recordSize < static_cast<size_t>(element.Count))
+      {
+      return false;
+      }
+    position += recordSize * element.Count;
+    return true;
+    }
+  for (vtkIdType recordId = 0; recordId < element.Count; ++recordId)
+    {
+    if (recordStarts)
+      {
+      recordStarts->push_back(position);
+      }
+    for (const PLYProperty& property : element.Properties)
+      {
+      if (property.CountType == PLYUnknown)
+        {
+        position += GetPLYTypeSize(property.Type);
+        continue;
+        }
+      const size_t countSize = GetPLYTypeSize(property.CountType);
+      if (position + countSize > file.GetSize())
+        {
+        return false;
+        }
+      const vtkIdType count = DecodePLY<vtkIdType>(file.GetData() + position, property.CountType, swap);
+      if (count < 0)
+        {
+        return false;
+        }
+      position += countSize + count * GetPLYTypeSize(property.Type);
+      }
+    if (position > file.GetSize())
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Coordinates, normals and colors of the vertex element, which has no list.
+// Returns false if the file is truncated.
+bool ReadPLYVertices(const MappedFile& file, const PLYElement& element, bool swap, size_t& position,
+                     vtkPolyData* polyData)
+{
+  const size_t recordSize = element.GetRecordSize();
+  if ((file.GetSize() - position) / recordSize < static_cast<size_t>(element.Count))
+    {
+    return false;
+    }
+  const vtkIdType numberOfPoints = element.Count;
+  const char* records = file.GetData() + position;
+  position += recordSize * numberOfPoints;
+
+  // Properties read, with their offset in the records, or -1 if missing
+  const char* names[] = { "x", "y", "z", "nx", "ny", "nz", "red", "green", "blue", "alpha" };
+  int offsets[10];
+  PLYType types[10];
+  for (int i = 0; i < 10; ++i)
+    {
+    offsets[i] = element.GetPropertyOffset(names[i], types[i]);
+    if (offsets[i] < 0 && i >= 6 && i < 9)
+      {
+      const std::string diffuseName = std::string("diffuse_") + names[i];
+      offsets[i] = element.GetPropertyOffset(diffuseName, types[i]);
+      }
+    }
+  const bool hasNormals = offsets[3] >= 0 && offsets[4] >= 0 && offsets[5] >= 0;
+  const bool hasColors = offsets[6] >= 0 && offsets[7] >= 0 && offsets[8] >= 0;
+  const int numberOfColorComponents = offsets[9] >= 0 ? 4 : 3;
+
+  vtkSmartPointer<vtkFloatArray> coordinates = CreateFloatArray(nullptr, 3, numberOfPoints);
+  vtkSmartPointer<vtkFloatArray> normals = CreateFloatArray("Normals", 3, hasNormals ? numberOfPoints : 0);
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetName("RGB");
+  colors->SetNumberOfComponents(numberOfColorComponents);
+  colors->SetNumberOfTuples(hasColors ? numberOfPoints : 0);
+  float* coordinatePointer = coordinates->GetPointer(0);
+  float* normalPointer = normals->GetPointer(0);
+  unsigned char* colorPointer = colors->GetPointer(0);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      const char* record = records + recordSize * pointId;
+      for (int i = 0; i < 3; ++i)
+        {
+        coordinatePointer[3 * pointId + i] = DecodePLY<float>(record + offsets[i], types[i], swap);
+        if (hasNormals)
+          {
+          normalPointer[3 * pointId + i] = DecodePLY<float>(record + offsets[3 + i], types[3 + i], swap);
+          }
+        }
+      for (int i = 0; hasColors && i < numberOfColorComponents; ++i)
+        {
+        colorPointer[numberOfColorComponents * pointId + i] =
+          DecodePLY<unsigned char>(record + offsets[6 + i], types[6 + i], swap);
+        }
+      }
+    });
+
+  vtkNew<vtkPoints> points;
+  points->SetData(coordinates);
+  polyData->SetPoints(points);
+  if (hasNormals)
+    {
+    polyData->GetPointData()->SetNormals(normals);
+    }
+  if (hasColors)
+    {
+    polyData->GetPointData()->SetScalars(colors);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Polygons of the vertex lists of the face element. Returns false if the file
+// is truncated or a face uses a point that does not exist.
+bool ReadPLYFaces(const MappedFile& file, const PLYElement& element, int listIndex, bool swap,
+                  vtkIdType numberOfPoints, size_t& position, vtkPolyData* polyData)
+{
+  const vtkIdType numberOfFaces = element.Count;
+  const PLYProperty& list = element.Properties[listIndex];
+  const size_t countSize = GetPLYTypeSize(list.CountType);
+  const size_t indexSize = GetPLYTypeSize(list.Type);
+  const char* data = file.GetData();
+
+  // Usual case: the vertex list is the only list of the faces, and all the
+  // faces have as many points as the first one, so that the records have a
+  // fixed size. Each face then only has to check its number of points.
+  size_t listOffset = 0;
+  size_t otherSize = 0;
+  bool fixedSize = numberOfFaces > 0;
+  for (int i = 0; i < static_cast<int>(element.Properties.size()); ++i)
+    {
+    const PLYProperty& property = element.Properties[i];
+    fixedSize = fixedSize && (i == listIndex || property.CountType == PLYUnknown);
+    if (i != listIndex)
+      {
+      otherSize += GetPLYTypeSize(property.Type);
+      listOffset += i < listIndex ? GetPLYTypeSize(property.Type) : 0;
+      }
+    }
+  vtkIdType faceSize = 0;
+  size_t recordSize = 0;
+  fixedSize = fixedSize && position + listOffset + countSize <= file.GetSize();
+  if (fixedSize)
+    {
+    faceSize = DecodePLY<vtkIdType>(data + position + listOffset, list.CountType, swap);
+    fixedSize = faceSize >= 0;
+    }
+  if (fixedSize)
+    {
+    recordSize = otherSize + countSize + faceSize * indexSize;
+    fixedSize = (file.GetSize() - position) / recordSize >= static_cast<size_t>(numberOfFaces);
+    }
+  if (fixedSize)
+    {
+    std::atomic<bool> sameSize(true);
+    vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType faceId = begin; faceId < end && sameSize; ++faceId)
+        {
+        const char* count = data + position + recordSize * faceId + listOffset;
+        if (DecodePLY<vtkIdType>(count, list.CountType, swap) != faceSize)
+          {
+          sameSize = false;
+          }
+        }
+      });
+    fixedSize = sameSize;
+    }
+
+  // Otherwise, find the records one after the other
+  std::vector<size_t> recordStarts;
+  size_t end = position + recordSize * numberOfFaces;
+  if (!fixedSize)
+    {
+    recordStarts.reserve(numberOfFaces);
+    end = position;
+    if (!ScanPLYRecords(file, element, swap, end, &recordStarts))
+      {
+      return false;
+      }
+    }
+  // Start of the list of a face
+  auto getList = [&](vtkIdType faceId) -> const char*
+    {
+    if (fixedSize)
+      {
+      return data + position + recordSize * faceId + listOffset;
+      }
+    const char* record = data + recordStarts[faceId];
+    for (int i = 0; i < listIndex; ++i)
+      {
+      const PLYProperty& property = element.Properties[i];
+      if (property.CountType == PLYUnknown)
+        {
+        record += GetPLYTypeSize(property.Type);
+        }
+      else
+        {
+        const vtkIdType count = DecodePLY<vtkIdType>(record, property.CountType, swap);
+        record += GetPLYTypeSize(property.CountType) + count * GetPLYTypeSize(property.Type);
+        }
+      }
+    return record;
+    };
+
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(numberOfFaces + 1);
+  vtkIdType* offsetPointer = offsets->GetPointer(0);
+  offsetPointer[0] = 0;
+  if (fixedSize)
+    {
+    vtkSMPTools::For(0, numberOfFaces + 1, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType faceId = begin; faceId < end; ++faceId)
+        {
+        offsetPointer[faceId] = faceSize * faceId;
+        }
+      });
+    }
+  else
+    {
+    for (vtkIdType faceId = 0; faceId < numberOfFaces; ++faceId)
+      {
+      offsetPointer[faceId + 1] = offsetPointer[faceId] + DecodePLY<vtkIdType>(getList(faceId), list.CountType, swap);
+      }
+    }
+
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(offsetPointer[numberOfFaces]);
+  vtkIdType* connectivityPointer = connectivity->GetPointer(0);
+  std::atomic<bool> valid(true);
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType faceId = begin; faceId < end; ++faceId)
+      {
+      const char* indices = getList(faceId) + countSize;
+      for (vtkIdType i = offsetPointer[faceId]; i < offsetPointer[faceId + 1]; ++i, indices += indexSize)
+        {
+        const vtkIdType pointId = DecodePLY<vtkIdType>(indices, list.Type, swap);
+        if (pointId < 0 || pointId >= numberOfPoints)
+          {
+          valid = false;
+          }
+        connectivityPointer[i] = pointId;
+        }
+      }
+    });
+  if (!valid)
+    {
+    return false;
+    }
+  position = end;
+
+  vtkNew<vtkCellArray> polys;
+  polys->SetData(offsets, connectivity);
+  polyData->SetPolys(polys);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Binary PLY files whose vertex element has no list and face element has a
+// vertex list are read here, others by vtkPLYReader.
+vtkSmartPointer<vtkPolyData> ReadPLY(const MappedFile& file, const std::string& fileName)
+{
+  PLYHeader header;
+  if (!ReadPLYHeader(file, header))
+    {
+    std::cerr << "Failed to read " << fileName << ": invalid PLY header" << std::endl;
+    return nullptr;
+    }
+  const PLYElement* vertices = nullptr;
+  int listIndex = -1;
+  for (const PLYElement& element : header.Elements)
+    {
+    if (element.Name == "vertex")
+      {
+      PLYType type;
+      vertices = element.GetRecordSize() > 0 && element.GetPropertyOffset("x", type) >= 0
+          && element.GetPropertyOffset("y", type) >= 0 && element.GetPropertyOffset("z", type) >= 0
+        ? &element
+        : nullptr;
+      }
+    else if (element.Name == "face")
+      {
+      for (int i = 0; i < static_cast<int>(element.Properties.size()); ++i)
+        {
+        const PLYProperty& property = element.Properties[i];
+        if (property.CountType != PLYUnknown && (property.Name == "vertex_indices" || property.Name == "vertex_index"))
+          {
+          listIndex = i;
+          }
+        }
+      }
+    }
+  if (!header.Binary || !vertices)
+    {
+    return ReadWithVTKReader<vtkPLYReader>(fileName);
+    }
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  size_t position = header.DataOffset;
+  for (const PLYElement& element : header.Elements)
+    {
+    bool read = true;
+    if (&element == vertices)
+      {
+      read = ReadPLYVertices(file, element, header.Swap, position, polyData);
+      }
+    else if (element.Name == "face" && listIndex >= 0)
+      {
+      read = ReadPLYFaces(file, element, listIndex, header.Swap, vertices->Count, position, polyData);
+      }
+    else
+      {
+      read = ScanPLYRecords(file, element, header.Swap, position, nullptr);
+      }
+    if (!read)
+      {
+      std::cerr << "Failed to read " << fileName << ": invalid or truncated element " << element.Name << std::endl;
+      return nullptr;
+      }
+    }
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+// Cells and vertex attributes read from a chunk of lines of an OBJ file
+struct OBJChunk
+{
+  std::vector<float> Points;
+  std::vector<float> Normals;
+  std::vector<float> TCoords;
+  /// Vertices, lines and polygons: end of each cell in Connectivity
+  std::vector<vtkIdType> CellEnds[3];
+  std::vector<vtkIdType> Connectivity[3];
+  /// Positions in Connectivity of the point ids counted from the first point
+  /// of the chunk (negative indices of the file)
+  std::vector<size_t> RelativePointIds[3];
+  bool UsesNormals = false;
+  bool UsesTCoords = false;
+  /// True if a face uses a normal or texture coordinate index different from
+  /// its vertex index
+  bool SeparateAttributeIndices = false;
+  std::string Error;
+};
+
+//----------------------------------------------------------------------------
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+//----------------------------------------------------------------------------
+bool ParseOBJFloat(const char*& position, const char* end, float& value)
+{
+  while (position < end && IsSpace(*position))
+    {
+    ++position;
+    }
+  // The mapped file is not null-terminated: copy the number
+  char number[64];
+  size_t length = 0;
+  while (position + length < end && !IsSpace(position[length]) && length < sizeof(number) - 1)
+    {
+    number[length] = position[length];
+    ++length;
+    }
+  if (position + length < end && !IsSpace(position[length]))
+    {
+    return false;
+    }
+  number[length] = '\0';
+  char* numberEnd = nullptr;
+  value = static_cast<float>(std::strtod(number, &numberEnd));
+  if (length == 0 || numberEnd != number + length)
+    {
+    return false;
+    }
+  position += length;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ParseOBJInteger(const char*& position, const char* end, vtkIdType& value)
+{
+  const bool negative = position < end && *position == '-';
+  if (negative || (position < end && *position == '+'))
+    {
+    ++position;
+    }
+  const char* digits = position;
+  value = 0;
+  while (position < end && *position >= '0' && *position <= '9')
+    {
+    value = 10 * value + (*position++ - '0');
+    }
+  value = negative ? -value : value;
+  return position > digits;
+}
+
+//----------------------------------------------------------------------------
+// Corners "v", "v/vt", "v//vn" or "v/vt/vn" of a face, line or vertex
+bool ParseOBJCell(const char* position, const char* end, int cellType, OBJChunk& chunk)
+{
+  std::vector<vtkIdType>& connectivity = chunk.Connectivity[cellType];
+  const vtkIdType localPoints = static_cast<vtkIdType>(chunk.Points.size() / 3);
+  for (;;)
+    {
+    while (position < end && IsSpace(*position))
+      {
+      ++position;
+      }
+    if (position == end)
+      {
+      break;
+      }
+    vtkIdType index = 0;
+    if (!ParseOBJInteger(position, end, index) || index == 0)
+      {
+      return false;
+      }
+    if (index > 0)
+      {
+      connectivity.push_back(index - 1);
+      }
+    else
+      {
+      chunk.RelativePointIds[cellType].push_back(connectivity.size());
+      connectivity.push_back(localPoints + index);
+      }
+    for (int attribute = 0; attribute < 2 && position < end && *position == '/'; ++attribute)
+      {
+      ++position;
+      vtkIdType attributeIndex = 0;
+      if (position < end && *position != '/' && !IsSpace(*position))
+        {
+        if (!ParseOBJInteger(position, end, attributeIndex))
+          {
+          return false;
+          }
+        (attribute == 0 ? chunk.UsesTCoords : chunk.UsesNormals) = true;
+        chunk.SeparateAttributeIndices = chunk.SeparateAttributeIndices || index < 0 || attributeIndex != index;
+        }
+      }
+    if (position < end && !IsSpace(*position))
+      {
+      return false;
+      }
+    }
+  chunk.CellEnds[cellType].push_back(static_cast<vtkIdType>(connectivity.size()));
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ParseOBJLine(const char* position, const char* end, OBJChunk& chunk)
+{
+  while (position < end && IsSpace(*position))
+    {
+    ++position;
+    }
+  const char* keyword = position;
+  while (position < end && !IsSpace(*position))
+    {
+    ++position;
+    }
+  const std::string name(keyword, position);
+  if (name == "v" || name == "vn" || name == "vt")
+    {
+    std::vector<float>& values = name == "v" ? chunk.Points : (name == "vn" ? chunk.Normals : chunk.TCoords);
+    const int numberOfComponents = name == "vt" ? 2 : 3;
+    float value = 0.0f;
+    for (int i = 0; i < numberOfComponents; ++i)
+      {
+      // Texture coordinates may only have u
+      if (!ParseOBJFloat(position, end, value) && !(name == "vt" && i == 1))
+        {
+        return false;
+        }
+      values.push_back(value);
+      value = 0.0f;
+      }
+    return true;
+    }
+  if (name == "p" || name == "l" || name == "f")
+    {
+    return ParseOBJCell(position, end, name == "p" ? 0 : (name == "l" ? 1 : 2), chunk);
+    }
+  // Comments, groups, materials, smoothing groups...
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ParseOBJChunk(const char* begin, const char* end, OBJChunk& chunk)
+{
+  for (const char* line = begin; line < end;)
+    {
+    const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    lineEnd = lineEnd ? lineEnd : end;
+    if (!ParseOBJLine(line, lineEnd, chunk))
+      {
+      chunk.Error = "invalid line \"" + std::string(line, std::min<size_t>(lineEnd - line, 80)) + "\"";
+      return;
+      }
+    line = lineEnd + 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// The file is cut into chunks of about OBJChunkSize bytes ending at line ends,
+// parsed in parallel. The cells and point attributes of the chunks are then
+// copied in parallel to their place in the arrays of the surface.
+vtkSmartPointer<vtkPolyData> ReadOBJ(const MappedFile& file, const std::string& fileName)
+{
+  const char* data = file.GetData();
+  const size_t size = file.GetSize();
+  std::vector<size_t> chunkStarts(1, 0);
+  while (chunkStarts.back() < size)
+    {
+    const size_t nominalEnd = std::min(size, chunkStarts.back() + OBJChunkSize);
+    const char* lineEnd = static_cast<const char*>(std::memchr(data + nominalEnd, '\n', size - nominalEnd));
+    chunkStarts.push_back(lineEnd ? static_cast<size_t>(lineEnd - data) + 1 : size);
+    }
+  const vtkIdType numberOfChunks = static_cast<vtkIdType>(chunkStarts.size()) - 1;
+  std::vector<OBJChunk> chunks(numberOfChunks);
+  vtkSMPTools::For(0, numberOfChunks, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType chunkId = begin; chunkId < end; ++chunkId)
+      {
+      ParseOBJChunk(data + chunkStarts[chunkId], data + chunkStarts[chunkId + 1], chunks[chunkId]);
+      }
+    });
+
+  // Place of each chunk in the arrays of the surface
+  std::vector<vtkIdType> pointStarts(numberOfChunks + 1, 0);
+  std::vector<vtkIdType> normalStarts(numberOfChunks + 1, 0);
+  std::vector<vtkIdType> tcoordStarts(numberOfChunks + 1, 0);
+  std::vector<vtkIdType> cellStarts[3];
+  std::vector<vtkIdType> connectivityStarts[3];
+  for (int cellType = 0; cellType < 3; ++cellType)
+    {
+    cellStarts[cellType].assign(numberOfChunks + 1, 0);
+    connectivityStarts[cellType].assign(numberOfChunks + 1, 0);
+    }
+  bool usesNormals = false;
+  bool usesTCoords = false;
+  bool separateAttributeIndices = false;
+  for (vtkIdType chunkId = 0; chunkId < numberOfChunks; ++chunkId)
+    {
+    const OBJChunk& chunk = chunks[chunkId];
+    if (!chunk.Error.empty())
+      {
+      std::cerr << "Failed to read " << fileName << ": " << chunk.Error << std::endl;
+      return nullptr;
+      }
+    pointStarts[chunkId + 1] = pointStarts[chunkId] + static_cast<vtkIdType>(chunk.Points.size() / 3);
+    for (int cellType = 0; cellType < 3; ++cellType)
+      {
+      cellStarts[cellType][chunkId + 1] = cellStarts[cellType][chunkId] + chunk.CellEnds[cellType].size();
+      connectivityStarts[cellType][chunkId + 1] =
+        connectivityStarts[cellType][chunkId] + chunk.Connectivity[cellType].size();
+      }
+    normalStarts[chunkId + 1] = normalStarts[chunkId] + static_cast<vtkIdType>(chunk.Normals.size() / 3);
+    tcoordStarts[chunkId + 1] = tcoordStarts[chunkId] + static_cast<vtkIdType>(chunk.TCoords.size() / 2);
+    usesNormals = usesNormals || chunk.UsesNormals;
+    usesTCoords = usesTCoords || chunk.UsesTCoords;
+    separateAttributeIndices = separateAttributeIndices || chunk.SeparateAttributeIndices;
+    }
+  const vtkIdType numberOfPoints = pointStarts[numberOfChunks];
+  const vtkIdType numberOfNormals = normalStarts[numberOfChunks];
+  const vtkIdType numberOfTCoords = tcoordStarts[numberOfChunks];
+  // Attributes indexed separately from the points need points duplicated per
+  // attribute, as vtkOBJReader does.
+  if ((usesNormals && (separateAttributeIndices || numberOfNormals != numberOfPoints))
+      || (usesTCoords && (separateAttributeIndices || numberOfTCoords != numberOfPoints)))
+    {
+    return ReadWithVTKReader<vtkOBJReader>(fileName);
+    }
+
+  vtkSmartPointer<vtkFloatArray> coordinates = CreateFloatArray(nullptr, 3, numberOfPoints);
+  vtkSmartPointer<vtkFloatArray> normals = CreateFloatArray("Normals", 3, usesNormals ? numberOfPoints : 0);
+  vtkSmartPointer<vtkFloatArray> tcoords = CreateFloatArray("TCoords", 2, usesTCoords ? numberOfPoints : 0);
+  vtkSmartPointer<vtkIdTypeArray> offsets[3];
+  vtkSmartPointer<vtkIdTypeArray> connectivity[3];
+  for (int cellType = 0; cellType < 3; ++cellType)
+    {
+    offsets[cellType] = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets[cellType]->SetNumberOfValues(cellStarts[cellType][numberOfChunks] + 1);
+    offsets[cellType]->SetValue(0, 0);
+    connectivity[cellType] = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity[cellType]->SetNumberOfValues(connectivityStarts[cellType][numberOfChunks]);
+    }
+  std::atomic<bool> valid(true);
+  vtkSMPTools::For(0, numberOfChunks, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType chunkId = begin; chunkId < end; ++chunkId)
+      {
+      const OBJChunk& chunk = chunks[chunkId];
+      const vtkIdType pointStart = pointStarts[chunkId];
+      std::copy(chunk.Points.begin(), chunk.Points.end(), coordinates->GetPointer(3 * pointStart));
+      if (usesNormals)
+        {
+        std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals->GetPointer(3 * normalStarts[chunkId]));
+        }
+      if (usesTCoords)
+        {
+        std::copy(chunk.TCoords.begin(), chunk.TCoords.end(), tcoords->GetPointer(2 * tcoordStarts[chunkId]));
+        }
+      for (int cellType = 0; cellType < 3; ++cellType)
+        {
+        const vtkIdType connectivityStart = connectivityStarts[cellType][chunkId];
+        vtkIdType* offsetPointer = offsets[cellType]->GetPointer(cellStarts[cellType][chunkId] + 1);
+        for (vtkIdType cellEnd : chunk.CellEnds[cellType])
+          {
+          *offsetPointer++ = connectivityStart + cellEnd;
+          }
+        vtkIdType* connectivityPointer = connectivity[cellType]->GetPointer(connectivityStart);
+        std::copy(chunk.Connectivity[cellType].begin(), chunk.Connectivity[cellType].end(), connectivityPointer);
+        for (size_t position : chunk.RelativePointIds[cellType])
+          {
+          connectivityPointer[position] += pointStart;
+          }
+        for (size_t i = 0; i < chunk.Connectivity[cellType].size(); ++i)
+          {
+          if (connectivityPointer[i] < 0 || connectivityPointer[i] >= numberOfPoints)
+            {
+            valid = false;
+            }
+          }
+        }
+      }
+    });
+  if (!valid)
+    {
+    std::cerr << "Failed to read " << fileName << ": a cell uses a vertex that does not exist" << std::endl;
+    return nullptr;
+    }
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetData(coordinates);
+  polyData->SetPoints(points);
+  vtkNew<vtkCellArray> verts;
+  verts->SetData(offsets[0], connectivity[0]);
+  polyData->SetVerts(verts);
+  vtkNew<vtkCellArray> lines;
+  lines->SetData(offsets[1], connectivity[1]);
+  polyData->SetLines(lines);
+  vtkNew<vtkCellArray> polys;
+  polys->SetData(offsets[2], connectivity[2]);
+  polyData->SetPolys(polys);
+  if (usesNormals)
+    {
+    polyData->GetPointData()->SetNormals(normals);
+    }
+  if (usesTCoords)
+    {
+    polyData->GetPointData()->SetTCoords(tcoords);
+    }
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+std::FILE* OpenFile(const std::string& fileName)
+{
+  std::FILE* file = std::fopen(fileName.c_str(), "wb");
+  if (!file)
+    {
+    std::cerr << "Failed to write " << fileName << ": " << std::strerror(errno) << std::endl;
+    }
+  return file;
+}
+
+//----------------------------------------------------------------------------
+bool CloseFile(std::FILE* file, const std::string& fileName, bool written)
+{
+  written = std::fclose(file) == 0 && written;
+  if (!written)
+    {
+    std::cerr << "Failed to write " << fileName << ": " << std::strerror(errno) << std::endl;
+    }
+  return written;
+}
+
+//----------------------------------------------------------------------------
+// Write numberOfRecords records formatted by formatRecords(begin, end, buffer)
+// without formatting the whole file in memory: the blocks of a batch of
+// blocks are formatted in parallel, then written in order, and their buffers
+// are reused by the next batch.
+template <typename Formatter>
+bool WriteRecords(std::FILE* file, vtkIdType numberOfRecords, Formatter formatRecords)
+{
+  const vtkIdType numberOfBlocks = (numberOfRecords + RecordsPerBlock - 1) / RecordsPerBlock;
+  const vtkIdType blocksPerBatch = 2 * vtkSMPTools::GetEstimatedNumberOfThreads();
+  std::vector<std::string> buffers(blocksPerBatch);
+  for (vtkIdType firstBlock = 0; firstBlock < numberOfBlocks; firstBlock += blocksPerBatch)
+    {
+    const vtkIdType lastBlock = std::min(numberOfBlocks, firstBlock + blocksPerBatch);
+    vtkSMPTools::For(firstBlock, lastBlock, 1, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType block = begin; block < end; ++block)
+        {
+        std::string& buffer = buffers[block - firstBlock];
+        buffer.clear();
+        formatRecords(block * RecordsPerBlock, std::min(numberOfRecords, (block + 1) * RecordsPerBlock), buffer);
+        }
+      });
+    for (vtkIdType block = firstBlock; block < lastBlock; ++block)
+      {
+      const std::string& buffer = buffers[block - firstBlock];
+      if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// printf formatted text appended to buffer
+template <typename... Values>
+void AppendText(std::string& buffer, const char* format, Values... values)
+{
+  char text[256];
+  const int length = std::snprintf(text, sizeof(text), format, values...);
+  buffer.append(text, static_cast<size_t>(std::min<int>(length, sizeof(text) - 1)));
+}
+
+//----------------------------------------------------------------------------
+// Polygons, then the triangles of the strips, as faces of PLY and OBJ files:
+// the points of face i are connectivity[offsets[i]] to connectivity[offsets[i + 1] - 1].
+void GetFaces(vtkPolyData* polyData, std::vector<vtkIdType>& offsets, std::vector<vtkIdType>& connectivity)
+{
+  std::vector<vtkIdType> cellOffsets;
+  std::vector<vtkIdType> cellConnectivity;
+  SurfaceToolbox::GetCells(polyData, cellOffsets, cellConnectivity);
+  const vtkIdType firstPolygon = polyData->GetNumberOfVerts() + polyData->GetNumberOfLines();
+  const vtkIdType firstStrip = firstPolygon + polyData->GetNumberOfPolys();
+  const vtkIdType polygonStart = cellOffsets[firstPolygon];
+  offsets.clear();
+  for (vtkIdType cellId = firstPolygon; cellId <= firstStrip; ++cellId)
+    {
+    offsets.push_back(cellOffsets[cellId] - polygonStart);
+    }
+  connectivity.assign(cellConnectivity.begin() + polygonStart, cellConnectivity.begin() + cellOffsets[firstStrip]);
+  for (vtkIdType stripId = firstStrip; stripId + 1 < static_cast<vtkIdType>(cellOffsets.size()); ++stripId)
+    {
+    for (vtkIdType i = cellOffsets[stripId]; i + 2 < cellOffsets[stripId + 1]; ++i)
+      {
+      // Every other triangle of a strip is reversed to keep the orientation
+      const bool odd = (i - cellOffsets[stripId]) % 2 == 1;
+      connectivity.push_back(cellConnectivity[odd ? i + 1 : i]);
+      connectivity.push_back(cellConnectivity[odd ? i : i + 1]);
+      connectivity.push_back(cellConnectivity[i + 2]);
+      offsets.push_back(static_cast<vtkIdType>(connectivity.size()));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool WriteBinarySTL(vtkPolyData* polyData, const std::string& fileName)
+{
+  std::vector<vtkIdType> triangles;
+  vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::GetTriangulatedSurface(polyData, triangles);
+  const vtkIdType numberOfTriangles = static_cast<vtkIdType>(triangles.size() / 3);
+  if (numberOfTriangles > static_cast<vtkIdType>(VTK_TYPE_UINT32_MAX))
+    {
+    std::cerr << "Failed to write " << fileName << ": too many triangles for a binary STL file" << std::endl;
+    return false;
+    }
+  std::FILE* file = OpenFile(fileName);
+  if (!file)
+    {
+    return false;
+    }
+  const bool swap = IsBigEndianHost();
+  std::string header = "SurfaceToolbox binary STL";
+  header.resize(80, ' ');
+  Encode<vtkTypeUInt32>(static_cast<vtkTypeUInt32>(numberOfTriangles), swap, header);
+  bool written = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+  vtkPoints* points = surface->GetPoints();
+  written = written && WriteRecords(file, numberOfTriangles, [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    buffer.reserve(STLTriangleSize * (end - begin));
+    for (vtkIdType triangleId = begin; triangleId < end; ++triangleId)
+      {
+      double corners[3][3];
+      for (int i = 0; i < 3; ++i)
+        {
+        points->GetPoint(triangles[3 * triangleId + i], corners[i]);
+        }
+      double normal[3];
+      double u[3];
+      double v[3];
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        u[axis] = corners[1][axis] - corners[0][axis];
+        v[axis] = corners[2][axis] - corners[0][axis];
+        }
+      normal[0] = u[1] * v[2] - u[2] * v[1];
+      normal[1] = u[2] * v[0] - u[0] * v[2];
+      normal[2] = u[0] * v[1] - u[1] * v[0];
+      const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        Encode<float>(static_cast<float>(length > 0.0 ? normal[axis] / length : 0.0), swap, buffer);
+        }
+      for (int i = 0; i < 3; ++i)
+        {
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          Encode<float>(static_cast<float>(corners[i][axis]), swap, buffer);
+          }
+        }
+      Encode<vtkTypeUInt16>(0, swap, buffer);
+      }
+    });
+  return CloseFile(file, fileName, written);
+}
+
+//----------------------------------------------------------------------------
+bool WriteBinaryPLY(vtkPolyData* polyData, const std::string& fileName)
+{
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  if (numberOfPoints > static_cast<vtkIdType>(VTK_TYPE_INT32_MAX))
+    {
+    std::cerr << "Failed to write " << fileName << ": too many points for a PLY file" << std::endl;
+    return false;
+    }
+  std::vector<vtkIdType> offsets;
+  std::vector<vtkIdType> connectivity;
+  GetFaces(polyData, offsets, connectivity);
+  const vtkIdType numberOfFaces = static_cast<vtkIdType>(offsets.size()) - 1;
+  vtkIdType maximumFaceSize = 0;
+  for (vtkIdType faceId = 0; faceId < numberOfFaces; ++faceId)
+    {
+    maximumFaceSize = std::max(maximumFaceSize, offsets[faceId + 1] - offsets[faceId]);
+    }
+  const bool byteCounts = maximumFaceSize <= VTK_UNSIGNED_CHAR_MAX;
+  vtkDataArray* normals = polyData->GetPointData()->GetNormals();
+  vtkDataArray* colors = polyData->GetPointData()->GetScalars();
+  if (colors && (colors->GetDataType() != VTK_UNSIGNED_CHAR
+                 || (colors->GetNumberOfComponents() != 3 && colors->GetNumberOfComponents() != 4)))
+    {
+    colors = nullptr;
+    }
+
+  std::FILE* file = OpenFile(fileName);
+  if (!file)
+    {
+    return false;
+    }
+  std::ostringstream header;
+  header << "ply\nformat binary_little_endian 1.0\ncomment SurfaceToolbox\n";
+  header << "element vertex " << numberOfPoints << "\nproperty float x\nproperty float y\nproperty float z\n";
+  if (normals)
+    {
+    header << "property float nx\nproperty float ny\nproperty float nz\n";
+    }
+  if (colors)
+    {
+    header << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+    header << (colors->GetNumberOfComponents() == 4 ? "property uchar alpha\n" : "");
+    }
+  header << "element face " << numberOfFaces << "\nproperty list " << (byteCounts ? "uchar" : "int")
+         << " int vertex_indices\nend_header\n";
+  const std::string headerText = header.str();
+  bool written = std::fwrite(headerText.data(), 1, headerText.size(), file) == headerText.size();
+
+  const bool swap = IsBigEndianHost();
+  vtkPoints* points = polyData->GetPoints();
+  written = written && WriteRecords(file, numberOfPoints, [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    double values[4];
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      points->GetPoint(pointId, values);
+      for (int i = 0; i < 3; ++i)
+        {
+        Encode<float>(static_cast<float>(values[i]), swap, buffer);
+        }
+      if (normals)
+        {
+        normals->GetTuple(pointId, values);
+        for (int i = 0; i < 3; ++i)
+          {
+          Encode<float>(static_cast<float>(values[i]), swap, buffer);
+          }
+        }
+      if (colors)
+        {
+        colors->GetTuple(pointId, values);
+        for (int i = 0; i < colors->GetNumberOfComponents(); ++i)
+          {
+          buffer += static_cast<char>(static_cast<unsigned char>(values[i]));
+          }
+        }
+      }
+    });
+  written = written && WriteRecords(file, numberOfFaces, [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    for (vtkIdType faceId = begin; faceId < end; ++faceId)
+      {
+      const vtkIdType faceSize = offsets[faceId + 1] - offsets[faceId];
+      if (byteCounts)
+        {
+        buffer += static_cast<char>(static_cast<unsigned char>(faceSize));
+        }
+      else
+        {
+        Encode<vtkTypeInt32>(static_cast<vtkTypeInt32>(faceSize), swap, buffer);
+        }
+      for (vtkIdType i = offsets[faceId]; i < offsets[faceId + 1]; ++i)
+        {
+        Encode<vtkTypeInt32>(static_cast<vtkTypeInt32>(connectivity[i]), swap, buffer);
+        }
+      }
+    });
+  return CloseFile(file, fileName, written);
+}
+
+//----------------------------------------------------------------------------
+bool WriteOBJ(vtkPolyData* polyData, const std::string& fileName)
+{
+  std::vector<vtkIdType> offsets;
+  std::vector<vtkIdType> connectivity;
+  SurfaceToolbox::GetCells(polyData, offsets, connectivity);
+  const vtkIdType numberOfVertsAndLines = polyData->GetNumberOfVerts() + polyData->GetNumberOfLines();
+  std::vector<vtkIdType> faceOffsets;
+  std::vector<vtkIdType> faceConnectivity;
+  GetFaces(polyData, faceOffsets, faceConnectivity);
+  const vtkIdType numberOfFaces = static_cast<vtkIdType>(faceOffsets.size()) - 1;
+
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  vtkPoints* points = polyData->GetPoints();
+  vtkDataArray* normals = polyData->GetPointData()->GetNormals();
+  vtkDataArray* tcoords = polyData->GetPointData()->GetTCoords();
+  // Enough digits to read back the same values
+  const char* pointFormat = points && points->GetDataType() == VTK_DOUBLE ? "v %.17g %.17g %.17g\n" : "v %.9g %.9g %.9g\n";
+  // Corner of a cell, with the same index for the point and its attributes
+  const char* cornerFormat = normals ? (tcoords ? " %lld/%lld/%lld" : " %lld//%lld") : (tcoords ? " %lld/%lld" : " %lld");
+
+  std::FILE* file = OpenFile(fileName);
+  if (!file)
+    {
+    return false;
+    }
+  bool written = std::fputs("# SurfaceToolbox\n", file) >= 0;
+  written = written && WriteRecords(file, numberOfPoints, [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    double values[3];
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      points->GetPoint(pointId, values);
+      AppendText(buffer, pointFormat, values[0], values[1], values[2]);
+      }
+    });
+  auto formatTCoords = [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    double values[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      tcoords->GetTuple(pointId, values);
+      AppendText(buffer, "vt %.9g %.9g\n", values[0], tcoords->GetNumberOfComponents() > 1 ? values[1] : 0.0);
+      }
+    };
+  written = written && (!tcoords || WriteRecords(file, numberOfPoints, formatTCoords));
+  auto formatNormals = [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    double values[3];
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      normals->GetTuple(pointId, values);
+      AppendText(buffer, "vn %.9g %.9g %.9g\n", values[0], values[1], values[2]);
+      }
+    };
+  written = written && (!normals || WriteRecords(file, numberOfPoints, formatNormals));
+  // Vertices and lines, then the faces
+  auto formatCell = [&](const vtkIdType* cellBegin, const vtkIdType* cellEnd, const char* keyword, std::string& buffer)
+    {
+    buffer += keyword;
+    for (const vtkIdType* pointId = cellBegin; pointId != cellEnd; ++pointId)
+      {
+      const long long index = static_cast<long long>(*pointId) + 1;
+      AppendText(buffer, cornerFormat, index, index, index);
+      }
+    buffer += '\n';
+    };
+  written = written && WriteRecords(file, numberOfVertsAndLines, [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      formatCell(connectivity.data() + offsets[cellId], connectivity.data() + offsets[cellId + 1],
+                 cellId < polyData->GetNumberOfVerts() ? "p" : "l", buffer);
+      }
+    });
+  written = written && WriteRecords(file, numberOfFaces, [&](vtkIdType begin, vtkIdType end, std::string& buffer)
+    {
+    for (vtkIdType faceId = begin; faceId < end; ++faceId)
+      {
+      formatCell(faceConnectivity.data() + faceOffsets[faceId], faceConnectivity.data() + faceOffsets[faceId + 1],
+                 "f", buffer);
+      }
+    });
+  return CloseFile(file, fileName, written);
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+bool IsMeshFileName(const std::string& fileName)
+{
+  return GetMeshFormat(fileName) != UnknownFormat;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadMeshFile(const std::string& fileName)
+{
+  const MeshFormat format = GetMeshFormat(fileName);
+  MappedFile file(fileName);
+  if (!file.IsValid())
+    {
+    std::cerr << "Failed to read " << fileName << ": " << file.GetError() << std::endl;
+    return nullptr;
+    }
+  switch (format)
+    {
+    case STL:
+      return IsBinarySTL(file) ? ReadBinarySTL(file, fileName) : ReadWithVTKReader<vtkSTLReader>(fileName);
+    case PLY:
+      return ReadPLY(file, fileName);
+    case OBJ:
+      return ReadOBJ(file, fileName);
+    default:
+      std::cerr << "Failed to read " << fileName << ": unknown mesh file format" << std::endl;
+      return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool IsBinarySTLFile(const std::string& fileName)
+{
+  if (GetMeshFormat(fileName) != STL)
+    {
+    return false;
+    }
+  MappedFile file(fileName, true);
+  return file.IsValid() && IsBinarySTL(file);
+}
+
+//----------------------------------------------------------------------------
+bool StreamSTLTriangles(const std::string& fileName, vtkIdType blockSize,
+                        const std::function<void(const std::vector<float>& corners)>& processBlock)
+{
+  MappedFile file(fileName, true);
+  if (!file.IsValid())
+    {
+    std::cerr << "Failed to read " << fileName << ": " << file.GetError() << std::endl;
+    return false;
+    }
+  const bool swap = IsBigEndianHost();
+  const vtkIdType numberOfTriangles =
+    file.GetSize() < STLHeaderSize ? 0 : Decode<vtkTypeUInt32>(file.GetData() + 80, swap);
+  if (file.GetSize() < STLHeaderSize + STLTriangleSize * static_cast<size_t>(numberOfTriangles))
+    {
+    std::cerr << "Failed to read " << fileName << ": truncated binary STL file" << std::endl;
+    return false;
+    }
+
+  const char* triangleData = file.GetData() + STLHeaderSize;
+  std::vector<float> corners;
+  for (vtkIdType first = 0; first < numberOfTriangles; first += blockSize)
+    {
+    const vtkIdType size = std::min(blockSize, numberOfTriangles - first);
+    corners.resize(9 * size);
+    vtkSMPTools::For(0, size, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        const char* vertices = triangleData + STLTriangleSize * (first + i) + 3 * sizeof(float);
+        for (int k = 0; k < 9; ++k)
+          {
+          corners[9 * i + k] = Decode<float>(vertices + k * sizeof(float), swap);
+          }
+        }
+      });
+    processBlock(corners);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool WriteMeshFile(vtkPolyData* polyData, const std::string& fileName)
+{
+  switch (GetMeshFormat(fileName))
+    {
+    case STL:
+      return WriteBinarySTL(polyData, fileName);
+    case PLY:
+      return WriteBinaryPLY(polyData, fileName);
+    case OBJ:
+      return WriteOBJ(polyData, fileName);
+    default:
+      std::cerr << "Failed to write " << fileName << ": unknown mesh file format" << std::endl;
+      return false;
+    }
+}
+
+}
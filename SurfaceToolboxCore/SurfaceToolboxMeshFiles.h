@@ -0,0 +1,66 @@
+#ifndef SurfaceToolboxMeshFiles_h
+#define SurfaceToolboxMeshFiles_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+// STD includes
+#include <functional>
+#include <string>
+#include <vector>
+
+class vtkPolyData;
+
+// Surfaces in the mesh formats of scanners and 3D printers, read and written
+// without going through .vtp files. ReadPolyData and WritePolyData use them
+// for file names ending in ".stl", ".ply" and ".obj".
+//
+// Files are read through a memory mapping of the whole file, so that the
+// values are decoded from the file cache directly into the arrays of the
+// surface, in parallel:
+// - binary STL: triangles are decoded in parallel, then equal vertices are
+//   merged with the parallel sort of the cleaner and degenerate triangles are
+//   removed, as vtkSTLReader does;
+// - binary PLY: the vertex element (x, y, z, and nx, ny, nz and red, green,
+//   blue, alpha when present) and the vertex lists of the face element;
+// - OBJ: the file is cut into chunks of lines parsed in parallel. Vertices,
+//   points, lines and faces are read, and vertex normals and texture
+//   coordinates when faces use the same index for them as for the vertex.
+// ASCII STL and PLY files, and OBJ files indexing normals or texture
+// coordinates separately, are read by the VTK readers.
+//
+// Writers format blocks of records in parallel and write them one after the
+// other, without building the file in memory: binary STL (triangulated
+// polygons and strips), binary little-endian PLY (polygons and strips, with
+// point normals and unsigned char RGB(A) point scalars) and OBJ (all cells,
+// with point normals and texture coordinates).
+namespace SurfaceToolbox
+{
+
+/// Return true if \a fileName is the name of an STL, PLY or OBJ file.
+bool IsMeshFileName(const std::string& fileName);
+
+/// Read the STL, PLY or OBJ file \a fileName.
+/// Returns nullptr if the file cannot be read.
+vtkSmartPointer<vtkPolyData> ReadMeshFile(const std::string& fileName);
+
+/// Return true if \a fileName is a binary STL file.
+bool IsBinarySTLFile(const std::string& fileName);
+
+/// Pass the triangles of the binary STL file \a fileName to \a processBlock
+/// by blocks of at most \a blockSize triangles, decoded in parallel from the
+/// mapping of the file, which is read once from start to end: only one block
+/// is in memory at a time. \a corners holds the x, y, z coordinates of the
+/// three corners of each triangle of the block.
+/// Returns false if the file cannot be read.
+bool StreamSTLTriangles(const std::string& fileName, vtkIdType blockSize,
+                        const std::function<void(const std::vector<float>& corners)>& processBlock);
+
+/// Write \a polyData to the STL, PLY or OBJ file \a fileName.
+/// Returns false if the file cannot be written.
+bool WriteMeshFile(vtkPolyData* polyData, const std::string& fileName);
+
+}
+
+#endif
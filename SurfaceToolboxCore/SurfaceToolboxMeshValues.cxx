@@ -0,0 +1,230 @@
+#include "SurfaceToolboxMeshValues.h"
+
+// VTK includes
+#include "vtkByteSwap.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Point ids are written as int32 when all of them fit
+bool UseInt32Indices(const SurfaceToolbox::MeshValues& values)
+{
+  return values.GetNumberOfPoints() <= std::numeric_limits<vtkTypeInt32>::max();
+}
+
+//----------------------------------------------------------------------------
+// Write count values converted to OutputType, in little-endian byte order,
+// through a fixed-size buffer.
+template <typename OutputType, typename InputType>
+void WriteLittleEndian(std::ofstream& file, const InputType* data, size_t count)
+{
+  const size_t bufferSize = 1 << 20;
+  std::vector<OutputType> buffer(std::min(count, bufferSize));
+  for (size_t begin = 0; begin < count; begin += bufferSize)
+    {
+    const size_t size = std::min(bufferSize, count - begin);
+    std::copy(data + begin, data + begin + size, buffer.begin());
+    vtkByteSwap::SwapLERange(buffer.data(), size);
+    file.write(reinterpret_cast<const char*>(buffer.data()), size * sizeof(OutputType));
+    }
+}
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+void WriteLittleEndianValue(std::ofstream& file, ValueType value)
+{
+  WriteLittleEndian<ValueType>(file, &value, 1);
+}
+
+//----------------------------------------------------------------------------
+// NumPy format version 1.0: magic, version, header length, then a Python
+// dictionary padded with spaces and a newline so that the data starts at a
+// multiple of 64 bytes.
+void WriteNpyHeader(std::ofstream& file, const char* descr, vtkTypeInt64 rows)
+{
+  std::ostringstream dictionary;
+  dictionary << "{'descr': '" << descr << "', 'fortran_order': False, 'shape': (" << rows << ", 3), }";
+  std::string header = dictionary.str();
+  const size_t prefixSize = 10;
+  const size_t totalSize = ((prefixSize + header.size() + 1 + 63) / 64) * 64;
+  header.append(totalSize - prefixSize - header.size() - 1, ' ');
+  header.push_back('\n');
+
+  file.write("\x93NUMPY\x01\x00", 8);
+  WriteLittleEndianValue(file, static_cast<std::uint16_t>(header.size()));
+  file.write(header.data(), header.size());
+}
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+char* AppendNumber(char* out, ValueType value)
+{
+  // Buffers are sized for the longest rows, see MaximumRowLength
+  return std::to_chars(out, out + 32, value).ptr;
+}
+
+//----------------------------------------------------------------------------
+char* AppendText(char* out, const char* text)
+{
+  const size_t length = std::strlen(text);
+  std::memcpy(out, text, length);
+  return out + length;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+bool WriteMeshValuesCSV(const MeshValues& values, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  if (!file)
+    {
+    std::cerr << "Cannot write mesh values to " << fileName << std::endl;
+    return false;
+    }
+
+  const vtkTypeInt64 numberOfPoints = values.GetNumberOfPoints();
+  const vtkTypeInt64 numberOfTriangles = values.GetNumberOfTriangles();
+  char line[64];
+  char* end = AppendNumber(line, numberOfPoints);
+  end = AppendText(end, ",\n");
+  file.write(line, end - line);
+
+  // Row i is point i, then triangle i - numberOfPoints. Blocks of rows are
+  // formatted in parallel into their own buffers, a batch at a time, and the
+  // buffers are written in order.
+  const vtkTypeInt64 numberOfRows = numberOfPoints + numberOfTriangles;
+  const vtkTypeInt64 maximumRowLength = 128;
+  const vtkTypeInt64 blockSize = 8192;
+  const vtkTypeInt64 blocksPerBatch = 64;
+  std::vector<std::string> buffers(blocksPerBatch);
+  for (vtkTypeInt64 batchBegin = 0; batchBegin < numberOfRows; batchBegin += blockSize * blocksPerBatch)
+    {
+    const vtkTypeInt64 numberOfBlocks =
+      std::min(blocksPerBatch, (numberOfRows - batchBegin + blockSize - 1) / blockSize);
+    vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType beginBlock, vtkIdType endBlock)
+      {
+      for (vtkIdType block = beginBlock; block < endBlock; ++block)
+        {
+        const vtkTypeInt64 begin = batchBegin + block * blockSize;
+        const vtkTypeInt64 end = std::min(numberOfRows, begin + blockSize);
+        std::string& buffer = buffers[block];
+        buffer.resize((end - begin) * maximumRowLength);
+        char* out = &buffer[0];
+        for (vtkTypeInt64 row = begin; row < end; ++row)
+          {
+          if (row < numberOfPoints)
+            {
+            const float* point = &values.Points[3 * row];
+            out = AppendNumber(out, row);
+            out = AppendText(out, ",[");
+            out = AppendNumber(out, point[0]);
+            out = AppendText(out, ", ");
+            out = AppendNumber(out, point[1]);
+            out = AppendText(out, ", ");
+            out = AppendNumber(out, point[2]);
+            out = AppendText(out, "]\n");
+            }
+          else
+            {
+            const vtkTypeInt64 triangleId = row - numberOfPoints;
+            const vtkTypeInt64* triangle = &values.Triangles[3 * triangleId];
+            out = AppendNumber(out, triangleId);
+            for (int i = 0; i < 3; ++i)
+              {
+              *out++ = ',';
+              out = AppendNumber(out, triangle[i]);
+              }
+            out = AppendText(out, ",\n");
+            }
+          }
+        buffer.resize(out - &buffer[0]);
+        }
+      });
+    for (vtkTypeInt64 block = 0; block < numberOfBlocks; ++block)
+      {
+      file.write(buffers[block].data(), buffers[block].size());
+      }
+    }
+  return static_cast<bool>(file);
+}
+
+//----------------------------------------------------------------------------
+bool WriteMeshValuesRaw(const MeshValues& values, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  if (!file)
+    {
+    std::cerr << "Cannot write mesh values to " << fileName << std::endl;
+    return false;
+    }
+  const bool int32Indices = UseInt32Indices(values);
+  file.write("MESHVAL1", 8);
+  WriteLittleEndianValue(file, static_cast<std::uint64_t>(values.GetNumberOfPoints()));
+  WriteLittleEndianValue(file, static_cast<std::uint64_t>(values.GetNumberOfTriangles()));
+  WriteLittleEndianValue(file, static_cast<std::uint32_t>(sizeof(float)));
+  WriteLittleEndianValue(file, static_cast<std::uint32_t>(int32Indices ? 4 : 8));
+  WriteLittleEndian<float>(file, values.Points.data(), values.Points.size());
+  if (int32Indices)
+    {
+    WriteLittleEndian<vtkTypeInt32>(file, values.Triangles.data(), values.Triangles.size());
+    }
+  else
+    {
+    WriteLittleEndian<vtkTypeInt64>(file, values.Triangles.data(), values.Triangles.size());
+    }
+  return static_cast<bool>(file);
+}
+
+//----------------------------------------------------------------------------
+bool WritePointsNpy(const MeshValues& values, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  if (!file)
+    {
+    std::cerr << "Cannot write points to " << fileName << std::endl;
+    return false;
+    }
+  WriteNpyHeader(file, "<f4", values.GetNumberOfPoints());
+  WriteLittleEndian<float>(file, values.Points.data(), values.Points.size());
+  return static_cast<bool>(file);
+}
+
+//----------------------------------------------------------------------------
+bool WriteTrianglesNpy(const MeshValues& values, const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  if (!file)
+    {
+    std::cerr << "Cannot write triangles to " << fileName << std::endl;
+    return false;
+    }
+  if (UseInt32Indices(values))
+    {
+    WriteNpyHeader(file, "<i4", values.GetNumberOfTriangles());
+    WriteLittleEndian<vtkTypeInt32>(file, values.Triangles.data(), values.Triangles.size());
+    }
+  else
+    {
+    WriteNpyHeader(file, "<i8", values.GetNumberOfTriangles());
+    WriteLittleEndian<vtkTypeInt64>(file, values.Triangles.data(), values.Triangles.size());
+    }
+  return static_cast<bool>(file);
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef SurfaceToolboxMeshValues_h
+#define SurfaceToolboxMeshValues_h
+
+// VTK includes
+#include "vtkType.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace SurfaceToolbox
+{
+
+/// Points and triangles of a mesh as flat arrays, as dumped by meshValues.
+struct MeshValues
+{
+  /// x, y, z of each point
+  std::vector<float> Points;
+  /// Three point ids per triangle
+  std::vector<vtkTypeInt64> Triangles;
+
+  vtkTypeInt64 GetNumberOfPoints() const { return static_cast<vtkTypeInt64>(this->Points.size() / 3); }
+  vtkTypeInt64 GetNumberOfTriangles() const { return static_cast<vtkTypeInt64>(this->Triangles.size() / 3); }
+};
+
+/// Write \a values as text: the number of points, one "id,[x, y, z]" line per
+/// point and one "id,i0,i1,i2," line per triangle. Blocks of lines are
+/// formatted in parallel with std::to_chars, which gives the shortest text
+/// that reads back to the same float, and written in order in large chunks.
+bool WriteMeshValuesCSV(const MeshValues& values, const std::string& fileName);
+
+/// Write \a values as raw little-endian arrays after a 32 byte header:
+///   char[8]  "MESHVAL1"
+///   uint64   number of points
+///   uint64   number of triangles
+///   uint32   bytes per coordinate (4, float32)
+///   uint32   bytes per point id (4, int32, if the ids fit, otherwise 8, int64)
+/// followed by the x, y, z of the points and the point ids of the triangles.
+bool WriteMeshValuesRaw(const MeshValues& values, const std::string& fileName);
+
+/// Write the points of \a values as a NumPy .npy file of shape (n, 3) and
+/// type float32, which numpy.load can read or memory-map.
+bool WritePointsNpy(const MeshValues& values, const std::string& fileName);
+
+/// Write the triangles of \a values as a NumPy .npy file of shape (n, 3) and
+/// type int32 if the point ids fit, int64 otherwise.
+bool WriteTrianglesNpy(const MeshValues& values, const std::string& fileName);
+
+}
+
+#endif
@@ -0,0 +1,649 @@
+#include "SurfaceToolboxNormals.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxTopology.h"
+
+// VTK includes
+#include "vtkAbstractArray.h"
+#include "vtkCellArray.h"
+#include "vtkDataArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Traversal frontiers smaller than this are processed by the calling thread
+const vtkIdType MinimumParallelFrontier = 1024;
+
+//----------------------------------------------------------------------------
+// 1 if \a face has the edge a -> b, -1 if it has the edge b -> a, 0 otherwise.
+int GetEdgeDirection(const SurfaceToolbox::SurfaceTopology& topology, vtkIdType face, vtkIdType a, vtkIdType b)
+{
+  const vtkIdType first = topology.FaceOffsets[face];
+  const vtkIdType size = topology.FaceOffsets[face + 1] - first;
+  for (vtkIdType i = 0; i < size; ++i)
+    {
+    const vtkIdType p = topology.FaceConnectivity[first + i];
+    const vtkIdType q = topology.FaceConnectivity[first + (i + 1) % size];
+    if (p == a && q == b)
+      {
+      return 1;
+      }
+    if (p == b && q == a)
+      {
+      return -1;
+      }
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+// Decide which faces to reverse so that neighbors across manifold edges have
+// opposite edge directions, traversing each connected component from its
+// first face. The faces of a traversal frontier are processed in parallel;
+// each face is claimed by the first frontier face reaching it. Returns the
+// number of components and fills the component of each face.
+vtkIdType OrientFaces(const SurfaceToolbox::SurfaceTopology& topology, std::vector<unsigned char>& reversed,
+                      std::vector<vtkIdType>& faceComponent)
+{
+  const vtkIdType numberOfFaces = topology.GetNumberOfFaces();
+  reversed.assign(numberOfFaces, 0);
+  std::vector<std::atomic<vtkIdType>> component(numberOfFaces);
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType face = begin; face < end; ++face)
+      {
+      component[face].store(-1, std::memory_order_relaxed);
+      }
+    });
+
+  std::vector<vtkIdType> frontier(numberOfFaces);
+  std::vector<vtkIdType> nextFrontier(numberOfFaces);
+  vtkIdType numberOfComponents = 0;
+  for (vtkIdType seed = 0; seed < numberOfFaces; ++seed)
+    {
+    if (component[seed].load(std::memory_order_relaxed) >= 0)
+      {
+      continue;
+      }
+    const vtkIdType componentId = numberOfComponents++;
+    component[seed].store(componentId, std::memory_order_relaxed);
+    frontier[0] = seed;
+    vtkIdType frontierSize = 1;
+    while (frontierSize > 0)
+      {
+      std::atomic<vtkIdType> nextFrontierSize(0);
+      auto visit = [&](vtkIdType begin, vtkIdType end)
+        {
+        for (vtkIdType i = begin; i < end; ++i)
+          {
+          const vtkIdType face = frontier[i];
+          const bool forward = !reversed[face];
+          const vtkIdType first = topology.FaceOffsets[face];
+          const vtkIdType size = topology.FaceOffsets[face + 1] - first;
+          for (vtkIdType j = 0; j < size; ++j)
+            {
+            const vtkIdType a = topology.FaceConnectivity[first + j];
+            const vtkIdType b = topology.FaceConnectivity[first + (j + 1) % size];
+            // The edge is manifold if exactly one other face uses it
+            vtkIdType neighbor = -1;
+            int direction = 0;
+            int numberOfNeighbors = 0;
+            for (vtkIdType k = topology.LinkOffsets[a]; k < topology.LinkOffsets[a + 1]; ++k)
+              {
+              const vtkIdType other = topology.Links[k];
+              if (other == face || (k > topology.LinkOffsets[a] && topology.Links[k - 1] == other))
+                {
+                continue;
+                }
+              const int otherDirection = GetEdgeDirection(topology, other, a, b);
+              if (otherDirection != 0)
+                {
+                neighbor = other;
+                direction = otherDirection;
+                ++numberOfNeighbors;
+                }
+              }
+            if (numberOfNeighbors != 1)
+              {
+              continue;
+              }
+            vtkIdType expected = -1;
+            if (component[neighbor].compare_exchange_strong(expected, componentId, std::memory_order_relaxed))
+              {
+              // Consistent neighbors use the edge in opposite directions
+              reversed[neighbor] = (direction > 0) == forward;
+              nextFrontier[nextFrontierSize++] = neighbor;
+              }
+            }
+          }
+        };
+      if (frontierSize < MinimumParallelFrontier)
+        {
+        visit(0, frontierSize);
+        }
+      else
+        {
+        vtkSMPTools::For(0, frontierSize, visit);
+        }
+      frontier.swap(nextFrontier);
+      frontierSize = nextFrontierSize;
+      }
+    }
+
+  faceComponent.resize(numberOfFaces);
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType face = begin; face < end; ++face)
+      {
+      faceComponent[face] = component[face].load(std::memory_order_relaxed);
+      }
+    });
+  return numberOfComponents;
+}
+
+//----------------------------------------------------------------------------
+// Normal of each face, in its output order, with a length of twice its area
+// (Newell's method, which handles non-planar polygons).
+void ComputeFaceNormals(const SurfaceToolbox::SurfaceTopology& topology, const std::vector<double>& coordinates,
+                        const std::vector<unsigned char>& reversed, std::vector<double>& faceNormals)
+{
+  const vtkIdType numberOfFaces = topology.GetNumberOfFaces();
+  faceNormals.resize(3 * numberOfFaces);
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType face = begin; face < end; ++face)
+      {
+      const vtkIdType first = topology.FaceOffsets[face];
+      const vtkIdType size = topology.FaceOffsets[face + 1] - first;
+      double normal[3] = { 0.0, 0.0, 0.0 };
+      for (vtkIdType i = 0; i < size; ++i)
+        {
+        const double* p = &coordinates[3 * topology.FaceConnectivity[first + i]];
+        const double* q = &coordinates[3 * topology.FaceConnectivity[first + (i + 1) % size]];
+        normal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+        normal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+        normal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+        }
+      const double sign = reversed[face] ? -1.0 : 1.0;
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        faceNormals[3 * face + axis] = sign * normal[axis];
+        }
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+// Reverse the components whose normal at their point of largest x points
+// towards -x: this point is on the convex hull, where the outside is +x.
+void OrientComponentsOutwards(const SurfaceToolbox::SurfaceTopology& topology, const std::vector<double>& coordinates,
+                              vtkIdType numberOfComponents, const std::vector<vtkIdType>& faceComponent,
+                              std::vector<unsigned char>& reversed, std::vector<double>& faceNormals)
+{
+  const vtkIdType numberOfFaces = topology.GetNumberOfFaces();
+  std::vector<vtkIdType> extremePoint(numberOfComponents, -1);
+  for (vtkIdType face = 0; face < numberOfFaces; ++face)
+    {
+    vtkIdType& pointId = extremePoint[faceComponent[face]];
+    for (vtkIdType j = topology.FaceOffsets[face]; j < topology.FaceOffsets[face + 1]; ++j)
+      {
+      const vtkIdType candidate = topology.FaceConnectivity[j];
+      if (pointId < 0 || coordinates[3 * candidate] > coordinates[3 * pointId])
+        {
+        pointId = candidate;
+        }
+      }
+    }
+
+  std::vector<unsigned char> reverseComponent(numberOfComponents, 0);
+  vtkSMPTools::For(0, numberOfComponents, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType componentId = begin; componentId < end; ++componentId)
+      {
+      const vtkIdType pointId = extremePoint[componentId];
+      double normalX = 0.0;
+      for (vtkIdType k = topology.LinkOffsets[pointId]; k < topology.LinkOffsets[pointId + 1]; ++k)
+        {
+        const vtkIdType face = topology.Links[k];
+        if (faceComponent[face] == componentId)
+          {
+          normalX += faceNormals[3 * face];
+          }
+        }
+      reverseComponent[componentId] = normalX < 0.0;
+      }
+    });
+
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType face = begin; face < end; ++face)
+      {
+      if (reverseComponent[faceComponent[face]])
+        {
+        reversed[face] = !reversed[face];
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          faceNormals[3 * face + axis] = -faceNormals[3 * face + axis];
+          }
+        }
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+// Faces around a point, with the points before and after it in their output
+// order, split into groups across sharp or non-manifold edges.
+class PointFan
+{
+public:
+  void Build(const SurfaceToolbox::SurfaceTopology& topology, const std::vector<unsigned char>& reversed,
+             vtkIdType pointId)
+  {
+    this->Faces.clear();
+    this->Previous.clear();
+    this->Next.clear();
+    for (vtkIdType k = topology.LinkOffsets[pointId]; k < topology.LinkOffsets[pointId + 1]; ++k)
+      {
+      const vtkIdType face = topology.Links[k];
+      if (!this->Faces.empty() && this->Faces.back() == face)
+        {
+        continue;
+        }
+      const vtkIdType first = topology.FaceOffsets[face];
+      const vtkIdType size = topology.FaceOffsets[face + 1] - first;
+      vtkIdType corner = 0;
+      while (topology.FaceConnectivity[first + corner] != pointId)
+        {
+        ++corner;
+        }
+      vtkIdType previous = topology.FaceConnectivity[first + (corner + size - 1) % size];
+      vtkIdType next = topology.FaceConnectivity[first + (corner + 1) % size];
+      if (reversed[face])
+        {
+        std::swap(previous, next);
+        }
+      this->Faces.push_back(face);
+      this->Previous.push_back(previous);
+      this->Next.push_back(next);
+      }
+  }
+
+  // Group the faces joined by manifold edges where their normals differ by
+  // less than the feature angle. Group 0 holds the first face. Returns the
+  // number of groups.
+  int Split(const std::vector<double>& faceNormals, double cosFeatureAngle)
+  {
+    const int numberOfFaces = static_cast<int>(this->Faces.size());
+    this->Group.resize(numberOfFaces);
+    for (int i = 0; i < numberOfFaces; ++i)
+      {
+      this->Group[i] = i;
+      }
+    auto find = [&](int i)
+      {
+      while (this->Group[i] != i)
+        {
+        i = this->Group[i] = this->Group[this->Group[i]];
+        }
+      return i;
+      };
+    // Faces sharing an edge are found by sorting the neighbors of the point
+    // they use; the edge is manifold if exactly two faces use it.
+    this->Edges.clear();
+    for (int i = 0; i < numberOfFaces; ++i)
+      {
+      this->Edges.emplace_back(this->Previous[i], i);
+      this->Edges.emplace_back(this->Next[i], i);
+      }
+    std::sort(this->Edges.begin(), this->Edges.end());
+    for (size_t first = 0; first < this->Edges.size(); )
+      {
+      size_t last = first + 1;
+      while (last < this->Edges.size() && this->Edges[last].first == this->Edges[first].first)
+        {
+        ++last;
+        }
+      const int i = this->Edges[first].second;
+      const int j = this->Edges[last - 1].second;
+      if (last - first == 2 && i != j)
+        {
+        const double* ni = &faceNormals[3 * this->Faces[i]];
+        const double* nj = &faceNormals[3 * this->Faces[j]];
+        const double lengths = vtkMath::Norm(ni) * vtkMath::Norm(nj);
+        if (lengths > 0.0 && vtkMath::Dot(ni, nj) >= cosFeatureAngle * lengths)
+          {
+          const int root = find(i);
+          const int otherRoot = find(j);
+          this->Group[std::max(root, otherRoot)] = std::min(root, otherRoot);
+          }
+        }
+      first = last;
+      }
+    // Number the groups in order of their first face
+    int numberOfGroups = 0;
+    std::vector<int>& groupIndex = this->GroupIndex;
+    groupIndex.assign(numberOfFaces, -1);
+    for (int i = 0; i < numberOfFaces; ++i)
+      {
+      const int root = find(i);
+      if (groupIndex[root] < 0)
+        {
+        groupIndex[root] = numberOfGroups++;
+        }
+      }
+    for (int i = 0; i < numberOfFaces; ++i)
+      {
+      this->Group[i] = groupIndex[find(i)];
+      }
+    return numberOfGroups;
+  }
+
+  void SetSingleGroup()
+  {
+    this->Group.assign(this->Faces.size(), 0);
+  }
+
+  std::vector<vtkIdType> Faces;
+  std::vector<vtkIdType> Previous;
+  std::vector<vtkIdType> Next;
+  std::vector<int> Group;
+
+private:
+  std::vector<std::pair<vtkIdType, int>> Edges;
+  std::vector<int> GroupIndex;
+};
+
+//----------------------------------------------------------------------------
+// Copy of \a input with the tuples of sourceIds appended: tuple
+// numberOfTuples + i is a copy of tuple sourceIds[i]. The copy is allocated
+// once to its final size.
+vtkSmartPointer<vtkAbstractArray> AppendTuples(vtkAbstractArray* input, const std::vector<vtkIdType>& sourceIds)
+{
+  const vtkIdType numberOfTuples = input->GetNumberOfTuples();
+  const vtkIdType numberOfCopies = static_cast<vtkIdType>(sourceIds.size());
+  vtkSmartPointer<vtkAbstractArray> output = vtkSmartPointer<vtkAbstractArray>::Take(input->NewInstance());
+  output->SetName(input->GetName());
+  output->SetNumberOfComponents(input->GetNumberOfComponents());
+  output->SetNumberOfTuples(numberOfTuples + numberOfCopies);
+  output->InsertTuples(0, numberOfTuples, 0, input);
+  vtkSMPTools::For(0, numberOfCopies, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      output->SetTuple(numberOfTuples + i, sourceIds[i], input);
+      }
+    });
+  return output;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunParallelNormals(vtkPolyData* input, const NormalsParameters& parameters)
+{
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(input);
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  if (numberOfPoints == 0)
+    {
+    return output;
+    }
+
+  std::shared_ptr<const SurfaceTopology> topology = GetSurfaceTopology(input);
+  const SurfaceTopology& faces = *topology;
+  const vtkIdType numberOfFaces = faces.GetNumberOfFaces();
+  std::vector<double> coordinates;
+  GetPointCoordinates(input, coordinates);
+
+  std::vector<unsigned char> reversed;
+  std::vector<vtkIdType> faceComponent;
+  const vtkIdType numberOfComponents = OrientFaces(faces, reversed, faceComponent);
+  std::vector<double> faceNormals;
+  ComputeFaceNormals(faces, coordinates, reversed, faceNormals);
+  if (parameters.AutoOrient)
+    {
+    OrientComponentsOutwards(faces, coordinates, numberOfComponents, faceComponent, reversed, faceNormals);
+    }
+
+  // Group of each point-to-face link; every group but the first of a point
+  // gets a new point, numbered after the input points.
+  std::vector<int> linkGroup;
+  std::vector<vtkIdType> firstCopy(numberOfPoints + 1, 0);
+  if (parameters.Splitting)
+    {
+    const double cosFeatureAngle = std::cos(vtkMath::RadiansFromDegrees(parameters.FeatureAngle));
+    linkGroup.resize(faces.Links.size());
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      PointFan fan;
+      for (vtkIdType pointId = begin; pointId < end; ++pointId)
+        {
+        fan.Build(faces, reversed, pointId);
+        const int numberOfGroups = fan.Split(faceNormals, cosFeatureAngle);
+        firstCopy[pointId + 1] = std::max(0, numberOfGroups - 1);
+        size_t i = 0;
+        for (vtkIdType k = faces.LinkOffsets[pointId]; k < faces.LinkOffsets[pointId + 1]; ++k)
+          {
+          if (fan.Faces[i] != faces.Links[k])
+            {
+            ++i;
+            }
+          linkGroup[k] = fan.Group[i];
+          }
+        }
+      });
+    for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+      {
+      firstCopy[pointId + 1] += firstCopy[pointId];
+      }
+    }
+  const vtkIdType numberOfCopies = firstCopy[numberOfPoints];
+  const vtkIdType numberOfOutputPoints = numberOfPoints + numberOfCopies;
+  auto getOutputPointId = [&](vtkIdType pointId, int group)
+    {
+    return group == 0 ? pointId : numberOfPoints + firstCopy[pointId] + group - 1;
+    };
+
+  // Point normals: sum of the normals of the faces of each group, weighted by
+  // face area or by the angle of the face at the point.
+  const bool angleWeighting = parameters.Weighting == "Angle";
+  vtkNew<vtkFloatArray> normals;
+  normals->SetName("Normals");
+  normals->SetNumberOfComponents(3);
+  normals->SetNumberOfTuples(numberOfOutputPoints);
+  float* normalValues = normals->GetPointer(0);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    PointFan fan;
+    std::vector<double> sums;
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      fan.Build(faces, reversed, pointId);
+      int numberOfGroups = 1;
+      if (parameters.Splitting)
+        {
+        fan.Group.resize(fan.Faces.size());
+        size_t i = 0;
+        for (vtkIdType k = faces.LinkOffsets[pointId]; k < faces.LinkOffsets[pointId + 1]; ++k)
+          {
+          if (fan.Faces[i] != faces.Links[k])
+            {
+            ++i;
+            }
+          fan.Group[i] = linkGroup[k];
+          }
+        numberOfGroups = static_cast<int>(firstCopy[pointId + 1] - firstCopy[pointId]) + 1;
+        }
+      else
+        {
+        fan.SetSingleGroup();
+        }
+      sums.assign(3 * numberOfGroups, 0.0);
+      const double* point = &coordinates[3 * pointId];
+      for (size_t i = 0; i < fan.Faces.size(); ++i)
+        {
+        const double* faceNormal = &faceNormals[3 * fan.Faces[i]];
+        double weight = 1.0;
+        if (angleWeighting)
+          {
+          const double length = vtkMath::Norm(faceNormal);
+          double toPrevious[3];
+          double toNext[3];
+          vtkMath::Subtract(&coordinates[3 * fan.Previous[i]], point, toPrevious);
+          vtkMath::Subtract(&coordinates[3 * fan.Next[i]], point, toNext);
+          weight = length > 0.0 ? vtkMath::AngleBetweenVectors(toPrevious, toNext) / length : 0.0;
+          }
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          sums[3 * fan.Group[i] + axis] += weight * faceNormal[axis];
+          }
+        }
+      for (int group = 0; group < numberOfGroups; ++group)
+        {
+        double* normal = &sums[3 * group];
+        vtkMath::Normalize(normal);
+        float* outputNormal = normalValues + 3 * getOutputPointId(pointId, group);
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          outputNormal[axis] = static_cast<float>(parameters.Flip ? -normal[axis] : normal[axis]);
+          }
+        }
+      }
+    });
+
+  // Flip reverses all the faces: the ones not reversed by the orientation
+  bool reorderFaces = parameters.Flip || numberOfCopies > 0;
+  for (vtkIdType face = 0; face < numberOfFaces && !reorderFaces; ++face)
+    {
+    reorderFaces = reversed[face] != 0;
+    }
+  if (reorderFaces)
+    {
+    vtkNew<vtkIdTypeArray> offsets;
+    offsets->SetNumberOfValues(numberOfFaces + 1);
+    std::copy(faces.FaceOffsets.begin(), faces.FaceOffsets.end(), offsets->GetPointer(0));
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->SetNumberOfValues(faces.FaceOffsets[numberOfFaces]);
+    vtkIdType* faceConnectivity = connectivity->GetPointer(0);
+    vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType face = begin; face < end; ++face)
+        {
+        const vtkIdType first = faces.FaceOffsets[face];
+        const vtkIdType size = faces.FaceOffsets[face + 1] - first;
+        const bool reverse = (reversed[face] != 0) != parameters.Flip;
+        for (vtkIdType i = 0; i < size; ++i)
+          {
+          vtkIdType pointId = faces.FaceConnectivity[first + i];
+          if (numberOfCopies > 0)
+            {
+            vtkIdType k = faces.LinkOffsets[pointId];
+            while (faces.Links[k] != face)
+              {
+              ++k;
+              }
+            pointId = getOutputPointId(pointId, linkGroup[k]);
+            }
+          faceConnectivity[first + (reverse ? size - 1 - i : i)] = pointId;
+          }
+        }
+      });
+    vtkNew<vtkCellArray> polys;
+    polys->SetData(offsets, connectivity);
+    output->SetPolys(polys);
+    }
+
+  if (numberOfCopies > 0)
+    {
+    std::vector<vtkIdType> sourceIds(numberOfCopies);
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType pointId = begin; pointId < end; ++pointId)
+        {
+        std::fill(sourceIds.begin() + firstCopy[pointId], sourceIds.begin() + firstCopy[pointId + 1], pointId);
+        }
+      });
+    vtkNew<vtkPoints> points;
+    points->SetData(vtkDataArray::SafeDownCast(AppendTuples(input->GetPoints()->GetData(), sourceIds)));
+    output->SetPoints(points);
+
+    vtkPointData* inputPointData = input->GetPointData();
+    vtkPointData* outputPointData = output->GetPointData();
+    outputPointData->Initialize();
+    for (int arrayIndex = 0; arrayIndex < inputPointData->GetNumberOfArrays(); ++arrayIndex)
+      {
+      vtkAbstractArray* inputArray = inputPointData->GetAbstractArray(arrayIndex);
+      vtkSmartPointer<vtkAbstractArray> outputArray = AppendTuples(inputArray, sourceIds);
+      outputPointData->AddArray(outputArray);
+      for (int attribute = 0; attribute < vtkDataSetAttributes::NUM_ATTRIBUTES; ++attribute)
+        {
+        if (inputPointData->GetAbstractAttribute(attribute) == inputArray)
+          {
+          outputPointData->SetActiveAttribute(outputPointData->GetNumberOfArrays() - 1, attribute);
+          }
+        }
+      }
+    }
+  output->GetPointData()->SetNormals(normals);
+  if (!reorderFaces)
+    {
+    PassSurfaceTopology(input, output);
+    }
+  return output;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkCellArray> GetConsistentPolygons(vtkPolyData* input)
+{
+  std::shared_ptr<const SurfaceTopology> topology = GetSurfaceTopology(input);
+  const SurfaceTopology& faces = *topology;
+  const vtkIdType numberOfFaces = faces.GetNumberOfFaces();
+  std::vector<unsigned char> reversed;
+  std::vector<vtkIdType> faceComponent;
+  OrientFaces(faces, reversed, faceComponent);
+  if (std::find(reversed.begin(), reversed.end(), 1) == reversed.end())
+    {
+    return input->GetPolys();
+    }
+
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(numberOfFaces + 1);
+  std::copy(faces.FaceOffsets.begin(), faces.FaceOffsets.end(), offsets->GetPointer(0));
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(faces.FaceOffsets[numberOfFaces]);
+  vtkIdType* faceConnectivity = connectivity->GetPointer(0);
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType face = begin; face < end; ++face)
+      {
+      const vtkIdType first = faces.FaceOffsets[face];
+      const vtkIdType size = faces.FaceOffsets[face + 1] - first;
+      for (vtkIdType i = 0; i < size; ++i)
+        {
+        faceConnectivity[first + (reversed[face] ? size - 1 - i : i)] = faces.FaceConnectivity[first + i];
+        }
+      }
+    });
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  polys->SetData(offsets, connectivity);
+  return polys;
+}
+
+}
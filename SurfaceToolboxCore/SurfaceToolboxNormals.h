@@ -0,0 +1,40 @@
+#ifndef SurfaceToolboxNormals_h
+#define SurfaceToolboxNormals_h
+
+#include "SurfaceToolboxStages.h"
+
+class vtkCellArray;
+
+namespace SurfaceToolbox
+{
+
+/// Multi-threaded point normals with consistent polygon ordering, equivalent
+/// to vtkPolyDataNormals on surfaces without triangle strips.
+///
+/// Polygons are reordered consistently with their neighbors across manifold
+/// edges, one connected component at a time from its first polygon, by a
+/// breadth-first traversal whose frontiers are processed in parallel. With
+/// AutoOrient, each component is then reversed if needed so that the normal
+/// at its point of largest x points towards +x, which orients closed surfaces
+/// outwards. Face normals are computed in parallel, and point normals are the
+/// sum of the normals of the faces around the point weighted by face area or
+/// by the angle of the face at the point (Weighting).
+///
+/// With Splitting, the faces around each point are grouped across the edges
+/// that are manifold and not sharper than FeatureAngle, and every group but
+/// the first gets a copy of the point. The copies are appended after the
+/// input points, whose arrays are allocated once to their final size.
+///
+/// Vertices, lines, and the point and cell data of the input are passed to
+/// the output. The input polygons are shared with the output if none is
+/// reordered or split.
+vtkSmartPointer<vtkPolyData> RunParallelNormals(vtkPolyData* input, const NormalsParameters& parameters);
+
+/// Polygons of \a input reordered consistently with their neighbors, as
+/// RunParallelNormals reorders them without AutoOrient, or the polygons of
+/// \a input if none is reversed. \a input must not have triangle strips.
+vtkSmartPointer<vtkCellArray> GetConsistentPolygons(vtkPolyData* input);
+
+}
+
+#endif
@@ -0,0 +1,560 @@
+#include "SurfaceToolboxPieces.h"
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxXMLWriter.h"
+
+// VTK includes
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+const int NumberOfCellTypes = 4;
+
+// Attributes that can be named in the summary file, in
+// vtkDataSetAttributes::AttributeTypes order
+const char* AttributeNames[] = { "Scalars", "Vectors", "Normals", "TCoords", "Tensors" };
+
+//----------------------------------------------------------------------------
+std::string GetPieceFileName(const std::string& name, int piece)
+{
+  std::ostringstream pieceFileName;
+  pieceFileName << name << "/" << name << "_" << piece << ".vtp";
+  return pieceFileName.str();
+}
+
+//----------------------------------------------------------------------------
+std::string UnescapeXML(const std::string& text)
+{
+  const char* entities[][2] = { { "&lt;", "<" }, { "&gt;", ">" }, { "&quot;", "\"" }, { "&apos;", "'" }, { "&amp;", "&" } };
+  std::string unescaped = text;
+  for (const auto& entity : entities)
+    {
+    const std::string from = entity[0];
+    for (size_t position = unescaped.find(from); position != std::string::npos;
+         position = unescaped.find(from, position + 1))
+      {
+      unescaped.replace(position, from.size(), entity[1]);
+      }
+    }
+  return unescaped;
+}
+
+//----------------------------------------------------------------------------
+void WriteDataArrayHeader(std::ostream& output, vtkAbstractArray* array, const char* indent)
+{
+  output << indent << "<PDataArray type=\"" << SurfaceToolbox::GetXMLTypeName(array) << "\"";
+  if (array->GetDataType() == VTK_ID_TYPE)
+    {
+    output << " IdType=\"1\"";
+    }
+  if (array->GetName())
+    {
+    output << " Name=\"" << SurfaceToolbox::EscapeXML(array->GetName()) << "\"";
+    }
+  if (array->GetNumberOfComponents() > 1)
+    {
+    output << " NumberOfComponents=\"" << array->GetNumberOfComponents() << "\"";
+    }
+  output << "/>\n";
+}
+
+//----------------------------------------------------------------------------
+void WriteDataHeaders(std::ostream& output, vtkDataSetAttributes* data, const char* element,
+                      vtkAbstractArray* pointIds)
+{
+  output << "    <" << element;
+  for (int attribute = 0; attribute < 5; ++attribute)
+    {
+    vtkAbstractArray* array = data->GetAttribute(attribute);
+    if (array && array->GetName())
+      {
+      output << " " << AttributeNames[attribute] << "=\"" << SurfaceToolbox::EscapeXML(array->GetName()) << "\"";
+      }
+    }
+  output << ">\n";
+  for (int i = 0; i < data->GetNumberOfArrays(); ++i)
+    {
+    WriteDataArrayHeader(output, data->GetAbstractArray(i), "      ");
+    }
+  if (pointIds)
+    {
+    WriteDataArrayHeader(output, pointIds, "      ");
+    }
+  output << "    </" << element << ">\n";
+}
+
+//----------------------------------------------------------------------------
+bool WriteSummaryFile(vtkPolyData* polyData, const std::string& fileName, const std::string& name,
+                      int numberOfPieces)
+{
+  std::ofstream output(fileName.c_str());
+  vtkNew<vtkIdTypeArray> pointIds;
+  pointIds->SetName(SurfaceToolbox::PiecePointIdsArrayName);
+  output << "<?xml version=\"1.0\"?>\n"
+#ifdef VTK_WORDS_BIGENDIAN
+         << "<VTKFile type=\"PPolyData\" version=\"1.0\" byte_order=\"BigEndian\" header_type=\"UInt64\">\n"
+#else
+         << "<VTKFile type=\"PPolyData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+#endif
+         << "  <PPolyData GhostLevel=\"0\">\n";
+  WriteDataHeaders(output, polyData->GetPointData(), "PPointData", pointIds);
+  WriteDataHeaders(output, polyData->GetCellData(), "PCellData", nullptr);
+  output << "    <PPoints>\n";
+  if (polyData->GetPoints())
+    {
+    WriteDataArrayHeader(output, polyData->GetPoints()->GetData(), "      ");
+    }
+  output << "    </PPoints>\n";
+  for (int piece = 0; piece < numberOfPieces; ++piece)
+    {
+    output << "    <Piece Source=\"" << SurfaceToolbox::EscapeXML(GetPieceFileName(name, piece)) << "\"/>\n";
+    }
+  output << "  </PPolyData>\n"
+         << "</VTKFile>\n";
+  output.close();
+  return static_cast<bool>(output);
+}
+
+//----------------------------------------------------------------------------
+// Piece files listed in a summary file, relative to its directory
+bool ReadSummaryFile(const std::string& fileName, std::vector<std::string>& pieceFileNames)
+{
+  std::ifstream input(fileName.c_str());
+  if (!input)
+    {
+    return false;
+    }
+  std::stringstream content;
+  content << input.rdbuf();
+  const std::string text = content.str();
+  if (text.find("PPolyData") == std::string::npos)
+    {
+    return false;
+    }
+  pieceFileNames.clear();
+  for (size_t position = text.find("<Piece"); position != std::string::npos; position = text.find("<Piece", position + 1))
+    {
+    const size_t end = text.find('>', position);
+    const size_t source = text.find("Source=\"", position);
+    if (end == std::string::npos || source == std::string::npos || source > end)
+      {
+      return false;
+      }
+    const size_t first = source + 8;
+    pieceFileNames.push_back(UnescapeXML(text.substr(first, text.find('"', first) - first)));
+    }
+  return !pieceFileNames.empty();
+}
+
+//----------------------------------------------------------------------------
+// Piece \a piece of \a polyData, whose cells are given by \a offsets and
+// \a connectivity (see GetCells) with the cells of type t starting at
+// firstCellIds[t]. The piece has the range of cells and the range of points
+// of its index, plus the other points used by these cells, and the original
+// ids of its points.
+vtkSmartPointer<vtkPolyData> ExtractPiece(vtkPolyData* polyData, const std::vector<vtkIdType>& offsets,
+                                          const std::vector<vtkIdType>& connectivity,
+                                          const vtkIdType firstCellIds[NumberOfCellTypes + 1], int piece,
+                                          int numberOfPieces)
+{
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  const vtkIdType numberOfCells = firstCellIds[NumberOfCellTypes];
+  const vtkIdType firstPoint = numberOfPoints * piece / numberOfPieces;
+  const vtkIdType lastPoint = numberOfPoints * (piece + 1) / numberOfPieces;
+  const vtkIdType firstCell = numberOfCells * piece / numberOfPieces;
+  const vtkIdType lastCell = numberOfCells * (piece + 1) / numberOfPieces;
+
+  // Points of the range first, then the other points used by the cells
+  std::vector<vtkIdType> otherPoints;
+  for (vtkIdType i = offsets[firstCell]; i < offsets[lastCell]; ++i)
+    {
+    if (connectivity[i] < firstPoint || connectivity[i] >= lastPoint)
+      {
+      otherPoints.push_back(connectivity[i]);
+      }
+    }
+  std::sort(otherPoints.begin(), otherPoints.end());
+  otherPoints.erase(std::unique(otherPoints.begin(), otherPoints.end()), otherPoints.end());
+  const vtkIdType numberOfRangePoints = lastPoint - firstPoint;
+  const vtkIdType numberOfPiecePoints = numberOfRangePoints + static_cast<vtkIdType>(otherPoints.size());
+  auto getPointId = [&](vtkIdType localId)
+    {
+    return localId < numberOfRangePoints ? firstPoint + localId : otherPoints[localId - numberOfRangePoints];
+    };
+  auto getLocalId = [&](vtkIdType pointId)
+    {
+    if (pointId >= firstPoint && pointId < lastPoint)
+      {
+      return pointId - firstPoint;
+      }
+    return numberOfRangePoints
+      + static_cast<vtkIdType>(std::lower_bound(otherPoints.begin(), otherPoints.end(), pointId) - otherPoints.begin());
+    };
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  if (polyData->GetPoints())
+    {
+    vtkNew<vtkPoints> points;
+    points->SetDataType(polyData->GetPoints()->GetDataType());
+    points->SetNumberOfPoints(numberOfPiecePoints);
+    for (vtkIdType i = 0; i < numberOfPiecePoints; ++i)
+      {
+      points->GetData()->SetTuple(i, getPointId(i), polyData->GetPoints()->GetData());
+      }
+    output->SetPoints(points);
+    }
+  vtkPointData* outputPointData = output->GetPointData();
+  outputPointData->CopyAllocate(polyData->GetPointData(), numberOfPiecePoints);
+  for (vtkIdType i = 0; i < numberOfPiecePoints; ++i)
+    {
+    outputPointData->CopyData(polyData->GetPointData(), getPointId(i), i);
+    }
+  vtkNew<vtkIdTypeArray> pointIds;
+  pointIds->SetName(SurfaceToolbox::PiecePointIdsArrayName);
+  pointIds->SetNumberOfValues(numberOfPiecePoints);
+  for (vtkIdType i = 0; i < numberOfPiecePoints; ++i)
+    {
+    pointIds->SetValue(i, getPointId(i));
+    }
+  outputPointData->AddArray(pointIds);
+
+  vtkSmartPointer<vtkCellArray> cellArrays[NumberOfCellTypes];
+  for (int type = 0; type < NumberOfCellTypes; ++type)
+    {
+    const vtkIdType first = std::max(firstCell, firstCellIds[type]);
+    const vtkIdType last = std::max(first, std::min(lastCell, firstCellIds[type + 1]));
+    vtkNew<vtkIdTypeArray> cellOffsets;
+    cellOffsets->SetNumberOfValues(last - first + 1);
+    for (vtkIdType cellId = first; cellId <= last; ++cellId)
+      {
+      cellOffsets->SetValue(cellId - first, offsets[cellId] - offsets[first]);
+      }
+    vtkNew<vtkIdTypeArray> cellConnectivity;
+    cellConnectivity->SetNumberOfValues(offsets[last] - offsets[first]);
+    for (vtkIdType i = offsets[first]; i < offsets[last]; ++i)
+      {
+      cellConnectivity->SetValue(i - offsets[first], getLocalId(connectivity[i]));
+      }
+    cellArrays[type] = vtkSmartPointer<vtkCellArray>::New();
+    cellArrays[type]->SetData(cellOffsets, cellConnectivity);
+    }
+  output->SetVerts(cellArrays[0]);
+  output->SetLines(cellArrays[1]);
+  output->SetPolys(cellArrays[2]);
+  output->SetStrips(cellArrays[3]);
+
+  vtkCellData* outputCellData = output->GetCellData();
+  outputCellData->CopyAllocate(polyData->GetCellData(), lastCell - firstCell);
+  for (vtkIdType cellId = firstCell; cellId < lastCell; ++cellId)
+    {
+    outputCellData->CopyData(polyData->GetCellData(), cellId, cellId - firstCell);
+    }
+  output->GetFieldData()->ShallowCopy(polyData->GetFieldData());
+  return output;
+}
+
+//----------------------------------------------------------------------------
+// Pieces without the original point ids are appended as they are.
+vtkSmartPointer<vtkPolyData> AppendPieces(const std::vector<vtkSmartPointer<vtkPolyData>>& pieces)
+{
+  vtkNew<vtkAppendPolyData> append;
+  for (vtkPolyData* piece : pieces)
+    {
+    append->AddInputData(piece);
+    }
+  append->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(append->GetOutput());
+  return output;
+}
+
+//----------------------------------------------------------------------------
+// Assemble pieces written by WritePolyDataPieces: every point is copied once
+// to its original id, and the cells of each type are concatenated in piece
+// order.
+vtkSmartPointer<vtkPolyData> AssemblePieces(const std::vector<vtkSmartPointer<vtkPolyData>>& pieces)
+{
+  const vtkIdType numberOfPieces = static_cast<vtkIdType>(pieces.size());
+  vtkPolyData* firstPiece = pieces[0];
+  std::vector<vtkIdTypeArray*> pointIds(numberOfPieces, nullptr);
+  std::vector<vtkIdType> numberOfPointsOfPieces(numberOfPieces, -1);
+  std::vector<std::vector<vtkIdType>> offsets(numberOfPieces);
+  std::vector<std::vector<vtkIdType>> connectivity(numberOfPieces);
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType piece = begin; piece < end; ++piece)
+      {
+      vtkPolyData* polyData = pieces[piece];
+      vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(
+        polyData->GetPointData()->GetAbstractArray(SurfaceToolbox::PiecePointIdsArrayName));
+      if (!ids || ids->GetNumberOfComponents() != 1 || ids->GetNumberOfTuples() != polyData->GetNumberOfPoints()
+          || polyData->GetPointData()->GetNumberOfArrays() != firstPiece->GetPointData()->GetNumberOfArrays()
+          || polyData->GetCellData()->GetNumberOfArrays() != firstPiece->GetCellData()->GetNumberOfArrays())
+        {
+        continue;
+        }
+      vtkIdType numberOfPoints = 0;
+      for (vtkIdType i = 0; i < ids->GetNumberOfTuples() && numberOfPoints >= 0; ++i)
+        {
+        numberOfPoints = ids->GetValue(i) < 0 ? -1 : std::max(numberOfPoints, ids->GetValue(i) + 1);
+        }
+      pointIds[piece] = ids;
+      numberOfPointsOfPieces[piece] = numberOfPoints;
+      SurfaceToolbox::GetCells(polyData, offsets[piece], connectivity[piece]);
+      }
+    });
+  if (std::find(numberOfPointsOfPieces.begin(), numberOfPointsOfPieces.end(), -1) != numberOfPointsOfPieces.end())
+    {
+    return AppendPieces(pieces);
+    }
+  const vtkIdType numberOfPoints = *std::max_element(numberOfPointsOfPieces.begin(), numberOfPointsOfPieces.end());
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetDataType(firstPiece->GetPoints() ? firstPiece->GetPoints()->GetDataType() : VTK_FLOAT);
+  points->SetNumberOfPoints(numberOfPoints);
+  vtkPointData* outputPointData = output->GetPointData();
+  outputPointData->CopyAllocate(firstPiece->GetPointData(), numberOfPoints);
+  const int numberOfPointArrays = outputPointData->GetNumberOfArrays();
+  for (int i = 0; i < numberOfPointArrays; ++i)
+    {
+    outputPointData->GetAbstractArray(i)->SetNumberOfTuples(numberOfPoints);
+    }
+
+  // Cells of each type, in piece order
+  std::vector<vtkIdType> firstCellIds[NumberOfCellTypes];
+  std::vector<vtkIdType> firstConnectivityIds[NumberOfCellTypes];
+  vtkIdType firstCellIdOfType[NumberOfCellTypes + 1] = { 0 };
+  vtkSmartPointer<vtkIdTypeArray> cellOffsets[NumberOfCellTypes];
+  vtkSmartPointer<vtkIdTypeArray> cellConnectivity[NumberOfCellTypes];
+  for (int type = 0; type < NumberOfCellTypes; ++type)
+    {
+    firstCellIds[type].assign(numberOfPieces + 1, 0);
+    firstConnectivityIds[type].assign(numberOfPieces + 1, 0);
+    for (vtkIdType piece = 0; piece < numberOfPieces; ++piece)
+      {
+      vtkCellArray* cells[NumberOfCellTypes] = { pieces[piece]->GetVerts(), pieces[piece]->GetLines(),
+        pieces[piece]->GetPolys(), pieces[piece]->GetStrips() };
+      firstCellIds[type][piece + 1] = firstCellIds[type][piece] + cells[type]->GetNumberOfCells();
+      firstConnectivityIds[type][piece + 1] =
+        firstConnectivityIds[type][piece] + cells[type]->GetNumberOfConnectivityIds();
+      }
+    firstCellIdOfType[type + 1] = firstCellIdOfType[type] + firstCellIds[type][numberOfPieces];
+    cellOffsets[type] = vtkSmartPointer<vtkIdTypeArray>::New();
+    cellOffsets[type]->SetNumberOfValues(firstCellIds[type][numberOfPieces] + 1);
+    cellOffsets[type]->SetValue(firstCellIds[type][numberOfPieces], firstConnectivityIds[type][numberOfPieces]);
+    cellConnectivity[type] = vtkSmartPointer<vtkIdTypeArray>::New();
+    cellConnectivity[type]->SetNumberOfValues(firstConnectivityIds[type][numberOfPieces]);
+    }
+  vtkCellData* outputCellData = output->GetCellData();
+  outputCellData->CopyAllocate(firstPiece->GetCellData(), firstCellIdOfType[NumberOfCellTypes]);
+  const int numberOfCellArrays = outputCellData->GetNumberOfArrays();
+  for (int i = 0; i < numberOfCellArrays; ++i)
+    {
+    outputCellData->GetAbstractArray(i)->SetNumberOfTuples(firstCellIdOfType[NumberOfCellTypes]);
+    }
+
+  // Points shared by pieces are copied by the first piece getting to them
+  std::vector<std::atomic<unsigned char>> copiedPoints(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType piece = begin; piece < end; ++piece)
+      {
+      vtkPolyData* polyData = pieces[piece];
+      const vtkIdType* ids = pointIds[piece]->GetPointer(0);
+      vtkPointData* pointData = polyData->GetPointData();
+      for (vtkIdType i = 0; i < polyData->GetNumberOfPoints(); ++i)
+        {
+        if (copiedPoints[ids[i]].exchange(1))
+          {
+          continue;
+          }
+        points->GetData()->SetTuple(ids[i], i, polyData->GetPoints()->GetData());
+        for (int array = 0; array < numberOfPointArrays; ++array)
+          {
+          outputPointData->GetAbstractArray(array)->SetTuple(ids[i], i, pointData->GetAbstractArray(array));
+          }
+        }
+
+      vtkIdType localFirstCellId = 0;
+      vtkCellData* cellData = polyData->GetCellData();
+      for (int type = 0; type < NumberOfCellTypes; ++type)
+        {
+        const vtkIdType numberOfCells = firstCellIds[type][piece + 1] - firstCellIds[type][piece];
+        const vtkIdType localFirstConnectivityId = offsets[piece][localFirstCellId];
+        vtkIdType* typeOffsets = cellOffsets[type]->GetPointer(firstCellIds[type][piece]);
+        vtkIdType* typeConnectivity = cellConnectivity[type]->GetPointer(0);
+        for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+          {
+          const vtkIdType localCellId = localFirstCellId + cellId;
+          typeOffsets[cellId] =
+            firstConnectivityIds[type][piece] + offsets[piece][localCellId] - localFirstConnectivityId;
+          for (vtkIdType j = offsets[piece][localCellId]; j < offsets[piece][localCellId + 1]; ++j)
+            {
+            typeConnectivity[firstConnectivityIds[type][piece] + j - localFirstConnectivityId] =
+              ids[connectivity[piece][j]];
+            }
+          const vtkIdType outputCellId = firstCellIdOfType[type] + firstCellIds[type][piece] + cellId;
+          for (int array = 0; array < numberOfCellArrays; ++array)
+            {
+            outputCellData->GetAbstractArray(array)->SetTuple(outputCellId, localCellId,
+                                                              cellData->GetAbstractArray(array));
+            }
+          }
+        localFirstCellId += numberOfCells;
+        }
+      }
+    });
+
+  outputPointData->RemoveArray(SurfaceToolbox::PiecePointIdsArrayName);
+  output->SetPoints(points);
+  vtkSmartPointer<vtkCellArray> cellArrays[NumberOfCellTypes];
+  for (int type = 0; type < NumberOfCellTypes; ++type)
+    {
+    cellArrays[type] = vtkSmartPointer<vtkCellArray>::New();
+    cellArrays[type]->SetData(cellOffsets[type], cellConnectivity[type]);
+    }
+  output->SetVerts(cellArrays[0]);
+  output->SetLines(cellArrays[1]);
+  output->SetPolys(cellArrays[2]);
+  output->SetStrips(cellArrays[3]);
+  output->GetFieldData()->ShallowCopy(firstPiece->GetFieldData());
+  return output;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+const char* PiecePointIdsArrayName = "SurfaceToolboxPointIds";
+
+//----------------------------------------------------------------------------
+bool IsPiecesFileName(const std::string& fileName)
+{
+  const std::string extension = ".pvtp";
+  return fileName.size() > extension.size()
+    && vtksys::SystemTools::LowerCase(fileName.substr(fileName.size() - extension.size())) == extension;
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> GetPieceFileNames(const std::string& fileName)
+{
+  std::vector<std::string> pieceFileNames;
+  if (!ReadSummaryFile(fileName, pieceFileNames))
+    {
+    return std::vector<std::string>();
+    }
+  const std::string directory = vtksys::SystemTools::GetFilenamePath(fileName);
+  for (std::string& pieceFileName : pieceFileNames)
+    {
+    if (!directory.empty() && !vtksys::SystemTools::FileIsFullPath(pieceFileName))
+      {
+      pieceFileName = directory + "/" + pieceFileName;
+      }
+    }
+  return pieceFileNames;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadPolyDataPieces(const std::string& fileName)
+{
+  const std::vector<std::string> pieceFileNames = GetPieceFileNames(fileName);
+  if (pieceFileNames.empty())
+    {
+    std::cerr << "Failed to read " << fileName << ": not a PPolyData summary file" << std::endl;
+    return nullptr;
+    }
+  const vtkIdType numberOfPieces = static_cast<vtkIdType>(pieceFileNames.size());
+  std::vector<vtkSmartPointer<vtkPolyData>> pieces(numberOfPieces);
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType piece = begin; piece < end; ++piece)
+      {
+      pieces[piece] = ReadPolyData(pieceFileNames[piece]);
+      }
+    });
+  for (vtkPolyData* piece : pieces)
+    {
+    if (!piece)
+      {
+      return nullptr;
+      }
+    }
+  return AssemblePieces(pieces);
+}
+
+//----------------------------------------------------------------------------
+bool WritePolyDataPieces(vtkPolyData* polyData, const std::string& fileName, const WriteParameters& parameters)
+{
+  std::vector<vtkIdType> offsets;
+  std::vector<vtkIdType> connectivity;
+  GetCells(polyData, offsets, connectivity);
+  const vtkIdType firstCellIds[NumberOfCellTypes + 1] = { 0, polyData->GetNumberOfVerts(),
+    polyData->GetNumberOfVerts() + polyData->GetNumberOfLines(),
+    polyData->GetNumberOfVerts() + polyData->GetNumberOfLines() + polyData->GetNumberOfPolys(),
+    static_cast<vtkIdType>(offsets.size()) - 1 };
+
+  int numberOfPieces = parameters.NumberOfPieces;
+  if (numberOfPieces <= 0)
+    {
+    numberOfPieces = vtkSMPTools::GetEstimatedNumberOfThreads();
+    }
+  const vtkIdType maximumNumberOfPieces =
+    std::max<vtkIdType>(1, std::max(polyData->GetNumberOfPoints(), firstCellIds[NumberOfCellTypes]));
+  numberOfPieces = static_cast<int>(std::min<vtkIdType>(numberOfPieces, maximumNumberOfPieces));
+
+  const std::string directory = vtksys::SystemTools::GetFilenamePath(fileName);
+  const std::string name = vtksys::SystemTools::GetFilenameWithoutLastExtension(fileName);
+  const std::string pieceDirectory = directory.empty() ? name : directory + "/" + name;
+  if (!vtksys::SystemTools::MakeDirectory(pieceDirectory))
+    {
+    std::cerr << "Failed to write " << fileName << ": cannot create " << pieceDirectory << std::endl;
+    return false;
+    }
+
+  WriteParameters pieceParameters = parameters;
+  pieceParameters.ReportStatistics = false;
+  std::vector<unsigned char> written(numberOfPieces, 0);
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType piece = begin; piece < end; ++piece)
+      {
+      vtkSmartPointer<vtkPolyData> pieceData =
+        ExtractPiece(polyData, offsets, connectivity, firstCellIds, static_cast<int>(piece), numberOfPieces);
+      const std::string pieceFileName = GetPieceFileName(name, static_cast<int>(piece));
+      written[piece] = WritePolyData(pieceData, directory.empty() ? pieceFileName : directory + "/" + pieceFileName,
+                                     pieceParameters);
+      }
+    });
+  if (std::find(written.begin(), written.end(), 0) != written.end())
+    {
+    return false;
+    }
+  if (!WriteSummaryFile(polyData, fileName, name, numberOfPieces))
+    {
+    std::cerr << "Failed to write " << fileName << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef SurfaceToolboxPieces_h
+#define SurfaceToolboxPieces_h
+
+#include "SurfaceToolboxIO.h"
+
+// VTK includes
+#include "vtkSmartPointer.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+class vtkPolyData;
+
+// Surfaces stored as several pieces, written and read in parallel: a .pvtp
+// summary file lists .vtp piece files, written to a directory named after it
+// ("surface.pvtp" uses "surface/surface_0.vtp", "surface/surface_1.vtp"...),
+// as written by vtkXMLPPolyDataWriter. ReadPolyData and WritePolyData use
+// this layout for file names ending in ".pvtp".
+//
+// Each piece holds a range of the cells of the surface, plus a range of its
+// points so that points not used by any cell are kept. Its point data has the
+// original point ids (see PiecePointIdsArrayName), so that reading the pieces
+// back gives the points, cells and their order of the written surface, without
+// duplicating the points shared by pieces. Pieces of other writers, without
+// these ids, are appended.
+namespace SurfaceToolbox
+{
+
+/// Name of the point data array of the pieces holding the original point ids.
+extern const char* PiecePointIdsArrayName;
+
+/// Return true if \a fileName is the name of a parallel summary file (.pvtp).
+bool IsPiecesFileName(const std::string& fileName);
+
+/// Return the piece files listed in the summary file \a fileName, with their
+/// path. Returns an empty list if the summary file cannot be read.
+std::vector<std::string> GetPieceFileNames(const std::string& fileName);
+
+/// Read the pieces listed in the summary file \a fileName in parallel and
+/// assemble them. Returns nullptr if the summary file or a piece cannot be read.
+vtkSmartPointer<vtkPolyData> ReadPolyDataPieces(const std::string& fileName);
+
+/// Split \a polyData into parameters.NumberOfPieces pieces, or one per thread
+/// if 0, and write them in parallel with the compression of \a parameters,
+/// along with the summary file \a fileName.
+/// Returns false if a file cannot be written.
+bool WritePolyDataPieces(vtkPolyData* polyData, const std::string& fileName, const WriteParameters& parameters);
+
+}
+
+#endif
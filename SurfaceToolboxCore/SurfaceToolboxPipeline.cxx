@@ -0,0 +1,457 @@
+#include "SurfaceToolboxPipeline.h"
+#include "SurfaceToolboxTopology.h"
+#include "SurfaceToolboxTransform.h"
+
+// VTK includes
+#include "vtkMatrix4x4.h"
+#include "vtkPolyData.h"
+
+// STD includes
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string ToLower(std::string value)
+{
+  std::transform(value.begin(), value.end(), value.begin(),
+    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return value;
+}
+
+//----------------------------------------------------------------------------
+bool IsTransformStage(const std::string& name)
+{
+  return name == "mirror" || name == "scalemesh" || name == "translatemesh" || name == "mc2origin";
+}
+
+//----------------------------------------------------------------------------
+// Compose the matrix of transform stage \a name with \a transform, the
+// transforms of the previous stages that have not been applied to \a input yet.
+void ComposeTransformStage(const std::string& name, vtkPolyData* input,
+                           const SurfaceToolbox::PipelineParameters& parameters, double transform[16])
+{
+  double matrix[16];
+  if (name == "mirror")
+    {
+    SurfaceToolbox::GetMirrorMatrix(parameters.Mirror, matrix);
+    }
+  else if (name == "scalemesh")
+    {
+    SurfaceToolbox::GetScaleMatrix(parameters.Scale, matrix);
+    }
+  else if (name == "translatemesh")
+    {
+    SurfaceToolbox::GetTranslateMatrix(parameters.Translate, matrix);
+    }
+  else
+    {
+    SurfaceToolbox::GetMC2OriginMatrix(input, transform, parameters.MC2Origin, matrix);
+    }
+  vtkMatrix4x4::Multiply4x4(matrix, transform, transform);
+}
+
+
+//----------------------------------------------------------------------------
+// Consecutive transform stages are composed and applied in one pass, so they
+// form a single step of the pipeline.
+std::vector<std::pair<size_t, size_t>> GetPipelineSteps(const std::vector<std::string>& stages)
+{
+  std::vector<std::pair<size_t, size_t>> steps;
+  for (size_t stageIndex = 0; stageIndex < stages.size(); )
+    {
+    size_t end = stageIndex + 1;
+    if (IsTransformStage(ToLower(stages[stageIndex])))
+      {
+      while (end < stages.size() && IsTransformStage(ToLower(stages[end])))
+        {
+        ++end;
+        }
+      }
+    steps.push_back(std::make_pair(stageIndex, end));
+    stageIndex = end;
+    }
+  return steps;
+}
+
+//----------------------------------------------------------------------------
+// Run the stages [first, last) of a step. Returns nullptr if the step fails.
+vtkSmartPointer<vtkPolyData> RunPipelineStep(vtkSmartPointer<vtkPolyData> surface,
+                                             const std::vector<std::string>& stages, size_t first, size_t last,
+                                             const SurfaceToolbox::PipelineParameters& parameters)
+{
+  if (!IsTransformStage(ToLower(stages[first])))
+    {
+    vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::RunStage(stages[first], surface, parameters);
+    if (output)
+      {
+      // Stages that only move points or add arrays keep the faces of their input
+      SurfaceToolbox::PassSurfaceTopology(surface, output);
+      }
+    return output;
+    }
+  double transform[16];
+  vtkMatrix4x4::Identity(transform);
+  for (size_t stageIndex = first; stageIndex < last; ++stageIndex)
+    {
+    ComposeTransformStage(ToLower(stages[stageIndex]), surface, parameters, transform);
+    }
+  SurfaceToolbox::TransformPolyData(surface, transform);
+  return surface;
+}
+
+//----------------------------------------------------------------------------
+std::string GetStepName(const std::vector<std::string>& stages, size_t first, size_t last)
+{
+  std::string name = stages[first];
+  for (size_t stageIndex = first + 1; stageIndex < last; ++stageIndex)
+    {
+    name += "+" + stages[stageIndex];
+    }
+  return name;
+}
+
+//----------------------------------------------------------------------------
+void LogStep(std::ostream* log, const std::string& name, double seconds, vtkPolyData* surface)
+{
+  if (log)
+    {
+    *log << name << ": " << seconds << " s, "
+         << surface->GetNumberOfPoints() << " points, "
+         << surface->GetNumberOfCells() << " cells";
+    if (std::shared_ptr<const SurfaceToolbox::SurfaceTopology> topology = SurfaceToolbox::FindSurfaceTopology(surface))
+      {
+      *log << ", topology " << topology->GetMemorySize() / (1024.0 * 1024.0) << " MiB";
+      }
+    *log << std::endl;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Name and parameters of stage \a name, from which its cache key is computed.
+// Only the parameters used by the stage are included, so that changing the
+// parameters of a stage does not invalidate the cached outputs of the stages
+// before it.
+std::string GetStageDescription(const std::string& name, const SurfaceToolbox::PipelineParameters& parameters)
+{
+  std::ostringstream description;
+  description.precision(std::numeric_limits<double>::max_digits10);
+  description << name;
+  if (name == "decimation")
+    {
+    const SurfaceToolbox::DecimationParameters& p = parameters.Decimation;
+    description << " " << p.Method << " " << p.TargetReduction << " " << p.BoundaryVertexDeletion
+                << " " << p.TargetNumberOfTriangles << " " << p.MaximumError << " " << p.ClusterSize;
+    }
+  else if (name == "smoothing")
+    {
+    const SurfaceToolbox::SmoothingParameters& p = parameters.Smoothing;
+    description << " " << p.Method << " " << p.Iterations << " " << p.Relaxation << " " << p.PassBand
+                << " " << p.BoundarySmoothing;
+    }
+  else if (name == "normals")
+    {
+    const SurfaceToolbox::NormalsParameters& p = parameters.Normals;
+    description << " " << p.AutoOrient << " " << p.Flip << " " << p.Splitting << " " << p.FeatureAngle
+                << " " << p.Weighting;
+    }
+  else if (name == "mirror")
+    {
+    description << " " << parameters.Mirror.X << " " << parameters.Mirror.Y << " " << parameters.Mirror.Z;
+    }
+  else if (name == "cleaner")
+    {
+    description << " " << parameters.Cleaner.Tolerance;
+    }
+  else if (name == "fillholes")
+    {
+    const SurfaceToolbox::FillHolesParameters& p = parameters.FillHoles;
+    description << " " << p.MaximumHoleSize << " " << p.Triangulation << " " << p.FairingIterations;
+    }
+  else if (name == "connectivity")
+    {
+    const SurfaceToolbox::ConnectivityParameters& p = parameters.Connectivity;
+    description << " " << p.Mode << " " << p.NumberOfRegions << " " << p.MinimumNumberOfCells
+                << " " << p.MinimumArea << " " << p.LabelRegions;
+    }
+  else if (name == "scalemesh")
+    {
+    description << " " << parameters.Scale.X << " " << parameters.Scale.Y << " " << parameters.Scale.Z;
+    }
+  else if (name == "translatemesh")
+    {
+    description << " " << parameters.Translate.X << " " << parameters.Translate.Y << " " << parameters.Translate.Z;
+    }
+  else if (name == "relaxpolygons")
+    {
+    description << " " << parameters.Relax.Iterations;
+    }
+  else if (name == "bordersout")
+    {
+    description << " " << parameters.Borders.MergeCoincidentPoints;
+    }
+  else if (name == "reorder")
+    {
+    description << " " << parameters.Reorder.Curve;
+    }
+  else if (name == "mc2origin")
+    {
+    description << " " << parameters.MC2Origin.ExactMassCenter;
+    }
+  if (parameters.Tiles.TileSize > 0 && SurfaceToolbox::IsTiledStage(name))
+    {
+    // Tiling changes the result of some stages, and the tiles depend on their size
+    description << " tiles " << parameters.Tiles.TileSize << " " << parameters.Tiles.HaloRings;
+    }
+  return description.str();
+}
+
+//----------------------------------------------------------------------------
+// Stages writing a statistics file must run for the file to be written, so
+// the pipeline is never restored from the cache past them.
+bool HasSideEffects(const std::string& name, const SurfaceToolbox::PipelineParameters& parameters)
+{
+  return (name == "connectivity" && !parameters.Connectivity.StatisticsFileName.empty())
+    || (name == "fillholes" && !parameters.FillHoles.StatisticsFileName.empty())
+    || (name == "bordersout" && !parameters.Borders.StatisticsFileName.empty());
+}
+
+//----------------------------------------------------------------------------
+bool ValidateStages(const std::vector<std::string>& stages)
+{
+  // Validate the whole chain first so that a typo does not waste a long run.
+  for (const std::string& stage : stages)
+    {
+    if (!SurfaceToolbox::IsStage(stage))
+      {
+      std::cerr << "Unknown stage: " << stage << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+const std::vector<std::string>& GetStageNames()
+{
+  static const std::vector<std::string> stageNames = {
+    "Reorder",
+    "Decimation",
+    "Smoothing",
+    "Normals",
+    "Mirror",
+    "Cleaner",
+    "FillHoles",
+    "Connectivity",
+    "scaleMesh",
+    "translateMesh",
+    "relaxPolygons",
+    "BordersOut",
+    "MC2Origin"
+    };
+  return stageNames;
+}
+
+//----------------------------------------------------------------------------
+bool IsStage(const std::string& stage)
+{
+  for (const std::string& stageName : GetStageNames())
+    {
+    if (IsSameStage(stageName, stage))
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool IsSameStage(const std::string& stage, const std::string& otherStage)
+{
+  return ToLower(stage) == ToLower(otherStage);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunStage(const std::string& stage, vtkPolyData* input,
+                                      const PipelineParameters& parameters)
+{
+  const std::string name = ToLower(stage);
+  if (parameters.Tiles.TileSize > 0 && IsTiledStage(name))
+    {
+    return RunTiledStage(name, input, parameters);
+    }
+  if (name == "decimation")
+    {
+    return RunDecimation(input, parameters.Decimation);
+    }
+  else if (name == "smoothing")
+    {
+    return RunSmoothing(input, parameters.Smoothing);
+    }
+  else if (name == "normals")
+    {
+    return RunNormals(input, parameters.Normals);
+    }
+  else if (name == "mirror")
+    {
+    return RunMirror(input, parameters.Mirror);
+    }
+  else if (name == "cleaner")
+    {
+    return RunCleaner(input, parameters.Cleaner);
+    }
+  else if (name == "fillholes")
+    {
+    return RunFillHoles(input, parameters.FillHoles);
+    }
+  else if (name == "connectivity")
+    {
+    return RunConnectivity(input, parameters.Connectivity);
+    }
+  else if (name == "scalemesh")
+    {
+    return RunScaleMesh(input, parameters.Scale);
+    }
+  else if (name == "translatemesh")
+    {
+    return RunTranslateMesh(input, parameters.Translate);
+    }
+  else if (name == "relaxpolygons")
+    {
+    return RunRelaxPolygons(input, parameters.Relax);
+    }
+  else if (name == "bordersout")
+    {
+    return RunBordersOut(input, parameters.Borders);
+    }
+  else if (name == "reorder")
+    {
+    return RunReorder(input, parameters.Reorder);
+    }
+  else if (name == "mc2origin")
+    {
+    return RunMC2Origin(input, parameters.MC2Origin);
+    }
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunPipeline(vtkPolyData* input, const std::vector<std::string>& stages,
+                                         const PipelineParameters& parameters, std::ostream* log)
+{
+  if (!ValidateStages(stages))
+    {
+    return nullptr;
+    }
+
+  vtkSmartPointer<vtkPolyData> surface = input;
+  for (const std::pair<size_t, size_t>& step : GetPipelineSteps(stages))
+    {
+    auto start = std::chrono::steady_clock::now();
+    const std::string name = GetStepName(stages, step.first, step.second);
+    surface = RunPipelineStep(surface, stages, step.first, step.second, parameters);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (!surface)
+      {
+      std::cerr << "Stage " << name << " failed" << std::endl;
+      return nullptr;
+      }
+    LogStep(log, name, elapsed.count(), surface);
+    }
+  return surface;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunCachedPipeline(vtkPolyData* input, const std::vector<std::string>& stages,
+                                               const PipelineParameters& parameters,
+                                               const CacheParameters& cacheParameters, std::ostream* log)
+{
+  if (cacheParameters.MaximumSize <= 0.0)
+    {
+    return RunPipeline(input, stages, parameters, log);
+    }
+  if (!ValidateStages(stages))
+    {
+    return nullptr;
+    }
+
+  // The key of the output of a step combines the key of its input with the
+  // names and parameters of the stages of the step. The input is hashed
+  // before any stage runs, as transform stages modify it in place.
+  auto start = std::chrono::steady_clock::now();
+  const std::vector<std::pair<size_t, size_t>> steps = GetPipelineSteps(stages);
+  std::vector<vtkTypeUInt64> keys(steps.size());
+  vtkTypeUInt64 key = HashPolyData(input);
+  size_t restorableSteps = steps.size();
+  for (size_t stepIndex = 0; stepIndex < steps.size(); ++stepIndex)
+    {
+    for (size_t stageIndex = steps[stepIndex].first; stageIndex < steps[stepIndex].second; ++stageIndex)
+      {
+      const std::string name = ToLower(stages[stageIndex]);
+      key = HashString(key, GetStageDescription(name, parameters));
+      if (HasSideEffects(name, parameters))
+        {
+        restorableSteps = std::min(restorableSteps, stepIndex);
+        }
+      }
+    keys[stepIndex] = key;
+    }
+
+  // Restart from the output of the deepest step found in the cache
+  vtkSmartPointer<vtkPolyData> surface = input;
+  size_t firstStep = 0;
+  for (size_t stepIndex = restorableSteps; stepIndex > 0; --stepIndex)
+    {
+    vtkSmartPointer<vtkPolyData> cached = ReadCachedPolyData(keys[stepIndex - 1], cacheParameters);
+    if (cached)
+      {
+      surface = cached;
+      firstStep = stepIndex;
+      break;
+      }
+    }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  if (log)
+    {
+    *log << "Cache: " << elapsed.count() << " s, ";
+    if (firstStep > 0)
+      {
+      *log << "restored " << GetStepName(stages, 0, steps[firstStep - 1].second) << std::endl;
+      }
+    else
+      {
+      *log << "no cached stage" << std::endl;
+      }
+    }
+
+  for (size_t stepIndex = firstStep; stepIndex < steps.size(); ++stepIndex)
+    {
+    start = std::chrono::steady_clock::now();
+    const std::string name = GetStepName(stages, steps[stepIndex].first, steps[stepIndex].second);
+    surface = RunPipelineStep(surface, stages, steps[stepIndex].first, steps[stepIndex].second, parameters);
+    if (!surface)
+      {
+      std::cerr << "Stage " << name << " failed" << std::endl;
+      return nullptr;
+      }
+    // Cached before the next step, which may modify the surface in place
+    WriteCachedPolyData(keys[stepIndex], surface, cacheParameters);
+    elapsed = std::chrono::steady_clock::now() - start;
+    LogStep(log, name, elapsed.count(), surface);
+    }
+  return surface;
+}
+
+}
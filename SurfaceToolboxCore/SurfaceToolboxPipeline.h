@@ -0,0 +1,73 @@
+#ifndef SurfaceToolboxPipeline_h
+#define SurfaceToolboxPipeline_h
+
+#include "SurfaceToolboxCache.h"
+#include "SurfaceToolboxReorder.h"
+#include "SurfaceToolboxStages.h"
+#include "SurfaceToolboxTiles.h"
+
+// STD includes
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace SurfaceToolbox
+{
+
+/// Parameters of every stage that can appear in a pipeline.
+struct PipelineParameters
+{
+  DecimationParameters Decimation;
+  SmoothingParameters Smoothing;
+  NormalsParameters Normals;
+  MirrorParameters Mirror;
+  CleanerParameters Cleaner;
+  FillHolesParameters FillHoles;
+  ConnectivityParameters Connectivity;
+  ScaleParameters Scale;
+  TranslateParameters Translate;
+  RelaxParameters Relax;
+  BordersParameters Borders;
+  ReorderParameters Reorder;
+  MC2OriginParameters MC2Origin;
+  // Tiled execution of the stages that support it (see IsTiledStage)
+  TileParameters Tiles;
+};
+
+/// Names of the stages, in the order used by the SurfaceToolbox module:
+/// Reorder, Decimation, Smoothing, Normals, Mirror, Cleaner, FillHoles,
+/// Connectivity, scaleMesh, translateMesh, relaxPolygons, BordersOut, MC2Origin.
+/// Stage names are matched case-insensitively.
+const std::vector<std::string>& GetStageNames();
+bool IsStage(const std::string& stage);
+/// Return true if \a stage and \a otherStage name the same stage.
+bool IsSameStage(const std::string& stage, const std::string& otherStage);
+
+/// Run a single stage. Stages supporting it run tiled if
+/// parameters.Tiles.TileSize is set (see RunTiledStage).
+/// Returns nullptr if \a stage is unknown.
+vtkSmartPointer<vtkPolyData> RunStage(const std::string& stage, vtkPolyData* input,
+                                      const PipelineParameters& parameters);
+
+/// Run \a stages in order, feeding the output of each stage to the next one
+/// without leaving memory. The time spent in each stage is reported to \a log
+/// if it is not null. Consecutive transform stages (Mirror, scaleMesh,
+/// translateMesh, MC2Origin) are composed into one matrix and applied in a
+/// single pass, and are reported as one entry. Returns nullptr if any stage is
+/// unknown or fails.
+vtkSmartPointer<vtkPolyData> RunPipeline(vtkPolyData* input, const std::vector<std::string>& stages,
+                                         const PipelineParameters& parameters, std::ostream* log = nullptr);
+
+/// Same as RunPipeline, with the output of every step kept in the cache
+/// described by \a cacheParameters. The run restarts from the output of the
+/// deepest step already cached for the same input surface and the same stage
+/// names and parameters, so that changing the parameters of the last stages
+/// only reruns these. Stages writing a statistics file always run.
+vtkSmartPointer<vtkPolyData> RunCachedPipeline(vtkPolyData* input, const std::vector<std::string>& stages,
+                                               const PipelineParameters& parameters,
+                                               const CacheParameters& cacheParameters,
+                                               std::ostream* log = nullptr);
+
+}
+
+#endif
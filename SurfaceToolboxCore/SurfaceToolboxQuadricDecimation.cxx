@@ -0,0 +1,1051 @@
+#include "SurfaceToolboxQuadricDecimation.h"
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+// Regions smaller than this are not worth a separate task.
+const vtkIdType MinimumVerticesPerRegion = 4096;
+const int MaximumNumberOfRounds = 8;
+// Collapses that rotate a triangle normal by more than ~78 degrees are rejected.
+const double MinimumNormalCosine = 0.2;
+
+//----------------------------------------------------------------------------
+// Symmetric 4x4 matrix of the sum of squared distances to a set of planes,
+// stored as a2 ab ac ad b2 bc bd c2 cd d2, and the number of planes.
+struct Quadric
+{
+  double A[10] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  double NumberOfPlanes = 0.0;
+
+  void AddPlane(const double n[3], double d)
+  {
+    this->A[0] += n[0] * n[0]; this->A[1] += n[0] * n[1]; this->A[2] += n[0] * n[2]; this->A[3] += n[0] * d;
+    this->A[4] += n[1] * n[1]; this->A[5] += n[1] * n[2]; this->A[6] += n[1] * d;
+    this->A[7] += n[2] * n[2]; this->A[8] += n[2] * d;
+    this->A[9] += d * d;
+    this->NumberOfPlanes += 1.0;
+  }
+
+  void Add(const Quadric& other)
+  {
+    for (int i = 0; i < 10; ++i)
+      {
+      this->A[i] += other.A[i];
+      }
+    this->NumberOfPlanes += other.NumberOfPlanes;
+  }
+
+  double Evaluate(const double p[3]) const
+  {
+    const double* a = this->A;
+    return a[0] * p[0] * p[0] + 2.0 * a[1] * p[0] * p[1] + 2.0 * a[2] * p[0] * p[2] + 2.0 * a[3] * p[0]
+         + a[4] * p[1] * p[1] + 2.0 * a[5] * p[1] * p[2] + 2.0 * a[6] * p[1]
+         + a[7] * p[2] * p[2] + 2.0 * a[8] * p[2]
+         + a[9];
+  }
+
+  // Root mean square distance of p to the planes.
+  double Error(const double p[3]) const
+  {
+    return std::sqrt(std::max(0.0, this->Evaluate(p)) / std::max(1.0, this->NumberOfPlanes));
+  }
+
+  // Position minimizing the quadric. Returns false if the system is singular,
+  // which happens on flat areas and along ridges.
+  bool Minimize(double p[3]) const
+  {
+    const double* a = this->A;
+    const double c00 = a[4] * a[7] - a[5] * a[5];
+    const double c01 = a[2] * a[5] - a[1] * a[7];
+    const double c02 = a[1] * a[5] - a[4] * a[2];
+    const double c11 = a[0] * a[7] - a[2] * a[2];
+    const double c12 = a[1] * a[2] - a[0] * a[5];
+    const double c22 = a[0] * a[4] - a[1] * a[1];
+    const double det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+    const double trace = a[0] + a[4] + a[7];
+    if (std::fabs(det) <= 1e-10 * trace * trace * trace)
+      {
+      return false;
+      }
+    const double r[3] = { -a[3], -a[6], -a[8] };
+    p[0] = (c00 * r[0] + c01 * r[1] + c02 * r[2]) / det;
+    p[1] = (c01 * r[0] + c11 * r[1] + c12 * r[2]) / det;
+    p[2] = (c02 * r[0] + c12 * r[1] + c22 * r[2]) / det;
+    return true;
+  }
+};
+
+//----------------------------------------------------------------------------
+struct Collapse
+{
+  double Error;
+  vtkIdType U;
+  vtkIdType V;
+  unsigned int StampU;
+  unsigned int StampV;
+  double Position[3];
+
+  bool operator>(const Collapse& other) const
+  {
+    if (this->Error != other.Error)
+      {
+      return this->Error > other.Error;
+      }
+    if (this->U != other.U)
+      {
+      return this->U > other.U;
+      }
+    return this->V > other.V;
+  }
+};
+
+typedef std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> CollapseQueue;
+
+//----------------------------------------------------------------------------
+// Scratch buffers of a region task
+struct RegionWorkspace
+{
+  std::vector<vtkIdType> Triangles;
+  std::vector<vtkIdType> Neighbors;
+  std::vector<vtkIdType> TrianglesU;
+  std::vector<vtkIdType> TrianglesV;
+  std::vector<vtkIdType> NeighborsU;
+  std::vector<vtkIdType> NeighborsV;
+  std::vector<vtkIdType> Shared;
+  CollapseQueue Queue;
+};
+
+//----------------------------------------------------------------------------
+// Vertices are identified by the id of one of the input points they replace
+// (their representative). Triangles keep the input point ids; the current
+// vertex of a point is Representative[point]. The points merged into a vertex
+// form a circular list through NextMember, which gives the triangles around a
+// vertex from the input point-to-triangle links without any reallocation.
+//
+// Regions are decimated concurrently without locks, and the per-point and
+// per-triangle vectors are shared. Ownership is what keeps them apart: the
+// region of a vertex is fixed for a round, relabelling keeps a point in the
+// region of its vertex, and a region only collapses an edge if every triangle
+// around both of its vertices has all its corners in the region (IsOwned).
+// The entries a collapse writes (Representative and NextMember of the merged
+// points, TriangleDeleted of the shared triangles, and the other per-vertex
+// values of its two vertices) therefore belong to points and triangles that
+// no other region reads: a region only reads the triangles around its own
+// vertices, and the corners of those triangles.
+class QuadricDecimator
+{
+public:
+  explicit QuadricDecimator(const SurfaceToolbox::DecimationParameters& parameters)
+    : Parameters(parameters)
+  {
+  }
+
+  /// Decimate \a input to each of \a targetReductions, or to
+  /// TargetNumberOfTriangles if it is set. Levels are decimated from the
+  /// least to the most reduced, each one continuing from the previous one,
+  /// and are returned in the order of \a targetReductions.
+  std::vector<vtkSmartPointer<vtkPolyData>> Execute(vtkPolyData* input, const std::vector<double>& targetReductions);
+
+private:
+  void Initialize(vtkPolyData* surface);
+  void InitializeAttributes(vtkPointData* pointData);
+  void ComputeQuadrics();
+  void ComputeRegionGrid();
+  vtkIdType DecimateRound(int round, vtkIdType numberToRemove);
+  vtkIdType DecimateRegion(int region, const vtkIdType* vertices, vtkIdType numberOfVertices,
+                           vtkIdType budget, RegionWorkspace& workspace);
+  bool CollapseEdge(const Collapse& collapse, int region, RegionWorkspace& workspace, vtkIdType& removed);
+  bool ComputeCollapse(vtkIdType u, vtkIdType v, Collapse& collapse) const;
+  void PushCollapses(vtkIdType vertex, int region, RegionWorkspace& workspace) const;
+  vtkSmartPointer<vtkPolyData> CreateOutput(vtkPolyData* surface) const;
+
+  void GetVertexTriangles(vtkIdType vertex, std::vector<vtkIdType>& triangles) const;
+  void GetNeighbors(vtkIdType vertex, const std::vector<vtkIdType>& triangles, std::vector<vtkIdType>& neighbors) const;
+  bool IsOwned(int region, const std::vector<vtkIdType>& triangles) const;
+  bool HasVertex(vtkIdType triangle, vtkIdType vertex) const;
+
+  const SurfaceToolbox::DecimationParameters& Parameters;
+
+  vtkIdType NumberOfPoints = 0;
+  std::vector<double> Points;
+  std::vector<vtkIdType> Triangles;
+  std::vector<unsigned char> TriangleDeleted;
+  std::vector<vtkIdType> LinkOffsets;
+  std::vector<vtkIdType> Links;
+
+  std::vector<vtkIdType> Representative;
+  std::vector<vtkIdType> NextMember;
+  std::vector<vtkIdType> GroupSize;
+  std::vector<unsigned char> Alive;
+  std::vector<unsigned char> Boundary;
+  std::vector<unsigned char> Locked;
+  std::vector<unsigned int> Stamp;
+  std::vector<Quadric> Quadrics;
+
+  // Point data, interpolated along collapsed edges
+  std::vector<vtkDataArray*> AttributeArrays;
+  std::vector<std::vector<double>> Attributes;
+
+  // Region grid
+  std::vector<int> Region;
+  double Origin[3] = { 0.0, 0.0, 0.0 };
+  double RegionSize = 0.0;
+  int NumberOfRegions = 1;
+};
+
+//----------------------------------------------------------------------------
+std::vector<vtkSmartPointer<vtkPolyData>> QuadricDecimator::Execute(vtkPolyData* input,
+                                                                    const std::vector<double>& targetReductions)
+{
+  vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::GetTriangulatedSurface(input, this->Triangles);
+  const vtkIdType numberOfTriangles = static_cast<vtkIdType>(this->Triangles.size() / 3);
+
+  const size_t numberOfLevels = targetReductions.size();
+  std::vector<vtkIdType> targetNumbersOfTriangles(numberOfLevels, this->Parameters.TargetNumberOfTriangles);
+  for (size_t level = 0; level < numberOfLevels; ++level)
+    {
+    if (targetNumbersOfTriangles[level] <= 0)
+      {
+      targetNumbersOfTriangles[level] = numberOfTriangles -
+        static_cast<vtkIdType>(std::floor(numberOfTriangles * targetReductions[level]));
+      }
+    }
+  std::vector<size_t> levelOrder(numberOfLevels);
+  for (size_t level = 0; level < numberOfLevels; ++level)
+    {
+    levelOrder[level] = level;
+    }
+  std::stable_sort(levelOrder.begin(), levelOrder.end(), [&](size_t a, size_t b)
+    {
+    return targetNumbersOfTriangles[a] > targetNumbersOfTriangles[b];
+    });
+
+  this->Initialize(surface);
+  // Degenerate input triangles are dropped and count towards the reduction
+  vtkIdType numberOfRemainingTriangles = numberOfTriangles;
+  for (unsigned char deleted : this->TriangleDeleted)
+    {
+    numberOfRemainingTriangles -= deleted;
+    }
+  this->ComputeQuadrics();
+
+  std::vector<vtkSmartPointer<vtkPolyData>> levels(numberOfLevels);
+  int round = 0;
+  for (size_t level : levelOrder)
+    {
+    vtkIdType numberToRemove = std::max<vtkIdType>(0, numberOfRemainingTriangles - targetNumbersOfTriangles[level]);
+    // Regions shrink with the number of vertices left
+    this->ComputeRegionGrid();
+    int unproductiveRounds = 0;
+    for (int levelRound = 0; levelRound < MaximumNumberOfRounds && numberToRemove > 0; ++levelRound, ++round)
+      {
+      const vtkIdType removed = this->DecimateRound(round, numberToRemove);
+      numberToRemove -= removed;
+      numberOfRemainingTriangles -= removed;
+      if (this->NumberOfRegions == 1)
+        {
+        // Nothing is left for another round to do
+        break;
+        }
+      unproductiveRounds = (removed == 0) ? unproductiveRounds + 1 : 0;
+      if (unproductiveRounds == 2)
+        {
+        break;
+        }
+      }
+    levels[level] = this->CreateOutput(surface);
+    }
+  return levels;
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::Initialize(vtkPolyData* surface)
+{
+  this->NumberOfPoints = surface->GetNumberOfPoints();
+  const vtkIdType numberOfPoints = this->NumberOfPoints;
+  const vtkIdType numberOfTriangles = static_cast<vtkIdType>(this->Triangles.size() / 3);
+
+  SurfaceToolbox::GetPointCoordinates(surface, this->Points);
+  SurfaceToolbox::BuildPointTriangleLinks(numberOfPoints, this->Triangles, this->LinkOffsets, this->Links);
+
+  this->TriangleDeleted.assign(numberOfTriangles, 0);
+  vtkSMPTools::For(0, numberOfTriangles, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType triangleId = begin; triangleId < end; ++triangleId)
+      {
+      const vtkIdType* t = &this->Triangles[3 * triangleId];
+      this->TriangleDeleted[triangleId] = (t[0] == t[1] || t[1] == t[2] || t[2] == t[0]);
+      }
+    });
+
+  this->Representative.resize(numberOfPoints);
+  this->NextMember.resize(numberOfPoints);
+  this->GroupSize.assign(numberOfPoints, 1);
+  this->Alive.resize(numberOfPoints);
+  this->Boundary.assign(numberOfPoints, 0);
+  this->Locked.assign(numberOfPoints, 0);
+  this->Stamp.assign(numberOfPoints, 0);
+  this->Region.assign(numberOfPoints, 0);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      this->Representative[pointId] = pointId;
+      this->NextMember[pointId] = pointId;
+      // Points not used by any triangle are dropped
+      this->Alive[pointId] = this->LinkOffsets[pointId + 1] > this->LinkOffsets[pointId];
+      }
+    });
+
+  this->InitializeAttributes(surface->GetPointData());
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::InitializeAttributes(vtkPointData* pointData)
+{
+  this->AttributeArrays.clear();
+  this->Attributes.clear();
+  for (int arrayIndex = 0; arrayIndex < pointData->GetNumberOfArrays(); ++arrayIndex)
+    {
+    vtkDataArray* array = pointData->GetArray(arrayIndex);
+    if (!array || array->GetNumberOfTuples() != this->NumberOfPoints)
+      {
+      continue;
+      }
+    const int numberOfComponents = array->GetNumberOfComponents();
+    std::vector<double> values(this->NumberOfPoints * numberOfComponents);
+    vtkSMPTools::For(0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType pointId = begin; pointId < end; ++pointId)
+        {
+        array->GetTuple(pointId, &values[pointId * numberOfComponents]);
+        }
+      });
+    this->AttributeArrays.push_back(array);
+    this->Attributes.push_back(std::move(values));
+    }
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::ComputeQuadrics()
+{
+  this->Quadrics.assign(this->NumberOfPoints, Quadric());
+
+  // Each point accumulates the planes of its own triangles, so no two threads
+  // write the same quadric.
+  vtkSMPTools::For(0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    std::vector<vtkIdType> edgeEnds;
+    std::vector<vtkIdType> edgeTriangles;
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      Quadric& quadric = this->Quadrics[pointId];
+      edgeEnds.clear();
+      edgeTriangles.clear();
+      for (vtkIdType link = this->LinkOffsets[pointId]; link < this->LinkOffsets[pointId + 1]; ++link)
+        {
+        const vtkIdType triangleId = this->Links[link];
+        if (this->TriangleDeleted[triangleId])
+          {
+          continue;
+          }
+        const vtkIdType* t = &this->Triangles[3 * triangleId];
+        const double* p0 = &this->Points[3 * t[0]];
+        const double* p1 = &this->Points[3 * t[1]];
+        const double* p2 = &this->Points[3 * t[2]];
+        double e1[3], e2[3], normal[3];
+        vtkMath::Subtract(p1, p0, e1);
+        vtkMath::Subtract(p2, p0, e2);
+        vtkMath::Cross(e1, e2, normal);
+        if (vtkMath::Normalize(normal) == 0.0)
+          {
+          continue;
+          }
+        quadric.AddPlane(normal, -vtkMath::Dot(normal, p0));
+        for (int corner = 0; corner < 3; ++corner)
+          {
+          if (t[corner] != pointId)
+            {
+            edgeEnds.push_back(t[corner]);
+            edgeTriangles.push_back(triangleId);
+            }
+          }
+        }
+
+      // Edges used by a single triangle are on the boundary. Constrain the
+      // boundary with the plane through the edge, perpendicular to its triangle.
+      for (size_t i = 0; i < edgeEnds.size(); ++i)
+        {
+        if (std::count(edgeEnds.begin(), edgeEnds.end(), edgeEnds[i]) != 1)
+          {
+          continue;
+          }
+        this->Boundary[pointId] = 1;
+        const vtkIdType* t = &this->Triangles[3 * edgeTriangles[i]];
+        const double* p0 = &this->Points[3 * t[0]];
+        const double* p1 = &this->Points[3 * t[1]];
+        const double* p2 = &this->Points[3 * t[2]];
+        double e1[3], e2[3], normal[3], edge[3], constraint[3];
+        vtkMath::Subtract(p1, p0, e1);
+        vtkMath::Subtract(p2, p0, e2);
+        vtkMath::Cross(e1, e2, normal);
+        vtkMath::Subtract(&this->Points[3 * edgeEnds[i]], &this->Points[3 * pointId], edge);
+        vtkMath::Cross(edge, normal, constraint);
+        if (vtkMath::Normalize(constraint) == 0.0)
+          {
+          continue;
+          }
+        quadric.AddPlane(constraint, -vtkMath::Dot(constraint, &this->Points[3 * pointId]));
+        }
+      this->Locked[pointId] = this->Boundary[pointId] && !this->Parameters.BoundaryVertexDeletion;
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::ComputeRegionGrid()
+{
+  double bounds[6] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+  vtkIdType numberOfVertices = 0;
+  for (vtkIdType pointId = 0; pointId < this->NumberOfPoints; ++pointId)
+    {
+    if (!this->Alive[pointId])
+      {
+      continue;
+      }
+    ++numberOfVertices;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      bounds[2 * axis] = std::min(bounds[2 * axis], this->Points[3 * pointId + axis]);
+      bounds[2 * axis + 1] = std::max(bounds[2 * axis + 1], this->Points[3 * pointId + axis]);
+      }
+    }
+
+  const vtkIdType maximumNumberOfRegions = std::min<vtkIdType>(
+    8 * vtkSMPTools::GetEstimatedNumberOfThreads(), numberOfVertices / MinimumVerticesPerRegion);
+  this->RegionSize = 0.0;
+  this->NumberOfRegions = 1;
+  if (maximumNumberOfRegions <= 1)
+    {
+    return;
+    }
+
+  // Cubic regions, sized so that the grid has about maximumNumberOfRegions
+  // cells over the axes along which the surface extends.
+  double maximumExtent = 0.0;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    maximumExtent = std::max(maximumExtent, bounds[2 * axis + 1] - bounds[2 * axis]);
+    }
+  double volume = 1.0;
+  int dimension = 0;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    const double extent = bounds[2 * axis + 1] - bounds[2 * axis];
+    if (extent > 1e-6 * maximumExtent)
+      {
+      volume *= extent;
+      ++dimension;
+      }
+    }
+  if (dimension == 0)
+    {
+    return;
+    }
+  this->RegionSize = std::pow(volume / maximumNumberOfRegions, 1.0 / dimension);
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    this->Origin[axis] = bounds[2 * axis];
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType QuadricDecimator::DecimateRound(int round, vtkIdType numberToRemove)
+{
+  // Shift the grid at every round, so that vertices near region borders in
+  // one round are inside a region in the next one.
+  const double shifts[4] = { 0.0, 0.5, 0.25, 0.75 };
+  const double shift = this->RegionSize > 0.0 ? shifts[round % 4] * this->RegionSize : 0.0;
+  double origin[3];
+  int dimensions[3] = { 1, 1, 1 };
+  if (this->RegionSize > 0.0)
+    {
+    double bounds[6];
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      origin[axis] = this->Origin[axis] - shift;
+      bounds[2 * axis] = VTK_DOUBLE_MAX;
+      bounds[2 * axis + 1] = -VTK_DOUBLE_MAX;
+      }
+    for (vtkIdType pointId = 0; pointId < this->NumberOfPoints; ++pointId)
+      {
+      if (this->Alive[pointId])
+        {
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          bounds[2 * axis + 1] = std::max(bounds[2 * axis + 1], this->Points[3 * pointId + axis]);
+          }
+        }
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      dimensions[axis] = 1 + static_cast<int>((bounds[2 * axis + 1] - origin[axis]) / this->RegionSize);
+      }
+    }
+  this->NumberOfRegions = dimensions[0] * dimensions[1] * dimensions[2];
+
+  // Label vertices with their region
+  vtkSMPTools::For(0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      if (!this->Alive[pointId] || this->NumberOfRegions == 1)
+        {
+        this->Region[pointId] = 0;
+        continue;
+        }
+      int index[3];
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        index[axis] = static_cast<int>((this->Points[3 * pointId + axis] - origin[axis]) / this->RegionSize);
+        index[axis] = std::min(std::max(index[axis], 0), dimensions[axis] - 1);
+        }
+      this->Region[pointId] = index[0] + dimensions[0] * (index[1] + dimensions[1] * index[2]);
+      }
+    });
+
+  // Bucket the vertices by region
+  std::vector<vtkIdType> regionOffsets(this->NumberOfRegions + 1, 0);
+  vtkIdType numberOfVertices = 0;
+  for (vtkIdType pointId = 0; pointId < this->NumberOfPoints; ++pointId)
+    {
+    if (this->Alive[pointId])
+      {
+      ++regionOffsets[this->Region[pointId] + 1];
+      ++numberOfVertices;
+      }
+    }
+  for (int region = 0; region < this->NumberOfRegions; ++region)
+    {
+    regionOffsets[region + 1] += regionOffsets[region];
+    }
+  std::vector<vtkIdType> regionVertices(numberOfVertices);
+  std::vector<vtkIdType> cursors(regionOffsets.begin(), regionOffsets.end() - 1);
+  for (vtkIdType pointId = 0; pointId < this->NumberOfPoints; ++pointId)
+    {
+    if (this->Alive[pointId])
+      {
+      regionVertices[cursors[this->Region[pointId]]++] = pointId;
+      }
+    }
+
+  // Split the number of triangles to remove between regions, in proportion
+  // to their number of vertices. Each region gets the difference of the
+  // rounded-down shares of the vertices up to its end and up to its start, so
+  // that the budgets add up to numberToRemove.
+  const auto getShare = [&](int region)
+    {
+    return numberToRemove * regionOffsets[region] / numberOfVertices;
+    };
+  std::atomic<vtkIdType> removed(0);
+  vtkSMPTools::For(0, this->NumberOfRegions, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    RegionWorkspace workspace;
+    for (vtkIdType region = begin; region < end; ++region)
+      {
+      const vtkIdType regionSize = regionOffsets[region + 1] - regionOffsets[region];
+      if (regionSize == 0)
+        {
+        continue;
+        }
+      const vtkIdType budget = getShare(static_cast<int>(region) + 1) - getShare(static_cast<int>(region));
+      if (budget == 0)
+        {
+        continue;
+        }
+      removed += this->DecimateRegion(static_cast<int>(region), &regionVertices[regionOffsets[region]],
+                                      regionSize, budget, workspace);
+      }
+    });
+  return removed;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType QuadricDecimator::DecimateRegion(int region, const vtkIdType* vertices, vtkIdType numberOfVertices,
+                                           vtkIdType budget, RegionWorkspace& workspace)
+{
+  CollapseQueue& queue = workspace.Queue;
+  queue = CollapseQueue();
+  for (vtkIdType i = 0; i < numberOfVertices; ++i)
+    {
+    this->PushCollapses(vertices[i], region, workspace);
+    }
+
+  const double maximumError = this->Parameters.MaximumError;
+  vtkIdType removed = 0;
+  while (!queue.empty() && removed < budget)
+    {
+    const Collapse collapse = queue.top();
+    queue.pop();
+    if (!this->Alive[collapse.U] || !this->Alive[collapse.V] ||
+        this->Stamp[collapse.U] != collapse.StampU || this->Stamp[collapse.V] != collapse.StampV)
+      {
+      // Outdated by an earlier collapse
+      continue;
+      }
+    if (maximumError > 0.0 && collapse.Error > maximumError)
+      {
+      break;
+      }
+    this->CollapseEdge(collapse, region, workspace, removed);
+    }
+  return removed;
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::PushCollapses(vtkIdType vertex, int region, RegionWorkspace& workspace) const
+{
+  this->GetVertexTriangles(vertex, workspace.Triangles);
+  this->GetNeighbors(vertex, workspace.Triangles, workspace.Neighbors);
+  Collapse collapse;
+  for (vtkIdType neighbor : workspace.Neighbors)
+    {
+    if (this->Region[neighbor] == region && this->ComputeCollapse(vertex, neighbor, collapse))
+      {
+      workspace.Queue.push(collapse);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::ComputeCollapse(vtkIdType u, vtkIdType v, Collapse& collapse) const
+{
+  if (this->Locked[u] && this->Locked[v])
+    {
+    return false;
+    }
+  Quadric quadric = this->Quadrics[u];
+  quadric.Add(this->Quadrics[v]);
+
+  const double* pu = &this->Points[3 * u];
+  const double* pv = &this->Points[3 * v];
+  double* position = collapse.Position;
+  if (this->Locked[u] || this->Locked[v])
+    {
+    const double* locked = this->Locked[u] ? pu : pv;
+    std::copy(locked, locked + 3, position);
+    }
+  else
+    {
+    const double midpoint[3] = { 0.5 * (pu[0] + pv[0]), 0.5 * (pu[1] + pv[1]), 0.5 * (pu[2] + pv[2]) };
+    // Keep the optimum only if it stays near the edge; it may be far away
+    // when the system is nearly singular.
+    if (!quadric.Minimize(position) ||
+        vtkMath::Distance2BetweenPoints(position, midpoint) > 4.0 * vtkMath::Distance2BetweenPoints(pu, pv))
+      {
+      const double* candidates[3] = { pu, pv, midpoint };
+      double bestError = VTK_DOUBLE_MAX;
+      for (const double* candidate : candidates)
+        {
+        const double error = quadric.Evaluate(candidate);
+        if (error < bestError)
+          {
+          bestError = error;
+          std::copy(candidate, candidate + 3, position);
+          }
+        }
+      }
+    }
+  collapse.Error = quadric.Error(position);
+  collapse.U = u;
+  collapse.V = v;
+  collapse.StampU = this->Stamp[u];
+  collapse.StampV = this->Stamp[v];
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::CollapseEdge(const Collapse& collapse, int region, RegionWorkspace& workspace, vtkIdType& removed)
+{
+  const vtkIdType u = collapse.U;
+  const vtkIdType v = collapse.V;
+  this->GetVertexTriangles(u, workspace.TrianglesU);
+  this->GetVertexTriangles(v, workspace.TrianglesV);
+
+  // Only collapse edges whose surrounding triangles all belong to this region,
+  // so that the writes below are owned by this region (see QuadricDecimator).
+  // A triangle across regions is never modified, so this check cannot be
+  // invalidated by another region before the writes.
+  if (!this->IsOwned(region, workspace.TrianglesU) || !this->IsOwned(region, workspace.TrianglesV))
+    {
+    return false;
+    }
+
+  // Topology checks
+  workspace.Shared.clear();
+  for (vtkIdType triangleId : workspace.TrianglesU)
+    {
+    if (this->HasVertex(triangleId, v))
+      {
+      workspace.Shared.push_back(triangleId);
+      }
+    }
+  const size_t numberOfShared = workspace.Shared.size();
+  if (numberOfShared == 0 || numberOfShared > 2)
+    {
+    // Not an edge anymore, or a non-manifold edge
+    return false;
+    }
+  if (numberOfShared == 2 && this->Boundary[u] && this->Boundary[v])
+    {
+    // Would pinch the surface
+    return false;
+    }
+  const size_t numberOfRemaining = workspace.TrianglesU.size() + workspace.TrianglesV.size() - 2 * numberOfShared;
+  if (numberOfRemaining < ((this->Boundary[u] || this->Boundary[v]) ? 1u : 3u))
+    {
+    return false;
+    }
+  this->GetNeighbors(u, workspace.TrianglesU, workspace.NeighborsU);
+  this->GetNeighbors(v, workspace.TrianglesV, workspace.NeighborsV);
+  size_t numberOfCommonNeighbors = 0;
+  for (vtkIdType neighbor : workspace.NeighborsU)
+    {
+    numberOfCommonNeighbors += std::binary_search(workspace.NeighborsV.begin(), workspace.NeighborsV.end(), neighbor);
+    }
+  if (numberOfCommonNeighbors != numberOfShared)
+    {
+    // Link condition: the collapse would make the surface non-manifold
+    return false;
+    }
+
+  // Geometry check: no triangle may flip or become degenerate
+  const double* position = collapse.Position;
+  for (const std::vector<vtkIdType>* triangles : { &workspace.TrianglesU, &workspace.TrianglesV })
+    {
+    for (vtkIdType triangleId : *triangles)
+      {
+      if (this->HasVertex(triangleId, u) && this->HasVertex(triangleId, v))
+        {
+        continue;
+        }
+      const double* corners[3];
+      const double* moved[3];
+      for (int corner = 0; corner < 3; ++corner)
+        {
+        const vtkIdType vertex = this->Representative[this->Triangles[3 * triangleId + corner]];
+        corners[corner] = &this->Points[3 * vertex];
+        moved[corner] = (vertex == u || vertex == v) ? position : corners[corner];
+        }
+      double e1[3], e2[3], before[3], after[3];
+      vtkMath::Subtract(corners[1], corners[0], e1);
+      vtkMath::Subtract(corners[2], corners[0], e2);
+      vtkMath::Cross(e1, e2, before);
+      vtkMath::Subtract(moved[1], moved[0], e1);
+      vtkMath::Subtract(moved[2], moved[0], e2);
+      vtkMath::Cross(e1, e2, after);
+      const double beforeNorm = vtkMath::Norm(before);
+      const double afterNorm = vtkMath::Norm(after);
+      if (afterNorm <= 1e-12 * beforeNorm ||
+          vtkMath::Dot(before, after) < MinimumNormalCosine * beforeNorm * afterNorm)
+        {
+        return false;
+        }
+      }
+    }
+
+  // Collapse: the vertex with more merged points survives, so that relabelling
+  // the other one stays cheap.
+  for (vtkIdType triangleId : workspace.Shared)
+    {
+    this->TriangleDeleted[triangleId] = 1;
+    }
+  const vtkIdType survivor = this->GroupSize[u] >= this->GroupSize[v] ? u : v;
+  const vtkIdType other = survivor == u ? v : u;
+  vtkIdType member = other;
+  do
+    {
+    this->Representative[member] = survivor;
+    member = this->NextMember[member];
+    }
+  while (member != other);
+  std::swap(this->NextMember[survivor], this->NextMember[other]);
+  this->GroupSize[survivor] += this->GroupSize[other];
+
+  // Interpolate point data at the position of the new vertex along the edge
+  const double* pu = &this->Points[3 * u];
+  const double* pv = &this->Points[3 * v];
+  double edge[3], offset[3];
+  vtkMath::Subtract(pv, pu, edge);
+  vtkMath::Subtract(position, pu, offset);
+  const double edgeLength2 = vtkMath::Dot(edge, edge);
+  const double t = edgeLength2 > 0.0 ? std::min(1.0, std::max(0.0, vtkMath::Dot(offset, edge) / edgeLength2)) : 0.5;
+  for (size_t arrayIndex = 0; arrayIndex < this->Attributes.size(); ++arrayIndex)
+    {
+    const int numberOfComponents = this->AttributeArrays[arrayIndex]->GetNumberOfComponents();
+    double* values = this->Attributes[arrayIndex].data();
+    for (int component = 0; component < numberOfComponents; ++component)
+      {
+      values[survivor * numberOfComponents + component] =
+        (1.0 - t) * values[u * numberOfComponents + component] + t * values[v * numberOfComponents + component];
+      }
+    }
+
+  Quadric quadric = this->Quadrics[u];
+  quadric.Add(this->Quadrics[v]);
+  this->Quadrics[survivor] = quadric;
+  std::copy(position, position + 3, &this->Points[3 * survivor]);
+  this->Boundary[survivor] = this->Boundary[u] || this->Boundary[v];
+  this->Locked[survivor] = this->Locked[u] || this->Locked[v];
+  this->Alive[other] = 0;
+  ++this->Stamp[survivor];
+  removed += static_cast<vtkIdType>(numberOfShared);
+
+  this->PushCollapses(survivor, region, workspace);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::GetVertexTriangles(vtkIdType vertex, std::vector<vtkIdType>& triangles) const
+{
+  triangles.clear();
+  vtkIdType member = vertex;
+  do
+    {
+    for (vtkIdType link = this->LinkOffsets[member]; link < this->LinkOffsets[member + 1]; ++link)
+      {
+      if (!this->TriangleDeleted[this->Links[link]])
+        {
+        triangles.push_back(this->Links[link]);
+        }
+      }
+    member = this->NextMember[member];
+    }
+  while (member != vertex);
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::GetNeighbors(vtkIdType vertex, const std::vector<vtkIdType>& triangles,
+                                    std::vector<vtkIdType>& neighbors) const
+{
+  neighbors.clear();
+  for (vtkIdType triangleId : triangles)
+    {
+    for (int corner = 0; corner < 3; ++corner)
+      {
+      const vtkIdType neighbor = this->Representative[this->Triangles[3 * triangleId + corner]];
+      if (neighbor != vertex)
+        {
+        neighbors.push_back(neighbor);
+        }
+      }
+    }
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::IsOwned(int region, const std::vector<vtkIdType>& triangles) const
+{
+  if (this->NumberOfRegions == 1)
+    {
+    return true;
+    }
+  for (vtkIdType triangleId : triangles)
+    {
+    for (int corner = 0; corner < 3; ++corner)
+      {
+      if (this->Region[this->Representative[this->Triangles[3 * triangleId + corner]]] != region)
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::HasVertex(vtkIdType triangleId, vtkIdType vertex) const
+{
+  const vtkIdType* t = &this->Triangles[3 * triangleId];
+  return this->Representative[t[0]] == vertex || this->Representative[t[1]] == vertex ||
+         this->Representative[t[2]] == vertex;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> QuadricDecimator::CreateOutput(vtkPolyData* surface) const
+{
+  // Renumber the remaining vertices
+  std::vector<vtkIdType> outputIds(this->NumberOfPoints, -1);
+  std::vector<vtkIdType> vertices;
+  for (vtkIdType pointId = 0; pointId < this->NumberOfPoints; ++pointId)
+    {
+    if (this->Alive[pointId])
+      {
+      outputIds[pointId] = static_cast<vtkIdType>(vertices.size());
+      vertices.push_back(pointId);
+      }
+    }
+  const vtkIdType numberOfVertices = static_cast<vtkIdType>(vertices.size());
+
+  std::vector<double> coordinates(3 * numberOfVertices);
+  vtkSMPTools::For(0, numberOfVertices, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      std::copy_n(&this->Points[3 * vertices[i]], 3, &coordinates[3 * i]);
+      }
+    });
+
+  std::vector<vtkIdType> keptTriangles;
+  const vtkIdType numberOfInputTriangles = static_cast<vtkIdType>(this->TriangleDeleted.size());
+  for (vtkIdType triangleId = 0; triangleId < numberOfInputTriangles; ++triangleId)
+    {
+    if (!this->TriangleDeleted[triangleId])
+      {
+      keptTriangles.push_back(triangleId);
+      }
+    }
+  const vtkIdType numberOfTriangles = static_cast<vtkIdType>(keptTriangles.size());
+  std::vector<vtkIdType> triangles(3 * numberOfTriangles);
+  vtkSMPTools::For(0, numberOfTriangles, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      for (int corner = 0; corner < 3; ++corner)
+        {
+        triangles[3 * i + corner] =
+          outputIds[this->Representative[this->Triangles[3 * keptTriangles[i] + corner]]];
+        }
+      }
+    });
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->SetPoints(SurfaceToolbox::CreatePoints(coordinates, surface->GetPoints()->GetDataType()));
+  output->SetPolys(SurfaceToolbox::CreateTriangleCells(triangles.data(), numberOfTriangles));
+
+  // Point data
+  vtkPointData* inputPointData = surface->GetPointData();
+  vtkPointData* outputPointData = output->GetPointData();
+  for (size_t arrayIndex = 0; arrayIndex < this->AttributeArrays.size(); ++arrayIndex)
+    {
+    vtkDataArray* inputArray = this->AttributeArrays[arrayIndex];
+    const int numberOfComponents = inputArray->GetNumberOfComponents();
+    const bool isNormals = (inputArray == inputPointData->GetNormals() && numberOfComponents == 3);
+    const double* values = this->Attributes[arrayIndex].data();
+    vtkSmartPointer<vtkDataArray> outputArray = vtkSmartPointer<vtkDataArray>::Take(inputArray->NewInstance());
+    outputArray->SetName(inputArray->GetName());
+    outputArray->SetNumberOfComponents(numberOfComponents);
+    outputArray->SetNumberOfTuples(numberOfVertices);
+    vtkSMPTools::For(0, numberOfVertices, [&](vtkIdType begin, vtkIdType end)
+      {
+      double tuple[3];
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        const double* value = values + vertices[i] * numberOfComponents;
+        if (isNormals)
+          {
+          std::copy_n(value, 3, tuple);
+          vtkMath::Normalize(tuple);
+          value = tuple;
+          }
+        for (int component = 0; component < numberOfComponents; ++component)
+          {
+          outputArray->SetComponent(i, component, value[component]);
+          }
+        }
+      });
+    outputPointData->AddArray(outputArray);
+    for (int attribute = 0; attribute < vtkDataSetAttributes::NUM_ATTRIBUTES; ++attribute)
+      {
+      if (inputPointData->GetAttribute(attribute) == inputArray)
+        {
+        outputPointData->SetAttribute(outputArray, attribute);
+        }
+      }
+    }
+
+  // Cell data of the remaining triangles
+  vtkCellData* inputCellData = surface->GetCellData();
+  vtkCellData* outputCellData = output->GetCellData();
+  outputCellData->CopyAllocate(inputCellData, numberOfTriangles);
+  if (inputCellData->GetNumberOfArrays() > 0)
+    {
+    // Triangles are the only cells of the triangulated surface, unless it
+    // also has vertices and lines, which come first in cell order.
+    const vtkIdType firstTriangleCell = surface->GetNumberOfVerts() + surface->GetNumberOfLines();
+    for (vtkIdType i = 0; i < numberOfTriangles; ++i)
+      {
+      outputCellData->CopyData(inputCellData, firstTriangleCell + keptTriangles[i], i);
+      }
+    }
+
+  return output;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunQuadricDecimation(vtkPolyData* input, const DecimationParameters& parameters)
+{
+  QuadricDecimator decimator(parameters);
+  // A maximum error without a number of triangles is the only stop criterion
+  const bool errorOnly = parameters.MaximumError > 0.0 && parameters.TargetNumberOfTriangles <= 0;
+  return decimator.Execute(input, std::vector<double>(1, errorOnly ? 1.0 : parameters.TargetReduction)).front();
+}
+
+//----------------------------------------------------------------------------
+std::vector<vtkSmartPointer<vtkPolyData>> RunQuadricDecimationLevels(vtkPolyData* input,
+                                                                     const DecimationParameters& parameters,
+                                                                     const std::vector<double>& targetReductions)
+{
+  DecimationParameters levelParameters = parameters;
+  levelParameters.TargetNumberOfTriangles = 0;
+  QuadricDecimator decimator(levelParameters);
+  return decimator.Execute(input, targetReductions);
+}
+
+//----------------------------------------------------------------------------
+std::string GetLevelFileName(const std::string& fileName, const std::string& directory, size_t level)
+{
+  const std::string::size_type separator = fileName.find_last_of("/\\");
+  const std::string::size_type dot = fileName.find_last_of('.');
+  const bool hasExtension = dot != std::string::npos && (separator == std::string::npos || dot > separator);
+  const std::string stem = fileName.substr(0, hasExtension ? dot : fileName.size());
+  std::ostringstream levelFileName;
+  if (directory.empty())
+    {
+    levelFileName << stem;
+    }
+  else
+    {
+    levelFileName << directory << '/' << (separator == std::string::npos ? stem : stem.substr(separator + 1));
+    }
+  levelFileName << "_lod" << level << (hasExtension ? fileName.substr(dot) : std::string());
+  return levelFileName.str();
+}
+
+}
@@ -0,0 +1,47 @@
+#ifndef SurfaceToolboxQuadricDecimation_h
+#define SurfaceToolboxQuadricDecimation_h
+
+#include "SurfaceToolboxStages.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace SurfaceToolbox
+{
+
+/// Multi-threaded quadric error decimation.
+///
+/// The surface is triangulated, then edges are collapsed in order of
+/// increasing quadric error. The bounding box is split into a grid of regions
+/// that are decimated concurrently; an edge is only collapsed by a region that
+/// owns every vertex around it, so regions never touch the same triangles.
+/// The grid is shifted between rounds so that edges on region borders are
+/// processed too. Point data arrays are interpolated along collapsed edges and
+/// cell data arrays are passed for the remaining triangles.
+///
+/// Decimation stops when the target number of triangles (or target
+/// reduction) is reached, or when every remaining collapse would move the
+/// surface by more than MaximumError (root mean square distance to the
+/// original triangle planes), if it is set. A MaximumError without a
+/// TargetNumberOfTriangles is the only limit: TargetReduction is ignored.
+vtkSmartPointer<vtkPolyData> RunQuadricDecimation(vtkPolyData* input, const DecimationParameters& parameters);
+
+/// Quadric decimation to several levels of detail in one run. The levels are
+/// reached one after the other, from the least to the most reduced, each
+/// continuing the collapses of the previous one from where it stopped: a
+/// coarser level only costs its additional collapses and the copy of its
+/// output. TargetNumberOfTriangles is ignored. Returns one surface per reduction of
+/// \a targetReductions, in the same order.
+std::vector<vtkSmartPointer<vtkPolyData>> RunQuadricDecimationLevels(vtkPolyData* input,
+                                                                     const DecimationParameters& parameters,
+                                                                     const std::vector<double>& targetReductions);
+
+/// File of the additional level \a level of the output \a fileName, in
+/// \a directory, or next to \a fileName if \a directory is empty:
+/// "surface.vtp" gives "surface_lod1.vtp".
+std::string GetLevelFileName(const std::string& fileName, const std::string& directory, size_t level);
+
+}
+
+#endif
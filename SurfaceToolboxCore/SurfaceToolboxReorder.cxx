@@ -0,0 +1,241 @@
+#include "SurfaceToolboxReorder.h"
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkFieldData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Bits of the integer coordinates of the points along each axis
+const int KeyBits = 21;
+
+//----------------------------------------------------------------------------
+// Spread the 21 low bits of \a value to every third bit.
+vtkTypeUInt64 SpreadBits(vtkTypeUInt64 value)
+{
+  value &= 0x1fffff;
+  value = (value | value << 32) & 0x1f00000000ffffULL;
+  value = (value | value << 16) & 0x1f0000ff0000ffULL;
+  value = (value | value << 8) & 0x100f00f00f00f00fULL;
+  value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+  value = (value | value << 2) & 0x1249249249249249ULL;
+  return value;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 GetMortonKey(const vtkTypeUInt32 x[3])
+{
+  return SpreadBits(x[0]) << 2 | SpreadBits(x[1]) << 1 | SpreadBits(x[2]);
+}
+
+//----------------------------------------------------------------------------
+// Hilbert curve index by transposition of the coordinates, from J. Skilling,
+// "Programming the Hilbert curve", AIP Conference Proceedings 707, 2004.
+vtkTypeUInt64 GetHilbertKey(const vtkTypeUInt32 coordinates[3])
+{
+  vtkTypeUInt32 x[3] = { coordinates[0], coordinates[1], coordinates[2] };
+  const vtkTypeUInt32 highBit = vtkTypeUInt32(1) << (KeyBits - 1);
+  // Inverse undo
+  for (vtkTypeUInt32 q = highBit; q > 1; q >>= 1)
+    {
+    const vtkTypeUInt32 p = q - 1;
+    for (int i = 0; i < 3; ++i)
+      {
+      if (x[i] & q)
+        {
+        x[0] ^= p;
+        }
+      else
+        {
+        const vtkTypeUInt32 t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+        }
+      }
+    }
+  // Gray encode
+  x[1] ^= x[0];
+  x[2] ^= x[1];
+  vtkTypeUInt32 t = 0;
+  for (vtkTypeUInt32 q = highBit; q > 1; q >>= 1)
+    {
+    if (x[2] & q)
+      {
+      t ^= q - 1;
+      }
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    x[i] ^= t;
+    }
+  return GetMortonKey(x);
+}
+
+//----------------------------------------------------------------------------
+// Sort the cells [firstCellId, lastCellId) of the cells given by GetCells by
+// their smallest new point id, and append their old ids to cellIds. Return
+// them as a cell array with their points renumbered by pointMap.
+vtkSmartPointer<vtkCellArray> SortCells(const std::vector<vtkIdType>& offsets,
+                                        const std::vector<vtkIdType>& connectivity,
+                                        vtkIdType firstCellId, vtkIdType lastCellId,
+                                        const std::vector<vtkIdType>& pointMap, std::vector<vtkIdType>& cellIds)
+{
+  const vtkIdType numberOfCells = lastCellId - firstCellId;
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(pointMap.size());
+  std::vector<std::pair<vtkIdType, vtkIdType>> keys(numberOfCells);
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      const vtkIdType cellId = firstCellId + i;
+      // Empty cells go last
+      vtkIdType key = numberOfPoints;
+      for (vtkIdType j = offsets[cellId]; j < offsets[cellId + 1]; ++j)
+        {
+        key = std::min(key, pointMap[connectivity[j]]);
+        }
+      keys[i] = std::make_pair(key, cellId);
+      }
+    });
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+
+  vtkNew<vtkIdTypeArray> newOffsets;
+  newOffsets->SetNumberOfValues(numberOfCells + 1);
+  vtkIdType* newOffsetsPointer = newOffsets->GetPointer(0);
+  newOffsetsPointer[0] = 0;
+  for (vtkIdType i = 0; i < numberOfCells; ++i)
+    {
+    const vtkIdType cellId = keys[i].second;
+    newOffsetsPointer[i + 1] = newOffsetsPointer[i] + offsets[cellId + 1] - offsets[cellId];
+    cellIds.push_back(cellId);
+    }
+  vtkNew<vtkIdTypeArray> newConnectivity;
+  newConnectivity->SetNumberOfValues(newOffsetsPointer[numberOfCells]);
+  vtkIdType* newConnectivityPointer = newConnectivity->GetPointer(0);
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      const vtkIdType cellId = keys[i].second;
+      vtkIdType* destination = newConnectivityPointer + newOffsetsPointer[i];
+      for (vtkIdType j = offsets[cellId]; j < offsets[cellId + 1]; ++j)
+        {
+        *destination++ = pointMap[connectivity[j]];
+        }
+      }
+    });
+
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  cells->SetData(newOffsets, newConnectivity);
+  return cells;
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunReorder(vtkPolyData* input, const ReorderParameters& parameters)
+{
+  const bool hilbert = parameters.Curve == "Hilbert";
+  if (!hilbert && parameters.Curve != "Morton")
+    {
+    std::cerr << "Unknown reordering curve: " << parameters.Curve << std::endl;
+    return nullptr;
+    }
+  vtkPoints* inputPoints = input->GetPoints();
+  if (!inputPoints || inputPoints->GetNumberOfPoints() == 0)
+    {
+    return input;
+    }
+  const vtkIdType numberOfPoints = inputPoints->GetNumberOfPoints();
+
+  // Integer coordinates in the bounding cube, so that the curve has the same
+  // resolution along all axes
+  double bounds[6];
+  inputPoints->GetBounds(bounds);
+  const double size = std::max(bounds[1] - bounds[0], std::max(bounds[3] - bounds[2], bounds[5] - bounds[4]));
+  const double maximum = static_cast<double>((vtkTypeUInt32(1) << KeyBits) - 1);
+  const double scale = size > 0.0 ? maximum / size : 0.0;
+
+  std::vector<std::pair<vtkTypeUInt64, vtkIdType>> keys(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    double point[3];
+    vtkTypeUInt32 x[3];
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      inputPoints->GetPoint(pointId, point);
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        x[axis] = static_cast<vtkTypeUInt32>(std::min(std::max((point[axis] - bounds[2 * axis]) * scale, 0.0), maximum));
+        }
+      keys[pointId] = std::make_pair(hilbert ? GetHilbertKey(x) : GetMortonKey(x), pointId);
+      }
+    });
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+
+  // pointIds[newId] is the input id of the point, pointMap[inputId] its new id
+  std::vector<vtkIdType> pointIds(numberOfPoints);
+  std::vector<vtkIdType> pointMap(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      pointIds[i] = keys[i].second;
+      pointMap[keys[i].second] = i;
+      }
+    });
+  keys.clear();
+  keys.shrink_to_fit();
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetData(vtkDataArray::SafeDownCast(CopyTuples(inputPoints->GetData(), pointIds)));
+  output->SetPoints(points);
+  CopyTuples(input->GetPointData(), output->GetPointData(), pointIds);
+  pointIds.clear();
+  pointIds.shrink_to_fit();
+
+  // Cells are sorted within their type, as cell ids follow the type order
+  std::vector<vtkIdType> offsets;
+  std::vector<vtkIdType> connectivity;
+  GetCells(input, offsets, connectivity);
+  const vtkIdType numberOfCells[4] = { input->GetNumberOfVerts(), input->GetNumberOfLines(),
+                                       input->GetNumberOfPolys(), input->GetNumberOfStrips() };
+  std::vector<vtkIdType> cellIds;
+  cellIds.reserve(offsets.size() - 1);
+  vtkSmartPointer<vtkCellArray> cells[4];
+  vtkIdType firstCellId = 0;
+  for (int type = 0; type < 4; ++type)
+    {
+    cells[type] = SortCells(offsets, connectivity, firstCellId, firstCellId + numberOfCells[type], pointMap, cellIds);
+    firstCellId += numberOfCells[type];
+    }
+  output->SetVerts(cells[0]);
+  output->SetLines(cells[1]);
+  output->SetPolys(cells[2]);
+  output->SetStrips(cells[3]);
+  CopyTuples(input->GetCellData(), output->GetCellData(), cellIds);
+  output->GetFieldData()->PassData(input->GetFieldData());
+  return output;
+}
+
+}
@@ -0,0 +1,41 @@
+#ifndef SurfaceToolboxReorder_h
+#define SurfaceToolboxReorder_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+// STD includes
+#include <string>
+
+class vtkPolyData;
+
+namespace SurfaceToolbox
+{
+
+struct ReorderParameters
+{
+  // Space-filling curve along which points are sorted: "Hilbert" or "Morton".
+  std::string Curve = "Hilbert";
+};
+
+/// Spatial-locality reordering of a surface, so that the stages walking the
+/// neighbors of points and faces (Smoothing, Normals, Connectivity, Cleaner)
+/// access nearby memory. Surfaces from segmentation come in the order of the
+/// marching cubes slices, where the neighbors of a point are far apart.
+///
+/// The bounding cube of the points is divided into 2^21 steps per axis, and
+/// the key of every point is the index of its step along a Hilbert or Morton
+/// curve, computed in parallel. Points are sorted by key, ties keeping their
+/// input order, and the cells are renumbered. The cells of each type
+/// (vertices, lines, polygons, strips) are then sorted by their smallest new
+/// point id, which is the order of their smallest point key. Cell point order,
+/// and so face orientation, is kept. All point and cell data arrays follow
+/// their points and cells, field data is passed.
+///
+/// Returns nullptr if the curve is unknown.
+vtkSmartPointer<vtkPolyData> RunReorder(vtkPolyData* input, const ReorderParameters& parameters);
+
+}
+
+#endif
@@ -0,0 +1,470 @@
+#include "SurfaceToolboxSharedMemory.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkTypeInt32Array.h"
+#include "vtkTypeInt64Array.h"
+
+// STD includes
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const char Magic[8] = "STSHM01";
+const vtkTypeUInt32 Version = 1;
+const size_t Alignment = 64;
+
+static_assert(sizeof(SurfaceToolbox::SharedMemoryHeader) == 64, "unexpected shared memory header size");
+static_assert(sizeof(SurfaceToolbox::SharedMemoryArrayEntry) == 96, "unexpected shared memory entry size");
+
+//----------------------------------------------------------------------------
+size_t Align(size_t size)
+{
+  return (size + Alignment - 1) / Alignment * Alignment;
+}
+
+//----------------------------------------------------------------------------
+// "shm:/name" or "shm:name" to the POSIX name "/name"
+std::string GetSegmentName(const std::string& fileName)
+{
+  std::string name = fileName.substr(4);
+  if (name.empty() || name[0] != '/')
+    {
+    name = "/" + name;
+    }
+  return name;
+}
+
+//----------------------------------------------------------------------------
+struct ArrayToWrite
+{
+  vtkDataArray* Array;
+  SurfaceToolbox::SharedMemoryArrayEntry Entry;
+};
+
+//----------------------------------------------------------------------------
+// Returns false if the name of the array does not fit in its entry.
+bool AddArray(vtkDataArray* array, int role, int attribute, int dataType, std::vector<ArrayToWrite>& arrays)
+{
+  ArrayToWrite arrayToWrite;
+  arrayToWrite.Array = array;
+  SurfaceToolbox::SharedMemoryArrayEntry& entry = arrayToWrite.Entry;
+  std::memset(&entry, 0, sizeof(entry));
+  if (array->GetName())
+    {
+    if (std::strlen(array->GetName()) >= sizeof(entry.Name))
+      {
+      std::cerr << "Cannot write the array " << array->GetName() << " to shared memory: names are limited to "
+                << sizeof(entry.Name) - 1 << " bytes" << std::endl;
+      return false;
+      }
+    std::strcpy(entry.Name, array->GetName());
+    }
+  entry.Role = role;
+  entry.Attribute = attribute;
+  entry.DataType = dataType;
+  entry.NumberOfComponents = array->GetNumberOfComponents();
+  entry.NumberOfTuples = array->GetNumberOfTuples();
+  arrays.push_back(arrayToWrite);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool AddAttributeArrays(vtkDataSetAttributes* attributes, int role, std::vector<ArrayToWrite>& arrays)
+{
+  for (int i = 0; i < attributes->GetNumberOfArrays(); ++i)
+    {
+    vtkDataArray* array = attributes->GetArray(i);
+    // String, variant and non-contiguous arrays are not transferred
+    if (array && array->HasStandardMemoryLayout()
+        && !AddArray(array, role, attributes->IsArrayAnAttribute(i), array->GetDataType(), arrays))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+#ifndef _WIN32
+
+//----------------------------------------------------------------------------
+// Segments mapped by ReadSharedMemoryPolyData, with the number of arrays
+// still using them.
+struct Mapping
+{
+  char* Address;
+  size_t Size;
+  int References;
+};
+
+std::mutex MappingsMutex;
+std::vector<Mapping> Mappings;
+
+//----------------------------------------------------------------------------
+// Free function of the arrays using mapped memory: unmap the segment when its
+// last array is deleted.
+void ReleaseMappedArray(void* pointer)
+{
+  std::lock_guard<std::mutex> lock(MappingsMutex);
+  char* address = static_cast<char*>(pointer);
+  for (auto mapping = Mappings.begin(); mapping != Mappings.end(); ++mapping)
+    {
+    if (address >= mapping->Address && address < mapping->Address + mapping->Size)
+      {
+      if (--mapping->References == 0)
+        {
+        munmap(mapping->Address, mapping->Size);
+        Mappings.erase(mapping);
+        }
+      return;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Array of the given type using count values at address, without copying
+template <typename ArrayType>
+vtkSmartPointer<ArrayType> CreateMappedArray(ArrayType* array, const SurfaceToolbox::SharedMemoryArrayEntry& entry,
+                                             char* address)
+{
+  vtkSmartPointer<ArrayType> result = vtkSmartPointer<ArrayType>::Take(array);
+  result->SetNumberOfComponents(entry.NumberOfComponents);
+  if (entry.Name[0])
+    {
+    result->SetName(entry.Name);
+    }
+  const vtkIdType numberOfValues = static_cast<vtkIdType>(entry.NumberOfTuples) * entry.NumberOfComponents;
+  if (numberOfValues == 0)
+    {
+    return result;
+    }
+  {
+  std::lock_guard<std::mutex> lock(MappingsMutex);
+  for (Mapping& mapping : Mappings)
+    {
+    if (address >= mapping.Address && address < mapping.Address + mapping.Size)
+      {
+      ++mapping.References;
+      }
+    }
+  }
+  result->SetVoidArray(address + entry.Offset, numberOfValues, 0, vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+  result->SetArrayFreeFunction(&ReleaseMappedArray);
+  return result;
+}
+
+#endif
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+bool IsSharedMemoryName(const std::string& fileName)
+{
+  return fileName.compare(0, 4, "shm:") == 0;
+}
+
+#ifdef _WIN32
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadSharedMemoryPolyData(const std::string& fileName)
+{
+  std::cerr << "Cannot read " << fileName << ": shared memory surfaces are not supported on Windows" << std::endl;
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------
+bool WriteSharedMemoryPolyData(vtkPolyData*, const std::string& fileName)
+{
+  std::cerr << "Cannot write " << fileName << ": shared memory surfaces are not supported on Windows" << std::endl;
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool RemoveSharedMemory(const std::string&)
+{
+  return false;
+}
+
+#else
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadSharedMemoryPolyData(const std::string& fileName)
+{
+  const std::string name = GetSegmentName(fileName);
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    {
+    std::cerr << "Cannot open shared memory " << name << ": " << std::strerror(errno) << std::endl;
+    return nullptr;
+    }
+  struct stat status;
+  if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(SharedMemoryHeader))
+    {
+    std::cerr << "Invalid shared memory surface " << name << std::endl;
+    close(fd);
+    return nullptr;
+    }
+  const size_t size = static_cast<size_t>(status.st_size);
+  void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    {
+    std::cerr << "Cannot map shared memory " << name << ": " << std::strerror(errno) << std::endl;
+    return nullptr;
+    }
+  char* address = static_cast<char*>(mapped);
+  {
+  // Reference held while the surface is created
+  std::lock_guard<std::mutex> lock(MappingsMutex);
+  Mappings.push_back(Mapping{ address, size, 1 });
+  }
+
+  const SharedMemoryHeader* header = reinterpret_cast<const SharedMemoryHeader*>(address);
+  const SharedMemoryArrayEntry* entries = reinterpret_cast<const SharedMemoryArrayEntry*>(address + sizeof(SharedMemoryHeader));
+  bool valid = std::memcmp(header->Magic, Magic, sizeof(Magic)) == 0 && header->Version == Version
+    && header->Size <= size
+    && sizeof(SharedMemoryHeader) + header->NumberOfArrays * sizeof(SharedMemoryArrayEntry) <= size;
+  for (vtkTypeUInt32 i = 0; valid && i < header->NumberOfArrays; ++i)
+    {
+    const SharedMemoryArrayEntry& entry = entries[i];
+    vtkSmartPointer<vtkDataArray> probe = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(entry.DataType));
+    valid = probe && entry.NumberOfComponents > 0 && entry.NumberOfTuples >= 0 && entry.Offset >= 0
+      && entry.Offset % Alignment == 0
+      && static_cast<size_t>(entry.Offset) + static_cast<size_t>(entry.NumberOfTuples) * entry.NumberOfComponents
+         * probe->GetDataTypeSize() <= size;
+    }
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkDataArray> offsets[4];
+  vtkSmartPointer<vtkDataArray> connectivity[4];
+  for (vtkTypeUInt32 i = 0; valid && i < header->NumberOfArrays; ++i)
+    {
+    const SharedMemoryArrayEntry& entry = entries[i];
+    if (entry.Role >= SharedMemoryVertsOffsets && entry.Role <= SharedMemoryStripsConnectivity)
+      {
+      // Cells are used directly only in the types of the vtkCellArray storage
+      vtkSmartPointer<vtkDataArray> array;
+      if (entry.DataType == VTK_TYPE_INT64)
+        {
+        array = CreateMappedArray(vtkTypeInt64Array::New(), entry, address);
+        }
+      else if (entry.DataType == VTK_TYPE_INT32)
+        {
+        array = CreateMappedArray(vtkTypeInt32Array::New(), entry, address);
+        }
+      else
+        {
+        valid = false;
+        break;
+        }
+      const int cellType = (entry.Role - SharedMemoryVertsOffsets) / 2;
+      if ((entry.Role - SharedMemoryVertsOffsets) % 2 == 0)
+        {
+        offsets[cellType] = array;
+        }
+      else
+        {
+        connectivity[cellType] = array;
+        }
+      continue;
+      }
+
+    vtkSmartPointer<vtkDataArray> array = CreateMappedArray(vtkDataArray::CreateDataArray(entry.DataType), entry, address);
+    if (entry.Role == SharedMemoryPoints)
+      {
+      vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+      points->SetData(array);
+      polyData->SetPoints(points);
+      }
+    else if (entry.Role == SharedMemoryPointData || entry.Role == SharedMemoryCellData)
+      {
+      vtkDataSetAttributes* attributes = entry.Role == SharedMemoryPointData
+        ? static_cast<vtkDataSetAttributes*>(polyData->GetPointData())
+        : static_cast<vtkDataSetAttributes*>(polyData->GetCellData());
+      const int index = attributes->AddArray(array);
+      if (entry.Attribute >= 0)
+        {
+        attributes->SetActiveAttribute(index, entry.Attribute);
+        }
+      }
+    }
+
+  for (int cellType = 0; valid && cellType < 4; ++cellType)
+    {
+    if (!offsets[cellType] && !connectivity[cellType])
+      {
+      continue;
+      }
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    vtkTypeInt64Array* offsets64 = vtkTypeInt64Array::SafeDownCast(offsets[cellType]);
+    vtkTypeInt64Array* connectivity64 = vtkTypeInt64Array::SafeDownCast(connectivity[cellType]);
+    vtkTypeInt32Array* offsets32 = vtkTypeInt32Array::SafeDownCast(offsets[cellType]);
+    vtkTypeInt32Array* connectivity32 = vtkTypeInt32Array::SafeDownCast(connectivity[cellType]);
+    if (offsets64 && connectivity64)
+      {
+      valid = cells->SetData(offsets64, connectivity64);
+      }
+    else if (offsets32 && connectivity32)
+      {
+      valid = cells->SetData(offsets32, connectivity32);
+      }
+    else
+      {
+      valid = false;
+      }
+    if (cellType == 0)
+      {
+      polyData->SetVerts(cells);
+      }
+    else if (cellType == 1)
+      {
+      polyData->SetLines(cells);
+      }
+    else if (cellType == 2)
+      {
+      polyData->SetPolys(cells);
+      }
+    else
+      {
+      polyData->SetStrips(cells);
+      }
+    }
+
+  ReleaseMappedArray(address);
+  if (!valid)
+    {
+    std::cerr << "Invalid shared memory surface " << name << std::endl;
+    return nullptr;
+    }
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+bool WriteSharedMemoryPolyData(vtkPolyData* polyData, const std::string& fileName)
+{
+  std::vector<ArrayToWrite> arrays;
+  if (polyData->GetPoints())
+    {
+    vtkDataArray* points = polyData->GetPoints()->GetData();
+    if (!AddArray(points, SharedMemoryPoints, -1, points->GetDataType(), arrays))
+      {
+      return false;
+      }
+    }
+  vtkCellArray* cellArrays[4] = { polyData->GetVerts(), polyData->GetLines(), polyData->GetPolys(), polyData->GetStrips() };
+  for (int cellType = 0; cellType < 4; ++cellType)
+    {
+    vtkCellArray* cells = cellArrays[cellType];
+    if (!cells || cells->GetNumberOfCells() == 0)
+      {
+      continue;
+      }
+    const int dataType = cells->IsStorage64Bit() ? VTK_TYPE_INT64 : VTK_TYPE_INT32;
+    if (!AddArray(cells->GetOffsetsArray(), SharedMemoryVertsOffsets + 2 * cellType, -1, dataType, arrays)
+        || !AddArray(cells->GetConnectivityArray(), SharedMemoryVertsConnectivity + 2 * cellType, -1, dataType,
+                     arrays))
+      {
+      return false;
+      }
+    }
+  if (!AddAttributeArrays(polyData->GetPointData(), SharedMemoryPointData, arrays)
+      || !AddAttributeArrays(polyData->GetCellData(), SharedMemoryCellData, arrays))
+    {
+    return false;
+    }
+
+  size_t size = Align(sizeof(SharedMemoryHeader) + arrays.size() * sizeof(SharedMemoryArrayEntry));
+  for (ArrayToWrite& array : arrays)
+    {
+    array.Entry.Offset = static_cast<vtkTypeInt64>(size);
+    size += Align(static_cast<size_t>(array.Array->GetNumberOfValues()) * array.Array->GetDataTypeSize());
+    }
+
+  const std::string name = GetSegmentName(fileName);
+  const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+  if (fd < 0)
+    {
+    std::cerr << "Cannot create shared memory " << name << ": " << std::strerror(errno) << std::endl;
+    return false;
+    }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+    std::cerr << "Cannot allocate " << size << " bytes of shared memory " << name << ": " << std::strerror(errno)
+              << std::endl;
+    close(fd);
+    shm_unlink(name.c_str());
+    return false;
+    }
+  void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    {
+    std::cerr << "Cannot map shared memory " << name << ": " << std::strerror(errno) << std::endl;
+    shm_unlink(name.c_str());
+    return false;
+    }
+
+  char* address = static_cast<char*>(mapped);
+  SharedMemoryHeader* header = reinterpret_cast<SharedMemoryHeader*>(address);
+  std::memset(header, 0, sizeof(SharedMemoryHeader));
+  std::memcpy(header->Magic, Magic, sizeof(Magic));
+  header->Version = Version;
+  header->NumberOfArrays = static_cast<vtkTypeUInt32>(arrays.size());
+  header->Size = size;
+  SharedMemoryArrayEntry* entries = reinterpret_cast<SharedMemoryArrayEntry*>(address + sizeof(SharedMemoryHeader));
+  for (size_t i = 0; i < arrays.size(); ++i)
+    {
+    entries[i] = arrays[i].Entry;
+    }
+
+  // Values copied in chunks of a few megabytes, in parallel
+  const size_t chunkSize = 1 << 22;
+  for (const ArrayToWrite& array : arrays)
+    {
+    const char* source = static_cast<const char*>(array.Array->GetVoidPointer(0));
+    char* destination = address + array.Entry.Offset;
+    const size_t bytes = static_cast<size_t>(array.Array->GetNumberOfValues()) * array.Array->GetDataTypeSize();
+    vtkSMPTools::For(0, static_cast<vtkIdType>((bytes + chunkSize - 1) / chunkSize), [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType chunk = begin; chunk < end; ++chunk)
+        {
+        const size_t offset = static_cast<size_t>(chunk) * chunkSize;
+        std::memcpy(destination + offset, source + offset, std::min(chunkSize, bytes - offset));
+        }
+      });
+    }
+  munmap(mapped, size);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool RemoveSharedMemory(const std::string& fileName)
+{
+  return shm_unlink(GetSegmentName(fileName).c_str()) == 0;
+}
+
+#endif
+
+}
@@ -0,0 +1,85 @@
+#ifndef SurfaceToolboxSharedMemory_h
+#define SurfaceToolboxSharedMemory_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+// STD includes
+#include <string>
+
+class vtkPolyData;
+
+// Surfaces passed through named POSIX shared memory segments instead of files.
+// ReadPolyData and WritePolyData use a segment when given a name of the form
+// "shm:/name", so every CLI accepts them in place of file names.
+//
+// A segment starts with a SharedMemoryHeader followed by one
+// SharedMemoryArrayEntry per array, then the array values, each starting at a
+// multiple of 64 bytes. Values are in the byte order of the host, as segments
+// do not leave it. The segment is created by the writer and removed by the
+// reader's caller once the surface is not needed anymore (see
+// RemoveSharedMemory): Slicer creates the input segment and removes it when
+// the CLI is done, the CLI creates the output segment that Slicer reads and
+// removes.
+namespace SurfaceToolbox
+{
+
+struct SharedMemoryHeader
+{
+  char Magic[8];            // "STSHM01"
+  vtkTypeUInt32 Version;    // 1
+  vtkTypeUInt32 NumberOfArrays;
+  vtkTypeUInt64 Size;       // of the whole segment, in bytes
+  char Reserved[40];
+};
+
+enum SharedMemoryArrayRole
+{
+  SharedMemoryPoints = 0,
+  SharedMemoryVertsOffsets,
+  SharedMemoryVertsConnectivity,
+  SharedMemoryLinesOffsets,
+  SharedMemoryLinesConnectivity,
+  SharedMemoryPolysOffsets,
+  SharedMemoryPolysConnectivity,
+  SharedMemoryStripsOffsets,
+  SharedMemoryStripsConnectivity,
+  SharedMemoryPointData,
+  SharedMemoryCellData
+};
+
+struct SharedMemoryArrayEntry
+{
+  char Name[64];            // null-terminated, empty if the array has no name
+  vtkTypeInt32 Role;        // SharedMemoryArrayRole
+  vtkTypeInt32 Attribute;   // vtkDataSetAttributes::AttributeTypes, or -1
+  vtkTypeInt32 DataType;    // VTK data type, VTK_TYPE_INT32 or VTK_TYPE_INT64 for cells
+  vtkTypeInt32 NumberOfComponents;
+  vtkTypeInt64 NumberOfTuples;
+  vtkTypeInt64 Offset;      // of the values from the start of the segment, in bytes
+};
+
+/// Return true if \a fileName is a shared memory name, "shm:/name".
+bool IsSharedMemoryName(const std::string& fileName);
+
+/// Map the segment named by \a fileName and create a surface whose points,
+/// cells and point and cell data arrays use the mapped memory directly, without
+/// copying. The mapping is private: stages that modify the surface in place
+/// get their own copy of the modified pages and do not change the segment.
+/// The memory is unmapped when the last of these arrays is deleted.
+/// Returns nullptr if the segment cannot be mapped or is not valid.
+vtkSmartPointer<vtkPolyData> ReadSharedMemoryPolyData(const std::string& fileName);
+
+/// Create the segment named by \a fileName, replacing any segment of that
+/// name, and copy the points, cells and numeric point and cell data arrays of
+/// \a polyData into it. Returns false if the segment cannot be created, or if
+/// the name of an array is longer than the 63 bytes of its entry.
+bool WriteSharedMemoryPolyData(vtkPolyData* polyData, const std::string& fileName);
+
+/// Remove the segment named by \a fileName. Mappings of the segment stay valid.
+bool RemoveSharedMemory(const std::string& fileName);
+
+}
+
+#endif
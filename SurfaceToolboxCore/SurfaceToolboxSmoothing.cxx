@@ -0,0 +1,429 @@
+#include "SurfaceToolboxSmoothing.h"
+#include "SurfaceToolboxTopology.h"
+
+// VTK includes
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Point coordinates as separate x, y and z arrays
+template <typename ValueType>
+struct PointArrays
+{
+  std::vector<ValueType> X;
+  std::vector<ValueType> Y;
+  std::vector<ValueType> Z;
+
+  void Resize(vtkIdType numberOfPoints)
+  {
+    this->X.resize(numberOfPoints);
+    this->Y.resize(numberOfPoints);
+    this->Z.resize(numberOfPoints);
+  }
+
+  void Swap(PointArrays& other)
+  {
+    this->X.swap(other.X);
+    this->Y.swap(other.Y);
+    this->Z.swap(other.Z);
+  }
+};
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+struct PointDataArray;
+template <>
+struct PointDataArray<float>
+{
+  typedef vtkFloatArray Type;
+};
+template <>
+struct PointDataArray<double>
+{
+  typedef vtkDoubleArray Type;
+};
+
+//----------------------------------------------------------------------------
+// Neighbors used to smooth each vertex, in compressed sparse row form.
+// Fixed vertices have no neighbors.
+struct SmoothingNeighborhoods
+{
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Neighbors;
+};
+
+//----------------------------------------------------------------------------
+void BuildSmoothingNeighborhoods(vtkPolyData* input, bool boundarySmoothing, SmoothingNeighborhoods& neighborhoods)
+{
+  std::shared_ptr<const SurfaceToolbox::SurfaceTopology> topology = SurfaceToolbox::GetSurfaceTopology(input);
+  const SurfaceToolbox::EdgeAdjacency& adjacency = topology->Edges;
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(adjacency.Offsets.size()) - 1;
+
+  // Edges used by one face are on the boundary, edges used by more than two
+  // faces are non-manifold. Vertices on these edges are smoothed along them.
+  // Returns the number of neighbors of a vertex and copies them to neighbors
+  // if it is not null.
+  auto selectNeighbors = [&](vtkIdType pointId, vtkIdType* neighbors) -> vtkIdType
+    {
+    const vtkIdType firstEdge = adjacency.Offsets[pointId];
+    const vtkIdType lastEdge = adjacency.Offsets[pointId + 1];
+    vtkIdType numberOfBoundaryEdges = 0;
+    for (vtkIdType edge = firstEdge; edge < lastEdge; ++edge)
+      {
+      numberOfBoundaryEdges += (adjacency.EdgeUses[edge] != 2);
+      }
+    if (numberOfBoundaryEdges > 0 && (numberOfBoundaryEdges != 2 || !boundarySmoothing))
+      {
+      return 0;
+      }
+    vtkIdType numberOfNeighbors = 0;
+    for (vtkIdType edge = firstEdge; edge < lastEdge; ++edge)
+      {
+      if (numberOfBoundaryEdges == 0 || adjacency.EdgeUses[edge] != 2)
+        {
+        if (neighbors)
+          {
+          neighbors[numberOfNeighbors] = adjacency.Neighbors[edge];
+          }
+        ++numberOfNeighbors;
+        }
+      }
+    return numberOfNeighbors;
+    };
+
+  neighborhoods.Offsets.assign(numberOfPoints + 1, 0);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      neighborhoods.Offsets[pointId + 1] = selectNeighbors(pointId, nullptr);
+      }
+    });
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    neighborhoods.Offsets[pointId + 1] += neighborhoods.Offsets[pointId];
+    }
+
+  neighborhoods.Neighbors.resize(neighborhoods.Offsets[numberOfPoints]);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      selectNeighbors(pointId, neighborhoods.Neighbors.data() + neighborhoods.Offsets[pointId]);
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+void LoadPoints(vtkPoints* points, PointArrays<ValueType>& arrays)
+{
+  const vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  arrays.Resize(numberOfPoints);
+  typename PointDataArray<ValueType>::Type* data = PointDataArray<ValueType>::Type::SafeDownCast(points->GetData());
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    double point[3];
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      if (data)
+        {
+        const ValueType* p = data->GetPointer(3 * pointId);
+        arrays.X[pointId] = p[0];
+        arrays.Y[pointId] = p[1];
+        arrays.Z[pointId] = p[2];
+        }
+      else
+        {
+        points->GetPoint(pointId, point);
+        arrays.X[pointId] = static_cast<ValueType>(point[0]);
+        arrays.Y[pointId] = static_cast<ValueType>(point[1]);
+        arrays.Z[pointId] = static_cast<ValueType>(point[2]);
+        }
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+vtkSmartPointer<vtkPoints> CreatePoints(const PointArrays<ValueType>& arrays, int dataType)
+{
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(arrays.X.size());
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataType(dataType);
+  points->SetNumberOfPoints(numberOfPoints);
+  typename PointDataArray<ValueType>::Type* data = PointDataArray<ValueType>::Type::SafeDownCast(points->GetData());
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      if (data)
+        {
+        ValueType* p = data->GetPointer(3 * pointId);
+        p[0] = arrays.X[pointId];
+        p[1] = arrays.Y[pointId];
+        p[2] = arrays.Z[pointId];
+        }
+      else
+        {
+        points->SetPoint(pointId, arrays.X[pointId], arrays.Y[pointId], arrays.Z[pointId]);
+        }
+      }
+    });
+  return points;
+}
+
+//----------------------------------------------------------------------------
+// Average position of the neighbors of a vertex
+template <typename ValueType>
+inline void ComputeAverage(const PointArrays<ValueType>& points, const vtkIdType* neighbors,
+                           vtkIdType numberOfNeighbors, ValueType average[3])
+{
+  ValueType x = 0, y = 0, z = 0;
+  for (vtkIdType i = 0; i < numberOfNeighbors; ++i)
+    {
+    x += points.X[neighbors[i]];
+    y += points.Y[neighbors[i]];
+    z += points.Z[neighbors[i]];
+    }
+  const ValueType scale = ValueType(1) / static_cast<ValueType>(numberOfNeighbors);
+  average[0] = x * scale;
+  average[1] = y * scale;
+  average[2] = z * scale;
+}
+
+//----------------------------------------------------------------------------
+// Laplacian smoothing, as in vtkSmoothPolyDataFilter
+template <typename ValueType>
+void SmoothLaplace(const SmoothingNeighborhoods& neighborhoods, int numberOfIterations, double relaxationFactor,
+                   PointArrays<ValueType>& points)
+{
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(points.X.size());
+  const ValueType relaxation = static_cast<ValueType>(relaxationFactor);
+  PointArrays<ValueType> newPoints;
+  newPoints.Resize(numberOfPoints);
+  for (int iteration = 0; iteration < numberOfIterations; ++iteration)
+    {
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      ValueType average[3];
+      for (vtkIdType pointId = begin; pointId < end; ++pointId)
+        {
+        const vtkIdType numberOfNeighbors = neighborhoods.Offsets[pointId + 1] - neighborhoods.Offsets[pointId];
+        if (numberOfNeighbors == 0)
+          {
+          newPoints.X[pointId] = points.X[pointId];
+          newPoints.Y[pointId] = points.Y[pointId];
+          newPoints.Z[pointId] = points.Z[pointId];
+          continue;
+          }
+        ComputeAverage(points, &neighborhoods.Neighbors[neighborhoods.Offsets[pointId]], numberOfNeighbors, average);
+        newPoints.X[pointId] = points.X[pointId] + relaxation * (average[0] - points.X[pointId]);
+        newPoints.Y[pointId] = points.Y[pointId] + relaxation * (average[1] - points.Y[pointId]);
+        newPoints.Z[pointId] = points.Z[pointId] + relaxation * (average[2] - points.Z[pointId]);
+        }
+      });
+    points.Swap(newPoints);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Chebyshev coefficients of the windowed sinc filter, with the offset
+// computed so that the pass band is preserved (same as
+// vtkWindowedSincPolyDataFilter, with a Hamming window).
+std::vector<double> ComputeWindowedSincCoefficients(int numberOfIterations, double passBand)
+{
+  const int n = numberOfIterations;
+  const double thetaPassBand = std::acos(1.0 - 0.5 * passBand);
+  std::vector<double> w(n + 1);
+  std::vector<double> c(n + 1);
+  std::vector<double> cPrime(n + 1);
+  for (int i = 0; i <= n; ++i)
+    {
+    w[i] = 0.54 + 0.46 * std::cos(i * vtkMath::Pi() / (n + 1));
+    }
+
+  // Newton-Raphson search for the offset sigma such that f(passBand) = 1
+  double sigma = 0.0;
+  double f = 0.0;
+  for (int iteration = 0; iteration < 500; ++iteration)
+    {
+    c[0] = w[0] * (thetaPassBand + sigma) / vtkMath::Pi();
+    for (int i = 1; i <= n; ++i)
+      {
+      c[i] = w[i] * 2.0 * std::sin(i * (thetaPassBand + sigma)) / (i * vtkMath::Pi());
+      }
+    if (n < 2)
+      {
+      // The offset cannot be optimized, the surface will most likely shrink
+      break;
+      }
+    cPrime[n] = 0.0;
+    cPrime[n - 1] = 0.0;
+    cPrime[n - 2] = 2.0 * (n - 1) * c[n - 1];
+    for (int i = n - 3; i >= 0; --i)
+      {
+      cPrime[i] = cPrime[i + 2] + 2.0 * (i + 1) * c[i + 1];
+      }
+    f = 0.0;
+    double fPrime = 0.0;
+    for (int i = 0; i <= n; ++i)
+      {
+      const double chebyshev = std::cos(i * thetaPassBand);
+      f += c[i] * chebyshev;
+      fPrime += cPrime[i] * chebyshev;
+      }
+    if (std::fabs(f - 1.0) < 1e-3)
+      {
+      break;
+      }
+    sigma -= (f - 1.0) / fPrime;
+    }
+  if (n >= 2 && std::fabs(f - 1.0) >= 1e-3)
+    {
+    std::cerr << "An optimal offset for the smoothing filter could not be found. "
+                 "Unpredictable smoothing/shrinkage may result." << std::endl;
+    }
+  return c;
+}
+
+//----------------------------------------------------------------------------
+// Windowed sinc smoothing, as in vtkWindowedSincPolyDataFilter. The filter is
+// evaluated as a sum of Chebyshev polynomials of the Laplacian operator:
+// x[k + 1] = x[k] + average(x[k]) - x[k - 1].
+template <typename ValueType>
+void SmoothWindowedSinc(const SmoothingNeighborhoods& neighborhoods, int numberOfIterations, double passBand,
+                        PointArrays<ValueType>& points)
+{
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(points.X.size());
+  const std::vector<double> coefficients = ComputeWindowedSincCoefficients(numberOfIterations, passBand);
+
+  PointArrays<ValueType> previous; // x[k - 1]
+  PointArrays<ValueType> current;  // x[k]
+  PointArrays<ValueType> next;     // x[k + 1]
+  previous = points;
+  current.Resize(numberOfPoints);
+  next.Resize(numberOfPoints);
+
+  // First iteration: x[1] = x[0] + (average(x[0]) - x[0]) / 2
+  const ValueType c0 = static_cast<ValueType>(coefficients[0]);
+  const ValueType c1 = static_cast<ValueType>(coefficients[1]);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    ValueType average[3];
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      const vtkIdType numberOfNeighbors = neighborhoods.Offsets[pointId + 1] - neighborhoods.Offsets[pointId];
+      const ValueType x = previous.X[pointId];
+      const ValueType y = previous.Y[pointId];
+      const ValueType z = previous.Z[pointId];
+      if (numberOfNeighbors == 0)
+        {
+        current.X[pointId] = x;
+        current.Y[pointId] = y;
+        current.Z[pointId] = z;
+        continue;
+        }
+      ComputeAverage(previous, &neighborhoods.Neighbors[neighborhoods.Offsets[pointId]], numberOfNeighbors, average);
+      current.X[pointId] = x + ValueType(0.5) * (average[0] - x);
+      current.Y[pointId] = y + ValueType(0.5) * (average[1] - y);
+      current.Z[pointId] = z + ValueType(0.5) * (average[2] - z);
+      points.X[pointId] = c0 * x + c1 * current.X[pointId];
+      points.Y[pointId] = c0 * y + c1 * current.Y[pointId];
+      points.Z[pointId] = c0 * z + c1 * current.Z[pointId];
+      }
+    });
+
+  for (int iteration = 2; iteration <= numberOfIterations; ++iteration)
+    {
+    const ValueType c = static_cast<ValueType>(coefficients[iteration]);
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      ValueType average[3];
+      for (vtkIdType pointId = begin; pointId < end; ++pointId)
+        {
+        const vtkIdType numberOfNeighbors = neighborhoods.Offsets[pointId + 1] - neighborhoods.Offsets[pointId];
+        if (numberOfNeighbors == 0)
+          {
+          // Fixed points keep their input position
+          next.X[pointId] = current.X[pointId];
+          next.Y[pointId] = current.Y[pointId];
+          next.Z[pointId] = current.Z[pointId];
+          continue;
+          }
+        ComputeAverage(current, &neighborhoods.Neighbors[neighborhoods.Offsets[pointId]], numberOfNeighbors, average);
+        next.X[pointId] = average[0] + current.X[pointId] - previous.X[pointId];
+        next.Y[pointId] = average[1] + current.Y[pointId] - previous.Y[pointId];
+        next.Z[pointId] = average[2] + current.Z[pointId] - previous.Z[pointId];
+        points.X[pointId] += c * next.X[pointId];
+        points.Y[pointId] += c * next.Y[pointId];
+        points.Z[pointId] += c * next.Z[pointId];
+        }
+      });
+    previous.Swap(current);
+    current.Swap(next);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+vtkSmartPointer<vtkPoints> Smooth(vtkPolyData* input, const SurfaceToolbox::SmoothingParameters& parameters)
+{
+  SmoothingNeighborhoods neighborhoods;
+  BuildSmoothingNeighborhoods(input, parameters.BoundarySmoothing, neighborhoods);
+
+  PointArrays<ValueType> points;
+  LoadPoints(input->GetPoints(), points);
+  if (parameters.Method == "Taubin")
+    {
+    SmoothWindowedSinc(neighborhoods, parameters.Iterations, parameters.PassBand, points);
+    }
+  else
+    {
+    SmoothLaplace(neighborhoods, parameters.Iterations, parameters.Relaxation, points);
+    }
+  return CreatePoints(points, input->GetPoints()->GetDataType());
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunParallelSmoothing(vtkPolyData* input, const SmoothingParameters& parameters)
+{
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(input);
+  if (input->GetNumberOfPoints() == 0 || parameters.Iterations <= 0)
+    {
+    return output;
+    }
+
+  if (input->GetPoints()->GetDataType() == VTK_DOUBLE)
+    {
+    output->SetPoints(Smooth<double>(input, parameters));
+    }
+  else
+    {
+    output->SetPoints(Smooth<float>(input, parameters));
+    }
+  // Only the points moved: later stages can reuse the topology
+  PassSurfaceTopology(input, output);
+  return output;
+}
+
+}
@@ -0,0 +1,28 @@
+#ifndef SurfaceToolboxSmoothing_h
+#define SurfaceToolboxSmoothing_h
+
+#include "SurfaceToolboxStages.h"
+
+namespace SurfaceToolbox
+{
+
+/// Multi-threaded Laplacian and windowed sinc (Taubin) smoothing.
+///
+/// The vertex neighborhoods are built once as a compressed sparse row
+/// adjacency, and the iterations update all vertices in parallel from the
+/// positions of the previous iteration, stored as separate x, y and z arrays
+/// in the precision of the input points. Vertices follow the classification
+/// of vtkSmoothPolyDataFilter and vtkWindowedSincPolyDataFilter without
+/// feature edge smoothing: interior
+/// vertices move towards the average of their neighbors, vertices with
+/// exactly two boundary or non-manifold edges move along these edges if
+/// BoundarySmoothing is set, and all other vertices (boundary corners and
+/// vertices not used by polygons) are fixed.
+///
+/// The topology and the point and cell data of the input are passed to the
+/// output.
+vtkSmartPointer<vtkPolyData> RunParallelSmoothing(vtkPolyData* input, const SmoothingParameters& parameters);
+
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include "SurfaceToolboxStages.h"
+#include "SurfaceToolboxBorders.h"
+#include "SurfaceToolboxCleaner.h"
+#include "SurfaceToolboxClustering.h"
+#include "SurfaceToolboxConnectivity.h"
+#include "SurfaceToolboxFillHoles.h"
+#include "SurfaceToolboxNormals.h"
+#include "SurfaceToolboxQuadricDecimation.h"
+#include "SurfaceToolboxSmoothing.h"
+#include "SurfaceToolboxTransform.h"
+
+// VTK includes
+#include "vtkDecimatePro.h"
+#include "vtkMatrix4x4.h"
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataNormals.h"
+#include "vtkTriangleFilter.h"
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunDecimation(vtkPolyData* input, const DecimationParameters& parameters)
+{
+  if (parameters.Method == "Quadric")
+    {
+    return RunQuadricDecimation(input, parameters);
+    }
+  if (parameters.Method == "Clustering")
+    {
+    return RunClusteringDecimation(input, parameters);
+    }
+
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputData(input);
+  triangles->Update();
+
+  vtkNew<vtkDecimatePro> decimate;
+  decimate->SetInputData(triangles->GetOutput());
+  decimate->SetTargetReduction(parameters.TargetReduction);
+  decimate->SetBoundaryVertexDeletion(parameters.BoundaryVertexDeletion);
+  decimate->PreserveTopologyOn();
+  decimate->Update();
+  return decimate->GetOutput();
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunSmoothing(vtkPolyData* input, const SmoothingParameters& parameters)
+{
+  return RunParallelSmoothing(input, parameters);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunNormals(vtkPolyData* input, const NormalsParameters& parameters)
+{
+  if (input->GetNumberOfStrips() == 0)
+    {
+    return RunParallelNormals(input, parameters);
+    }
+
+  // vtkPolyDataNormals splits triangle strips into triangles
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputData(input);
+  normals->SetAutoOrientNormals(parameters.AutoOrient);
+  normals->SetFlipNormals(parameters.Flip);
+  normals->SetSplitting(parameters.Splitting);
+  if (parameters.Splitting)
+    {
+    // only applicable if splitting is set
+    normals->SetFeatureAngle(parameters.FeatureAngle);
+    }
+  normals->Update();
+  return normals->GetOutput();
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunMirror(vtkPolyData* input, const MirrorParameters& parameters)
+{
+  double matrix[16];
+  GetMirrorMatrix(parameters, matrix);
+  TransformPolyData(input, matrix);
+  return input;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunCleaner(vtkPolyData* input, const CleanerParameters& parameters)
+{
+  return RunParallelCleaner(input, parameters);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunFillHoles(vtkPolyData* input, const FillHolesParameters& parameters)
+{
+  vtkSmartPointer<vtkPolyData> filled = RunParallelFillHoles(input, parameters);
+  if (!filled)
+    {
+    return nullptr;
+    }
+
+  // Caps are oriented like the faces around them, but the output has point
+  // normals, as with vtkFillHolesFilter followed by an auto-oriented normals
+  // pass, so that closed surfaces are front-facing
+  NormalsParameters normalsParameters;
+  normalsParameters.AutoOrient = true;
+  return RunNormals(filled, normalsParameters);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunConnectivity(vtkPolyData* input, const ConnectivityParameters& parameters)
+{
+  return RunParallelConnectivity(input, parameters);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunScaleMesh(vtkPolyData* input, const ScaleParameters& parameters)
+{
+  double matrix[16];
+  GetScaleMatrix(parameters, matrix);
+  TransformPolyData(input, matrix);
+  return input;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunTranslateMesh(vtkPolyData* input, const TranslateParameters& parameters)
+{
+  double matrix[16];
+  GetTranslateMatrix(parameters, matrix);
+  TransformPolyData(input, matrix);
+  return input;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunRelaxPolygons(vtkPolyData* input, const RelaxParameters& parameters)
+{
+  // Similar to Smoothing, but with settings tuned for regularizing the mesh.
+  // The cleaned surface keeps the topology of the input if nothing was
+  // merged, and the smoothing reuses it.
+  vtkSmartPointer<vtkPolyData> cleaned = RunCleaner(input, CleanerParameters());
+
+  SmoothingParameters smoothing;
+  smoothing.Method = "Taubin";
+  smoothing.Iterations = parameters.Iterations;
+  smoothing.PassBand = 0.001;
+  smoothing.BoundarySmoothing = false;
+  return RunParallelSmoothing(cleaned, smoothing);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunBordersOut(vtkPolyData* input, const BordersParameters& parameters)
+{
+  return RunParallelBordersOut(input, parameters);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunMC2Origin(vtkPolyData* input, const MC2OriginParameters& parameters)
+{
+  double identity[16];
+  vtkMatrix4x4::Identity(identity);
+  double matrix[16];
+  GetMC2OriginMatrix(input, identity, parameters, matrix);
+  TransformPolyData(input, matrix);
+  return input;
+}
+
+//----------------------------------------------------------------------------
+void GetMirrorMatrix(const MirrorParameters& parameters, double matrix[16])
+{
+  vtkMatrix4x4::Identity(matrix);
+  matrix[0] = parameters.X ? -1.0 : 1.0;
+  matrix[5] = parameters.Y ? -1.0 : 1.0;
+  matrix[10] = parameters.Z ? -1.0 : 1.0;
+}
+
+//----------------------------------------------------------------------------
+void GetScaleMatrix(const ScaleParameters& parameters, double matrix[16])
+{
+  vtkMatrix4x4::Identity(matrix);
+  matrix[0] = parameters.X;
+  matrix[5] = parameters.Y;
+  matrix[10] = parameters.Z;
+}
+
+//----------------------------------------------------------------------------
+void GetTranslateMatrix(const TranslateParameters& parameters, double matrix[16])
+{
+  vtkMatrix4x4::Identity(matrix);
+  matrix[3] = parameters.X;
+  matrix[7] = parameters.Y;
+  matrix[11] = parameters.Z;
+}
+
+//----------------------------------------------------------------------------
+void GetMC2OriginMatrix(vtkPolyData* input, const double transform[16], const MC2OriginParameters& parameters,
+                        double matrix[16])
+{
+  // translate center of mesh to origin
+  vtkMatrix4x4::Identity(matrix);
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  if (numberOfPoints == 0)
+    {
+    return;
+    }
+
+  // sum of the points after the transform, sum(A * p + t) = A * sum(p) + n * t
+  double sum[3];
+  ComputePointSum(input, sum);
+  for (int row = 0; row < 3; ++row)
+    {
+    const double* transformRow = transform + 4 * row;
+    const double transformedSum = transformRow[0] * sum[0] + transformRow[1] * sum[1] + transformRow[2] * sum[2] +
+                                  numberOfPoints * transformRow[3];
+    // Calculate MC. By default, one point too many, which stops short of the
+    // mass center by 1 / (numberOfPoints + 1) of it, as the module always did.
+    matrix[4 * row + 3] = -transformedSum / (parameters.ExactMassCenter ? numberOfPoints : numberOfPoints + 1);
+    }
+}
+
+}
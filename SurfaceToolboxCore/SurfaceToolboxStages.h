@@ -0,0 +1,157 @@
+#ifndef SurfaceToolboxStages_h
+#define SurfaceToolboxStages_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+// STD includes
+#include <string>
+
+class vtkPolyData;
+
+// Each stage of the surface toolbox takes a surface and returns the processed
+// surface. The CLI modules run a single stage, the SurfacePipeline CLI chains
+// them in memory. Stages may modify the points and cells of their input in place,
+// after copying the arrays it shares with other surfaces.
+namespace SurfaceToolbox
+{
+
+struct DecimationParameters
+{
+  std::string Method = "DecimatePro"; // "DecimatePro", "Quadric" or "Clustering"
+  double TargetReduction = 0.8;
+  bool BoundaryVertexDeletion = true;
+  // Quadric only: if > 0, takes precedence over TargetReduction.
+  vtkIdType TargetNumberOfTriangles = 0;
+  // Quadric only: if > 0, collapses moving the surface further than this are not done.
+  // Without TargetNumberOfTriangles, it is the only limit and TargetReduction is ignored.
+  double MaximumError = 0.0;
+  // Clustering only: size of the cells of the clustering grid. If 0, chosen from TargetReduction.
+  double ClusterSize = 0.0;
+};
+
+struct SmoothingParameters
+{
+  std::string Method = "Laplace"; // "Laplace" or "Taubin"
+  int Iterations = 100;
+  double Relaxation = 0.5;  // Laplace only
+  double PassBand = 0.1;    // Taubin only
+  bool BoundarySmoothing = true;
+};
+
+struct NormalsParameters
+{
+  bool AutoOrient = false;
+  bool Flip = false;
+  bool Splitting = false;
+  double FeatureAngle = 30.0;
+  // Weight of the face normals summed into point normals: "Area" or "Angle"
+  // (angle of the face at the point).
+  std::string Weighting = "Area";
+};
+
+struct MirrorParameters
+{
+  bool X = false;
+  bool Y = false;
+  bool Z = false;
+};
+
+struct CleanerParameters
+{
+  // Points closer than this distance (in the same cell of a grid of this
+  // spacing) are merged. If 0, only coincident points are merged.
+  double Tolerance = 0.0;
+};
+
+struct FillHolesParameters
+{
+  // Holes whose points are farther than this from their centroid are not filled.
+  double MaximumHoleSize = 1000.0;
+  // "MinimumArea": triangulation of minimum total area (loops of up to 150 points).
+  // "EarClipping": ear clipping in the best-fit plane of the hole.
+  std::string Triangulation = "MinimumArea";
+  // If > 0, caps are refined to the boundary edge length and their added points smoothed with this number of iterations.
+  int FairingIterations = 0;
+  // If set, the size, fill status and cap of every hole are written to this CSV file.
+  std::string StatisticsFileName;
+};
+
+struct ConnectivityParameters
+{
+  // "Largest": keep the NumberOfRegions largest regions.
+  // "MinimumSize": keep the regions with at least MinimumNumberOfCells cells and MinimumArea area.
+  // "All": keep all regions, useful with LabelRegions.
+  std::string Mode = "Largest";
+  int NumberOfRegions = 1;
+  vtkIdType MinimumNumberOfCells = 0;
+  double MinimumArea = 0.0;
+  // Add "RegionId" point and cell arrays. Regions are numbered by decreasing number of cells.
+  bool LabelRegions = false;
+  // If set, the statistics of all regions are written to this CSV file.
+  std::string StatisticsFileName;
+};
+
+struct ScaleParameters
+{
+  double X = 1.0;
+  double Y = 1.0;
+  double Z = 1.0;
+};
+
+struct TranslateParameters
+{
+  double X = 0.0;
+  double Y = 0.0;
+  double Z = 0.0;
+};
+
+struct RelaxParameters
+{
+  int Iterations = 5;
+};
+
+struct BordersParameters
+{
+  // Treat points at the same location as one point, as if the surface was cleaned first.
+  bool MergeCoincidentPoints = true;
+  // If set, the number of edges, perimeter and closure of every boundary loop are written to this CSV file.
+  std::string StatisticsFileName;
+};
+
+struct MC2OriginParameters
+{
+  // Divide the sum of the points by their number, instead of their number plus
+  // one as the module always did, to move the mass center exactly to the origin.
+  bool ExactMassCenter = false;
+};
+
+vtkSmartPointer<vtkPolyData> RunDecimation(vtkPolyData* input, const DecimationParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunSmoothing(vtkPolyData* input, const SmoothingParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunNormals(vtkPolyData* input, const NormalsParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunMirror(vtkPolyData* input, const MirrorParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunCleaner(vtkPolyData* input, const CleanerParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunFillHoles(vtkPolyData* input, const FillHolesParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunConnectivity(vtkPolyData* input, const ConnectivityParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunScaleMesh(vtkPolyData* input, const ScaleParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunTranslateMesh(vtkPolyData* input, const TranslateParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunRelaxPolygons(vtkPolyData* input, const RelaxParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunBordersOut(vtkPolyData* input, const BordersParameters& parameters);
+vtkSmartPointer<vtkPolyData> RunMC2Origin(vtkPolyData* input, const MC2OriginParameters& parameters);
+
+/// Row-major 4x4 matrices of the transform stages (Mirror, scaleMesh,
+/// translateMesh and MC2Origin), which are applied in place by
+/// TransformPolyData. Consecutive transform stages can be composed and applied
+/// in a single pass over the points.
+void GetMirrorMatrix(const MirrorParameters& parameters, double matrix[16]);
+void GetScaleMatrix(const ScaleParameters& parameters, double matrix[16]);
+void GetTranslateMatrix(const TranslateParameters& parameters, double matrix[16]);
+/// Translation that moves the mass center of \a input, once \a transform is
+/// applied to it, to the origin.
+void GetMC2OriginMatrix(vtkPolyData* input, const double transform[16], const MC2OriginParameters& parameters,
+                        double matrix[16]);
+
+}
+
+#endif
@@ -0,0 +1,940 @@
+#include "SurfaceToolboxTiles.h"
+#include "SurfaceToolboxCleaner.h"
+#include "SurfaceToolboxMesh.h"
+#include "SurfaceToolboxNormals.h"
+#include "SurfaceToolboxPipeline.h"
+#include "SurfaceToolboxSmoothing.h"
+#include "SurfaceToolboxTopology.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string ToLower(std::string value)
+{
+  std::transform(value.begin(), value.end(), value.begin(),
+    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return value;
+}
+
+//----------------------------------------------------------------------------
+// Number of tiles of at most parameters.TileSize of the \a numberOfItems
+// items of \a input, and the number of them to process at the same time: one
+// per thread, and no more than fit in parameters.MemoryBudget. A tile holds
+// its surface with its halo, the working memory of the stage and its output,
+// estimated to four times the memory of its share of the input.
+int GetNumberOfTiles(vtkPolyData* input, vtkIdType numberOfItems, const SurfaceToolbox::TileParameters& parameters,
+                     int& concurrency)
+{
+  const vtkIdType tileSize = parameters.TileSize;
+  const int numberOfTiles = static_cast<int>((numberOfItems + tileSize - 1) / tileSize);
+  concurrency = std::min(vtkSMPTools::GetEstimatedNumberOfThreads(), numberOfTiles);
+  if (parameters.MemoryBudget > 0.0 && numberOfItems > 0)
+    {
+    const double inputMemory = static_cast<double>(input->GetActualMemorySize()) / 1024.0;
+    const double tileMemory = 4.0 * inputMemory * std::min(tileSize, numberOfItems) / numberOfItems;
+    if (tileMemory > 0.0)
+      {
+      concurrency = std::min(concurrency, static_cast<int>(parameters.MemoryBudget / tileMemory));
+      }
+    }
+  concurrency = std::max(1, concurrency);
+  return numberOfTiles;
+}
+
+//----------------------------------------------------------------------------
+// Assign each of \a numberOfItems items to one of \a numberOfTiles tiles by
+// recursive bisection at the median item along the axis of largest extent,
+// getCoordinate(item, axis) giving the location of an item. Items at the same
+// location along the split axis go to the same tile.
+template <typename GetCoordinate>
+std::vector<int> PartitionItems(vtkIdType numberOfItems, int numberOfTiles, GetCoordinate getCoordinate)
+{
+  std::vector<vtkIdType> items(numberOfItems);
+  std::iota(items.begin(), items.end(), 0);
+  std::vector<int> itemTile(numberOfItems, 0);
+
+  struct Range
+  {
+    vtkIdType Begin;
+    vtkIdType End;
+    int FirstTile;
+    int NumberOfTiles;
+  };
+  std::vector<Range> ranges = { { 0, numberOfItems, 0, numberOfTiles } };
+  while (!ranges.empty())
+    {
+    const Range range = ranges.back();
+    ranges.pop_back();
+    if (range.NumberOfTiles == 1 || range.Begin == range.End)
+      {
+      for (vtkIdType i = range.Begin; i < range.End; ++i)
+        {
+        itemTile[items[i]] = range.FirstTile;
+        }
+      continue;
+      }
+
+    double bounds[6] = { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+    for (vtkIdType i = range.Begin; i < range.End; ++i)
+      {
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        const double coordinate = getCoordinate(items[i], axis);
+        bounds[2 * axis] = std::min(bounds[2 * axis], coordinate);
+        bounds[2 * axis + 1] = std::max(bounds[2 * axis + 1], coordinate);
+        }
+      }
+    int splitAxis = 0;
+    for (int axis = 1; axis < 3; ++axis)
+      {
+      if (bounds[2 * axis + 1] - bounds[2 * axis] > bounds[2 * splitAxis + 1] - bounds[2 * splitAxis])
+        {
+        splitAxis = axis;
+        }
+      }
+
+    const int leftTiles = range.NumberOfTiles / 2;
+    const auto begin = items.begin() + range.Begin;
+    const auto end = items.begin() + range.End;
+    const auto median = begin + (range.End - range.Begin) * leftTiles / range.NumberOfTiles;
+    auto isBefore = [&](vtkIdType a, vtkIdType b)
+      {
+      return getCoordinate(a, splitAxis) < getCoordinate(b, splitAxis);
+      };
+    std::nth_element(begin, median, end, isBefore);
+    const double split = getCoordinate(*median, splitAxis);
+    const vtkIdType middle = std::partition(begin, end,
+      [&](vtkIdType item) { return getCoordinate(item, splitAxis) < split; }) - items.begin();
+    ranges.push_back({ range.Begin, middle, range.FirstTile, leftTiles });
+    ranges.push_back({ middle, range.End, range.FirstTile + leftTiles, range.NumberOfTiles - leftTiles });
+    }
+  return itemTile;
+}
+
+//----------------------------------------------------------------------------
+// Items of each tile in compressed sparse row form: the items of tile i are
+// tileItems[tileOffsets[i]] to tileItems[tileOffsets[i + 1] - 1], in increasing order.
+void GetTileItems(const std::vector<int>& itemTile, int numberOfTiles,
+                  std::vector<vtkIdType>& tileOffsets, std::vector<vtkIdType>& tileItems)
+{
+  tileOffsets.assign(numberOfTiles + 1, 0);
+  for (int tile : itemTile)
+    {
+    ++tileOffsets[tile + 1];
+    }
+  std::partial_sum(tileOffsets.begin(), tileOffsets.end(), tileOffsets.begin());
+  tileItems.resize(itemTile.size());
+  std::vector<vtkIdType> next(tileOffsets.begin(), tileOffsets.end() - 1);
+  for (vtkIdType item = 0; item < static_cast<vtkIdType>(itemTile.size()); ++item)
+    {
+    tileItems[next[itemTile[item]]++] = item;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Call processTile(tile) for every tile, \a concurrency tiles at a time. The
+// stages run by concurrent tiles are single-threaded, as vtkSMPTools does not
+// nest parallel sections; a single tile at a time uses all threads.
+template <typename ProcessTile>
+void ForEachTile(int numberOfTiles, int concurrency, ProcessTile processTile)
+{
+  if (concurrency <= 1)
+    {
+    for (int tile = 0; tile < numberOfTiles; ++tile)
+      {
+      processTile(tile);
+      }
+    return;
+    }
+  for (int first = 0; first < numberOfTiles; first += concurrency)
+    {
+    const int last = std::min(numberOfTiles, first + concurrency);
+    vtkSMPTools::For(first, last, 1, [&](int begin, int end)
+      {
+      for (int tile = begin; tile < end; ++tile)
+        {
+        processTile(tile);
+        }
+      });
+    }
+}
+
+//----------------------------------------------------------------------------
+// Faces of the input split into tiles, and the tile owning each point: the
+// tile of the first face using it, or -1 for points not used by any face.
+struct FaceTiles
+{
+  std::shared_ptr<const SurfaceToolbox::SurfaceTopology> Faces;
+  int NumberOfTiles = 0;
+  int Concurrency = 1;
+  std::vector<int> FaceTile;
+  std::vector<vtkIdType> TileOffsets;
+  std::vector<vtkIdType> TileFaces;
+  std::vector<int> PointTile;
+};
+
+//----------------------------------------------------------------------------
+// Group the faces by tile, given tiles.FaceTile, and find the tile owning
+// each point.
+void AssignFaces(FaceTiles& tiles)
+{
+  const SurfaceToolbox::SurfaceTopology& faces = *tiles.Faces;
+  GetTileItems(tiles.FaceTile, tiles.NumberOfTiles, tiles.TileOffsets, tiles.TileFaces);
+  tiles.PointTile.resize(faces.NumberOfPoints);
+  vtkSMPTools::For(0, faces.NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      const vtkIdType first = faces.LinkOffsets[pointId];
+      tiles.PointTile[pointId] = first < faces.LinkOffsets[pointId + 1] ? tiles.FaceTile[faces.Links[first]] : -1;
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+// Returns false if the input fits in a single tile.
+bool SplitFaces(vtkPolyData* input, const SurfaceToolbox::TileParameters& parameters, FaceTiles& tiles)
+{
+  tiles.Faces = SurfaceToolbox::GetSurfaceTopology(input);
+  const SurfaceToolbox::SurfaceTopology& faces = *tiles.Faces;
+  const vtkIdType numberOfFaces = faces.GetNumberOfFaces();
+  tiles.NumberOfTiles = GetNumberOfTiles(input, numberOfFaces, parameters, tiles.Concurrency);
+  if (tiles.NumberOfTiles <= 1)
+    {
+    return false;
+    }
+
+  vtkDataArray* coordinates = input->GetPoints()->GetData();
+  tiles.FaceTile = PartitionItems(numberOfFaces, tiles.NumberOfTiles, [&](vtkIdType face, int axis)
+    {
+    return coordinates->GetComponent(faces.FaceConnectivity[faces.FaceOffsets[face]], axis);
+    });
+  AssignFaces(tiles);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Faces of \a tile and of \a haloRings rings of faces around them, in
+// increasing order. Each ring is the faces using the points of the previous
+// one, gathered by blocks in parallel. Returns false if the rings have more
+// than \a maximumHaloFaces faces.
+bool GetTileFaces(const FaceTiles& tiles, int tile, int haloRings, vtkIdType maximumHaloFaces,
+                  std::vector<vtkIdType>& tileFaces)
+{
+  const SurfaceToolbox::SurfaceTopology& faces = *tiles.Faces;
+  tileFaces.assign(tiles.TileFaces.begin() + tiles.TileOffsets[tile],
+                   tiles.TileFaces.begin() + tiles.TileOffsets[tile + 1]);
+  const size_t numberOfTileFaces = tileFaces.size();
+  std::vector<vtkIdType> ring(tileFaces);
+  std::vector<vtkIdType> neighbors;
+  std::vector<vtkIdType> selected;
+  const vtkIdType blockSize = 4096;
+  for (int ringIndex = 0; ringIndex < haloRings && !ring.empty(); ++ringIndex)
+    {
+    const vtkIdType numberOfRingFaces = static_cast<vtkIdType>(ring.size());
+    const vtkIdType numberOfBlocks = (numberOfRingFaces + blockSize - 1) / blockSize;
+    std::vector<std::vector<vtkIdType>> blockNeighbors(numberOfBlocks);
+    vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType beginBlock, vtkIdType endBlock)
+      {
+      for (vtkIdType block = beginBlock; block < endBlock; ++block)
+        {
+        std::vector<vtkIdType>& found = blockNeighbors[block];
+        const vtkIdType end = std::min(numberOfRingFaces, (block + 1) * blockSize);
+        for (vtkIdType i = block * blockSize; i < end; ++i)
+          {
+          const vtkIdType face = ring[i];
+          for (vtkIdType j = faces.FaceOffsets[face]; j < faces.FaceOffsets[face + 1]; ++j)
+            {
+            const vtkIdType pointId = faces.FaceConnectivity[j];
+            found.insert(found.end(), faces.Links.begin() + faces.LinkOffsets[pointId],
+                         faces.Links.begin() + faces.LinkOffsets[pointId + 1]);
+            }
+          }
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        }
+      });
+    neighbors.clear();
+    for (const std::vector<vtkIdType>& found : blockNeighbors)
+      {
+      neighbors.insert(neighbors.end(), found.begin(), found.end());
+      }
+    vtkSMPTools::Sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+    // The faces of the next ring are the ones not selected yet
+    ring.clear();
+    std::set_difference(neighbors.begin(), neighbors.end(), tileFaces.begin(), tileFaces.end(),
+                        std::back_inserter(ring));
+    selected.clear();
+    selected.reserve(tileFaces.size() + ring.size());
+    std::merge(tileFaces.begin(), tileFaces.end(), ring.begin(), ring.end(), std::back_inserter(selected));
+    tileFaces.swap(selected);
+    if (static_cast<vtkIdType>(tileFaces.size() - numberOfTileFaces) > maximumHaloFaces)
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Faces of a tile and its halo rings, as a surface.
+struct Tile
+{
+  vtkSmartPointer<vtkPolyData> Surface;
+  // Input point id of each point of the surface, in increasing order
+  std::vector<vtkIdType> PointIds;
+};
+
+//----------------------------------------------------------------------------
+// Extract \a tileFaces, in increasing order, in parallel. The points of the
+// tile keep the order of their input ids, so that the stages visit the
+// neighbors of a point in the same order as on the whole surface. The point
+// and cell data of the input are passed if \a passData is set.
+Tile ExtractTile(vtkPolyData* input, const FaceTiles& tiles, const std::vector<vtkIdType>& tileFaces, bool passData)
+{
+  const SurfaceToolbox::SurfaceTopology& faces = *tiles.Faces;
+  const vtkIdType numberOfTileFaces = static_cast<vtkIdType>(tileFaces.size());
+  std::vector<vtkIdType> offsets(numberOfTileFaces + 1, 0);
+  vtkSMPTools::For(0, numberOfTileFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      offsets[i] = faces.FaceOffsets[tileFaces[i] + 1] - faces.FaceOffsets[tileFaces[i]];
+      }
+    });
+  std::vector<vtkIdType> connectivity(SurfaceToolbox::ComputePrefixSums(offsets.data(), numberOfTileFaces + 1));
+  vtkSMPTools::For(0, numberOfTileFaces, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      std::copy(faces.FaceConnectivity.begin() + faces.FaceOffsets[tileFaces[i]],
+                faces.FaceConnectivity.begin() + faces.FaceOffsets[tileFaces[i] + 1],
+                connectivity.begin() + offsets[i]);
+      }
+    });
+
+  Tile result;
+  result.PointIds = connectivity;
+  vtkSMPTools::Sort(result.PointIds.begin(), result.PointIds.end());
+  result.PointIds.erase(std::unique(result.PointIds.begin(), result.PointIds.end()), result.PointIds.end());
+  const vtkIdType numberOfIds = static_cast<vtkIdType>(connectivity.size());
+  vtkSMPTools::For(0, numberOfIds, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      connectivity[i] = std::lower_bound(result.PointIds.begin(), result.PointIds.end(), connectivity[i])
+        - result.PointIds.begin();
+      }
+    });
+
+  // Polygons come before strips, as in the input
+  auto createCells = [&](vtkIdType first, vtkIdType last)
+    {
+    vtkNew<vtkIdTypeArray> cellOffsets;
+    cellOffsets->SetNumberOfValues(last - first + 1);
+    vtkNew<vtkIdTypeArray> cellConnectivity;
+    cellConnectivity->SetNumberOfValues(offsets[last] - offsets[first]);
+    vtkSMPTools::For(first, last + 1, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        cellOffsets->SetValue(i - first, offsets[i] - offsets[first]);
+        }
+      });
+    std::copy(connectivity.begin() + offsets[first], connectivity.begin() + offsets[last],
+              cellConnectivity->GetPointer(0));
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(cellOffsets, cellConnectivity);
+    return cells;
+    };
+  const vtkIdType numberOfTilePolys =
+    std::lower_bound(tileFaces.begin(), tileFaces.end(), faces.NumberOfPolys) - tileFaces.begin();
+
+  vtkNew<vtkPoints> points;
+  points->SetData(vtkDataArray::SafeDownCast(SurfaceToolbox::CopyTuples(input->GetPoints()->GetData(),
+                                                                        result.PointIds)));
+  result.Surface = vtkSmartPointer<vtkPolyData>::New();
+  result.Surface->SetPoints(points);
+  result.Surface->SetPolys(createCells(0, numberOfTilePolys));
+  result.Surface->SetStrips(createCells(numberOfTilePolys, numberOfTileFaces));
+  if (passData)
+    {
+    SurfaceToolbox::CopyTuples(input->GetPointData(), result.Surface->GetPointData(), result.PointIds);
+    std::vector<vtkIdType> cellIds(numberOfTileFaces);
+    vtkSMPTools::For(0, numberOfTileFaces, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        cellIds[i] = faces.FirstFaceCellId + tileFaces[i];
+        }
+      });
+    SurfaceToolbox::CopyTuples(input->GetCellData(), result.Surface->GetCellData(), cellIds);
+    }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+// Call copy(i, pointId) in parallel for the points i of \a extracted owned by
+// \a tile, pointId being their input id.
+template <typename Copy>
+void ForEachOwnedPoint(const FaceTiles& tiles, int tile, const Tile& extracted, Copy copy)
+{
+  vtkSMPTools::For(0, static_cast<vtkIdType>(extracted.PointIds.size()), [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      if (tiles.PointTile[extracted.PointIds[i]] == tile)
+        {
+        copy(i, extracted.PointIds[i]);
+        }
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunTiledSmoothing(vtkPolyData* input, const SurfaceToolbox::PipelineParameters& parameters)
+{
+  FaceTiles tiles;
+  if (!SplitFaces(input, parameters.Tiles, tiles))
+    {
+    return SurfaceToolbox::RunSmoothing(input, parameters.Smoothing);
+    }
+  const int haloRings = parameters.Tiles.HaloRings > 0 ? parameters.Tiles.HaloRings
+                                                       : parameters.Smoothing.Iterations + 1;
+
+  // Points not used by faces are fixed, so they keep their input coordinates.
+  // A halo larger than its tile would make every tile most of the surface.
+  vtkNew<vtkPoints> points;
+  points->DeepCopy(input->GetPoints());
+  std::atomic<bool> haloTooLarge(false);
+  ForEachTile(tiles.NumberOfTiles, tiles.Concurrency, [&](int tile)
+    {
+    std::vector<vtkIdType> tileFaces;
+    if (haloTooLarge || !GetTileFaces(tiles, tile, haloRings, tiles.TileOffsets[tile + 1] - tiles.TileOffsets[tile],
+                                      tileFaces))
+      {
+      haloTooLarge = true;
+      return;
+      }
+    Tile extracted = ExtractTile(input, tiles, tileFaces, false);
+    vtkSmartPointer<vtkPolyData> smoothed = SurfaceToolbox::RunParallelSmoothing(extracted.Surface, parameters.Smoothing);
+    vtkPoints* smoothedPoints = smoothed->GetPoints();
+    ForEachOwnedPoint(tiles, tile, extracted, [&](vtkIdType i, vtkIdType pointId)
+      {
+      double point[3];
+      smoothedPoints->GetPoint(i, point);
+      points->SetPoint(pointId, point);
+      });
+    });
+  if (haloTooLarge)
+    {
+    std::cerr << "Cannot smooth by tiles: the " << haloRings << " halo rings of a tile have more faces than the tile. "
+              << "Increase the tile size, or decrease the number of iterations or halo rings." << std::endl;
+    return nullptr;
+    }
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(input);
+  output->SetPoints(points);
+  SurfaceToolbox::PassSurfaceTopology(input, output);
+  return output;
+}
+
+//----------------------------------------------------------------------------
+// Copy of \a cells with the point order of every cell reversed.
+vtkSmartPointer<vtkCellArray> ReverseCells(vtkCellArray* cells)
+{
+  vtkSmartPointer<vtkCellArray> reversed = vtkSmartPointer<vtkCellArray>::New();
+  reversed->AllocateExact(cells->GetNumberOfCells(), cells->GetNumberOfConnectivityIds());
+  vtkNew<vtkIdList> cellPoints;
+  for (vtkIdType cellId = 0; cellId < cells->GetNumberOfCells(); ++cellId)
+    {
+    cells->GetCellAtId(cellId, cellPoints);
+    std::reverse(cellPoints->begin(), cellPoints->end());
+    reversed->InsertNextCell(cellPoints);
+    }
+  return reversed;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunTiledNormals(vtkPolyData* input, const SurfaceToolbox::PipelineParameters& parameters)
+{
+  // Triangle strips are left to vtkPolyDataNormals, as RunNormals does
+  const SurfaceToolbox::NormalsParameters& normalsParameters = parameters.Normals;
+  if (normalsParameters.AutoOrient || normalsParameters.Splitting || input->GetNumberOfStrips() > 0
+      || input->GetNumberOfPolys() <= parameters.Tiles.TileSize)
+    {
+    return SurfaceToolbox::RunNormals(input, normalsParameters);
+    }
+
+  // The polygons are reordered consistently on the whole surface first, as
+  // the tiles could not agree on the orientation of their components. The
+  // tiles are then consistent and reorder nothing.
+  vtkSmartPointer<vtkPolyData> oriented = vtkSmartPointer<vtkPolyData>::New();
+  oriented->ShallowCopy(input);
+  vtkSmartPointer<vtkCellArray> polys = SurfaceToolbox::GetConsistentPolygons(input);
+  if (polys == input->GetPolys())
+    {
+    SurfaceToolbox::PassSurfaceTopology(input, oriented);
+    }
+  else
+    {
+    oriented->SetPolys(polys);
+    }
+  FaceTiles tiles;
+  if (!SplitFaces(oriented, parameters.Tiles, tiles))
+    {
+    return SurfaceToolbox::RunNormals(input, normalsParameters);
+    }
+  const int haloRings = parameters.Tiles.HaloRings > 0 ? parameters.Tiles.HaloRings : 1;
+  SurfaceToolbox::NormalsParameters tileParameters;
+  tileParameters.FeatureAngle = normalsParameters.FeatureAngle;
+  tileParameters.Weighting = normalsParameters.Weighting;
+  tileParameters.Flip = normalsParameters.Flip;
+
+  vtkNew<vtkFloatArray> normals;
+  normals->SetName("Normals");
+  normals->SetNumberOfComponents(3);
+  normals->SetNumberOfTuples(oriented->GetNumberOfPoints());
+  normals->Fill(0.0);
+  ForEachTile(tiles.NumberOfTiles, tiles.Concurrency, [&](int tile)
+    {
+    std::vector<vtkIdType> tileFaces;
+    GetTileFaces(tiles, tile, haloRings, VTK_ID_MAX, tileFaces);
+    Tile extracted = ExtractTile(oriented, tiles, tileFaces, false);
+    vtkSmartPointer<vtkPolyData> tileOutput = SurfaceToolbox::RunParallelNormals(extracted.Surface, tileParameters);
+    vtkDataArray* tileNormals = tileOutput->GetPointData()->GetNormals();
+    ForEachOwnedPoint(tiles, tile, extracted, [&](vtkIdType i, vtkIdType pointId)
+      {
+      normals->SetTuple(pointId, i, tileNormals);
+      });
+    });
+
+  // Flip reverses all the polygons
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(oriented);
+  output->GetPointData()->SetNormals(normals);
+  if (normalsParameters.Flip)
+    {
+    output->SetPolys(ReverseCells(oriented->GetPolys()));
+    }
+  else
+    {
+    SurfaceToolbox::PassSurfaceTopology(oriented, output);
+    }
+  return output;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunTiledCleaner(vtkPolyData* input, const SurfaceToolbox::PipelineParameters& parameters)
+{
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  int concurrency = 1;
+  const int numberOfTiles = GetNumberOfTiles(input, numberOfPoints, parameters.Tiles, concurrency);
+  if (numberOfTiles <= 1)
+    {
+    return SurfaceToolbox::RunCleaner(input, parameters.Cleaner);
+    }
+
+  // Split the points by merge key, so that all the points merged together are
+  // in the same tile, and the grid is the same as for the whole surface.
+  const double tolerance = parameters.Cleaner.Tolerance;
+  vtkPoints* points = input->GetPoints();
+  double bounds[6];
+  points->GetBounds(bounds);
+  const double origin[3] = { bounds[0], bounds[2], bounds[4] };
+  vtkDataArray* coordinates = points->GetData();
+  const std::vector<int> pointTile = PartitionItems(numberOfPoints, numberOfTiles, [&](vtkIdType pointId, int axis)
+    {
+    const double coordinate = coordinates->GetComponent(pointId, axis);
+    return tolerance > 0.0 ? std::floor((coordinate - origin[axis]) / tolerance) : coordinate;
+    });
+  std::vector<vtkIdType> tileOffsets;
+  std::vector<vtkIdType> tilePoints;
+  GetTileItems(pointTile, numberOfTiles, tileOffsets, tilePoints);
+
+  std::vector<vtkIdType> mergeMap(numberOfPoints);
+  ForEachTile(numberOfTiles, concurrency, [&](int tile)
+    {
+    const std::vector<vtkIdType> pointIds(tilePoints.begin() + tileOffsets[tile],
+                                          tilePoints.begin() + tileOffsets[tile + 1]);
+    SurfaceToolbox::ComputePointMergeMap(points, pointIds, tolerance, origin, mergeMap);
+    });
+  return SurfaceToolbox::MergePoints(input, mergeMap);
+}
+
+// Point data array holding the input point ids of the points of the tiles
+// during decimation
+const char* const TilePointIdsName = "SurfaceToolboxTilePointIds";
+
+//----------------------------------------------------------------------------
+// Decimated tile, and the input id of each of its points on a seam between
+// tiles, or -1 for the points inside the tile.
+struct DecimatedTile
+{
+  vtkSmartPointer<vtkPolyData> Surface;
+  std::vector<vtkIdType> SeamPointIds;
+};
+
+//----------------------------------------------------------------------------
+// Decimate each tile with decimateTile(tile, surface), which must keep the
+// boundary points of the tile in place with their point data, and stitch the
+// tiles in order by the input ids of the points on their seams. outputSeam is
+// set for the output points that are on a seam.
+template <typename DecimateTile>
+vtkSmartPointer<vtkPolyData> DecimateTiles(vtkPolyData* input, const FaceTiles& tiles, DecimateTile decimateTile,
+                                           std::vector<unsigned char>& outputSeam)
+{
+  const SurfaceToolbox::SurfaceTopology& faces = *tiles.Faces;
+
+  // Points used by faces of several tiles
+  std::vector<unsigned char> seam(faces.NumberOfPoints, 0);
+  vtkSMPTools::For(0, faces.NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      for (vtkIdType k = faces.LinkOffsets[pointId]; k < faces.LinkOffsets[pointId + 1]; ++k)
+        {
+        if (tiles.FaceTile[faces.Links[k]] != tiles.PointTile[pointId])
+          {
+          seam[pointId] = 1;
+          break;
+          }
+        }
+      }
+    });
+
+  std::vector<DecimatedTile> decimatedTiles(tiles.NumberOfTiles);
+  ForEachTile(tiles.NumberOfTiles, tiles.Concurrency, [&](int tile)
+    {
+    std::vector<vtkIdType> tileFaces;
+    GetTileFaces(tiles, tile, 0, 0, tileFaces);
+    Tile extracted = ExtractTile(input, tiles, tileFaces, true);
+    vtkNew<vtkIdTypeArray> tilePointIds;
+    tilePointIds->SetName(TilePointIdsName);
+    tilePointIds->SetNumberOfValues(static_cast<vtkIdType>(extracted.PointIds.size()));
+    std::copy(extracted.PointIds.begin(), extracted.PointIds.end(), tilePointIds->GetPointer(0));
+    extracted.Surface->GetPointData()->AddArray(tilePointIds);
+    DecimatedTile& decimated = decimatedTiles[tile];
+    decimated.Surface = decimateTile(tile, extracted.Surface);
+
+    // Locked points keep their input id, and their location, by which it is
+    // checked: the ids of the other points are interpolated
+    vtkPointData* pointData = decimated.Surface->GetPointData();
+    vtkDataArray* pointIds = pointData->GetArray(TilePointIdsName);
+    const vtkIdType numberOfPoints = decimated.Surface->GetNumberOfPoints();
+    decimated.SeamPointIds.assign(numberOfPoints, -1);
+    vtkPoints* inputPoints = input->GetPoints();
+    vtkPoints* decimatedPoints = decimated.Surface->GetPoints();
+    vtkSMPTools::For(0, pointIds ? numberOfPoints : 0, [&](vtkIdType begin, vtkIdType end)
+      {
+      double point[3];
+      double inputPoint[3];
+      for (vtkIdType i = begin; i < end; ++i)
+        {
+        const double value = pointIds->GetComponent(i, 0);
+        const vtkIdType pointId = static_cast<vtkIdType>(value);
+        if (value != pointId || pointId < 0 || pointId >= faces.NumberOfPoints || !seam[pointId])
+          {
+          continue;
+          }
+        decimatedPoints->GetPoint(i, point);
+        inputPoints->GetPoint(pointId, inputPoint);
+        if (point[0] == inputPoint[0] && point[1] == inputPoint[1] && point[2] == inputPoint[2])
+          {
+          decimated.SeamPointIds[i] = pointId;
+          }
+        }
+      });
+    pointData->RemoveArray(TilePointIdsName);
+    });
+
+  // Stitch the tiles in order, sharing their seam points. The point and cell
+  // data of the tiles have the same arrays, as they come from the same stage.
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetDataType(input->GetPoints()->GetDataType());
+  vtkNew<vtkCellArray> polys;
+  vtkPointData* outputPointData = output->GetPointData();
+  vtkCellData* outputCellData = output->GetCellData();
+  bool dataAllocated = false;
+  std::unordered_map<vtkIdType, vtkIdType> seamOutputIds;
+  outputSeam.clear();
+  vtkNew<vtkIdList> cellPoints;
+  for (DecimatedTile& decimated : decimatedTiles)
+    {
+    vtkPolyData* surface = decimated.Surface;
+    if (!surface || surface->GetNumberOfPoints() == 0)
+      {
+      continue;
+      }
+    if (!dataAllocated)
+      {
+      outputPointData->CopyAllocate(surface->GetPointData());
+      outputCellData->CopyAllocate(surface->GetCellData());
+      dataAllocated = true;
+      }
+    std::vector<vtkIdType> pointMap(surface->GetNumberOfPoints());
+    for (vtkIdType i = 0; i < surface->GetNumberOfPoints(); ++i)
+      {
+      if (decimated.SeamPointIds[i] >= 0)
+        {
+        auto inserted = seamOutputIds.emplace(decimated.SeamPointIds[i], points->GetNumberOfPoints());
+        if (!inserted.second)
+          {
+          pointMap[i] = inserted.first->second;
+          continue;
+          }
+        }
+      pointMap[i] = points->InsertNextPoint(surface->GetPoint(i));
+      outputPointData->CopyData(surface->GetPointData(), i, pointMap[i]);
+      outputSeam.push_back(decimated.SeamPointIds[i] >= 0);
+      }
+    vtkCellArray* tilePolys = surface->GetPolys();
+    for (vtkIdType cellId = 0; cellId < tilePolys->GetNumberOfCells(); ++cellId)
+      {
+      tilePolys->GetCellAtId(cellId, cellPoints);
+      for (vtkIdType j = 0; j < cellPoints->GetNumberOfIds(); ++j)
+        {
+        cellPoints->SetId(j, pointMap[cellPoints->GetId(j)]);
+        }
+      const vtkIdType outputCellId = polys->InsertNextCell(cellPoints);
+      outputCellData->CopyData(surface->GetCellData(), surface->GetNumberOfVerts() + surface->GetNumberOfLines() + cellId,
+                               outputCellId);
+      }
+    decimated.Surface = nullptr;
+    }
+  output->SetPoints(points);
+  output->SetPolys(polys);
+  return output;
+}
+
+//----------------------------------------------------------------------------
+// Split \a numberOfTriangles among the tiles in proportion to their number of
+// faces, giving the remainder to the tiles with the largest fractional parts
+// so that the targets add up to \a numberOfTriangles.
+std::vector<vtkIdType> SplitTargetNumberOfTriangles(const FaceTiles& tiles, vtkIdType numberOfTriangles)
+{
+  const double numberOfFaces = static_cast<double>(tiles.Faces->GetNumberOfFaces());
+  std::vector<vtkIdType> targets(tiles.NumberOfTiles);
+  std::vector<std::pair<double, int>> remainders(tiles.NumberOfTiles);
+  vtkIdType remaining = numberOfTriangles;
+  for (int tile = 0; tile < tiles.NumberOfTiles; ++tile)
+    {
+    const double share = numberOfTriangles * ((tiles.TileOffsets[tile + 1] - tiles.TileOffsets[tile]) / numberOfFaces);
+    targets[tile] = static_cast<vtkIdType>(std::floor(share));
+    remainders[tile] = std::make_pair(share - targets[tile], tile);
+    remaining -= targets[tile];
+    }
+  std::sort(remainders.begin(), remainders.end(), std::greater<std::pair<double, int>>());
+  for (int i = 0; i < tiles.NumberOfTiles && remaining > 0; ++i, --remaining)
+    {
+    ++targets[remainders[i].second];
+    }
+  return targets;
+}
+
+//----------------------------------------------------------------------------
+// Number of triangles of the faces of a surface.
+vtkIdType GetNumberOfTriangles(const SurfaceToolbox::SurfaceTopology& faces)
+{
+  vtkIdType numberOfTriangles = 0;
+  for (vtkIdType face = 0; face < faces.GetNumberOfFaces(); ++face)
+    {
+    numberOfTriangles += std::max<vtkIdType>(0, faces.FaceOffsets[face + 1] - faces.FaceOffsets[face] - 2);
+    }
+  return numberOfTriangles;
+}
+
+//----------------------------------------------------------------------------
+// Decimate the faces within \a rings rings of the seam points of \a surface,
+// which the tiles could not decimate, down to \a targetNumberOfTriangles for
+// the whole surface. The other faces are passed unchanged.
+vtkSmartPointer<vtkPolyData> DecimateSeams(vtkPolyData* surface, const std::vector<unsigned char>& seam, int rings,
+                                           const SurfaceToolbox::DecimationParameters& parameters,
+                                           vtkIdType targetNumberOfTriangles)
+{
+  // Tile 0 is the band of faces around the seams, tile 1 the rest
+  FaceTiles band;
+  band.Faces = SurfaceToolbox::GetSurfaceTopology(surface);
+  const SurfaceToolbox::SurfaceTopology& faces = *band.Faces;
+  const vtkIdType numberOfFaces = faces.GetNumberOfFaces();
+  band.NumberOfTiles = 2;
+  band.FaceTile.assign(numberOfFaces, 1);
+  std::vector<unsigned char> bandPoints(seam);
+  for (int ring = 0; ring < rings; ++ring)
+    {
+    vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType face = begin; face < end; ++face)
+        {
+        for (vtkIdType j = faces.FaceOffsets[face]; j < faces.FaceOffsets[face + 1]; ++j)
+          {
+          if (bandPoints[faces.FaceConnectivity[j]])
+            {
+            band.FaceTile[face] = 0;
+            break;
+            }
+          }
+        }
+      });
+    vtkSMPTools::For(0, faces.NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType pointId = begin; pointId < end; ++pointId)
+        {
+        for (vtkIdType k = faces.LinkOffsets[pointId]; k < faces.LinkOffsets[pointId + 1] && !bandPoints[pointId]; ++k)
+          {
+          bandPoints[pointId] = band.FaceTile[faces.Links[k]] == 0;
+          }
+        }
+      });
+    }
+  AssignFaces(band);
+
+  // Faces to remove from the band to reach the target of the whole surface,
+  // unless the decimation is only bounded by its error
+  SurfaceToolbox::DecimationParameters bandParameters = parameters;
+  bandParameters.BoundaryVertexDeletion = false;
+  const bool errorOnly = parameters.Method == "Quadric" && parameters.MaximumError > 0.0
+                         && parameters.TargetNumberOfTriangles <= 0;
+  const vtkIdType bandFaces = band.TileOffsets[1];
+  const vtkIdType excess = GetNumberOfTriangles(faces) - targetNumberOfTriangles;
+  if (bandFaces == 0 || (!errorOnly && excess <= 0))
+    {
+    return surface;
+    }
+  const vtkIdType bandTarget = std::max<vtkIdType>(1, bandFaces - excess);
+  if (parameters.Method == "Quadric" && parameters.TargetNumberOfTriangles > 0)
+    {
+    bandParameters.TargetNumberOfTriangles = bandTarget;
+    }
+  else if (!errorOnly)
+    {
+    bandParameters.TargetReduction = 1.0 - static_cast<double>(bandTarget) / bandFaces;
+    }
+
+  std::vector<unsigned char> outputSeam;
+  return DecimateTiles(surface, band, [&](int tile, vtkPolyData* tileSurface) -> vtkSmartPointer<vtkPolyData>
+    {
+    if (tile == 1)
+      {
+      return tileSurface;
+      }
+    return SurfaceToolbox::RunDecimation(tileSurface, bandParameters);
+    }, outputSeam);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunTiledDecimation(vtkPolyData* input, const SurfaceToolbox::PipelineParameters& parameters)
+{
+  // Clustering already works in memory proportional to its output, and its
+  // clusters could not be locked along the seams
+  FaceTiles tiles;
+  if (parameters.Decimation.Method == "Clustering" || !SplitFaces(input, parameters.Tiles, tiles))
+    {
+    return SurfaceToolbox::RunDecimation(input, parameters.Decimation);
+    }
+  const vtkIdType numberOfTriangles = GetNumberOfTriangles(*tiles.Faces);
+  const vtkIdType targetNumberOfTriangles = parameters.Decimation.TargetNumberOfTriangles > 0
+    ? parameters.Decimation.TargetNumberOfTriangles
+    : static_cast<vtkIdType>(std::round(numberOfTriangles * (1.0 - parameters.Decimation.TargetReduction)));
+
+  // Seams are boundaries of the tiles: locking them keeps the tiles matching
+  std::vector<vtkIdType> tileTargets;
+  if (parameters.Decimation.TargetNumberOfTriangles > 0)
+    {
+    tileTargets = SplitTargetNumberOfTriangles(tiles, parameters.Decimation.TargetNumberOfTriangles);
+    }
+  std::vector<unsigned char> seam;
+  vtkSmartPointer<vtkPolyData> decimated = DecimateTiles(input, tiles,
+    [&](int tile, vtkPolyData* tileSurface)
+    {
+    SurfaceToolbox::DecimationParameters tileParameters = parameters.Decimation;
+    tileParameters.BoundaryVertexDeletion = false;
+    if (!tileTargets.empty())
+      {
+      tileParameters.TargetNumberOfTriangles = std::max<vtkIdType>(1, tileTargets[tile]);
+      }
+    return SurfaceToolbox::RunDecimation(tileSurface, tileParameters);
+    }, seam);
+  tiles = FaceTiles();
+
+  // The seams are decimated in a second pass, with the faces around them
+  const int rings = parameters.Tiles.HaloRings > 0 ? parameters.Tiles.HaloRings : 2;
+  return DecimateSeams(decimated, seam, rings, parameters.Decimation, targetNumberOfTriangles);
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+bool IsTiledStage(const std::string& stage)
+{
+  const std::string name = ToLower(stage);
+  return name == "smoothing" || name == "normals" || name == "cleaner" || name == "decimation";
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> RunTiledStage(const std::string& stage, vtkPolyData* input,
+                                           const PipelineParameters& parameters)
+{
+  const std::string name = ToLower(stage);
+  if (!IsTiledStage(name))
+    {
+    return nullptr;
+    }
+  if (input->GetNumberOfPoints() == 0)
+    {
+    PipelineParameters untiledParameters = parameters;
+    untiledParameters.Tiles = TileParameters();
+    return RunStage(name, input, untiledParameters);
+    }
+  if (name == "smoothing")
+    {
+    return RunTiledSmoothing(input, parameters);
+    }
+  else if (name == "normals")
+    {
+    return RunTiledNormals(input, parameters);
+    }
+  else if (name == "cleaner")
+    {
+    return RunTiledCleaner(input, parameters);
+    }
+  return RunTiledDecimation(input, parameters);
+}
+
+}
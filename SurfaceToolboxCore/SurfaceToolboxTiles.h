@@ -0,0 +1,74 @@
+#ifndef SurfaceToolboxTiles_h
+#define SurfaceToolboxTiles_h
+
+#include "SurfaceToolboxStages.h"
+
+// STD includes
+#include <string>
+
+// In-memory tiled execution of the Smoothing, Normals, Cleaner and Decimation
+// stages. The surface is split spatially into tiles of about the same size by
+// recursive bisection at the median, each tile is extracted with halo rings
+// of neighboring faces and run through the stage on its own, one tile per
+// thread or as many as fit in a memory budget, and the results of the tiles
+// are stitched into one surface. The input and output surfaces stay in
+// memory: tiling bounds the working memory of the stages, not the memory of
+// the process.
+namespace SurfaceToolbox
+{
+
+struct PipelineParameters;
+
+struct TileParameters
+{
+  // Maximum number of faces of a tile (of points for the Cleaner). If 0, the
+  // stages are not tiled.
+  vtkIdType TileSize = 0;
+  // Rings of neighboring faces added around each tile. If 0, the number of
+  // rings for which the tiles give the same result as the whole surface is
+  // used: Smoothing iterations + 1 for Smoothing, 1 for Normals. For
+  // Decimation, rings of faces around the seams decimated in the second pass
+  // (2 if 0).
+  int HaloRings = 0;
+  // Memory in MiB of the tiles processed at the same time, each estimated to
+  // four times the memory of its share of the input. If 0, one tile per thread.
+  double MemoryBudget = 0.0;
+};
+
+/// Return true if \a stage can run tiled: Smoothing, Normals, Cleaner and
+/// Decimation. Stage names are matched case-insensitively.
+bool IsTiledStage(const std::string& stage);
+
+/// Run \a stage tiled with parameters.Tiles, or untiled if the surface fits in
+/// a single tile. Returns nullptr if \a stage cannot run tiled, or fails.
+///
+/// The tiles are extracted in parallel, with their points in the order of
+/// their input ids.
+///
+/// - Smoothing: each tile is smoothed with its halo, and the points it owns
+///   (points whose first face is in the tile) are written to the output.
+///   Fails if the halo of a tile has more faces than the tile.
+/// - Normals: the polygons are first reordered consistently on the whole
+///   surface, as RunParallelNormals does. Point normals are then computed in
+///   each tile with a halo of one ring, on which they match the normals of the
+///   whole surface. Flip negates them and reverses the polygons. AutoOrient,
+///   Splitting and triangle strips need the whole surface, and run untiled.
+/// - Cleaner: the points are split along the planes of the merge grid, so that
+///   the points merged together are in the same tile, and the merge map of
+///   each tile is computed on its own. The result is the same as untiled.
+/// - Decimation: the tiles have no halo and are decimated with the vertices
+///   of their boundary locked, so that the tiles still match along their
+///   seams, which are stitched by the input ids of their points. Distinct
+///   points at the same location stay distinct. TargetNumberOfTriangles is
+///   split exactly among the tiles by number of faces. The faces within
+///   HaloRings rings of the seams are then decimated in a second pass, with
+///   the boundary of this band locked, down to the target of the whole
+///   surface. The boundary vertices of the surface are locked in both
+///   passes, whatever BoundaryVertexDeletion is. Clustering decimation runs
+///   untiled.
+vtkSmartPointer<vtkPolyData> RunTiledStage(const std::string& stage, vtkPolyData* input,
+                                           const PipelineParameters& parameters);
+
+}
+
+#endif
@@ -0,0 +1,266 @@
+#include "SurfaceToolboxTopology.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkInformation.h"
+#include "vtkInformationObjectBaseKey.h"
+#include "vtkNew.h"
+#include "vtkObject.h"
+#include "vtkObjectFactory.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Topology attached to the information of a surface, with what it was built
+// from, so that it is not used once the surface has changed.
+class TopologyInformation : public vtkObject
+{
+public:
+  static TopologyInformation* New();
+  vtkTypeMacro(TopologyInformation, vtkObject);
+
+  std::shared_ptr<const SurfaceToolbox::SurfaceTopology> Topology;
+  vtkCellArray* Polys = nullptr;
+  vtkCellArray* Strips = nullptr;
+  vtkMTimeType PolysTime = 0;
+  vtkMTimeType StripsTime = 0;
+
+  void SetSurface(vtkPolyData* polyData)
+  {
+    this->Polys = polyData->GetPolys();
+    this->Strips = polyData->GetStrips();
+    this->PolysTime = this->Polys->GetMTime();
+    this->StripsTime = this->Strips->GetMTime();
+  }
+
+  bool IsValid(vtkPolyData* polyData) const
+  {
+    return this->Topology->NumberOfPoints == polyData->GetNumberOfPoints()
+      && this->Topology->FirstFaceCellId == polyData->GetNumberOfVerts() + polyData->GetNumberOfLines()
+      && polyData->GetPolys() == this->Polys && polyData->GetStrips() == this->Strips
+      && this->Polys->GetMTime() == this->PolysTime && this->Strips->GetMTime() == this->StripsTime;
+  }
+
+protected:
+  TopologyInformation() = default;
+  ~TopologyInformation() override = default;
+
+private:
+  TopologyInformation(const TopologyInformation&) = delete;
+  void operator=(const TopologyInformation&) = delete;
+};
+
+vtkStandardNewMacro(TopologyInformation);
+
+//----------------------------------------------------------------------------
+vtkInformationObjectBaseKey* GetTopologyKey()
+{
+  // Deleted by the information key manager of VTK
+  static vtkInformationObjectBaseKey* key = new vtkInformationObjectBaseKey("SurfaceTopology", "SurfaceToolbox");
+  return key;
+}
+
+//----------------------------------------------------------------------------
+TopologyInformation* GetTopologyInformation(vtkPolyData* polyData)
+{
+  TopologyInformation* information = TopologyInformation::SafeDownCast(polyData->GetInformation()->Get(GetTopologyKey()));
+  return information && information->IsValid(polyData) ? information : nullptr;
+}
+
+//----------------------------------------------------------------------------
+// Neighbors of a point through the faces using it, with one entry per face
+// using the edge, sorted.
+void GetNeighbors(const SurfaceToolbox::SurfaceTopology& topology, vtkIdType pointId,
+                  std::vector<vtkIdType>& neighbors)
+{
+  neighbors.clear();
+  for (vtkIdType link = topology.LinkOffsets[pointId]; link < topology.LinkOffsets[pointId + 1]; ++link)
+    {
+    const vtkIdType face = topology.Links[link];
+    if (link > topology.LinkOffsets[pointId] && topology.Links[link - 1] == face)
+      {
+      // Point used twice by the face, both uses were handled below
+      continue;
+      }
+    const vtkIdType* facePoints = topology.FaceConnectivity.data() + topology.FaceOffsets[face];
+    const vtkIdType numberOfFacePoints = topology.FaceOffsets[face + 1] - topology.FaceOffsets[face];
+    for (vtkIdType k = 0; k < numberOfFacePoints; ++k)
+      {
+      if (facePoints[k] != pointId)
+        {
+        continue;
+        }
+      if (!topology.IsStrip(face))
+        {
+        neighbors.push_back(facePoints[(k + numberOfFacePoints - 1) % numberOfFacePoints]);
+        neighbors.push_back(facePoints[(k + 1) % numberOfFacePoints]);
+        }
+      else
+        {
+        // Triangle t of a strip is made of points t, t + 1 and t + 2. Strips
+        // repeat points to change the parity of the next triangles: these
+        // degenerate triangles add no edge.
+        const vtkIdType firstTriangle = std::max<vtkIdType>(0, k - 2);
+        const vtkIdType lastTriangle = std::min<vtkIdType>(k, numberOfFacePoints - 3);
+        for (vtkIdType t = firstTriangle; t <= lastTriangle; ++t)
+          {
+          if (facePoints[t] == facePoints[t + 1] || facePoints[t + 1] == facePoints[t + 2]
+              || facePoints[t + 2] == facePoints[t])
+            {
+            continue;
+            }
+          for (vtkIdType corner = t; corner < t + 3; ++corner)
+            {
+            if (corner != k)
+              {
+              neighbors.push_back(facePoints[corner]);
+              }
+            }
+          }
+        }
+      }
+    }
+  neighbors.erase(std::remove(neighbors.begin(), neighbors.end(), pointId), neighbors.end());
+  std::sort(neighbors.begin(), neighbors.end());
+}
+
+//----------------------------------------------------------------------------
+// Count the distinct neighbors of each point into offsets, which has room for
+// the number of points plus one, then turn them into offsets and return
+// their total.
+vtkIdType CountNeighbors(const SurfaceToolbox::SurfaceTopology& topology, vtkIdType* offsets)
+{
+  vtkSMPTools::For(0, topology.NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    std::vector<vtkIdType> neighbors;
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      GetNeighbors(topology, pointId, neighbors);
+      offsets[pointId] = std::unique(neighbors.begin(), neighbors.end()) - neighbors.begin();
+      }
+    });
+  offsets[topology.NumberOfPoints] = 0;
+  return SurfaceToolbox::ComputePrefixSums(offsets, topology.NumberOfPoints + 1);
+}
+
+//----------------------------------------------------------------------------
+// Fill the neighbors and edge uses of each point at the offsets given by
+// CountNeighbors.
+void FillNeighbors(const SurfaceToolbox::SurfaceTopology& topology, const vtkIdType* offsets,
+                   vtkIdType* neighborIds, vtkIdType* edgeUses)
+{
+  vtkSMPTools::For(0, topology.NumberOfPoints, [&](vtkIdType begin, vtkIdType end)
+    {
+    std::vector<vtkIdType> neighbors;
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+      {
+      GetNeighbors(topology, pointId, neighbors);
+      vtkIdType edge = offsets[pointId] - 1;
+      for (size_t i = 0; i < neighbors.size(); ++i)
+        {
+        if (i == 0 || neighbors[i] != neighbors[i - 1])
+          {
+          ++edge;
+          neighborIds[edge] = neighbors[i];
+          edgeUses[edge] = 0;
+          }
+        ++edgeUses[edge];
+        }
+      }
+    });
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+vtkIdType* IdArena::Allocate(size_t numberOfIds)
+{
+  this->Blocks.emplace_back(new vtkIdType[std::max<size_t>(numberOfIds, 1)]);
+  this->MemorySize += numberOfIds * sizeof(vtkIdType);
+  return this->Blocks.back().get();
+}
+
+//----------------------------------------------------------------------------
+size_t SurfaceTopology::GetMemorySize() const
+{
+  return sizeof(*this) + this->Arena.GetMemorySize();
+}
+
+//----------------------------------------------------------------------------
+std::shared_ptr<SurfaceTopology> BuildSurfaceTopology(vtkPolyData* polyData)
+{
+  std::shared_ptr<SurfaceTopology> topology = std::make_shared<SurfaceTopology>();
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  const vtkIdType numberOfFaces = polyData->GetNumberOfPolys() + polyData->GetNumberOfStrips();
+  const vtkIdType numberOfFaceIds =
+    polyData->GetPolys()->GetNumberOfConnectivityIds() + polyData->GetStrips()->GetNumberOfConnectivityIds();
+  topology->NumberOfPoints = numberOfPoints;
+  topology->FirstFaceCellId = polyData->GetNumberOfVerts() + polyData->GetNumberOfLines();
+
+  vtkIdType* faceOffsets = topology->Arena.Allocate(numberOfFaces + 1 + 2 * numberOfFaceIds + 2 * (numberOfPoints + 1));
+  vtkIdType* faceConnectivity = faceOffsets + numberOfFaces + 1;
+  vtkIdType* linkOffsets = faceConnectivity + numberOfFaceIds;
+  vtkIdType* links = linkOffsets + numberOfPoints + 1;
+  vtkIdType* edgeOffsets = links + numberOfFaceIds;
+  topology->NumberOfPolys = GetFaceCells(polyData, faceOffsets, faceConnectivity);
+  BuildPointCellLinks(numberOfPoints, numberOfFaces, faceOffsets, faceConnectivity, linkOffsets, links);
+  topology->FaceOffsets = IdArray(faceOffsets, numberOfFaces + 1);
+  topology->FaceConnectivity = IdArray(faceConnectivity, numberOfFaceIds);
+  topology->LinkOffsets = IdArray(linkOffsets, numberOfPoints + 1);
+  topology->Links = IdArray(links, numberOfFaceIds);
+
+  const vtkIdType numberOfEdges = CountNeighbors(*topology, edgeOffsets);
+  vtkIdType* neighbors = topology->Arena.Allocate(2 * numberOfEdges);
+  vtkIdType* edgeUses = neighbors + numberOfEdges;
+  FillNeighbors(*topology, edgeOffsets, neighbors, edgeUses);
+  topology->Edges.Offsets = IdArray(edgeOffsets, numberOfPoints + 1);
+  topology->Edges.Neighbors = IdArray(neighbors, numberOfEdges);
+  topology->Edges.EdgeUses = IdArray(edgeUses, numberOfEdges);
+  return topology;
+}
+
+//----------------------------------------------------------------------------
+std::shared_ptr<const SurfaceTopology> GetSurfaceTopology(vtkPolyData* polyData)
+{
+  if (TopologyInformation* information = GetTopologyInformation(polyData))
+    {
+    return information->Topology;
+    }
+  vtkNew<TopologyInformation> information;
+  information->Topology = BuildSurfaceTopology(polyData);
+  information->SetSurface(polyData);
+  polyData->GetInformation()->Set(GetTopologyKey(), information);
+  return information->Topology;
+}
+
+//----------------------------------------------------------------------------
+std::shared_ptr<const SurfaceTopology> FindSurfaceTopology(vtkPolyData* polyData)
+{
+  TopologyInformation* information = GetTopologyInformation(polyData);
+  return information ? information->Topology : nullptr;
+}
+
+//----------------------------------------------------------------------------
+void PassSurfaceTopology(vtkPolyData* input, vtkPolyData* output)
+{
+  if (input == output)
+    {
+    return;
+    }
+  TopologyInformation* information = GetTopologyInformation(input);
+  if (information && information->IsValid(output))
+    {
+    output->GetInformation()->Set(GetTopologyKey(), information);
+    }
+}
+
+}
@@ -0,0 +1,118 @@
+#ifndef SurfaceToolboxTopology_h
+#define SurfaceToolboxTopology_h
+
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkType.h"
+
+// STD includes
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class vtkPolyData;
+
+// Topology of the faces of a surface, built once and shared by the stages
+// that need point-to-face links or edge adjacency.
+namespace SurfaceToolbox
+{
+
+/// Read-only array of ids stored in the arena of a SurfaceTopology.
+class IdArray
+{
+public:
+  IdArray() = default;
+  IdArray(const vtkIdType* data, size_t size) : Data(data), Size(size) {}
+
+  const vtkIdType& operator[](size_t i) const { return this->Data[i]; }
+  const vtkIdType* data() const { return this->Data; }
+  const vtkIdType* begin() const { return this->Data; }
+  const vtkIdType* end() const { return this->Data + this->Size; }
+  size_t size() const { return this->Size; }
+  bool empty() const { return this->Size == 0; }
+
+private:
+  const vtkIdType* Data = nullptr;
+  size_t Size = 0;
+};
+
+/// Storage of the arrays of a SurfaceTopology: a few blocks of exactly the
+/// size of the arrays they hold, not initialized, released all at once.
+class IdArena
+{
+public:
+  /// Return room for \a numberOfIds ids, valid as long as the arena.
+  vtkIdType* Allocate(size_t numberOfIds);
+
+  /// Memory of the blocks, in bytes.
+  size_t GetMemorySize() const { return this->MemorySize; }
+
+private:
+  std::vector<std::unique_ptr<vtkIdType[]>> Blocks;
+  size_t MemorySize = 0;
+};
+
+/// Vertex adjacency of the polygons and triangle strips of a surface, in
+/// compressed sparse row form: the neighbors of point i are
+/// Neighbors[Offsets[i]] to Neighbors[Offsets[i + 1] - 1], in increasing
+/// order. EdgeUses gives the number of faces using each of these edges: 1 on
+/// the boundary, 2 inside a manifold surface, more on non-manifold edges.
+/// Triangle strips count each of their triangles as a face.
+struct EdgeAdjacency
+{
+  IdArray Offsets;
+  IdArray Neighbors;
+  IdArray EdgeUses;
+};
+
+/// Faces (polygons, then triangle strips), point-to-face links and edge
+/// adjacency of a surface, all in compressed sparse row form and allocated
+/// in one arena. Face i is cell FirstFaceCellId + i of the surface, as
+/// vertices and lines come first.
+struct SurfaceTopology
+{
+  vtkIdType NumberOfPoints = 0;
+  vtkIdType NumberOfPolys = 0;
+  vtkIdType FirstFaceCellId = 0;
+  /// The points of face i are FaceConnectivity[FaceOffsets[i]] to
+  /// FaceConnectivity[FaceOffsets[i + 1] - 1].
+  IdArray FaceOffsets;
+  IdArray FaceConnectivity;
+  /// The faces using point i are Links[LinkOffsets[i]] to
+  /// Links[LinkOffsets[i + 1] - 1], in increasing order. A face using a point
+  /// twice is listed twice.
+  IdArray LinkOffsets;
+  IdArray Links;
+  EdgeAdjacency Edges;
+  IdArena Arena;
+
+  vtkIdType GetNumberOfFaces() const { return static_cast<vtkIdType>(this->FaceOffsets.size()) - 1; }
+  bool IsStrip(vtkIdType face) const { return face >= this->NumberOfPolys; }
+
+  /// Memory used by the topology, in bytes.
+  size_t GetMemorySize() const;
+};
+
+/// Build the topology of \a polyData, in parallel. The faces, the links and
+/// the edge offsets share one block of the arena, the neighbors and edge uses
+/// a second one, allocated once their number is known.
+std::shared_ptr<SurfaceTopology> BuildSurfaceTopology(vtkPolyData* polyData);
+
+/// Return the topology of \a polyData. It is built on first use and attached
+/// to the information of \a polyData, so that later calls on the same surface
+/// return it until its number of points or its faces change.
+std::shared_ptr<const SurfaceTopology> GetSurfaceTopology(vtkPolyData* polyData);
+
+/// Return the topology attached to \a polyData by GetSurfaceTopology, or
+/// nullptr if it was not built or the surface has changed since.
+std::shared_ptr<const SurfaceTopology> FindSurfaceTopology(vtkPolyData* polyData);
+
+/// Attach the topology of \a input, if it was built, to \a output if \a output
+/// has the same number of points and shares the polygon and strip cell arrays
+/// of \a input, as stages moving points only do.
+void PassSurfaceTopology(vtkPolyData* input, vtkPolyData* output);
+
+}
+
+#endif
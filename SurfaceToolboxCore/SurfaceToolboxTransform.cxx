@@ -0,0 +1,471 @@
+#include "SurfaceToolboxTransform.h"
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMatrix4x4.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Affine map of 3-component tuples: x' = Linear * x + Translation, optionally
+// normalized.
+struct TupleTransform
+{
+  double Linear[9];
+  double Translation[3];
+  bool Normalize;
+};
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+void TransformTuples(ValueType* data, vtkIdType begin, vtkIdType end, const TupleTransform& transform)
+{
+  const double* a = transform.Linear;
+  const double* t = transform.Translation;
+  // Coefficients in locals so that the compiler does not reload them after
+  // every store and can vectorize the loop.
+  const double a00 = a[0], a01 = a[1], a02 = a[2];
+  const double a10 = a[3], a11 = a[4], a12 = a[5];
+  const double a20 = a[6], a21 = a[7], a22 = a[8];
+  const double t0 = t[0], t1 = t[1], t2 = t[2];
+  ValueType* tuple = data + 3 * begin;
+  if (!transform.Normalize)
+    {
+    for (vtkIdType i = begin; i < end; ++i, tuple += 3)
+      {
+      const double x = tuple[0], y = tuple[1], z = tuple[2];
+      tuple[0] = static_cast<ValueType>(a00 * x + a01 * y + a02 * z + t0);
+      tuple[1] = static_cast<ValueType>(a10 * x + a11 * y + a12 * z + t1);
+      tuple[2] = static_cast<ValueType>(a20 * x + a21 * y + a22 * z + t2);
+      }
+    return;
+    }
+  for (vtkIdType i = begin; i < end; ++i, tuple += 3)
+    {
+    const double x = tuple[0], y = tuple[1], z = tuple[2];
+    double nx = a00 * x + a01 * y + a02 * z;
+    double ny = a10 * x + a11 * y + a12 * z;
+    double nz = a20 * x + a21 * y + a22 * z;
+    const double norm = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (norm > 0.0)
+      {
+      nx /= norm;
+      ny /= norm;
+      nz /= norm;
+      }
+    tuple[0] = static_cast<ValueType>(nx);
+    tuple[1] = static_cast<ValueType>(ny);
+    tuple[2] = static_cast<ValueType>(nz);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Transform tuples [begin, end) of a 3-component array, directly in memory
+// for float and double arrays.
+void TransformTuples(vtkDataArray* array, vtkIdType begin, vtkIdType end, const TupleTransform& transform)
+{
+  if (vtkFloatArray* floatArray = vtkFloatArray::SafeDownCast(array))
+    {
+    TransformTuples(floatArray->GetPointer(0), begin, end, transform);
+    }
+  else if (vtkDoubleArray* doubleArray = vtkDoubleArray::SafeDownCast(array))
+    {
+    TransformTuples(doubleArray->GetPointer(0), begin, end, transform);
+    }
+  else
+    {
+    double tuple[3];
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      array->GetTuple(i, tuple);
+      TransformTuples(tuple, 0, 1, transform);
+      array->SetTuple(i, tuple);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Active normals and vectors of point or cell data with the transform that
+// applies to each.
+void GetAttributeTransforms(vtkDataSetAttributes* attributes, const TupleTransform& normalTransform,
+                            const TupleTransform& vectorTransform, std::vector<vtkDataArray*>& arrays,
+                            std::vector<const TupleTransform*>& transforms)
+{
+  vtkDataArray* normals = attributes->GetNormals();
+  if (normals && normals->GetNumberOfComponents() == 3)
+    {
+    arrays.push_back(normals);
+    transforms.push_back(&normalTransform);
+    }
+  vtkDataArray* vectors = attributes->GetVectors();
+  if (vectors && vectors != normals && vectors->GetNumberOfComponents() == 3)
+    {
+    arrays.push_back(vectors);
+    transforms.push_back(&vectorTransform);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <typename ValueType>
+void SumTuples(const ValueType* data, vtkIdType begin, vtkIdType end, double sum[3])
+{
+  double x = 0.0, y = 0.0, z = 0.0;
+  for (const ValueType* tuple = data + 3 * begin; tuple != data + 3 * end; tuple += 3)
+    {
+    x += tuple[0];
+    y += tuple[1];
+    z += tuple[2];
+    }
+  sum[0] += x;
+  sum[1] += y;
+  sum[2] += z;
+}
+
+//----------------------------------------------------------------------------
+template <typename OffsetsArrayType, typename ConnectivityArrayType>
+void ReverseCells(OffsetsArrayType* offsetsArray, ConnectivityArrayType* connectivityArray,
+                  vtkIdType begin, vtkIdType end)
+{
+  const auto* offsets = offsetsArray->GetPointer(0);
+  auto* connectivity = connectivityArray->GetPointer(0);
+  for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+    std::reverse(connectivity + offsets[cellId], connectivity + offsets[cellId + 1]);
+    }
+}
+
+//----------------------------------------------------------------------------
+void ReverseCells(vtkCellArray* cells, vtkIdType begin, vtkIdType end)
+{
+  if (cells->IsStorage64Bit())
+    {
+    ReverseCells(cells->GetOffsetsArray64(), cells->GetConnectivityArray64(), begin, end);
+    }
+  else
+    {
+    ReverseCells(cells->GetOffsetsArray32(), cells->GetConnectivityArray32(), begin, end);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Cell array with the orientation of every triangle strip flipped. Reversing
+// the points of a strip flips its triangles only if it has an odd number of
+// points: with an even number, the first triangle of the reversed strip has
+// the parity of the last one of the input, and keeps its orientation. These
+// strips repeat their first point instead, which shifts the parity of every
+// triangle through a degenerate one.
+template <typename OffsetsArrayType, typename ConnectivityArrayType>
+vtkSmartPointer<vtkCellArray> FlipStrips(OffsetsArrayType* offsetsArray, ConnectivityArrayType* connectivityArray,
+                                         vtkIdType numberOfStrips)
+{
+  const auto* offsets = offsetsArray->GetPointer(0);
+  const auto* connectivity = connectivityArray->GetPointer(0);
+  vtkNew<vtkIdTypeArray> flippedOffsets;
+  flippedOffsets->SetNumberOfValues(numberOfStrips + 1);
+  vtkIdType* newOffsets = flippedOffsets->GetPointer(0);
+  vtkSMPTools::For(0, numberOfStrips, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType stripId = begin; stripId < end; ++stripId)
+      {
+      const vtkIdType numberOfStripPoints = static_cast<vtkIdType>(offsets[stripId + 1] - offsets[stripId]);
+      newOffsets[stripId] = numberOfStripPoints + (numberOfStripPoints > 0 && numberOfStripPoints % 2 == 0);
+      }
+    });
+  newOffsets[numberOfStrips] = 0;
+  const vtkIdType numberOfIds = SurfaceToolbox::ComputePrefixSums(newOffsets, numberOfStrips + 1);
+
+  vtkNew<vtkIdTypeArray> flippedConnectivity;
+  flippedConnectivity->SetNumberOfValues(numberOfIds);
+  vtkIdType* newConnectivity = flippedConnectivity->GetPointer(0);
+  vtkSMPTools::For(0, numberOfStrips, [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType stripId = begin; stripId < end; ++stripId)
+      {
+      const auto* first = connectivity + offsets[stripId];
+      const auto* last = connectivity + offsets[stripId + 1];
+      vtkIdType* flipped = newConnectivity + newOffsets[stripId];
+      if ((last - first) % 2 == 1)
+        {
+        std::reverse_copy(first, last, flipped);
+        }
+      else if (last != first)
+        {
+        *flipped = *first;
+        std::copy(first, last, flipped + 1);
+        }
+      }
+    });
+
+  vtkSmartPointer<vtkCellArray> strips = vtkSmartPointer<vtkCellArray>::New();
+  strips->SetData(flippedOffsets, flippedConnectivity);
+  return strips;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkCellArray> FlipStrips(vtkCellArray* strips)
+{
+  if (strips->IsStorage64Bit())
+    {
+    return FlipStrips(strips->GetOffsetsArray64(), strips->GetConnectivityArray64(), strips->GetNumberOfCells());
+    }
+  return FlipStrips(strips->GetOffsetsArray32(), strips->GetConnectivityArray32(), strips->GetNumberOfCells());
+}
+
+//----------------------------------------------------------------------------
+// An object referenced more than once may be shared with another dataset:
+// stages pass the arrays of their input to their output by ShallowCopy, and
+// the caller of a pipeline keeps its input.
+bool IsShared(vtkObject* object)
+{
+  return object->GetReferenceCount() > 1;
+}
+
+//----------------------------------------------------------------------------
+// Copy of a data array, to be written instead of a shared one
+vtkSmartPointer<vtkDataArray> CopyArray(vtkDataArray* array)
+{
+  vtkSmartPointer<vtkDataArray> copy = vtkSmartPointer<vtkDataArray>::Take(array->NewInstance());
+  copy->DeepCopy(array);
+  return copy;
+}
+
+//----------------------------------------------------------------------------
+// Replace the data of \a polyData that TransformPolyData writes in place by
+// copies if it may be shared: the points, the active normals and vectors, and
+// the vertices, lines and polygons if they are reversed. Strips are rebuilt
+// when they are flipped.
+void DetachWrittenData(vtkPolyData* polyData, bool reverse)
+{
+  vtkPoints* points = polyData->GetPoints();
+  if (points && (IsShared(points) || IsShared(points->GetData())))
+    {
+    vtkNew<vtkPoints> copy;
+    copy->DeepCopy(points);
+    polyData->SetPoints(copy);
+    }
+
+  for (vtkDataSetAttributes* attributes : { static_cast<vtkDataSetAttributes*>(polyData->GetPointData()),
+                                            static_cast<vtkDataSetAttributes*>(polyData->GetCellData()) })
+    {
+    vtkDataArray* normals = attributes->GetNormals();
+    vtkDataArray* vectors = attributes->GetVectors();
+    if (normals && IsShared(normals))
+      {
+      vtkSmartPointer<vtkDataArray> copy = CopyArray(normals);
+      attributes->SetNormals(copy);
+      if (vectors == normals)
+        {
+        attributes->SetVectors(copy);
+        }
+      }
+    if (vectors && vectors != normals && IsShared(vectors))
+      {
+      attributes->SetVectors(CopyArray(vectors));
+      }
+    }
+
+  if (!reverse)
+    {
+    return;
+    }
+  vtkCellArray* verts = polyData->GetVerts();
+  vtkCellArray* lines = polyData->GetLines();
+  vtkCellArray* polys = polyData->GetPolys();
+  vtkCellArray* cellArrays[3] = { verts, lines, polys };
+  for (vtkCellArray* cells : cellArrays)
+    {
+    if (cells->GetNumberOfCells() == 0 ||
+        (!IsShared(cells) && !IsShared(cells->GetOffsetsArray()) && !IsShared(cells->GetConnectivityArray())))
+      {
+      continue;
+      }
+    vtkNew<vtkCellArray> copy;
+    copy->DeepCopy(cells);
+    if (cells == verts)
+      {
+      polyData->SetVerts(copy);
+      }
+    else if (cells == lines)
+      {
+      polyData->SetLines(copy);
+      }
+    else
+      {
+      polyData->SetPolys(copy);
+      }
+    }
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+void TransformPolyData(vtkPolyData* polyData, const double matrix[16])
+{
+  TupleTransform pointTransform;
+  TupleTransform vectorTransform;
+  TupleTransform normalTransform;
+  // Invert leaves the output unchanged if the matrix is singular
+  double inverse[16];
+  vtkMatrix4x4::Identity(inverse);
+  vtkMatrix4x4::Invert(matrix, inverse);
+  for (int row = 0; row < 3; ++row)
+    {
+    for (int column = 0; column < 3; ++column)
+      {
+      pointTransform.Linear[3 * row + column] = matrix[4 * row + column];
+      vectorTransform.Linear[3 * row + column] = matrix[4 * row + column];
+      normalTransform.Linear[3 * row + column] = inverse[4 * column + row];
+      }
+    pointTransform.Translation[row] = matrix[4 * row + 3];
+    vectorTransform.Translation[row] = 0.0;
+    normalTransform.Translation[row] = 0.0;
+    }
+  pointTransform.Normalize = false;
+  vectorTransform.Normalize = false;
+  normalTransform.Normalize = true;
+  const bool reverse = vtkMatrix4x4::Determinant(matrix) < 0.0;
+  DetachWrittenData(polyData, reverse);
+
+  // Points and point attributes, one pass over the point ids
+  std::vector<vtkDataArray*> pointArrays;
+  std::vector<const TupleTransform*> pointTransforms;
+  if (polyData->GetPoints())
+    {
+    pointArrays.push_back(polyData->GetPoints()->GetData());
+    pointTransforms.push_back(&pointTransform);
+    }
+  GetAttributeTransforms(polyData->GetPointData(), normalTransform, vectorTransform, pointArrays, pointTransforms);
+  vtkSMPTools::For(0, polyData->GetNumberOfPoints(), [&](vtkIdType begin, vtkIdType end)
+    {
+    for (size_t i = 0; i < pointArrays.size(); ++i)
+      {
+      TransformTuples(pointArrays[i], begin, end, *pointTransforms[i]);
+      }
+    });
+
+  // Cells and cell attributes, one pass over the cell ids of each cell array
+  std::vector<vtkDataArray*> cellArrays;
+  std::vector<const TupleTransform*> cellTransforms;
+  GetAttributeTransforms(polyData->GetCellData(), normalTransform, vectorTransform, cellArrays, cellTransforms);
+  if (reverse && polyData->GetNumberOfStrips() > 0)
+    {
+    polyData->SetStrips(FlipStrips(polyData->GetStrips()));
+    }
+  vtkCellArray* cellArraysOfType[4] = { polyData->GetVerts(), polyData->GetLines(), polyData->GetPolys(), polyData->GetStrips() };
+  vtkIdType firstCellId = 0;
+  for (int type = 0; type < 4; ++type)
+    {
+    vtkCellArray* cells = cellArraysOfType[type];
+    const vtkIdType numberOfCells = cells->GetNumberOfCells();
+    // Strips were flipped above
+    const bool reverseCells = reverse && type < 3;
+    if (reverseCells || !cellArrays.empty())
+      {
+      vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+        {
+        if (reverseCells)
+          {
+          ReverseCells(cells, begin, end);
+          }
+        for (size_t i = 0; i < cellArrays.size(); ++i)
+          {
+          TransformTuples(cellArrays[i], firstCellId + begin, firstCellId + end, *cellTransforms[i]);
+          }
+        });
+      }
+    if (reverseCells)
+      {
+      cells->Modified();
+      }
+    firstCellId += numberOfCells;
+    }
+
+  for (vtkDataArray* array : pointArrays)
+    {
+    array->Modified();
+    }
+  for (vtkDataArray* array : cellArrays)
+    {
+    array->Modified();
+    }
+  if (polyData->GetPoints())
+    {
+    polyData->GetPoints()->Modified();
+    }
+  polyData->Modified();
+}
+
+//----------------------------------------------------------------------------
+void ComputePointSum(vtkPolyData* polyData, double sum[3])
+{
+  sum[0] = sum[1] = sum[2] = 0.0;
+  vtkPoints* points = polyData->GetPoints();
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  if (!points || numberOfPoints == 0)
+    {
+    return;
+    }
+
+  // Partial sums over fixed-size blocks, added in order
+  const vtkIdType blockSize = 65536;
+  const vtkIdType numberOfBlocks = (numberOfPoints + blockSize - 1) / blockSize;
+  std::vector<double> blockSums(3 * numberOfBlocks, 0.0);
+  vtkDataArray* data = points->GetData();
+  vtkFloatArray* floatData = vtkFloatArray::SafeDownCast(data);
+  vtkDoubleArray* doubleData = vtkDoubleArray::SafeDownCast(data);
+  vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType beginBlock, vtkIdType endBlock)
+    {
+    for (vtkIdType block = beginBlock; block < endBlock; ++block)
+      {
+      double* blockSum = &blockSums[3 * block];
+      const vtkIdType begin = block * blockSize;
+      const vtkIdType end = std::min(numberOfPoints, begin + blockSize);
+      if (floatData)
+        {
+        SumTuples(floatData->GetPointer(0), begin, end, blockSum);
+        }
+      else if (doubleData)
+        {
+        SumTuples(doubleData->GetPointer(0), begin, end, blockSum);
+        }
+      else
+        {
+        double point[3];
+        for (vtkIdType pointId = begin; pointId < end; ++pointId)
+          {
+          data->GetTuple(pointId, point);
+          SumTuples(point, 0, 1, blockSum);
+          }
+        }
+      }
+    });
+  for (vtkIdType block = 0; block < numberOfBlocks; ++block)
+    {
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      sum[axis] += blockSums[3 * block + axis];
+      }
+    }
+}
+
+}
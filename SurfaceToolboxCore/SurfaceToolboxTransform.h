@@ -0,0 +1,36 @@
+#ifndef SurfaceToolboxTransform_h
+#define SurfaceToolboxTransform_h
+
+#include "SurfaceToolboxStages.h"
+
+namespace SurfaceToolbox
+{
+
+/// Apply the affine transform \a matrix (row-major 4x4, as
+/// vtkMatrix4x4::Element) to \a polyData in place.
+///
+/// Points are transformed directly in their float or double array by a
+/// multi-threaded loop; the active point and cell normals are transformed by
+/// the inverse transpose of the linear part and renormalized, and the active
+/// vectors by the linear part, in the same pass as the points or cells they
+/// belong to. If the determinant is negative the order of the points of every
+/// vertex, line and polygon is reversed, as vtkReverseSense, so that the
+/// orientation of the surface is consistent with its normals. Strips with an
+/// odd number of points are reversed too; those with an even number repeat
+/// their first point instead, as reversing them would keep their orientation.
+/// The result matches vtkTransformFilter followed by vtkReverseSense without
+/// copying the data.
+///
+/// Only the arrays written are owned by \a polyData afterwards: the points,
+/// active normals and vectors, and cell arrays to reverse that are referenced
+/// elsewhere, e.g. by the input of the stage that passed them by ShallowCopy,
+/// are deep-copied first and the copy is transformed.
+void TransformPolyData(vtkPolyData* polyData, const double matrix[16]);
+
+/// Sum of the point coordinates, computed in parallel. The result does not
+/// depend on the number of threads.
+void ComputePointSum(vtkPolyData* polyData, double sum[3]);
+
+}
+
+#endif
@@ -0,0 +1,386 @@
+#include "SurfaceToolboxXMLWriter.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkFieldData.h"
+#include "vtkLZ4DataCompressor.h"
+#include "vtkLZMADataCompressor.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkZLibDataCompressor.h"
+
+// STD includes
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+// Uncompressed size of the blocks. Larger than the 32 KiB of
+// vtkXMLWriter: fewer blocks compress better and have smaller headers, and
+// there are still many blocks to compress concurrently on large surfaces.
+const vtkTypeUInt64 BlockSize = 1 << 20;
+
+// Attributes that can be named in the data elements, in
+// vtkDataSetAttributes::AttributeTypes order
+const char* AttributeNames[] = { "Scalars", "Vectors", "Normals", "TCoords", "Tensors" };
+
+struct AppendedArray
+{
+  vtkDataArray* Array = nullptr;
+  vtkIdType FirstValue = 0;
+  vtkIdType NumberOfValues = 0;
+  std::string Name;
+  // Number of blocks, block size, size of the last block if partial, then
+  // the compressed size of each block
+  std::vector<vtkTypeUInt64> Header;
+  std::vector<vtkSmartPointer<vtkUnsignedCharArray>> Blocks;
+  vtkTypeUInt64 Offset = 0;
+
+  const unsigned char* GetData() const
+    {
+    return static_cast<const unsigned char*>(this->Array->GetVoidPointer(0))
+      + this->FirstValue * this->Array->GetDataTypeSize();
+    }
+  vtkTypeUInt64 GetSize() const
+    {
+    return static_cast<vtkTypeUInt64>(this->NumberOfValues) * this->Array->GetDataTypeSize();
+    }
+};
+
+//----------------------------------------------------------------------------
+bool IsWritableArray(vtkAbstractArray* array)
+{
+  vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array);
+  return dataArray && dataArray->GetDataType() != VTK_BIT && dataArray->HasStandardMemoryLayout();
+}
+
+//----------------------------------------------------------------------------
+void AddArray(vtkDataArray* array, std::vector<AppendedArray>& arrays)
+{
+  AppendedArray appendedArray;
+  appendedArray.Array = array;
+  appendedArray.NumberOfValues = array->GetNumberOfValues();
+  appendedArray.Name = array->GetName() ? array->GetName() : "";
+  arrays.push_back(appendedArray);
+}
+
+//----------------------------------------------------------------------------
+// Cells as connectivity and cell end offsets, as in VTK XML files
+void AddCells(vtkCellArray* cells, std::vector<AppendedArray>& arrays)
+{
+  AddArray(cells->GetConnectivityArray(), arrays);
+  arrays.back().Name = "connectivity";
+  AddArray(cells->GetOffsetsArray(), arrays);
+  arrays.back().Name = "offsets";
+  arrays.back().FirstValue = 1;
+  arrays.back().NumberOfValues = cells->GetNumberOfCells();
+}
+
+//----------------------------------------------------------------------------
+// Arrays of the file, in the order of their elements
+void GetArrays(vtkPolyData* polyData, std::vector<AppendedArray>& arrays)
+{
+  vtkFieldData* fieldData[3] = { polyData->GetFieldData(), polyData->GetPointData(), polyData->GetCellData() };
+  for (vtkFieldData* data : fieldData)
+    {
+    for (int i = 0; i < data->GetNumberOfArrays(); ++i)
+      {
+      AddArray(data->GetArray(i), arrays);
+      }
+    }
+  if (polyData->GetPoints())
+    {
+    AddArray(polyData->GetPoints()->GetData(), arrays);
+    if (arrays.back().Name.empty())
+      {
+      arrays.back().Name = "Points";
+      }
+    }
+  AddCells(polyData->GetVerts(), arrays);
+  AddCells(polyData->GetLines(), arrays);
+  AddCells(polyData->GetStrips(), arrays);
+  AddCells(polyData->GetPolys(), arrays);
+}
+
+//----------------------------------------------------------------------------
+// Compress the blocks of all the arrays in parallel, and set their offsets
+// in the appended data.
+bool CompressArrays(std::vector<AppendedArray>& arrays, const std::string& compression, int level)
+{
+  std::vector<std::pair<size_t, vtkTypeUInt64>> blocks;
+  for (size_t i = 0; i < arrays.size(); ++i)
+    {
+    const vtkTypeUInt64 size = arrays[i].GetSize();
+    const vtkTypeUInt64 numberOfBlocks = (size + BlockSize - 1) / BlockSize;
+    arrays[i].Header = { numberOfBlocks, BlockSize, size % BlockSize };
+    arrays[i].Blocks.resize(numberOfBlocks);
+    for (vtkTypeUInt64 block = 0; block < numberOfBlocks; ++block)
+      {
+      blocks.emplace_back(i, block);
+      }
+    }
+
+  vtkSMPTools::For(0, static_cast<vtkIdType>(blocks.size()), 1, [&](vtkIdType begin, vtkIdType end)
+    {
+    vtkSmartPointer<vtkDataCompressor> compressor = SurfaceToolbox::CreateCompressor(compression, level);
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      AppendedArray& array = arrays[blocks[i].first];
+      const vtkTypeUInt64 first = blocks[i].second * BlockSize;
+      const vtkTypeUInt64 size = std::min(BlockSize, array.GetSize() - first);
+      array.Blocks[blocks[i].second].TakeReference(compressor->Compress(array.GetData() + first, size));
+      }
+    });
+
+  vtkTypeUInt64 offset = 0;
+  for (AppendedArray& array : arrays)
+    {
+    array.Offset = offset;
+    offset += array.Header.size() * sizeof(vtkTypeUInt64);
+    for (vtkUnsignedCharArray* block : array.Blocks)
+      {
+      if (!block)
+        {
+        return false;
+        }
+      array.Header.push_back(static_cast<vtkTypeUInt64>(block->GetNumberOfValues()));
+      offset += sizeof(vtkTypeUInt64) + block->GetNumberOfValues();
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void WriteArray(std::ostream& output, const AppendedArray& array, const char* indent, bool numberOfTuples)
+{
+  output << indent << "<DataArray type=\"" << SurfaceToolbox::GetXMLTypeName(array.Array) << "\"";
+  if (array.Array->GetDataType() == VTK_ID_TYPE)
+    {
+    output << " IdType=\"1\"";
+    }
+  if (!array.Name.empty())
+    {
+    output << " Name=\"" << SurfaceToolbox::EscapeXML(array.Name) << "\"";
+    }
+  if (array.Array->GetNumberOfComponents() > 1)
+    {
+    output << " NumberOfComponents=\"" << array.Array->GetNumberOfComponents() << "\"";
+    }
+  if (numberOfTuples)
+    {
+    output << " NumberOfTuples=\"" << array.Array->GetNumberOfTuples() << "\"";
+    }
+  output << " format=\"appended\" offset=\"" << array.Offset << "\"/>\n";
+}
+
+//----------------------------------------------------------------------------
+void WriteData(std::ostream& output, vtkDataSetAttributes* data, const char* element,
+               std::vector<AppendedArray>::const_iterator& array)
+{
+  output << "      <" << element;
+  for (int attribute = 0; attribute < 5; ++attribute)
+    {
+    vtkAbstractArray* attributeArray = data->GetAttribute(attribute);
+    if (attributeArray && attributeArray->GetName())
+      {
+      output << " " << AttributeNames[attribute] << "=\"" << SurfaceToolbox::EscapeXML(attributeArray->GetName())
+             << "\"";
+      }
+    }
+  output << ">\n";
+  for (int i = 0; i < data->GetNumberOfArrays(); ++i)
+    {
+    WriteArray(output, *array++, "        ", false);
+    }
+  output << "      </" << element << ">\n";
+}
+
+//----------------------------------------------------------------------------
+void WriteXML(std::ostream& output, vtkPolyData* polyData, const std::vector<AppendedArray>& arrays,
+              const std::string& compressorName)
+{
+  auto array = arrays.cbegin();
+  output << "<?xml version=\"1.0\"?>\n"
+#ifdef VTK_WORDS_BIGENDIAN
+         << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"BigEndian\" header_type=\"UInt64\""
+#else
+         << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\""
+#endif
+         << " compressor=\"" << compressorName << "\">\n"
+         << "  <PolyData>\n";
+  vtkFieldData* fieldData = polyData->GetFieldData();
+  if (fieldData->GetNumberOfArrays() > 0)
+    {
+    output << "    <FieldData>\n";
+    for (int i = 0; i < fieldData->GetNumberOfArrays(); ++i)
+      {
+      WriteArray(output, *array++, "      ", true);
+      }
+    output << "    </FieldData>\n";
+    }
+  output << "    <Piece NumberOfPoints=\"" << polyData->GetNumberOfPoints() << "\" NumberOfVerts=\""
+         << polyData->GetNumberOfVerts() << "\" NumberOfLines=\"" << polyData->GetNumberOfLines()
+         << "\" NumberOfStrips=\"" << polyData->GetNumberOfStrips() << "\" NumberOfPolys=\""
+         << polyData->GetNumberOfPolys() << "\">\n";
+  WriteData(output, polyData->GetPointData(), "PointData", array);
+  WriteData(output, polyData->GetCellData(), "CellData", array);
+  output << "      <Points>\n";
+  if (polyData->GetPoints())
+    {
+    WriteArray(output, *array++, "        ", false);
+    }
+  output << "      </Points>\n";
+  for (const char* element : { "Verts", "Lines", "Strips", "Polys" })
+    {
+    output << "      <" << element << ">\n";
+    WriteArray(output, *array++, "        ", false);
+    WriteArray(output, *array++, "        ", false);
+    output << "      </" << element << ">\n";
+    }
+  output << "    </Piece>\n"
+         << "  </PolyData>\n"
+         << "  <AppendedData encoding=\"raw\">\n"
+         << "   _";
+}
+
+}
+
+namespace SurfaceToolbox
+{
+
+//----------------------------------------------------------------------------
+bool IsCompression(const std::string& compression)
+{
+  return compression == "none" || compression == "lz4" || compression == "zlib" || compression == "lzma";
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataCompressor> CreateCompressor(const std::string& compression, int level)
+{
+  vtkSmartPointer<vtkDataCompressor> compressor;
+  if (compression == "lz4")
+    {
+    compressor = vtkSmartPointer<vtkLZ4DataCompressor>::New();
+    }
+  else if (compression == "zlib")
+    {
+    compressor = vtkSmartPointer<vtkZLibDataCompressor>::New();
+    }
+  else if (compression == "lzma")
+    {
+    compressor = vtkSmartPointer<vtkLZMADataCompressor>::New();
+    }
+  if (compressor)
+    {
+    compressor->SetCompressionLevel(std::max(1, std::min(level, 9)));
+    }
+  return compressor;
+}
+
+//----------------------------------------------------------------------------
+bool CanWriteCompressedPolyData(vtkPolyData* polyData)
+{
+  vtkFieldData* fieldData[3] = { polyData->GetFieldData(), polyData->GetPointData(), polyData->GetCellData() };
+  for (vtkFieldData* data : fieldData)
+    {
+    for (int i = 0; i < data->GetNumberOfArrays(); ++i)
+      {
+      if (!IsWritableArray(data->GetAbstractArray(i)))
+        {
+        return false;
+        }
+      }
+    }
+  return !polyData->GetPoints() || IsWritableArray(polyData->GetPoints()->GetData());
+}
+
+//----------------------------------------------------------------------------
+bool WriteCompressedPolyData(vtkPolyData* polyData, const std::string& fileName, const std::string& compression,
+                             int level)
+{
+  vtkSmartPointer<vtkDataCompressor> compressor = CreateCompressor(compression, level);
+  if (!compressor)
+    {
+    std::cerr << "Failed to write " << fileName << ": unknown compression " << compression << std::endl;
+    return false;
+    }
+  std::vector<AppendedArray> arrays;
+  GetArrays(polyData, arrays);
+  if (!CompressArrays(arrays, compression, level))
+    {
+    std::cerr << "Failed to write " << fileName << ": compression failed" << std::endl;
+    return false;
+    }
+
+  std::ofstream output(fileName.c_str(), std::ios::binary);
+  WriteXML(output, polyData, arrays, compressor->GetClassName());
+  for (const AppendedArray& array : arrays)
+    {
+    output.write(reinterpret_cast<const char*>(array.Header.data()), array.Header.size() * sizeof(vtkTypeUInt64));
+    for (vtkUnsignedCharArray* block : array.Blocks)
+      {
+      output.write(reinterpret_cast<const char*>(block->GetPointer(0)), block->GetNumberOfValues());
+      }
+    }
+  output << "\n  </AppendedData>\n"
+         << "</VTKFile>\n";
+  output.close();
+  if (!output)
+    {
+    std::cerr << "Failed to write " << fileName << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+std::string GetXMLTypeName(vtkAbstractArray* array)
+{
+  switch (array->GetDataType())
+    {
+    case VTK_FLOAT:
+      return "Float32";
+    case VTK_DOUBLE:
+      return "Float64";
+    case VTK_STRING:
+      return "String";
+    case VTK_BIT:
+      return "Bit";
+    case VTK_UNSIGNED_CHAR:
+    case VTK_UNSIGNED_SHORT:
+    case VTK_UNSIGNED_INT:
+    case VTK_UNSIGNED_LONG:
+    case VTK_UNSIGNED_LONG_LONG:
+      return "UInt" + std::to_string(8 * array->GetDataTypeSize());
+    default:
+      return "Int" + std::to_string(8 * array->GetDataTypeSize());
+    }
+}
+
+//----------------------------------------------------------------------------
+std::string EscapeXML(const std::string& text)
+{
+  std::string escaped;
+  for (char c : text)
+    {
+    switch (c)
+      {
+      case '&': escaped += "&amp;"; break;
+      case '<': escaped += "&lt;"; break;
+      case '>': escaped += "&gt;"; break;
+      case '"': escaped += "&quot;"; break;
+      default: escaped += c;
+      }
+    }
+  return escaped;
+}
+
+}
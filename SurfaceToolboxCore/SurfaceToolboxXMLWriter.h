@@ -0,0 +1,48 @@
+#ifndef SurfaceToolboxXMLWriter_h
+#define SurfaceToolboxXMLWriter_h
+
+// VTK includes
+#include "vtkSmartPointer.h"
+
+// STD includes
+#include <string>
+
+class vtkAbstractArray;
+class vtkDataCompressor;
+class vtkPolyData;
+
+// Compressed .vtp files written with their blocks compressed in parallel.
+// vtkXMLPolyDataWriter compresses the blocks of the arrays one after the
+// other; here all the blocks of all the arrays are compressed concurrently,
+// with the compressors of VTK, then written as appended raw data. The files
+// are read by vtkXMLPolyDataReader.
+namespace SurfaceToolbox
+{
+
+/// Return true if \a compression is "none" or a compression supported by
+/// CreateCompressor.
+bool IsCompression(const std::string& compression);
+
+/// Create the compressor of \a compression ("lz4", "zlib" or "lzma") with
+/// \a level, from 1 (fastest) to 9 (smallest). Returns nullptr for "none" and
+/// unknown compressions.
+vtkSmartPointer<vtkDataCompressor> CreateCompressor(const std::string& compression, int level);
+
+/// Return true if WriteCompressedPolyData can write all the arrays of
+/// \a polyData: numeric arrays with their values stored contiguously.
+bool CanWriteCompressedPolyData(vtkPolyData* polyData);
+
+/// Write \a polyData to the .vtp file \a fileName with \a compression and
+/// \a level. Returns false if the file cannot be written.
+bool WriteCompressedPolyData(vtkPolyData* polyData, const std::string& fileName, const std::string& compression,
+                             int level);
+
+/// Type name of the values of \a array in VTK XML files, e.g. "Float32".
+std::string GetXMLTypeName(vtkAbstractArray* array);
+
+/// Escape the characters of \a text that cannot appear in XML attribute values.
+std::string EscapeXML(const std::string& text);
+
+}
+
+#endif
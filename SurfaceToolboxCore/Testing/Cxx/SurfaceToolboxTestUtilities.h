@@ -0,0 +1,254 @@
+#ifndef SurfaceToolboxTestUtilities_h
+#define SurfaceToolboxTestUtilities_h
+
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxMesh.h"
+
+// VTK includes
+#include "vtkAppendPolyData.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkFloatArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Helpers of the SurfaceToolboxCore tests: small deterministic surfaces, and
+// comparisons of surfaces within a tolerance.
+
+// Report the failed condition and make the test fail.
+#define SurfaceToolbox_CHECK(condition) \
+  if (!(condition)) \
+    { \
+    std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+    return EXIT_FAILURE; \
+    }
+
+namespace SurfaceToolboxTesting
+{
+
+//----------------------------------------------------------------------------
+/// Closed triangulated sphere with float points, a "PointValue" point data
+/// array (x + 2y + 3z) and a "CellValue" cell data array (the cell id).
+inline vtkSmartPointer<vtkPolyData> CreateSphere(double radius = 1.0, int resolution = 16,
+                                                 double x = 0.0, double y = 0.0, double z = 0.0)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(radius);
+  sphere->SetCenter(x, y, z);
+  sphere->SetThetaResolution(2 * resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->Update();
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->DeepCopy(sphere->GetOutput());
+  polyData->GetPointData()->Initialize();
+
+  vtkNew<vtkFloatArray> pointValues;
+  pointValues->SetName("PointValue");
+  pointValues->SetNumberOfTuples(polyData->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < polyData->GetNumberOfPoints(); ++pointId)
+    {
+    const double* point = polyData->GetPoint(pointId);
+    pointValues->SetValue(pointId, static_cast<float>(point[0] + 2.0 * point[1] + 3.0 * point[2]));
+    }
+  polyData->GetPointData()->SetScalars(pointValues);
+
+  vtkNew<vtkFloatArray> cellValues;
+  cellValues->SetName("CellValue");
+  cellValues->SetNumberOfTuples(polyData->GetNumberOfCells());
+  for (vtkIdType cellId = 0; cellId < polyData->GetNumberOfCells(); ++cellId)
+    {
+    cellValues->SetValue(cellId, static_cast<float>(cellId));
+    }
+  polyData->GetCellData()->SetScalars(cellValues);
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+/// \a numberOfSpheres disjoint spheres along x, sphere i of radius 0.5 + 0.1 i
+/// and resolution 4 + 2 i, so that every sphere has a different size.
+inline vtkSmartPointer<vtkPolyData> CreateSpheres(int numberOfSpheres)
+{
+  vtkNew<vtkAppendPolyData> append;
+  for (int i = 0; i < numberOfSpheres; ++i)
+    {
+    append->AddInputData(CreateSphere(0.5 + 0.1 * i, 4 + 2 * i, 3.0 * i, 0.0, 0.0));
+    }
+  append->Update();
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->DeepCopy(append->GetOutput());
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+inline vtkSmartPointer<vtkPolyData> Copy(vtkPolyData* polyData)
+{
+  vtkSmartPointer<vtkPolyData> copy = vtkSmartPointer<vtkPolyData>::New();
+  copy->DeepCopy(polyData);
+  return copy;
+}
+
+//----------------------------------------------------------------------------
+/// Return true if \a a and \a b have the same number of points, at most
+/// \a tolerance apart.
+inline bool ComparePoints(vtkPolyData* a, vtkPolyData* b, double tolerance)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints())
+    {
+    std::cerr << "Number of points: " << a->GetNumberOfPoints() << " != " << b->GetNumberOfPoints() << std::endl;
+    return false;
+    }
+  for (vtkIdType pointId = 0; pointId < a->GetNumberOfPoints(); ++pointId)
+    {
+    double pointA[3];
+    double pointB[3];
+    a->GetPoint(pointId, pointA);
+    b->GetPoint(pointId, pointB);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      if (std::abs(pointA[axis] - pointB[axis]) > tolerance)
+        {
+        std::cerr << "Point " << pointId << ": (" << pointA[0] << ", " << pointA[1] << ", " << pointA[2]
+                  << ") != (" << pointB[0] << ", " << pointB[1] << ", " << pointB[2] << ")" << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Return true if \a a and \a b have the same cells of each type, with the
+/// same point ids.
+inline bool CompareCells(vtkPolyData* a, vtkPolyData* b)
+{
+  if (a->GetNumberOfVerts() != b->GetNumberOfVerts() || a->GetNumberOfLines() != b->GetNumberOfLines()
+      || a->GetNumberOfPolys() != b->GetNumberOfPolys() || a->GetNumberOfStrips() != b->GetNumberOfStrips())
+    {
+    std::cerr << "Number of cells: " << a->GetNumberOfCells() << " != " << b->GetNumberOfCells() << std::endl;
+    return false;
+    }
+  std::vector<vtkIdType> offsetsA;
+  std::vector<vtkIdType> connectivityA;
+  std::vector<vtkIdType> offsetsB;
+  std::vector<vtkIdType> connectivityB;
+  SurfaceToolbox::GetCells(a, offsetsA, connectivityA);
+  SurfaceToolbox::GetCells(b, offsetsB, connectivityB);
+  if (offsetsA != offsetsB || connectivityA != connectivityB)
+    {
+    std::cerr << "Cells differ" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Return true if \a a and \a b have the same triangles, in the same order,
+/// whose corners are at most \a tolerance apart, whatever their point ids.
+/// Used for file formats that renumber the points.
+inline bool CompareTriangleCorners(vtkPolyData* a, vtkPolyData* b, double tolerance)
+{
+  std::vector<vtkIdType> trianglesA;
+  std::vector<vtkIdType> trianglesB;
+  if (!SurfaceToolbox::GetTriangles(a, trianglesA) || !SurfaceToolbox::GetTriangles(b, trianglesB))
+    {
+    std::cerr << "Surfaces are not triangle meshes" << std::endl;
+    return false;
+    }
+  if (trianglesA.size() != trianglesB.size())
+    {
+    std::cerr << "Number of triangles: " << trianglesA.size() / 3 << " != " << trianglesB.size() / 3 << std::endl;
+    return false;
+    }
+  for (size_t corner = 0; corner < trianglesA.size(); ++corner)
+    {
+    double pointA[3];
+    double pointB[3];
+    a->GetPoint(trianglesA[corner], pointA);
+    b->GetPoint(trianglesB[corner], pointB);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      if (std::abs(pointA[axis] - pointB[axis]) > tolerance)
+        {
+        std::cerr << "Corner " << corner % 3 << " of triangle " << corner / 3 << " differs" << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Return true if \a a and \a b have the same tuples, at most \a tolerance apart.
+inline bool CompareArrays(vtkDataArray* a, vtkDataArray* b, double tolerance)
+{
+  if (!a || !b)
+    {
+    std::cerr << "Missing array" << std::endl;
+    return false;
+    }
+  if (a->GetNumberOfTuples() != b->GetNumberOfTuples() || a->GetNumberOfComponents() != b->GetNumberOfComponents())
+    {
+    std::cerr << "Array " << (a->GetName() ? a->GetName() : "") << ": " << a->GetNumberOfTuples() << "x"
+              << a->GetNumberOfComponents() << " != " << b->GetNumberOfTuples() << "x" << b->GetNumberOfComponents()
+              << std::endl;
+    return false;
+    }
+  for (vtkIdType tupleId = 0; tupleId < a->GetNumberOfTuples(); ++tupleId)
+    {
+    for (int component = 0; component < a->GetNumberOfComponents(); ++component)
+      {
+      if (std::abs(a->GetComponent(tupleId, component) - b->GetComponent(tupleId, component)) > tolerance)
+        {
+        std::cerr << "Array " << (a->GetName() ? a->GetName() : "") << ": tuple " << tupleId << " differs"
+                  << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Return true if \a a and \a b have the same points, cells, and point and
+/// cell data arrays of the same names.
+inline bool CompareSurfaces(vtkPolyData* a, vtkPolyData* b, double tolerance)
+{
+  if (!ComparePoints(a, b, tolerance) || !CompareCells(a, b))
+    {
+    return false;
+    }
+  vtkDataSetAttributes* attributesA[2] = { a->GetPointData(), a->GetCellData() };
+  vtkDataSetAttributes* attributesB[2] = { b->GetPointData(), b->GetCellData() };
+  for (int i = 0; i < 2; ++i)
+    {
+    if (attributesA[i]->GetNumberOfArrays() != attributesB[i]->GetNumberOfArrays())
+      {
+      std::cerr << "Number of arrays: " << attributesA[i]->GetNumberOfArrays() << " != "
+                << attributesB[i]->GetNumberOfArrays() << std::endl;
+      return false;
+      }
+    for (int arrayIndex = 0; arrayIndex < attributesA[i]->GetNumberOfArrays(); ++arrayIndex)
+      {
+      vtkDataArray* arrayA = attributesA[i]->GetArray(arrayIndex);
+      if (arrayA && !CompareArrays(arrayA, attributesB[i]->GetArray(arrayA->GetName()), tolerance))
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+}
+
+#endif
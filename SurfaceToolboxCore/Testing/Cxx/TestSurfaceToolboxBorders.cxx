@@ -0,0 +1,281 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxBorders.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCleanPolyData.h"
+#include "vtkFeatureEdges.h"
+#include "vtkPolyDataConnectivityFilter.h"
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace
+{
+
+typedef std::array<double, 3> Point;
+typedef std::pair<Point, Point> Edge;
+
+//----------------------------------------------------------------------------
+// Sphere without the triangles around its poles: two boundary loops of
+// 2 * resolution edges each.
+vtkSmartPointer<vtkPolyData> CreateOpenSphere(int resolution)
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, resolution);
+  std::vector<unsigned char> keepCell(sphere->GetNumberOfCells(), 1);
+  for (vtkIdType cellId = 0; cellId < sphere->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    sphere->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      if (cellPoints[i] <= 1)
+        {
+        keepCell[cellId] = 0;
+        }
+      }
+    }
+  return SurfaceToolbox::ExtractCells(sphere, keepCell);
+}
+
+//----------------------------------------------------------------------------
+// Same polygons, each with its own points, as read from an STL file
+vtkSmartPointer<vtkPolyData> CreateSoup(vtkPolyData* polyData)
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> polys;
+  for (vtkIdType cellId = 0; cellId < polyData->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    polyData->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    polys->InsertNextCell(numberOfCellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      polys->InsertCellPoint(points->InsertNextPoint(polyData->GetPoint(cellPoints[i])));
+      }
+    }
+  vtkSmartPointer<vtkPolyData> soup = vtkSmartPointer<vtkPolyData>::New();
+  soup->SetPoints(points);
+  soup->SetPolys(polys);
+  return soup;
+}
+
+//----------------------------------------------------------------------------
+Edge GetEdge(vtkPolyData* polyData, vtkIdType a, vtkIdType b)
+{
+  Point pointA;
+  Point pointB;
+  polyData->GetPoint(a, pointA.data());
+  polyData->GetPoint(b, pointB.data());
+  return pointA < pointB ? Edge(pointA, pointB) : Edge(pointB, pointA);
+}
+
+//----------------------------------------------------------------------------
+double GetLength(const Edge& edge)
+{
+  return std::sqrt((edge.first[0] - edge.second[0]) * (edge.first[0] - edge.second[0])
+                   + (edge.first[1] - edge.second[1]) * (edge.first[1] - edge.second[1])
+                   + (edge.first[2] - edge.second[2]) * (edge.first[2] - edge.second[2]));
+}
+
+//----------------------------------------------------------------------------
+// Same boundary edges as vtkFeatureEdges on the (cleaned if \a merge) input,
+// chained into as many loops as the connected regions of those edges, of the
+// same lengths. Every loop is closed and repeats its first point.
+int CompareWithVTK(vtkPolyData* input, bool merge, const std::vector<SurfaceToolbox::BoundaryLoop>& loops,
+                   vtkPolyData* output)
+{
+  vtkNew<vtkCleanPolyData> cleaner;
+  cleaner->SetInputData(input);
+  cleaner->SetTolerance(0.0);
+  vtkNew<vtkFeatureEdges> featureEdges;
+  if (merge)
+    {
+    featureEdges->SetInputConnection(cleaner->GetOutputPort());
+    }
+  else
+    {
+    featureEdges->SetInputData(input);
+    }
+  featureEdges->BoundaryEdgesOn();
+  featureEdges->FeatureEdgesOff();
+  featureEdges->NonManifoldEdgesOff();
+  featureEdges->ManifoldEdgesOff();
+  vtkNew<vtkPolyDataConnectivityFilter> connectivity;
+  connectivity->SetInputConnection(featureEdges->GetOutputPort());
+  connectivity->SetExtractionModeToAllRegions();
+  connectivity->ColorRegionsOn();
+  connectivity->Update();
+  vtkPolyData* expected = connectivity->GetOutput();
+
+  // Loops and their lengths, by region
+  const int numberOfRegions = connectivity->GetNumberOfExtractedRegions();
+  SurfaceToolbox_CHECK(static_cast<int>(loops.size()) == numberOfRegions);
+  SurfaceToolbox_CHECK(output->GetNumberOfLines() == numberOfRegions);
+  vtkDataArray* regionIds = expected->GetCellData()->GetArray("RegionId");
+  SurfaceToolbox_CHECK(regionIds);
+  std::vector<double> expectedPerimeters(numberOfRegions, 0.0);
+  std::vector<vtkIdType> expectedNumberOfEdges(numberOfRegions, 0);
+  std::set<Edge> expectedEdges;
+  for (vtkIdType cellId = 0; cellId < expected->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    expected->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    SurfaceToolbox_CHECK(numberOfCellPoints == 2);
+    const Edge edge = GetEdge(expected, cellPoints[0], cellPoints[1]);
+    const int regionId = static_cast<int>(regionIds->GetComponent(cellId, 0));
+    expectedPerimeters[regionId] += GetLength(edge);
+    ++expectedNumberOfEdges[regionId];
+    expectedEdges.insert(edge);
+    }
+  std::vector<double> perimeters;
+  std::vector<vtkIdType> numberOfEdges;
+  for (const SurfaceToolbox::BoundaryLoop& loop : loops)
+    {
+    SurfaceToolbox_CHECK(loop.Closed);
+    perimeters.push_back(loop.Perimeter);
+    numberOfEdges.push_back(loop.NumberOfEdges);
+    }
+  std::sort(perimeters.begin(), perimeters.end());
+  std::sort(expectedPerimeters.begin(), expectedPerimeters.end());
+  std::sort(numberOfEdges.begin(), numberOfEdges.end());
+  std::sort(expectedNumberOfEdges.begin(), expectedNumberOfEdges.end());
+  SurfaceToolbox_CHECK(numberOfEdges == expectedNumberOfEdges);
+  for (int i = 0; i < numberOfRegions; ++i)
+    {
+    SurfaceToolbox_CHECK(std::abs(perimeters[i] - expectedPerimeters[i]) < 1e-9 * expectedPerimeters[i]);
+    }
+
+  // Polylines made of the same edges, with the statistics as cell data
+  std::set<Edge> edges;
+  vtkDataArray* numberOfEdgesArray = output->GetCellData()->GetArray("NumberOfEdges");
+  vtkDataArray* perimeterArray = output->GetCellData()->GetArray("Perimeter");
+  vtkDataArray* closedArray = output->GetCellData()->GetArray("Closed");
+  SurfaceToolbox_CHECK(numberOfEdgesArray && perimeterArray && closedArray);
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    output->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    SurfaceToolbox_CHECK(numberOfCellPoints == loops[cellId].NumberOfEdges + 1);
+    SurfaceToolbox_CHECK(cellPoints[0] == cellPoints[numberOfCellPoints - 1]);
+    for (vtkIdType i = 0; i + 1 < numberOfCellPoints; ++i)
+      {
+      SurfaceToolbox_CHECK(edges.insert(GetEdge(output, cellPoints[i], cellPoints[i + 1])).second);
+      }
+    SurfaceToolbox_CHECK(numberOfEdgesArray->GetComponent(cellId, 0) == loops[cellId].NumberOfEdges);
+    SurfaceToolbox_CHECK(perimeterArray->GetComponent(cellId, 0) == loops[cellId].Perimeter);
+    SurfaceToolbox_CHECK(closedArray->GetComponent(cellId, 0) == 1.0);
+    }
+  SurfaceToolbox_CHECK(edges == expectedEdges);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestBoundaryLoops(vtkPolyData* input, bool merge)
+{
+  SurfaceToolbox::BordersParameters parameters;
+  parameters.MergeCoincidentPoints = merge;
+  std::vector<SurfaceToolbox::BoundaryLoop> loops;
+  vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::ExtractBoundaryLoops(input, parameters, loops);
+  SurfaceToolbox_CHECK(output);
+  return CompareWithVTK(input, merge, loops, output);
+}
+
+//----------------------------------------------------------------------------
+// Header, then one line per loop: id, number of edges, perimeter, closed
+int CheckStatistics(const std::string& fileName, const std::vector<SurfaceToolbox::BoundaryLoop>& loops)
+{
+  std::ifstream file(fileName.c_str());
+  std::string line;
+  SurfaceToolbox_CHECK(std::getline(file, line) && line == "LoopId,NumberOfEdges,Perimeter,Closed");
+  for (size_t loopId = 0; loopId < loops.size(); ++loopId)
+    {
+    SurfaceToolbox_CHECK(std::getline(file, line));
+    std::istringstream row(line);
+    size_t id;
+    vtkIdType numberOfEdges;
+    double perimeter;
+    int closed;
+    char separators[3];
+    row >> id >> separators[0] >> numberOfEdges >> separators[1] >> perimeter >> separators[2] >> closed;
+    SurfaceToolbox_CHECK(row && separators[0] == ',' && separators[1] == ',' && separators[2] == ',');
+    SurfaceToolbox_CHECK(id == loopId && numberOfEdges == loops[loopId].NumberOfEdges);
+    SurfaceToolbox_CHECK(std::abs(perimeter - loops[loopId].Perimeter) < 1e-9 * loops[loopId].Perimeter);
+    SurfaceToolbox_CHECK(closed == (loops[loopId].Closed ? 1 : 0));
+    }
+  SurfaceToolbox_CHECK(!std::getline(file, line));
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxBorders(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string(argv[1]) + "/TestSurfaceToolboxBorders";
+  vtksys::SystemTools::RemoveADirectory(directory);
+  SurfaceToolbox_CHECK(vtksys::SystemTools::MakeDirectory(directory));
+
+  // Two loops around the poles, with or without merging points
+  const int resolution = 16;
+  vtkSmartPointer<vtkPolyData> openSphere = CreateOpenSphere(resolution);
+  for (bool merge : { false, true })
+    {
+    SurfaceToolbox_CHECK(TestBoundaryLoops(openSphere, merge) == EXIT_SUCCESS);
+    }
+
+  // Merging the points of a soup of the same triangles finds the two loops
+  // of the open sphere
+  vtkSmartPointer<vtkPolyData> soup = CreateSoup(openSphere);
+  SurfaceToolbox_CHECK(TestBoundaryLoops(soup, true) == EXIT_SUCCESS);
+  SurfaceToolbox::BordersParameters parameters;
+  std::vector<SurfaceToolbox::BoundaryLoop> loops;
+  vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::ExtractBoundaryLoops(soup, parameters, loops);
+  SurfaceToolbox_CHECK(output && loops.size() == 2 && output->GetNumberOfPoints() == 4 * resolution);
+  for (const SurfaceToolbox::BoundaryLoop& loop : loops)
+    {
+    SurfaceToolbox_CHECK(loop.NumberOfEdges == 2 * resolution);
+    }
+
+  // Without merging, every triangle of the soup is a loop of its own.
+  // vtkFeatureEdges merges the points of its output, so it is not compared.
+  parameters.MergeCoincidentPoints = false;
+  std::vector<SurfaceToolbox::BoundaryLoop> triangleLoops;
+  output = SurfaceToolbox::ExtractBoundaryLoops(soup, parameters, triangleLoops);
+  SurfaceToolbox_CHECK(output && static_cast<vtkIdType>(triangleLoops.size()) == soup->GetNumberOfPolys());
+  SurfaceToolbox_CHECK(output->GetNumberOfPoints() == soup->GetNumberOfPoints());
+  for (const SurfaceToolbox::BoundaryLoop& loop : triangleLoops)
+    {
+    SurfaceToolbox_CHECK(loop.NumberOfEdges == 3 && loop.Closed);
+    }
+  parameters.MergeCoincidentPoints = true;
+
+  // Statistics written by the stage, one line per loop
+  parameters.StatisticsFileName = directory + "/loops.csv";
+  output = SurfaceToolbox::RunParallelBordersOut(soup, parameters);
+  SurfaceToolbox_CHECK(output && output->GetNumberOfLines() == 2);
+  SurfaceToolbox_CHECK(CheckStatistics(parameters.StatisticsFileName, loops) == EXIT_SUCCESS);
+  parameters.StatisticsFileName = directory + "/missing/loops.csv";
+  SurfaceToolbox_CHECK(!SurfaceToolbox::RunParallelBordersOut(soup, parameters));
+
+  vtksys::SystemTools::RemoveADirectory(directory);
+  return EXIT_SUCCESS;
+}
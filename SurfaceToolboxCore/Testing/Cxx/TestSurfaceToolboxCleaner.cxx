@@ -0,0 +1,85 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxCleaner.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkCleanPolyData.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Triangles of a sphere that do not share their points, as read from an STL
+// file, followed by a triangle whose points are all at the same location, a
+// triangle with two points at the same location, and an unused point. Each
+// point has the "PointValue" of its location.
+vtkSmartPointer<vtkPolyData> CreateTriangleSoup()
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, 8);
+  std::vector<vtkIdType> triangles;
+  SurfaceToolbox::GetTriangles(sphere, triangles);
+  triangles.insert(triangles.end(), { 0, 0, 0, 1, 1, 2 });
+
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> polys;
+  vtkNew<vtkFloatArray> pointValues;
+  pointValues->SetName("PointValue");
+  vtkFloatArray* sphereValues = vtkFloatArray::SafeDownCast(sphere->GetPointData()->GetScalars());
+  for (size_t corner = 0; corner < triangles.size(); ++corner)
+    {
+    if (corner % 3 == 0)
+      {
+      polys->InsertNextCell(3);
+      }
+    polys->InsertCellPoint(points->InsertNextPoint(sphere->GetPoint(triangles[corner])));
+    pointValues->InsertNextValue(sphereValues->GetValue(triangles[corner]));
+    }
+  points->InsertNextPoint(5.0, 5.0, 5.0);
+  pointValues->InsertNextValue(5.0f + 10.0f + 15.0f);
+
+  vtkSmartPointer<vtkPolyData> soup = vtkSmartPointer<vtkPolyData>::New();
+  soup->SetPoints(points);
+  soup->SetPolys(polys);
+  soup->GetPointData()->SetScalars(pointValues);
+  return soup;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxCleaner(int, char*[])
+{
+  vtkSmartPointer<vtkPolyData> input = CreateTriangleSoup();
+
+  vtkNew<vtkCleanPolyData> cleaner;
+  cleaner->SetInputData(input);
+  cleaner->Update();
+  vtkPolyData* expected = cleaner->GetOutput();
+
+  SurfaceToolbox::CleanerParameters parameters;
+  vtkSmartPointer<vtkPolyData> cleaned =
+    SurfaceToolbox::RunParallelCleaner(SurfaceToolboxTesting::Copy(input), parameters);
+  SurfaceToolbox_CHECK(cleaned);
+
+  // Same points and cells: the sphere, a vertex and a line
+  const vtkIdType numberOfSpherePoints = SurfaceToolboxTesting::CreateSphere(1.0, 8)->GetNumberOfPoints();
+  SurfaceToolbox_CHECK(expected->GetNumberOfPoints() == numberOfSpherePoints);
+  SurfaceToolbox_CHECK(cleaned->GetNumberOfPoints() == expected->GetNumberOfPoints());
+  SurfaceToolbox_CHECK(cleaned->GetNumberOfVerts() == expected->GetNumberOfVerts());
+  SurfaceToolbox_CHECK(cleaned->GetNumberOfLines() == expected->GetNumberOfLines());
+  SurfaceToolbox_CHECK(cleaned->GetNumberOfPolys() == expected->GetNumberOfPolys());
+  SurfaceToolbox_CHECK(cleaned->GetNumberOfVerts() == 1 && cleaned->GetNumberOfLines() == 1);
+
+  // Merged points keep the values of their location
+  vtkDataArray* values = cleaned->GetPointData()->GetScalars();
+  SurfaceToolbox_CHECK(values && values->GetNumberOfTuples() == cleaned->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < cleaned->GetNumberOfPoints(); ++pointId)
+    {
+    const double* point = cleaned->GetPoint(pointId);
+    SurfaceToolbox_CHECK(std::abs(values->GetComponent(pointId, 0) - (point[0] + 2.0 * point[1] + 3.0 * point[2]))
+                         < 1e-5);
+    }
+  return EXIT_SUCCESS;
+}
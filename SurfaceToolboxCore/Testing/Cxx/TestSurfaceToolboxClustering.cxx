@@ -0,0 +1,106 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxClustering.h"
+#include "SurfaceToolboxIO.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkQuadricClustering.h"
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Triangles of a surface around the origin face outwards, as the input
+// triangles clustered to them. Clustering may fold a few slivers.
+int CheckOutwardTriangles(vtkPolyData* polyData)
+{
+  std::vector<vtkIdType> triangles;
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetTriangles(polyData, triangles));
+  size_t numberOfInwardTriangles = 0;
+  for (size_t triangle = 0; triangle < triangles.size(); triangle += 3)
+    {
+    double p[3][3];
+    for (int k = 0; k < 3; ++k)
+      {
+      polyData->GetPoint(triangles[triangle + k], p[k]);
+      }
+    double normal[3];
+    const double e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+    const double e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    if (normal[0] * (p[0][0] + p[1][0] + p[2][0]) + normal[1] * (p[0][1] + p[1][1] + p[2][1])
+        + normal[2] * (p[0][2] + p[1][2] + p[2][2]) <= 0.0)
+      {
+      ++numberOfInwardTriangles;
+      }
+    }
+  SurfaceToolbox_CHECK(numberOfInwardTriangles <= triangles.size() / 300);
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxClustering(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string(argv[1]) + "/TestSurfaceToolboxClustering";
+  vtksys::SystemTools::RemoveADirectory(directory);
+  SurfaceToolbox_CHECK(vtksys::SystemTools::MakeDirectory(directory));
+
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, 64);
+  SurfaceToolbox::DecimationParameters parameters;
+  parameters.Method = "Clustering";
+  parameters.ClusterSize = 0.1;
+  vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::RunClusteringDecimation(sphere, parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(CheckOutwardTriangles(output) == EXIT_SUCCESS);
+
+  // About as many triangles as vtkQuadricClustering with cells of the same
+  // size, whose grid starts at the bounds instead of the first point, and
+  // the same bounds within a cell
+  vtkNew<vtkQuadricClustering> clustering;
+  clustering->SetInputData(sphere);
+  clustering->SetNumberOfDivisions(20, 20, 20);
+  clustering->AutoAdjustNumberOfDivisionsOff();
+  clustering->Update();
+  vtkPolyData* expected = clustering->GetOutput();
+  const vtkIdType expectedNumberOfTriangles = expected->GetNumberOfPolys();
+  SurfaceToolbox_CHECK(expectedNumberOfTriangles > 0);
+  SurfaceToolbox_CHECK(std::abs(output->GetNumberOfPolys() - expectedNumberOfTriangles)
+                       < expectedNumberOfTriangles / 5);
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() < sphere->GetNumberOfPolys() / 10);
+  double bounds[6];
+  double expectedBounds[6];
+  output->GetBounds(bounds);
+  expected->GetBounds(expectedBounds);
+  for (int i = 0; i < 6; ++i)
+    {
+    SurfaceToolbox_CHECK(std::abs(bounds[i] - expectedBounds[i]) < parameters.ClusterSize);
+    }
+
+  // Streaming a binary STL file of the same triangles, in the same order,
+  // gives the same surface
+  const std::string fileName = directory + "/sphere.stl";
+  SurfaceToolbox_CHECK(SurfaceToolbox::WritePolyData(sphere, fileName));
+  vtkIdType numberOfInputTriangles = 0;
+  vtkSmartPointer<vtkPolyData> streamed =
+    SurfaceToolbox::RunClusteringDecimation(fileName, parameters, numberOfInputTriangles);
+  SurfaceToolbox_CHECK(streamed);
+  SurfaceToolbox_CHECK(numberOfInputTriangles == sphere->GetNumberOfPolys());
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(streamed, output, 1e-5));
+
+  vtksys::SystemTools::RemoveADirectory(directory);
+  return EXIT_SUCCESS;
+}
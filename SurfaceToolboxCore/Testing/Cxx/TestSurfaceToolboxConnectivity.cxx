@@ -0,0 +1,141 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxConnectivity.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkPolyDataConnectivityFilter.h"
+
+// STD includes
+#include <algorithm>
+#include <functional>
+#include <map>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Spheres of different sizes, and two triangles sharing only a point, which
+// are one region as regions are connected through points.
+vtkSmartPointer<vtkPolyData> CreateRegions()
+{
+  vtkSmartPointer<vtkPolyData> polyData = SurfaceToolboxTesting::CreateSpheres(3);
+  polyData->GetCellData()->Initialize();
+  polyData->GetPointData()->Initialize();
+  vtkPoints* points = polyData->GetPoints();
+  const vtkIdType firstPointId = points->GetNumberOfPoints();
+  const double bowtie[5][3] = { { 10, 0, 0 }, { 11, 0, 0 }, { 11, 1, 0 }, { 12, 2, 0 }, { 11, 2, 0 } };
+  for (const double* point : bowtie)
+    {
+    points->InsertNextPoint(point);
+    }
+  vtkCellArray* polys = polyData->GetPolys();
+  const vtkIdType first[3] = { firstPointId, firstPointId + 1, firstPointId + 2 };
+  const vtkIdType second[3] = { firstPointId + 2, firstPointId + 3, firstPointId + 4 };
+  polys->InsertNextCell(3, first);
+  polys->InsertNextCell(3, second);
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+// Return true if \a labels and \a expectedLabels define the same partition,
+// whatever the numbering of the regions.
+bool HaveSameRegions(const std::vector<vtkIdType>& labels, vtkIdTypeArray* expectedLabels)
+{
+  if (!expectedLabels || expectedLabels->GetNumberOfValues() != static_cast<vtkIdType>(labels.size()))
+    {
+    std::cerr << "Missing or incomplete RegionId array" << std::endl;
+    return false;
+    }
+  std::map<vtkIdType, vtkIdType> toExpected;
+  std::map<vtkIdType, vtkIdType> fromExpected;
+  for (vtkIdType i = 0; i < expectedLabels->GetNumberOfValues(); ++i)
+    {
+    const vtkIdType label = labels[i];
+    const vtkIdType expectedLabel = expectedLabels->GetValue(i);
+    if (toExpected.emplace(label, expectedLabel).first->second != expectedLabel
+        || fromExpected.emplace(expectedLabel, label).first->second != label)
+      {
+      std::cerr << "Region of " << i << " differs: " << label << " and " << expectedLabel << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Same regions as vtkPolyDataConnectivityFilter, numbered by decreasing size.
+int TestRegionLabels(vtkPolyData* input)
+{
+  vtkNew<vtkPolyDataConnectivityFilter> connectivity;
+  connectivity->SetInputData(input);
+  connectivity->SetExtractionModeToAllRegions();
+  connectivity->ColorRegionsOn();
+  connectivity->Update();
+  vtkPolyData* expected = connectivity->GetOutput();
+  // All regions are passed unchanged, with their labels
+  SurfaceToolbox_CHECK(expected->GetNumberOfPoints() == input->GetNumberOfPoints());
+  SurfaceToolbox_CHECK(expected->GetNumberOfCells() == input->GetNumberOfCells());
+
+  std::vector<vtkIdType> cellRegions;
+  std::vector<SurfaceToolbox::RegionStatistics> statistics;
+  const std::vector<vtkIdType> pointRegions = SurfaceToolbox::LabelConnectedRegions(input, cellRegions, statistics);
+  SurfaceToolbox_CHECK(static_cast<int>(statistics.size()) == connectivity->GetNumberOfExtractedRegions());
+  SurfaceToolbox_CHECK(statistics.size() == 4);
+  SurfaceToolbox_CHECK(HaveSameRegions(cellRegions,
+                                       vtkIdTypeArray::SafeDownCast(expected->GetCellData()->GetArray("RegionId"))));
+  SurfaceToolbox_CHECK(HaveSameRegions(pointRegions,
+                                       vtkIdTypeArray::SafeDownCast(expected->GetPointData()->GetArray("RegionId"))));
+
+  // Same region sizes, in decreasing order
+  vtkIdTypeArray* regionSizes = connectivity->GetRegionSizes();
+  std::vector<vtkIdType> expectedSizes(regionSizes->GetPointer(0),
+                                       regionSizes->GetPointer(0) + regionSizes->GetNumberOfValues());
+  std::sort(expectedSizes.begin(), expectedSizes.end(), std::greater<vtkIdType>());
+  for (size_t region = 0; region < statistics.size(); ++region)
+    {
+    SurfaceToolbox_CHECK(statistics[region].NumberOfCells == expectedSizes[region]);
+    }
+  SurfaceToolbox_CHECK(statistics.back().NumberOfCells == 2);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// The largest region has the cells and points extracted by vtkPolyDataConnectivityFilter.
+int TestLargestRegion(vtkPolyData* input)
+{
+  vtkNew<vtkPolyDataConnectivityFilter> connectivity;
+  connectivity->SetInputData(input);
+  connectivity->SetExtractionModeToLargestRegion();
+  connectivity->Update();
+  vtkPolyData* expected = connectivity->GetOutput();
+
+  SurfaceToolbox::ConnectivityParameters parameters;
+  vtkSmartPointer<vtkPolyData> largest =
+    SurfaceToolbox::RunParallelConnectivity(SurfaceToolboxTesting::Copy(input), parameters);
+  SurfaceToolbox_CHECK(largest);
+  SurfaceToolbox_CHECK(largest->GetNumberOfCells() == expected->GetNumberOfCells());
+  SurfaceToolbox_CHECK(largest->GetNumberOfPoints() == expected->GetNumberOfPoints());
+  double bounds[6];
+  double expectedBounds[6];
+  largest->GetBounds(bounds);
+  expected->GetBounds(expectedBounds);
+  for (int i = 0; i < 6; ++i)
+    {
+    SurfaceToolbox_CHECK(std::abs(bounds[i] - expectedBounds[i]) < 1e-6);
+    }
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxConnectivity(int, char*[])
+{
+  vtkSmartPointer<vtkPolyData> input = CreateRegions();
+  SurfaceToolbox_CHECK(TestRegionLabels(input) == EXIT_SUCCESS);
+  SurfaceToolbox_CHECK(TestLargestRegion(input) == EXIT_SUCCESS);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxPieces.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkPolyDataNormals.h"
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Write \a input to \a fileName and read it back.
+vtkSmartPointer<vtkPolyData> WriteAndRead(vtkPolyData* input, const std::string& fileName,
+                                          const SurfaceToolbox::WriteParameters& parameters)
+{
+  if (!SurfaceToolbox::WritePolyData(input, fileName, parameters))
+    {
+    std::cerr << "Cannot write " << fileName << std::endl;
+    return nullptr;
+    }
+  vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::ReadPolyData(fileName);
+  if (!output)
+    {
+    std::cerr << "Cannot read " << fileName << std::endl;
+    }
+  return output;
+}
+
+//----------------------------------------------------------------------------
+// .vtp files, raw and compressed, and .pvtp pieces keep the surface unchanged.
+int TestXMLRoundTrips(vtkPolyData* input, const std::string& directory)
+{
+  const char* compressions[4] = { "none", "lz4", "zlib", "lzma" };
+  for (const char* compression : compressions)
+    {
+    SurfaceToolbox::WriteParameters parameters;
+    parameters.Compression = compression;
+    parameters.CompressionLevel = 9;
+    vtkSmartPointer<vtkPolyData> output =
+      WriteAndRead(input, directory + "/surface_" + compression + ".vtp", parameters);
+    SurfaceToolbox_CHECK(output);
+    SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(input, output, 0.0));
+    }
+
+  SurfaceToolbox::WriteParameters parameters;
+  parameters.Compression = "zlib";
+  parameters.NumberOfPieces = 3;
+  const std::string fileName = directory + "/pieces.pvtp";
+  vtkSmartPointer<vtkPolyData> output = WriteAndRead(input, fileName, parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetPieceFileNames(fileName).size() == 3);
+  SurfaceToolbox_CHECK(!output->GetPointData()->GetArray(SurfaceToolbox::PiecePointIdsArrayName));
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(input, output, 0.0));
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// STL, PLY and OBJ files keep the triangles, with float precision.
+int TestMeshFileRoundTrips(vtkPolyData* input, const std::string& directory)
+{
+  const SurfaceToolbox::WriteParameters parameters;
+
+  // STL stores triangle corners: equal vertices are merged back
+  vtkSmartPointer<vtkPolyData> stl = WriteAndRead(input, directory + "/surface.stl", parameters);
+  SurfaceToolbox_CHECK(stl);
+  SurfaceToolbox_CHECK(stl->GetNumberOfPoints() == input->GetNumberOfPoints());
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareTriangleCorners(input, stl, 1e-6));
+
+  // PLY and OBJ keep the points, and their normals
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputData(input);
+  normals->SplittingOff();
+  normals->Update();
+  vtkPolyData* withNormals = normals->GetOutput();
+  const char* extensions[2] = { ".ply", ".obj" };
+  for (const char* extension : extensions)
+    {
+    vtkSmartPointer<vtkPolyData> output = WriteAndRead(withNormals, directory + "/surface" + extension, parameters);
+    SurfaceToolbox_CHECK(output);
+    SurfaceToolbox_CHECK(SurfaceToolboxTesting::ComparePoints(withNormals, output, 1e-6));
+    SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareCells(withNormals, output));
+    SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareArrays(withNormals->GetPointData()->GetNormals(),
+                                                              output->GetPointData()->GetNormals(), 1e-6));
+    }
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxFiles(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string(argv[1]) + "/TestSurfaceToolboxFiles";
+  vtksys::SystemTools::RemoveADirectory(directory);
+  SurfaceToolbox_CHECK(vtksys::SystemTools::MakeDirectory(directory));
+
+  vtkSmartPointer<vtkPolyData> input = SurfaceToolboxTesting::CreateSpheres(3);
+  SurfaceToolbox_CHECK(TestXMLRoundTrips(input, directory) == EXIT_SUCCESS);
+  SurfaceToolbox_CHECK(TestMeshFileRoundTrips(input, directory) == EXIT_SUCCESS);
+
+  vtksys::SystemTools::RemoveADirectory(directory);
+  return EXIT_SUCCESS;
+}
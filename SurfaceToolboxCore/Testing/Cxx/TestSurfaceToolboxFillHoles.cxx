@@ -0,0 +1,127 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxBorders.h"
+#include "SurfaceToolboxFillHoles.h"
+#include "SurfaceToolboxStages.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkFillHolesFilter.h"
+#include "vtkMassProperties.h"
+#include "vtkTriangleFilter.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Sphere without the triangles around its poles (points 0 and 1 of
+// vtkSphereSource) and without one triangle in the middle: two holes of
+// 2 * resolution edges and one of 3 edges, all planar.
+vtkSmartPointer<vtkPolyData> CreateSphereWithHoles(int resolution)
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, resolution);
+  std::vector<unsigned char> keepCell(sphere->GetNumberOfCells(), 1);
+  for (vtkIdType cellId = 0; cellId < sphere->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    sphere->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      if (cellPoints[i] <= 1)
+        {
+        keepCell[cellId] = 0;
+        }
+      }
+    }
+  keepCell[sphere->GetNumberOfCells() / 2] = 0;
+  return SurfaceToolbox::ExtractCells(sphere, keepCell);
+}
+
+//----------------------------------------------------------------------------
+// Number of boundary loops of a surface, -1 on failure.
+vtkIdType GetNumberOfBoundaryLoops(vtkPolyData* polyData)
+{
+  std::vector<SurfaceToolbox::BoundaryLoop> loops;
+  std::vector<vtkIdType> loopOffsets;
+  std::vector<vtkIdType> loopPoints;
+  if (!SurfaceToolbox::GetBoundaryLoops(polyData, false, loops, loopOffsets, loopPoints))
+    {
+    return -1;
+    }
+  return static_cast<vtkIdType>(loops.size());
+}
+
+//----------------------------------------------------------------------------
+double GetSurfaceArea(vtkPolyData* polyData)
+{
+  vtkNew<vtkTriangleFilter> triangulate;
+  triangulate->SetInputData(polyData);
+  vtkNew<vtkMassProperties> properties;
+  properties->SetInputConnection(triangulate->GetOutputPort());
+  properties->Update();
+  return properties->GetSurfaceArea();
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxFillHoles(int, char*[])
+{
+  const int resolution = 16;
+  vtkSmartPointer<vtkPolyData> input = CreateSphereWithHoles(resolution);
+  SurfaceToolbox_CHECK(GetNumberOfBoundaryLoops(input) == 3);
+
+  // vtkFillHolesFilter closes the surface
+  vtkNew<vtkFillHolesFilter> fillHoles;
+  fillHoles->SetInputData(input);
+  fillHoles->SetHoleSize(1000.0);
+  fillHoles->Update();
+  vtkPolyData* expected = fillHoles->GetOutput();
+  SurfaceToolbox_CHECK(GetNumberOfBoundaryLoops(expected) == 0);
+
+  // So does FillHoles, with the same points and caps of the same area, as
+  // the holes are planar
+  SurfaceToolbox::FillHolesParameters parameters;
+  std::vector<SurfaceToolbox::HoleStatistics> holes;
+  vtkSmartPointer<vtkPolyData> output =
+    SurfaceToolbox::FillHoles(SurfaceToolboxTesting::Copy(input), parameters, holes);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(GetNumberOfBoundaryLoops(output) == 0);
+  SurfaceToolbox_CHECK(output->GetNumberOfPoints() == input->GetNumberOfPoints());
+  SurfaceToolbox_CHECK(holes.size() == 3);
+  vtkIdType numberOfCapTriangles = 0;
+  for (const SurfaceToolbox::HoleStatistics& hole : holes)
+    {
+    SurfaceToolbox_CHECK(hole.Filled);
+    SurfaceToolbox_CHECK(hole.NumberOfTriangles == hole.NumberOfEdges - 2);
+    numberOfCapTriangles += hole.NumberOfTriangles;
+    }
+  SurfaceToolbox_CHECK(numberOfCapTriangles == 2 * (2 * resolution - 2) + 1);
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() == input->GetNumberOfPolys() + numberOfCapTriangles);
+  const double expectedArea = GetSurfaceArea(expected);
+  SurfaceToolbox_CHECK(std::abs(GetSurfaceArea(output) - expectedArea) < 1e-6 * expectedArea);
+
+  // Holes larger than MaximumHoleSize are left open: the pole holes have a
+  // radius of sin(12 degrees), the triangle about 0.15
+  parameters.MaximumHoleSize = 0.18;
+  output = SurfaceToolbox::FillHoles(SurfaceToolboxTesting::Copy(input), parameters, holes);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(GetNumberOfBoundaryLoops(output) == 2);
+
+  // The FillHoles stage adds outward point normals to the closed surface
+  parameters.MaximumHoleSize = 1000.0;
+  output = SurfaceToolbox::RunFillHoles(SurfaceToolboxTesting::Copy(input), parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(GetNumberOfBoundaryLoops(output) == 0);
+  vtkDataArray* normals = output->GetPointData()->GetArray("Normals");
+  SurfaceToolbox_CHECK(normals && normals->GetNumberOfTuples() == output->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < output->GetNumberOfPoints(); ++pointId)
+    {
+    const double* point = output->GetPoint(pointId);
+    double normal[3];
+    normals->GetTuple(pointId, normal);
+    SurfaceToolbox_CHECK(normal[0] * point[0] + normal[1] * point[1] + normal[2] * point[2] > 0.0);
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxMassProperties.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCubeSource.h"
+#include "vtkMassProperties.h"
+#include "vtkMath.h"
+#include "vtkTriangleFilter.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Same volume and area as vtkMassProperties, which only takes triangles.
+int CompareWithMassProperties(vtkPolyData* input, SurfaceToolbox::MassProperties& properties)
+{
+  vtkNew<vtkTriangleFilter> triangulate;
+  triangulate->SetInputData(input);
+  vtkNew<vtkMassProperties> expected;
+  expected->SetInputConnection(triangulate->GetOutputPort());
+  expected->Update();
+
+  SurfaceToolbox_CHECK(SurfaceToolbox::ComputeMassProperties(input, properties));
+  SurfaceToolbox_CHECK(std::abs(properties.Volume - expected->GetVolume()) < 1e-9 * expected->GetVolume());
+  SurfaceToolbox_CHECK(std::abs(properties.SurfaceArea - expected->GetSurfaceArea())
+                       < 1e-9 * expected->GetSurfaceArea());
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxMassProperties(int, char*[])
+{
+  // Sphere: a triangle mesh slightly inside the sphere
+  SurfaceToolbox::MassProperties sphereProperties;
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(2.0, 16, 1.0, 2.0, 3.0);
+  SurfaceToolbox_CHECK(CompareWithMassProperties(sphere, sphereProperties) == EXIT_SUCCESS);
+  SurfaceToolbox_CHECK(sphereProperties.Volume < 4.0 / 3.0 * vtkMath::Pi() * 8.0);
+  SurfaceToolbox_CHECK(sphereProperties.Volume > 0.95 * 4.0 / 3.0 * vtkMath::Pi() * 8.0);
+
+  // Box of quads: exact volume, area, centroid and inertia
+  vtkNew<vtkCubeSource> cube;
+  cube->SetXLength(1.0);
+  cube->SetYLength(2.0);
+  cube->SetZLength(3.0);
+  cube->SetCenter(-1.0, 0.5, 2.0);
+  cube->Update();
+  SurfaceToolbox::MassProperties cubeProperties;
+  SurfaceToolbox_CHECK(CompareWithMassProperties(cube->GetOutput(), cubeProperties) == EXIT_SUCCESS);
+  SurfaceToolbox_CHECK(cubeProperties.NumberOfTriangles == 12);
+  SurfaceToolbox_CHECK(std::abs(cubeProperties.Volume - 6.0) < 1e-10);
+  SurfaceToolbox_CHECK(std::abs(cubeProperties.SurfaceArea - 22.0) < 1e-10);
+  const double centroid[3] = { -1.0, 0.5, 2.0 };
+  // m (b^2 + c^2) / 12 about each axis, no products of inertia
+  const double inertia[9] = { 6.5, 0.0, 0.0, 0.0, 5.0, 0.0, 0.0, 0.0, 2.5 };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    SurfaceToolbox_CHECK(std::abs(cubeProperties.Centroid[axis] - centroid[axis]) < 1e-10);
+    }
+  for (int i = 0; i < 9; ++i)
+    {
+    SurfaceToolbox_CHECK(std::abs(cubeProperties.Inertia[i] - inertia[i]) < 1e-10);
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxMeshValues.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string ReadFile(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+//----------------------------------------------------------------------------
+// Unsigned integer of the given number of bytes, stored little-endian at
+// \a data, whatever the byte order of the host
+std::uint64_t ReadLittleEndian(const std::string& data, size_t offset, size_t bytes)
+{
+  std::uint64_t value = 0;
+  for (size_t i = 0; i < bytes; ++i)
+    {
+    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[offset + i])) << (8 * i);
+    }
+  return value;
+}
+
+//----------------------------------------------------------------------------
+float ReadLittleEndianFloat(const std::string& data, size_t offset)
+{
+  const std::uint32_t bits = static_cast<std::uint32_t>(ReadLittleEndian(data, offset, 4));
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+//----------------------------------------------------------------------------
+// Points and triangles stored as float32 and int32 from \a offset
+int CheckValues(const SurfaceToolbox::MeshValues& values, const std::string& data, size_t offset)
+{
+  SurfaceToolbox_CHECK(data.size() == offset + 4 * (values.Points.size() + values.Triangles.size()));
+  for (size_t i = 0; i < values.Points.size(); ++i)
+    {
+    SurfaceToolbox_CHECK(ReadLittleEndianFloat(data, offset + 4 * i) == values.Points[i]);
+    }
+  offset += 4 * values.Points.size();
+  for (size_t i = 0; i < values.Triangles.size(); ++i)
+    {
+    SurfaceToolbox_CHECK(static_cast<vtkTypeInt64>(ReadLittleEndian(data, offset + 4 * i, 4)) == values.Triangles[i]);
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// NumPy 1.0 header of an array of shape (rows, 3) and type \a descr, padded
+// so that the values start at a multiple of 64 bytes. Returns the offset of
+// the values, 0 on failure.
+size_t CheckNpyHeader(const std::string& data, const std::string& descr, vtkTypeInt64 rows)
+{
+  if (data.size() < 10 || data.compare(0, 8, std::string("\x93NUMPY\x01\x00", 8)) != 0)
+    {
+    std::cerr << "Invalid .npy magic" << std::endl;
+    return 0;
+    }
+  const size_t offset = 10 + ReadLittleEndian(data, 8, 2);
+  const std::string header = data.substr(10, offset - 10);
+  const std::string dictionary = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': ("
+    + std::to_string(rows) + ", 3), }";
+  if (offset % 64 != 0 || header.compare(0, dictionary.size(), dictionary) != 0 || header.back() != '\n'
+      || header.find_first_not_of(' ', dictionary.size()) != header.size() - 1)
+    {
+    std::cerr << "Invalid .npy header: " << header << std::endl;
+    return 0;
+    }
+  return offset;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxMeshValues(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string(argv[1]) + "/TestSurfaceToolboxMeshValues";
+  vtksys::SystemTools::RemoveADirectory(directory);
+  SurfaceToolbox_CHECK(vtksys::SystemTools::MakeDirectory(directory));
+
+  // Values that are not exact in decimal, and a point id above 2^16
+  SurfaceToolbox::MeshValues values;
+  values.Points = { 0.1f, -2.5f, 3.0e-8f, 1.0f / 3.0f, 1.0e20f, -0.0f, 7.0f, 8.0f, 9.0f, 10.5f, 11.25f, -12.0f };
+  values.Triangles = { 0, 1, 2, 3, 2, 1, 70000, 0, 3 };
+  SurfaceToolbox_CHECK(values.GetNumberOfPoints() == 4 && values.GetNumberOfTriangles() == 3);
+
+  // Raw: 32 byte header, then float32 points and int32 point ids
+  const std::string rawFileName = directory + "/values.raw";
+  SurfaceToolbox_CHECK(SurfaceToolbox::WriteMeshValuesRaw(values, rawFileName));
+  const std::string raw = ReadFile(rawFileName);
+  SurfaceToolbox_CHECK(raw.size() >= 32 && raw.compare(0, 8, "MESHVAL1") == 0);
+  SurfaceToolbox_CHECK(ReadLittleEndian(raw, 8, 8) == 4);
+  SurfaceToolbox_CHECK(ReadLittleEndian(raw, 16, 8) == 3);
+  SurfaceToolbox_CHECK(ReadLittleEndian(raw, 24, 4) == 4);
+  SurfaceToolbox_CHECK(ReadLittleEndian(raw, 28, 4) == 4);
+  SurfaceToolbox_CHECK(CheckValues(values, raw, 32) == EXIT_SUCCESS);
+
+  // NumPy: points of type float32, triangles of type int32
+  const std::string pointsFileName = directory + "/points.npy";
+  SurfaceToolbox_CHECK(SurfaceToolbox::WritePointsNpy(values, pointsFileName));
+  const std::string points = ReadFile(pointsFileName);
+  const size_t pointsOffset = CheckNpyHeader(points, "<f4", 4);
+  SurfaceToolbox_CHECK(pointsOffset > 0);
+  SurfaceToolbox::MeshValues pointValues;
+  pointValues.Points = values.Points;
+  SurfaceToolbox_CHECK(CheckValues(pointValues, points, pointsOffset) == EXIT_SUCCESS);
+
+  const std::string trianglesFileName = directory + "/triangles.npy";
+  SurfaceToolbox_CHECK(SurfaceToolbox::WriteTrianglesNpy(values, trianglesFileName));
+  const std::string triangles = ReadFile(trianglesFileName);
+  const size_t trianglesOffset = CheckNpyHeader(triangles, "<i4", 3);
+  SurfaceToolbox_CHECK(trianglesOffset > 0);
+  SurfaceToolbox::MeshValues triangleValues;
+  triangleValues.Triangles = values.Triangles;
+  SurfaceToolbox_CHECK(CheckValues(triangleValues, triangles, trianglesOffset) == EXIT_SUCCESS);
+
+  // Text: the shortest decimal that reads back to the same float
+  const std::string csvFileName = directory + "/values.csv";
+  SurfaceToolbox_CHECK(SurfaceToolbox::WriteMeshValuesCSV(values, csvFileName));
+  SurfaceToolbox_CHECK(ReadFile(csvFileName) == "4,\n"
+                                                "0,[0.1, -2.5, 3e-08]\n"
+                                                "1,[0.33333334, 1e+20, -0]\n"
+                                                "2,[7, 8, 9]\n"
+                                                "3,[10.5, 11.25, -12]\n"
+                                                "0,0,1,2,\n"
+                                                "1,3,2,1,\n"
+                                                "2,70000,0,3,\n");
+
+  vtksys::SystemTools::RemoveADirectory(directory);
+  return EXIT_SUCCESS;
+}
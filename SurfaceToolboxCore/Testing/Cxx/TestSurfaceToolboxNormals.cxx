@@ -0,0 +1,134 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxNormals.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkMath.h"
+#include "vtkPolyDataNormals.h"
+
+// STD includes
+#include <algorithm>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Sphere with every third triangle reversed, so that its polygons are not
+// consistently ordered. If \a mirror is set, the sphere is mirrored along x
+// first, which turns its triangles inwards.
+vtkSmartPointer<vtkPolyData> CreateInconsistentSphere(bool mirror)
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, 16);
+  if (mirror)
+    {
+    for (vtkIdType pointId = 0; pointId < sphere->GetNumberOfPoints(); ++pointId)
+      {
+      double point[3];
+      sphere->GetPoint(pointId, point);
+      point[0] = -point[0];
+      sphere->GetPoints()->SetPoint(pointId, point);
+      }
+    }
+  std::vector<vtkIdType> triangles;
+  SurfaceToolbox::GetTriangles(sphere, triangles);
+  for (size_t triangle = 0; triangle < triangles.size() / 3; triangle += 3)
+    {
+    std::swap(triangles[3 * triangle + 1], triangles[3 * triangle + 2]);
+    }
+  sphere->SetPolys(SurfaceToolbox::CreateTriangleCells(triangles.data(),
+                                                       static_cast<vtkIdType>(triangles.size() / 3)));
+  return sphere;
+}
+
+//----------------------------------------------------------------------------
+void GetTriangleNormal(vtkPolyData* polyData, vtkIdType cellId, double normal[3])
+{
+  const vtkIdType* cellPoints;
+  vtkIdType numberOfCellPoints;
+  polyData->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+  double p0[3], p1[3], p2[3], e1[3], e2[3];
+  polyData->GetPoint(cellPoints[0], p0);
+  polyData->GetPoint(cellPoints[1], p1);
+  polyData->GetPoint(cellPoints[2], p2);
+  vtkMath::Subtract(p1, p0, e1);
+  vtkMath::Subtract(p2, p0, e2);
+  vtkMath::Cross(e1, e2, normal);
+  vtkMath::Normalize(normal);
+}
+
+//----------------------------------------------------------------------------
+// Same polygon orientation and point normal directions as
+// vtkPolyDataNormals. Point normals are weighted differently, so only their
+// directions are compared. With AutoOrient, the normals also point outwards.
+int CompareWithPolyDataNormals(vtkPolyData* input, bool autoOrient, bool flip)
+{
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputData(input);
+  normals->SplittingOff();
+  normals->ConsistencyOn();
+  normals->SetAutoOrientNormals(autoOrient);
+  normals->SetFlipNormals(flip);
+  normals->Update();
+  vtkPolyData* expected = normals->GetOutput();
+
+  SurfaceToolbox::NormalsParameters parameters;
+  parameters.AutoOrient = autoOrient;
+  parameters.Flip = flip;
+  vtkSmartPointer<vtkPolyData> output =
+    SurfaceToolbox::RunParallelNormals(SurfaceToolboxTesting::Copy(input), parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(output->GetNumberOfPoints() == expected->GetNumberOfPoints());
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() == expected->GetNumberOfPolys());
+
+  double normal[3], expectedNormal[3];
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); ++cellId)
+    {
+    GetTriangleNormal(output, cellId, normal);
+    GetTriangleNormal(expected, cellId, expectedNormal);
+    SurfaceToolbox_CHECK(vtkMath::Dot(normal, expectedNormal) > 0.99);
+    }
+
+  vtkDataArray* pointNormals = output->GetPointData()->GetNormals();
+  vtkDataArray* expectedPointNormals = expected->GetPointData()->GetNormals();
+  SurfaceToolbox_CHECK(pointNormals && expectedPointNormals);
+  for (vtkIdType pointId = 0; pointId < output->GetNumberOfPoints(); ++pointId)
+    {
+    pointNormals->GetTuple(pointId, normal);
+    expectedPointNormals->GetTuple(pointId, expectedNormal);
+    vtkMath::Normalize(normal);
+    SurfaceToolbox_CHECK(vtkMath::Dot(normal, expectedNormal) > 0.95);
+    if (autoOrient)
+      {
+      // The sphere is centered on the origin
+      double point[3];
+      output->GetPoint(pointId, point);
+      SurfaceToolbox_CHECK(vtkMath::Dot(normal, point) * (flip ? -1.0 : 1.0) > 0.0);
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxNormals(int, char*[])
+{
+  for (bool mirror : { false, true })
+    {
+    vtkSmartPointer<vtkPolyData> input = CreateInconsistentSphere(mirror);
+    for (bool autoOrient : { false, true })
+      {
+      for (bool flip : { false, true })
+        {
+        if (CompareWithPolyDataNormals(input, autoOrient, flip) != EXIT_SUCCESS)
+          {
+          std::cerr << "Mirror " << mirror << ", AutoOrient " << autoOrient << ", Flip " << flip << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
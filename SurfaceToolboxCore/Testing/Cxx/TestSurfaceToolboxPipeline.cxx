@@ -0,0 +1,195 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxPipeline.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Run the stages one at a time, as the single-stage CLIs do.
+vtkSmartPointer<vtkPolyData> RunChainedStages(vtkPolyData* input, const std::vector<std::string>& stages,
+                                              const SurfaceToolbox::PipelineParameters& parameters)
+{
+  vtkSmartPointer<vtkPolyData> surface = SurfaceToolboxTesting::Copy(input);
+  for (const std::string& stage : stages)
+    {
+    surface = SurfaceToolbox::RunStage(stage, surface, parameters);
+    if (!surface)
+      {
+      std::cerr << "Stage " << stage << " failed" << std::endl;
+      return nullptr;
+      }
+    surface = SurfaceToolboxTesting::Copy(surface);
+    }
+  return surface;
+}
+
+//----------------------------------------------------------------------------
+int TestPipelineMatchesChainedStages()
+{
+  SurfaceToolbox::PipelineParameters parameters;
+  parameters.Smoothing.Iterations = 10;
+  parameters.Mirror.X = true;
+  parameters.Scale.X = 2.0;
+  parameters.Translate.Z = 1.5;
+  parameters.Connectivity.Mode = "All";
+  parameters.Connectivity.LabelRegions = true;
+  const std::vector<std::string> stages = {
+    "Smoothing", "Normals", "Mirror", "scaleMesh", "translateMesh", "Cleaner", "Connectivity" };
+
+  vtkSmartPointer<vtkPolyData> input = SurfaceToolboxTesting::CreateSpheres(3);
+  vtkSmartPointer<vtkPolyData> chained = RunChainedStages(input, stages, parameters);
+  vtkSmartPointer<vtkPolyData> pipeline =
+    SurfaceToolbox::RunPipeline(SurfaceToolboxTesting::Copy(input), stages, parameters);
+  SurfaceToolbox_CHECK(chained && pipeline);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(chained, pipeline, 1e-5));
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestTransformStagesAreFused()
+{
+  SurfaceToolbox::PipelineParameters parameters;
+  parameters.Mirror.X = true;
+  parameters.Scale.X = 2.0;
+  parameters.Scale.Y = 3.0;
+  parameters.Translate.X = 1.0;
+  parameters.Translate.Y = -2.0;
+  parameters.Translate.Z = 0.5;
+  const std::vector<std::string> stages = { "Mirror", "scaleMesh", "translateMesh" };
+
+  vtkSmartPointer<vtkPolyData> input = SurfaceToolboxTesting::CreateSphere();
+  std::ostringstream log;
+  vtkSmartPointer<vtkPolyData> fused = SurfaceToolbox::RunPipeline(SurfaceToolboxTesting::Copy(input), stages,
+                                                                   parameters, &log);
+  SurfaceToolbox_CHECK(fused);
+  // The three stages are run and logged as one step
+  const std::string logText = log.str();
+  SurfaceToolbox_CHECK(logText.find("Mirror+scaleMesh+translateMesh: ") == 0);
+  SurfaceToolbox_CHECK(std::count(logText.begin(), logText.end(), '\n') == 1);
+
+  // x' = -2 x + 1, y' = 3 y - 2, z' = z + 0.5, and the mirror reverses the cells
+  SurfaceToolbox_CHECK(fused->GetNumberOfPoints() == input->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < input->GetNumberOfPoints(); ++pointId)
+    {
+    double point[3];
+    double transformed[3];
+    input->GetPoint(pointId, point);
+    fused->GetPoint(pointId, transformed);
+    SurfaceToolbox_CHECK(std::abs(transformed[0] - (-2.0 * point[0] + 1.0)) < 1e-5);
+    SurfaceToolbox_CHECK(std::abs(transformed[1] - (3.0 * point[1] - 2.0)) < 1e-5);
+    SurfaceToolbox_CHECK(std::abs(transformed[2] - (point[2] + 0.5)) < 1e-5);
+    }
+  std::vector<vtkIdType> inputTriangles;
+  std::vector<vtkIdType> fusedTriangles;
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetTriangles(input, inputTriangles));
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetTriangles(fused, fusedTriangles));
+  SurfaceToolbox_CHECK(inputTriangles.size() == fusedTriangles.size());
+  for (size_t triangle = 0; triangle < inputTriangles.size(); triangle += 3)
+    {
+    const vtkIdType* a = &inputTriangles[triangle];
+    const vtkIdType* b = &fusedTriangles[triangle];
+    SurfaceToolbox_CHECK(std::is_permutation(a, a + 3, b));
+    // Same points in the opposite cyclic order
+    SurfaceToolbox_CHECK((b[0] == a[0] && b[1] == a[2]) || (b[0] == a[1] && b[1] == a[0])
+                         || (b[0] == a[2] && b[1] == a[1]));
+    }
+
+  // Same result as the stages run one at a time, MC2Origin included
+  parameters.MC2Origin.ExactMassCenter = true;
+  const std::vector<std::string> centeredStages = { "Mirror", "scaleMesh", "translateMesh", "MC2Origin" };
+  vtkSmartPointer<vtkPolyData> chained = RunChainedStages(input, centeredStages, parameters);
+  vtkSmartPointer<vtkPolyData> centered =
+    SurfaceToolbox::RunPipeline(SurfaceToolboxTesting::Copy(input), centeredStages, parameters);
+  SurfaceToolbox_CHECK(chained && centered);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(chained, centered, 1e-5));
+  // with the mass center exactly at the origin
+  double sum[3] = { 0.0, 0.0, 0.0 };
+  for (vtkIdType pointId = 0; pointId < centered->GetNumberOfPoints(); ++pointId)
+    {
+    const double* point = centered->GetPoint(pointId);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      sum[axis] += point[axis];
+      }
+    }
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    SurfaceToolbox_CHECK(std::abs(sum[axis] / centered->GetNumberOfPoints()) < 1e-5);
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestCachedPipeline(const std::string& temporaryDirectory)
+{
+  SurfaceToolbox::CacheParameters cacheParameters;
+  cacheParameters.Directory = temporaryDirectory + "/TestSurfaceToolboxPipelineCache";
+  cacheParameters.MaximumSize = 100.0;
+  vtksys::SystemTools::RemoveADirectory(cacheParameters.Directory);
+
+  SurfaceToolbox::PipelineParameters parameters;
+  parameters.Smoothing.Iterations = 10;
+  const std::vector<std::string> stages = { "Smoothing", "Normals" };
+  vtkSmartPointer<vtkPolyData> input = SurfaceToolboxTesting::CreateSphere();
+
+  // First run: nothing cached
+  std::ostringstream firstLog;
+  vtkSmartPointer<vtkPolyData> first = SurfaceToolbox::RunCachedPipeline(
+    SurfaceToolboxTesting::Copy(input), stages, parameters, cacheParameters, &firstLog);
+  SurfaceToolbox_CHECK(first);
+  SurfaceToolbox_CHECK(firstLog.str().find("no cached stage") != std::string::npos);
+
+  // Same input and parameters: the whole output is restored
+  std::ostringstream secondLog;
+  vtkSmartPointer<vtkPolyData> second = SurfaceToolbox::RunCachedPipeline(
+    SurfaceToolboxTesting::Copy(input), stages, parameters, cacheParameters, &secondLog);
+  SurfaceToolbox_CHECK(second);
+  SurfaceToolbox_CHECK(secondLog.str().find("restored Smoothing+Normals\n") != std::string::npos);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(first, second, 0.0));
+
+  // Changing the last stage resumes from the output of the first one
+  parameters.Normals.Flip = true;
+  std::ostringstream thirdLog;
+  vtkSmartPointer<vtkPolyData> third = SurfaceToolbox::RunCachedPipeline(
+    SurfaceToolboxTesting::Copy(input), stages, parameters, cacheParameters, &thirdLog);
+  SurfaceToolbox_CHECK(third);
+  SurfaceToolbox_CHECK(thirdLog.str().find("restored Smoothing\n") != std::string::npos);
+  vtkSmartPointer<vtkPolyData> uncached = SurfaceToolbox::RunPipeline(SurfaceToolboxTesting::Copy(input), stages,
+                                                                      parameters);
+  SurfaceToolbox_CHECK(uncached);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(third, uncached, 0.0));
+
+  // A different input does not hit the cache
+  std::ostringstream otherLog;
+  SurfaceToolbox_CHECK(SurfaceToolbox::RunCachedPipeline(SurfaceToolboxTesting::CreateSphere(2.0), stages,
+                                                         parameters, cacheParameters, &otherLog));
+  SurfaceToolbox_CHECK(otherLog.str().find("no cached stage") != std::string::npos);
+
+  vtksys::SystemTools::RemoveADirectory(cacheParameters.Directory);
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxPipeline(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  SurfaceToolbox_CHECK(TestPipelineMatchesChainedStages() == EXIT_SUCCESS);
+  SurfaceToolbox_CHECK(TestTransformStagesAreFused() == EXIT_SUCCESS);
+  SurfaceToolbox_CHECK(TestCachedPipeline(argv[1]) == EXIT_SUCCESS);
+  return EXIT_SUCCESS;
+}
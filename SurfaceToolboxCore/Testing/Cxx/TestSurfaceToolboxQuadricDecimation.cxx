@@ -0,0 +1,229 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxQuadricDecimation.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkPlaneSource.h"
+#include "vtkTriangleFilter.h"
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Triangulated square of 2 * resolution^2 triangles, from -0.5 to 0.5 in x
+// and y, whose 4 * resolution boundary points are locked when
+// BoundaryVertexDeletion is off.
+vtkSmartPointer<vtkPolyData> CreatePlane(int resolution)
+{
+  vtkNew<vtkPlaneSource> plane;
+  plane->SetResolution(resolution, resolution);
+  vtkNew<vtkTriangleFilter> triangulate;
+  triangulate->SetInputConnection(plane->GetOutputPort());
+  triangulate->Update();
+  return SurfaceToolboxTesting::Copy(triangulate->GetOutput());
+}
+
+//----------------------------------------------------------------------------
+// Coordinates of the points of the plane boundary
+std::set<std::pair<double, double>> GetBoundaryPoints(vtkPolyData* polyData)
+{
+  std::set<std::pair<double, double>> boundaryPoints;
+  for (vtkIdType pointId = 0; pointId < polyData->GetNumberOfPoints(); ++pointId)
+    {
+    const double* point = polyData->GetPoint(pointId);
+    if (std::abs(point[0]) == 0.5 || std::abs(point[1]) == 0.5)
+      {
+      boundaryPoints.insert(std::make_pair(point[0], point[1]));
+      }
+    }
+  return boundaryPoints;
+}
+
+//----------------------------------------------------------------------------
+// Closed, consistently oriented 2-manifold of genus 0: every directed edge is
+// used once and its reverse once, no triangle is degenerate, every point is
+// used, and V - E + F = 2.
+int CheckClosedManifold(vtkPolyData* polyData)
+{
+  std::vector<vtkIdType> triangles;
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetTriangles(polyData, triangles));
+  std::set<std::pair<vtkIdType, vtkIdType>> edges;
+  std::vector<unsigned char> usedPoints(polyData->GetNumberOfPoints(), 0);
+  for (size_t triangle = 0; triangle < triangles.size() / 3; ++triangle)
+    {
+    const vtkIdType* t = &triangles[3 * triangle];
+    SurfaceToolbox_CHECK(t[0] != t[1] && t[1] != t[2] && t[2] != t[0]);
+    for (int corner = 0; corner < 3; ++corner)
+      {
+      SurfaceToolbox_CHECK(edges.insert(std::make_pair(t[corner], t[(corner + 1) % 3])).second);
+      usedPoints[t[corner]] = 1;
+      }
+    }
+  for (const std::pair<vtkIdType, vtkIdType>& edge : edges)
+    {
+    SurfaceToolbox_CHECK(edges.count(std::make_pair(edge.second, edge.first)) == 1);
+    }
+  SurfaceToolbox_CHECK(std::count(usedPoints.begin(), usedPoints.end(), 0) == 0);
+  const vtkIdType numberOfEdges = static_cast<vtkIdType>(edges.size() / 2);
+  const vtkIdType numberOfTriangles = static_cast<vtkIdType>(triangles.size() / 3);
+  SurfaceToolbox_CHECK(polyData->GetNumberOfPoints() - numberOfEdges + numberOfTriangles == 2);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// Levels of detail decimated in one run, in the order of their reductions,
+// have decreasing numbers of triangles, and are written to the levels
+// directory under the name of the output.
+int TestLevels(vtkPolyData* sphere, const std::string& directory)
+{
+  SurfaceToolbox::DecimationParameters parameters;
+  parameters.Method = "Quadric";
+  parameters.TargetNumberOfTriangles = 10;
+  const std::vector<double> reductions = { 0.5, 0.95, 0.8 };
+  std::vector<vtkSmartPointer<vtkPolyData>> levels =
+    SurfaceToolbox::RunQuadricDecimationLevels(sphere, parameters, reductions);
+  SurfaceToolbox_CHECK(levels.size() == reductions.size());
+  const vtkIdType numberOfTriangles = sphere->GetNumberOfPolys();
+  for (size_t level = 0; level < levels.size(); ++level)
+    {
+    SurfaceToolbox_CHECK(levels[level]);
+    // TargetNumberOfTriangles is ignored
+    const vtkIdType target =
+      numberOfTriangles - static_cast<vtkIdType>(std::floor(reductions[level] * numberOfTriangles));
+    SurfaceToolbox_CHECK(levels[level]->GetNumberOfPolys() <= target
+                         && levels[level]->GetNumberOfPolys() >= target - 1);
+    SurfaceToolbox_CHECK(CheckClosedManifold(levels[level]) == EXIT_SUCCESS);
+    }
+  SurfaceToolbox_CHECK(levels[0]->GetNumberOfPolys() > levels[2]->GetNumberOfPolys());
+  SurfaceToolbox_CHECK(levels[2]->GetNumberOfPolys() > levels[1]->GetNumberOfPolys());
+
+  // Level i is written as <output name>_lod<i> in the levels directory, or
+  // next to the output
+  const std::string levelsDirectory = directory + "/levels";
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetLevelFileName("/output/surface.vtp", levelsDirectory, 2)
+                       == levelsDirectory + "/surface_lod2.vtp");
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetLevelFileName("/output/surface.vtp", "", 1) == "/output/surface_lod1.vtp");
+  SurfaceToolbox_CHECK(SurfaceToolbox::GetLevelFileName("/output.d/surface", "", 1) == "/output.d/surface_lod1");
+  SurfaceToolbox_CHECK(vtksys::SystemTools::MakeDirectory(levelsDirectory));
+  for (size_t level = 1; level < levels.size(); ++level)
+    {
+    const std::string fileName = SurfaceToolbox::GetLevelFileName(directory + "/surface.vtp", levelsDirectory, level);
+    SurfaceToolbox_CHECK(SurfaceToolbox::WritePolyData(levels[level], fileName));
+    vtkSmartPointer<vtkPolyData> written = SurfaceToolbox::ReadPolyData(levelsDirectory + "/surface_lod"
+                                                                        + std::to_string(level) + ".vtp");
+    SurfaceToolbox_CHECK(written);
+    SurfaceToolbox_CHECK(written->GetNumberOfPolys() == levels[level]->GetNumberOfPolys());
+    }
+  SurfaceToolbox_CHECK(!vtksys::SystemTools::FileExists(directory + "/surface_lod1.vtp"));
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxQuadricDecimation(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " <temporary directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = std::string(argv[1]) + "/TestSurfaceToolboxQuadricDecimation";
+  vtksys::SystemTools::RemoveADirectory(directory);
+  SurfaceToolbox_CHECK(vtksys::SystemTools::MakeDirectory(directory));
+
+  SurfaceToolbox::DecimationParameters parameters;
+  parameters.Method = "Quadric";
+
+  // TargetReduction is reached within one collapse, as the sphere is small
+  // enough to be decimated as one region, and the output is a closed manifold
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, 32);
+  const vtkIdType numberOfTriangles = sphere->GetNumberOfPolys();
+  parameters.TargetReduction = 0.75;
+  vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::RunQuadricDecimation(sphere, parameters);
+  SurfaceToolbox_CHECK(output);
+  const vtkIdType target = numberOfTriangles - static_cast<vtkIdType>(std::floor(0.75 * numberOfTriangles));
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() <= target && output->GetNumberOfPolys() >= target - 1);
+  SurfaceToolbox_CHECK(CheckClosedManifold(output) == EXIT_SUCCESS);
+  vtkDataArray* pointValues = output->GetPointData()->GetArray("PointValue");
+  SurfaceToolbox_CHECK(pointValues && pointValues->GetNumberOfTuples() == output->GetNumberOfPoints());
+
+  // TargetNumberOfTriangles takes precedence
+  parameters.TargetNumberOfTriangles = 500;
+  output = SurfaceToolbox::RunQuadricDecimation(sphere, parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() <= 500 && output->GetNumberOfPolys() >= 499);
+  SurfaceToolbox_CHECK(CheckClosedManifold(output) == EXIT_SUCCESS);
+  parameters.TargetNumberOfTriangles = 0;
+
+  // A sphere large enough to be split into regions, decimated concurrently:
+  // the budgets of the regions add up to the target
+  vtkSmartPointer<vtkPolyData> largeSphere = SurfaceToolboxTesting::CreateSphere(1.0, 96);
+  const vtkIdType largeNumberOfTriangles = largeSphere->GetNumberOfPolys();
+  parameters.TargetReduction = 0.9;
+  output = SurfaceToolbox::RunQuadricDecimation(largeSphere, parameters);
+  SurfaceToolbox_CHECK(output);
+  const vtkIdType largeTarget =
+    largeNumberOfTriangles - static_cast<vtkIdType>(std::floor(0.9 * largeNumberOfTriangles));
+  SurfaceToolbox_CHECK(std::abs(output->GetNumberOfPolys() - largeTarget) <= largeNumberOfTriangles / 100);
+  SurfaceToolbox_CHECK(CheckClosedManifold(output) == EXIT_SUCCESS);
+
+  // MaximumError alone stops the decimation long before TargetReduction,
+  // which is ignored, and a smaller error keeps more triangles. The points
+  // stay near the sphere.
+  parameters.TargetReduction = 0.99;
+  parameters.MaximumError = 1e-3;
+  output = SurfaceToolbox::RunQuadricDecimation(sphere, parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() < numberOfTriangles);
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() > numberOfTriangles / 10);
+  SurfaceToolbox_CHECK(CheckClosedManifold(output) == EXIT_SUCCESS);
+  for (vtkIdType pointId = 0; pointId < output->GetNumberOfPoints(); ++pointId)
+    {
+    const double* point = output->GetPoint(pointId);
+    SurfaceToolbox_CHECK(std::abs(std::sqrt(point[0] * point[0] + point[1] * point[1] + point[2] * point[2]) - 1.0)
+                         < 0.02);
+    }
+  parameters.MaximumError = 1e-5;
+  vtkSmartPointer<vtkPolyData> preciseOutput = SurfaceToolbox::RunQuadricDecimation(sphere, parameters);
+  SurfaceToolbox_CHECK(preciseOutput);
+  SurfaceToolbox_CHECK(preciseOutput->GetNumberOfPolys() >= output->GetNumberOfPolys());
+
+  // With a number of triangles, MaximumError still stops first
+  parameters.MaximumError = 1e-3;
+  parameters.TargetNumberOfTriangles = 100;
+  vtkSmartPointer<vtkPolyData> limitedOutput = SurfaceToolbox::RunQuadricDecimation(sphere, parameters);
+  SurfaceToolbox_CHECK(limitedOutput);
+  SurfaceToolbox_CHECK(limitedOutput->GetNumberOfPolys() > 100);
+  parameters.MaximumError = 0.0;
+  parameters.TargetNumberOfTriangles = 0;
+
+  // Without BoundaryVertexDeletion, every boundary point is kept in place.
+  // With it, the points along the straight borders are collapsed too.
+  vtkSmartPointer<vtkPolyData> plane = CreatePlane(20);
+  const std::set<std::pair<double, double>> boundaryPoints = GetBoundaryPoints(plane);
+  SurfaceToolbox_CHECK(boundaryPoints.size() == 80);
+  parameters.TargetReduction = 0.8;
+  parameters.BoundaryVertexDeletion = false;
+  output = SurfaceToolbox::RunQuadricDecimation(plane, parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() < plane->GetNumberOfPolys() / 2);
+  SurfaceToolbox_CHECK(GetBoundaryPoints(output) == boundaryPoints);
+  parameters.BoundaryVertexDeletion = true;
+  output = SurfaceToolbox::RunQuadricDecimation(plane, parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(GetBoundaryPoints(output).size() < boundaryPoints.size());
+
+  SurfaceToolbox_CHECK(TestLevels(sphere, directory) == EXIT_SUCCESS);
+  vtksys::SystemTools::RemoveADirectory(directory);
+  return EXIT_SUCCESS;
+}
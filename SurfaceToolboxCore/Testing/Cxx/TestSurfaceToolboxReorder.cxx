@@ -0,0 +1,152 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxReorder.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkFieldData.h"
+
+// STD includes
+#include <array>
+#include <map>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Disjoint spheres, whose points are all at different locations, with a
+// vertex and a line on the first points, so that every cell type with data
+// is reordered. "CellValue" is the cell id, and the field data has a
+// "FieldValue" array.
+vtkSmartPointer<vtkPolyData> CreateSurface()
+{
+  vtkSmartPointer<vtkPolyData> surface = SurfaceToolboxTesting::CreateSpheres(3);
+  vtkNew<vtkCellArray> verts;
+  verts->InsertNextCell(1);
+  verts->InsertCellPoint(0);
+  vtkNew<vtkCellArray> lines;
+  lines->InsertNextCell(2);
+  lines->InsertCellPoint(0);
+  lines->InsertCellPoint(1);
+  surface->SetVerts(verts);
+  surface->SetLines(lines);
+
+  vtkNew<vtkFloatArray> cellValues;
+  cellValues->SetName("CellValue");
+  cellValues->SetNumberOfTuples(surface->GetNumberOfCells());
+  for (vtkIdType cellId = 0; cellId < surface->GetNumberOfCells(); ++cellId)
+    {
+    cellValues->SetValue(cellId, static_cast<float>(cellId));
+    }
+  surface->GetCellData()->Initialize();
+  surface->GetCellData()->SetScalars(cellValues);
+
+  vtkNew<vtkFloatArray> fieldValues;
+  fieldValues->SetName("FieldValue");
+  fieldValues->InsertNextValue(42.0f);
+  surface->GetFieldData()->AddArray(fieldValues);
+  return surface;
+}
+
+//----------------------------------------------------------------------------
+// Same surface as \a input with its points and cells permuted: every point
+// keeps its "PointValue", and every cell its type, its points in the same
+// order, and its "CellValue".
+int CheckReordered(vtkPolyData* input, vtkPolyData* output)
+{
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(output->GetNumberOfPoints() == input->GetNumberOfPoints());
+  SurfaceToolbox_CHECK(output->GetNumberOfVerts() == input->GetNumberOfVerts());
+  SurfaceToolbox_CHECK(output->GetNumberOfLines() == input->GetNumberOfLines());
+  SurfaceToolbox_CHECK(output->GetNumberOfPolys() == input->GetNumberOfPolys());
+
+  // Input point of every output point, found by its location
+  std::map<std::array<double, 3>, vtkIdType> inputPointIds;
+  for (vtkIdType pointId = 0; pointId < input->GetNumberOfPoints(); ++pointId)
+    {
+    std::array<double, 3> point;
+    input->GetPoint(pointId, point.data());
+    inputPointIds[point] = pointId;
+    }
+  SurfaceToolbox_CHECK(static_cast<vtkIdType>(inputPointIds.size()) == input->GetNumberOfPoints());
+  std::vector<vtkIdType> outputToInput(output->GetNumberOfPoints());
+  std::vector<unsigned char> usedPoints(input->GetNumberOfPoints(), 0);
+  vtkIdType numberOfMovedPoints = 0;
+  vtkDataArray* pointValues = output->GetPointData()->GetArray("PointValue");
+  vtkDataArray* inputPointValues = input->GetPointData()->GetArray("PointValue");
+  SurfaceToolbox_CHECK(pointValues && pointValues->GetNumberOfTuples() == output->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < output->GetNumberOfPoints(); ++pointId)
+    {
+    std::array<double, 3> point;
+    output->GetPoint(pointId, point.data());
+    auto inputPoint = inputPointIds.find(point);
+    SurfaceToolbox_CHECK(inputPoint != inputPointIds.end());
+    SurfaceToolbox_CHECK(!usedPoints[inputPoint->second]);
+    usedPoints[inputPoint->second] = 1;
+    outputToInput[pointId] = inputPoint->second;
+    numberOfMovedPoints += inputPoint->second != pointId ? 1 : 0;
+    SurfaceToolbox_CHECK(pointValues->GetComponent(pointId, 0)
+                         == inputPointValues->GetComponent(inputPoint->second, 0));
+    }
+  // The spheres are generated ring by ring, not along a curve
+  SurfaceToolbox_CHECK(numberOfMovedPoints > 0);
+
+  // Input cell of every output cell, found by its input point ids
+  std::map<std::vector<vtkIdType>, vtkIdType> inputCellIds;
+  for (vtkIdType cellId = 0; cellId < input->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    input->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    inputCellIds[std::vector<vtkIdType>(cellPoints, cellPoints + numberOfCellPoints)] = cellId;
+    }
+  SurfaceToolbox_CHECK(static_cast<vtkIdType>(inputCellIds.size()) == input->GetNumberOfCells());
+  vtkDataArray* cellValues = output->GetCellData()->GetArray("CellValue");
+  vtkDataArray* inputCellValues = input->GetCellData()->GetArray("CellValue");
+  SurfaceToolbox_CHECK(cellValues && cellValues->GetNumberOfTuples() == output->GetNumberOfCells());
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    output->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    std::vector<vtkIdType> inputCellPoints(numberOfCellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      inputCellPoints[i] = outputToInput[cellPoints[i]];
+      }
+    auto inputCell = inputCellIds.find(inputCellPoints);
+    SurfaceToolbox_CHECK(inputCell != inputCellIds.end());
+    SurfaceToolbox_CHECK(output->GetCellType(cellId) == input->GetCellType(inputCell->second));
+    SurfaceToolbox_CHECK(cellValues->GetComponent(cellId, 0)
+                         == inputCellValues->GetComponent(inputCell->second, 0));
+    }
+
+  vtkDataArray* fieldValues = output->GetFieldData()->GetArray("FieldValue");
+  SurfaceToolbox_CHECK(fieldValues && fieldValues->GetComponent(0, 0) == 42.0);
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxReorder(int, char*[])
+{
+  vtkSmartPointer<vtkPolyData> input = CreateSurface();
+  SurfaceToolbox::ReorderParameters parameters;
+  for (const std::string curve : { "Hilbert", "Morton" })
+    {
+    parameters.Curve = curve;
+    vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::RunReorder(input, parameters);
+    if (CheckReordered(input, output) != EXIT_SUCCESS)
+      {
+      std::cerr << "Curve " << curve << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  parameters.Curve = "Peano";
+  SurfaceToolbox_CHECK(!SurfaceToolbox::RunReorder(input, parameters));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxSharedMemory.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// STD includes
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxSharedMemory(int, char*[])
+{
+#ifdef _WIN32
+  // Shared memory surfaces are not supported on Windows
+  SurfaceToolbox_CHECK(!SurfaceToolbox::WriteSharedMemoryPolyData(SurfaceToolboxTesting::CreateSphere(), "shm:/a"));
+  return EXIT_SUCCESS;
+#else
+  const std::string name = "shm:/TestSurfaceToolboxSharedMemory" + std::to_string(getpid());
+  SurfaceToolbox_CHECK(SurfaceToolbox::IsSharedMemoryName(name));
+  SurfaceToolbox_CHECK(!SurfaceToolbox::IsSharedMemoryName("surface.vtp"));
+
+  // The surface read back from the segment has the same points, cells and
+  // point and cell data arrays, through ReadPolyData as every CLI
+  vtkSmartPointer<vtkPolyData> input = SurfaceToolboxTesting::CreateSpheres(3);
+  SurfaceToolbox_CHECK(SurfaceToolbox::WritePolyData(input, name));
+  vtkSmartPointer<vtkPolyData> output = SurfaceToolbox::ReadPolyData(name);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(output, input, 0.0));
+  SurfaceToolbox_CHECK(output->GetPointData()->GetScalars()
+                       && std::string(output->GetPointData()->GetScalars()->GetName()) == "PointValue");
+
+  // The mapping is private: modifying the surface does not change the
+  // segment, which a second reader still sees unchanged
+  output->GetPoints()->SetPoint(0, 10.0, 20.0, 30.0);
+  vtkSmartPointer<vtkPolyData> secondOutput = SurfaceToolbox::ReadSharedMemoryPolyData(name);
+  SurfaceToolbox_CHECK(secondOutput);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(secondOutput, input, 0.0));
+
+  // Once removed, the segment cannot be read anymore, but the surfaces
+  // mapping it stay valid until they are deleted, which releases the mapping
+  SurfaceToolbox_CHECK(SurfaceToolbox::RemoveSharedMemory(name));
+  SurfaceToolbox_CHECK(!SurfaceToolbox::ReadSharedMemoryPolyData(name));
+  SurfaceToolbox_CHECK(!SurfaceToolbox::RemoveSharedMemory(name));
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareSurfaces(secondOutput, input, 0.0));
+  double point[3];
+  output->GetPoint(0, point);
+  SurfaceToolbox_CHECK(point[0] == 10.0 && point[1] == 20.0 && point[2] == 30.0);
+  output = nullptr;
+  secondOutput = nullptr;
+
+  // Array names that do not fit in their entry are rejected, not truncated
+  vtkNew<vtkFloatArray> longNameArray;
+  longNameArray->SetName(std::string(64, 'a').c_str());
+  longNameArray->SetNumberOfTuples(input->GetNumberOfPoints());
+  longNameArray->FillValue(1.0f);
+  input->GetPointData()->AddArray(longNameArray);
+  SurfaceToolbox_CHECK(!SurfaceToolbox::WriteSharedMemoryPolyData(input, name));
+  SurfaceToolbox_CHECK(!SurfaceToolbox::ReadSharedMemoryPolyData(name));
+  longNameArray->SetName(std::string(63, 'a').c_str());
+  SurfaceToolbox_CHECK(SurfaceToolbox::WriteSharedMemoryPolyData(input, name));
+  output = SurfaceToolbox::ReadSharedMemoryPolyData(name);
+  SurfaceToolbox_CHECK(SurfaceToolbox::RemoveSharedMemory(name));
+  SurfaceToolbox_CHECK(output && output->GetPointData()->GetArray(std::string(63, 'a').c_str()));
+  return EXIT_SUCCESS;
+#endif
+}
@@ -0,0 +1,120 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxSmoothing.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkSmoothPolyDataFilter.h"
+#include "vtkVersionMacros.h"
+#include "vtkWindowedSincPolyDataFilter.h"
+
+// STD includes
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Sphere without the triangles around its poles, so that it has two boundary
+// loops, with its points moved radially by up to 5% so that smoothing has
+// something to do. The boundary loops turn by 360 / 32 degrees at each point,
+// less than the 15 degree edge angle of the VTK filters, so that they smooth
+// the boundary points too.
+vtkSmartPointer<vtkPolyData> CreateNoisyOpenSphere()
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, 16);
+  std::vector<unsigned char> keepCell(sphere->GetNumberOfCells(), 1);
+  for (vtkIdType cellId = 0; cellId < sphere->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    sphere->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      if (cellPoints[i] <= 1)
+        {
+        keepCell[cellId] = 0;
+        }
+      }
+    }
+  vtkSmartPointer<vtkPolyData> openSphere = SurfaceToolbox::ExtractCells(sphere, keepCell);
+  for (vtkIdType pointId = 0; pointId < openSphere->GetNumberOfPoints(); ++pointId)
+    {
+    double point[3];
+    openSphere->GetPoint(pointId, point);
+    const double scale = 1.0 + 0.01 * static_cast<double>((pointId * 7919) % 11 - 5);
+    openSphere->GetPoints()->SetPoint(pointId, scale * point[0], scale * point[1], scale * point[2]);
+    }
+  return openSphere;
+}
+
+//----------------------------------------------------------------------------
+// Same points as vtkSmoothPolyDataFilter (Laplace) or
+// vtkWindowedSincPolyDataFilter with a Hamming window (Taubin), without
+// feature edge smoothing. The VTK filters compute in double precision, so
+// the float points differ by rounding, more for the windowed sinc sums.
+int CompareWithVTK(vtkPolyData* input, const std::string& method, bool boundarySmoothing,
+                   vtkSmartPointer<vtkPolyData>& output)
+{
+  SurfaceToolbox::SmoothingParameters parameters;
+  parameters.Method = method;
+  parameters.Iterations = 20;
+  parameters.BoundarySmoothing = boundarySmoothing;
+
+  vtkSmartPointer<vtkPolyData> expected;
+  if (method == "Taubin")
+    {
+    vtkNew<vtkWindowedSincPolyDataFilter> smooth;
+    smooth->SetInputData(input);
+    smooth->SetNumberOfIterations(parameters.Iterations);
+    smooth->SetPassBand(parameters.PassBand);
+    smooth->SetBoundarySmoothing(boundarySmoothing);
+    smooth->FeatureEdgeSmoothingOff();
+#if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 1, 0)
+    smooth->SetWindowFunctionToHamming();
+#endif
+    smooth->Update();
+    expected = smooth->GetOutput();
+    }
+  else
+    {
+    vtkNew<vtkSmoothPolyDataFilter> smooth;
+    smooth->SetInputData(input);
+    smooth->SetNumberOfIterations(parameters.Iterations);
+    smooth->SetRelaxationFactor(parameters.Relaxation);
+    smooth->SetBoundarySmoothing(boundarySmoothing);
+    smooth->FeatureEdgeSmoothingOff();
+    smooth->Update();
+    expected = smooth->GetOutput();
+    }
+
+  output = SurfaceToolbox::RunParallelSmoothing(SurfaceToolboxTesting::Copy(input), parameters);
+  SurfaceToolbox_CHECK(output);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareCells(output, input));
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::ComparePoints(output, expected, method == "Taubin" ? 1e-3 : 1e-4));
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxSmoothing(int, char*[])
+{
+  vtkSmartPointer<vtkPolyData> input = CreateNoisyOpenSphere();
+  for (const std::string method : { "Laplace", "Taubin" })
+    {
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    for (bool boundarySmoothing : { false, true })
+      {
+      if (CompareWithVTK(input, method, boundarySmoothing, outputs[boundarySmoothing]) != EXIT_SUCCESS)
+        {
+        std::cerr << "Method " << method << ", BoundarySmoothing " << boundarySmoothing << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    // Boundary smoothing moves the boundary points, and through them the
+    // others: the comparisons above are not on the same points twice
+    SurfaceToolbox_CHECK(!SurfaceToolboxTesting::ComparePoints(outputs[0], outputs[1], 1e-3));
+    }
+  return EXIT_SUCCESS;
+}
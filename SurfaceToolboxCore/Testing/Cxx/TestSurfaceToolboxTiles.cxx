@@ -0,0 +1,173 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxPipeline.h"
+#include "SurfaceToolboxTiles.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+#include "vtkPolyDataConnectivityFilter.h"
+
+// STD includes
+#include <algorithm>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Sphere with its points moved radially by up to 5%, so that smoothing has
+// something to do.
+vtkSmartPointer<vtkPolyData> CreateNoisySphere(int resolution)
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, resolution);
+  for (vtkIdType pointId = 0; pointId < sphere->GetNumberOfPoints(); ++pointId)
+    {
+    double point[3];
+    sphere->GetPoint(pointId, point);
+    const double scale = 1.0 + 0.01 * static_cast<double>((pointId * 7919) % 11 - 5);
+    sphere->GetPoints()->SetPoint(pointId, scale * point[0], scale * point[1], scale * point[2]);
+    }
+  return sphere;
+}
+
+//----------------------------------------------------------------------------
+// Sphere with every third triangle reversed, so that its polygons are not
+// consistently ordered.
+vtkSmartPointer<vtkPolyData> CreateInconsistentSphere(int resolution)
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, resolution);
+  std::vector<vtkIdType> triangles;
+  SurfaceToolbox::GetTriangles(sphere, triangles);
+  for (size_t triangle = 0; triangle < triangles.size() / 3; triangle += 3)
+    {
+    std::swap(triangles[3 * triangle + 1], triangles[3 * triangle + 2]);
+    }
+  sphere->SetPolys(SurfaceToolbox::CreateTriangleCells(triangles.data(),
+                                                       static_cast<vtkIdType>(triangles.size() / 3)));
+  return sphere;
+}
+
+//----------------------------------------------------------------------------
+// Triangles of a sphere that do not share their points, as read from an STL
+// file, with the "PointValue" of their location.
+vtkSmartPointer<vtkPolyData> CreateTriangleSoup(int resolution)
+{
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere(1.0, resolution);
+  std::vector<vtkIdType> triangles;
+  SurfaceToolbox::GetTriangles(sphere, triangles);
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkFloatArray> pointValues;
+  pointValues->SetName("PointValue");
+  vtkDataArray* sphereValues = sphere->GetPointData()->GetScalars();
+  for (vtkIdType pointId : triangles)
+    {
+    points->InsertNextPoint(sphere->GetPoint(pointId));
+    pointValues->InsertNextValue(static_cast<float>(sphereValues->GetComponent(pointId, 0)));
+    }
+  std::vector<vtkIdType> soupTriangles(triangles.size());
+  for (size_t corner = 0; corner < soupTriangles.size(); ++corner)
+    {
+    soupTriangles[corner] = static_cast<vtkIdType>(corner);
+    }
+  vtkSmartPointer<vtkPolyData> soup = vtkSmartPointer<vtkPolyData>::New();
+  soup->SetPoints(points);
+  soup->SetPolys(SurfaceToolbox::CreateTriangleCells(soupTriangles.data(),
+                                                     static_cast<vtkIdType>(soupTriangles.size() / 3)));
+  soup->GetPointData()->SetScalars(pointValues);
+  return soup;
+}
+
+//----------------------------------------------------------------------------
+// Same surface from \a stage run untiled and in tiles of \a tileSize, one
+// tile per thread and one at a time.
+int CompareTiledStage(const std::string& stage, vtkPolyData* input, SurfaceToolbox::PipelineParameters parameters,
+                      vtkIdType tileSize, double tolerance)
+{
+  parameters.Tiles = SurfaceToolbox::TileParameters();
+  vtkSmartPointer<vtkPolyData> expected = SurfaceToolbox::RunStage(stage, SurfaceToolboxTesting::Copy(input),
+                                                                   parameters);
+  SurfaceToolbox_CHECK(expected);
+  parameters.Tiles.TileSize = tileSize;
+  for (double memoryBudget : { 0.0, 1e-6 })
+    {
+    parameters.Tiles.MemoryBudget = memoryBudget;
+    vtkSmartPointer<vtkPolyData> tiled = SurfaceToolbox::RunTiledStage(stage, SurfaceToolboxTesting::Copy(input),
+                                                                       parameters);
+    SurfaceToolbox_CHECK(tiled);
+    if (!SurfaceToolboxTesting::CompareSurfaces(tiled, expected, tolerance))
+      {
+      std::cerr << "Stage " << stage << ", tile size " << tileSize << ", memory budget " << memoryBudget << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxTiles(int, char*[])
+{
+  SurfaceToolbox::PipelineParameters parameters;
+
+  // Cleaner: the points merged together are in the same tile
+  vtkSmartPointer<vtkPolyData> soup = CreateTriangleSoup(32);
+  for (double tolerance : { 0.0, 0.01 })
+    {
+    parameters.Cleaner.Tolerance = tolerance;
+    SurfaceToolbox_CHECK(CompareTiledStage("Cleaner", soup, parameters, soup->GetNumberOfPoints() / 5, 0.0)
+                         == EXIT_SUCCESS);
+    }
+
+  // Normals: the polygons are ordered consistently over the whole surface,
+  // whatever the tiles
+  vtkSmartPointer<vtkPolyData> inconsistentSphere = CreateInconsistentSphere(32);
+  for (const std::string weighting : { "Area", "Angle" })
+    {
+    for (bool flip : { false, true })
+      {
+      parameters.Normals.Weighting = weighting;
+      parameters.Normals.Flip = flip;
+      SurfaceToolbox_CHECK(CompareTiledStage("Normals", inconsistentSphere, parameters,
+                                             inconsistentSphere->GetNumberOfPolys() / 6, 1e-6) == EXIT_SUCCESS);
+      }
+    }
+
+  // Smoothing: the halo rings reach as far as the iterations
+  vtkSmartPointer<vtkPolyData> noisySphere = CreateNoisySphere(64);
+  const vtkIdType smoothingTileSize = noisySphere->GetNumberOfPolys() / 4;
+  parameters.Smoothing.Iterations = 5;
+  for (const std::string method : { "Laplace", "Taubin" })
+    {
+    parameters.Smoothing.Method = method;
+    SurfaceToolbox_CHECK(CompareTiledStage("Smoothing", noisySphere, parameters, smoothingTileSize, 1e-6)
+                         == EXIT_SUCCESS);
+    }
+
+  // Tiles whose halo is larger than themselves are rejected
+  parameters.Smoothing.Iterations = 200;
+  parameters.Tiles.TileSize = smoothingTileSize;
+  SurfaceToolbox_CHECK(!SurfaceToolbox::RunTiledStage("Smoothing", SurfaceToolboxTesting::Copy(noisySphere),
+                                                      parameters));
+
+  // Decimation: the seams are stitched by point id, so that two spheres at the
+  // same location, whose seam points coincide, stay apart
+  vtkNew<vtkAppendPolyData> append;
+  append->AddInputData(SurfaceToolboxTesting::CreateSphere(1.0, 32));
+  append->AddInputData(SurfaceToolboxTesting::CreateSphere(1.0, 32));
+  append->Update();
+  vtkSmartPointer<vtkPolyData> spheres = SurfaceToolboxTesting::Copy(append->GetOutput());
+  parameters.Decimation.Method = "Quadric";
+  parameters.Decimation.TargetReduction = 0.5;
+  parameters.Tiles.TileSize = spheres->GetNumberOfPolys() / 4;
+  vtkSmartPointer<vtkPolyData> decimated = SurfaceToolbox::RunTiledStage("Decimation", spheres, parameters);
+  SurfaceToolbox_CHECK(decimated);
+  SurfaceToolbox_CHECK(decimated->GetNumberOfPolys() < 3 * spheres->GetNumberOfPolys() / 4);
+  vtkNew<vtkPolyDataConnectivityFilter> connectivity;
+  connectivity->SetInputData(decimated);
+  connectivity->SetExtractionModeToAllRegions();
+  connectivity->Update();
+  SurfaceToolbox_CHECK(connectivity->GetNumberOfExtractedRegions() == 2);
+  return EXIT_SUCCESS;
+}
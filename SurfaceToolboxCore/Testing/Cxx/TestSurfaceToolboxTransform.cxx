@@ -0,0 +1,145 @@
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxTransform.h"
+
+#include "SurfaceToolboxTestUtilities.h"
+
+// VTK includes
+#include "vtkCellArray.h"
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Strips of 4 and 5 points in the z = 0 plane, every triangle facing +z
+vtkSmartPointer<vtkPolyData> CreateStrips()
+{
+  vtkNew<vtkPoints> points;
+  for (int i = 0; i < 5; ++i)
+    {
+    points->InsertNextPoint(0.5 * i, i % 2 ? 0.0 : 1.0, 0.0);
+    }
+  vtkNew<vtkCellArray> strips;
+  const vtkIdType evenStrip[4] = { 0, 1, 2, 3 };
+  const vtkIdType oddStrip[5] = { 0, 1, 2, 3, 4 };
+  strips->InsertNextCell(4, evenStrip);
+  strips->InsertNextCell(5, oddStrip);
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetStrips(strips);
+  return polyData;
+}
+
+//----------------------------------------------------------------------------
+// Z component of the normal of every non-degenerate triangle of the strips,
+// in the orientation of the strip: odd triangles are traversed backwards.
+std::vector<double> GetStripNormalsZ(vtkPolyData* polyData)
+{
+  std::vector<double> normalsZ;
+  for (vtkIdType cellId = 0; cellId < polyData->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    vtkIdType numberOfCellPoints;
+    polyData->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    for (vtkIdType t = 0; t + 2 < numberOfCellPoints; ++t)
+      {
+      vtkIdType a = cellPoints[t];
+      vtkIdType b = cellPoints[t + 1];
+      const vtkIdType c = cellPoints[t + 2];
+      if (a == b || b == c || c == a)
+        {
+        continue;
+        }
+      if (t % 2)
+        {
+        std::swap(a, b);
+        }
+      double pa[3], pb[3], pc[3];
+      polyData->GetPoint(a, pa);
+      polyData->GetPoint(b, pb);
+      polyData->GetPoint(c, pc);
+      normalsZ.push_back((pb[0] - pa[0]) * (pc[1] - pa[1]) - (pb[1] - pa[1]) * (pc[0] - pa[0]));
+      }
+    }
+  return normalsZ;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int TestSurfaceToolboxTransform(int, char*[])
+{
+  const double mirror[16] = { -1.0, 0.0, 0.0, 0.0,
+                              0.0, 1.0, 0.0, 0.0,
+                              0.0, 0.0, 1.0, 0.0,
+                              0.0, 0.0, 0.0, 1.0 };
+
+  // A surface that shares its arrays with another one, as the output of a
+  // stage passing its input by ShallowCopy, is transformed without changing
+  // the other surface
+  vtkSmartPointer<vtkPolyData> sphere = SurfaceToolboxTesting::CreateSphere();
+  vtkNew<vtkFloatArray> normals;
+  normals->SetName("Normals");
+  normals->SetNumberOfComponents(3);
+  normals->SetNumberOfTuples(sphere->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < sphere->GetNumberOfPoints(); ++pointId)
+    {
+    normals->SetTuple(pointId, sphere->GetPoint(pointId));
+    }
+  sphere->GetPointData()->SetNormals(normals);
+  vtkSmartPointer<vtkPolyData> original = SurfaceToolboxTesting::Copy(sphere);
+  vtkNew<vtkPolyData> shared;
+  shared->ShallowCopy(sphere);
+  SurfaceToolbox::TransformPolyData(shared, mirror);
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::ComparePoints(sphere, original, 0.0));
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareCells(sphere, original));
+  SurfaceToolbox_CHECK(SurfaceToolboxTesting::CompareArrays(sphere->GetPointData()->GetNormals(),
+                                                            original->GetPointData()->GetNormals(), 0.0));
+
+  // The shared surface is mirrored, its polygons reversed and its normals
+  // mirrored
+  SurfaceToolbox_CHECK(shared->GetNumberOfPoints() == original->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < shared->GetNumberOfPoints(); ++pointId)
+    {
+    const double* point = shared->GetPoint(pointId);
+    const double* originalPoint = original->GetPoint(pointId);
+    SurfaceToolbox_CHECK(point[0] == -originalPoint[0] && point[1] == originalPoint[1]);
+    const double* normal = shared->GetPointData()->GetNormals()->GetTuple3(pointId);
+    SurfaceToolbox_CHECK(std::abs(normal[0] - point[0]) < 1e-6 && std::abs(normal[2] - point[2]) < 1e-6);
+    }
+  for (vtkIdType cellId = 0; cellId < shared->GetNumberOfCells(); ++cellId)
+    {
+    const vtkIdType* cellPoints;
+    const vtkIdType* originalCellPoints;
+    vtkIdType numberOfCellPoints;
+    vtkIdType numberOfOriginalCellPoints;
+    shared->GetCellPoints(cellId, numberOfCellPoints, cellPoints);
+    original->GetCellPoints(cellId, numberOfOriginalCellPoints, originalCellPoints);
+    SurfaceToolbox_CHECK(numberOfCellPoints == numberOfOriginalCellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      SurfaceToolbox_CHECK(cellPoints[i] == originalCellPoints[numberOfCellPoints - 1 - i]);
+      }
+    }
+
+  // Mirrored strips of both parities keep facing +z, as their normals: the
+  // even one needs its first point repeated
+  vtkSmartPointer<vtkPolyData> strips = CreateStrips();
+  const std::vector<double> normalsZ = GetStripNormalsZ(strips);
+  SurfaceToolbox_CHECK(normalsZ.size() == 5);
+  for (double normalZ : normalsZ)
+    {
+    SurfaceToolbox_CHECK(normalZ > 0.0);
+    }
+  SurfaceToolbox::TransformPolyData(strips, mirror);
+  SurfaceToolbox_CHECK(strips->GetNumberOfStrips() == 2);
+  const std::vector<double> mirroredNormalsZ = GetStripNormalsZ(strips);
+  SurfaceToolbox_CHECK(mirroredNormalsZ.size() == 5);
+  for (double normalZ : mirroredNormalsZ)
+    {
+    SurfaceToolbox_CHECK(normalZ > 0.0);
+    }
+  return EXIT_SUCCESS;
+}
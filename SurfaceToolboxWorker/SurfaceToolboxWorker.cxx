@@ -0,0 +1,406 @@
+// Long-lived process running surface toolbox CLI jobs without starting a new
+// process for each of them. The ModuleEntryPoint of every CLI library
+// (${CLP}Lib) is loaded once; jobs are then read one per line, from the
+// standard input or from the connections to a Unix socket:
+//
+//   <module> <arguments...>
+//
+// e.g. "translateMesh --dimX 10 input.vtp output.vtp". Arguments are separated
+// by spaces and may be quoted with double quotes, in which a backslash escapes
+// the next character. After each job, the worker writes
+//
+//   SurfaceToolboxWorker: <exit code> <seconds>
+//
+// to its standard output, or "<exit code> <seconds>" to the socket
+// connection the job came from. The output of the modules themselves goes to
+// the standard output and error of the worker.
+//
+// Usage: SurfaceToolboxWorker [--modules-dir dir] [--socket path] [--in-process | --fork]
+//
+// By default (--in-process), jobs run in the worker process itself, so that
+// the file readers and writers that the modules keep between calls stay warm
+// from one job to the next. A crashing job, or a module calling exit(), as
+// PARSE_ARGS does on an invalid argument or --help, ends the worker and its
+// pending jobs. With --fork, each job runs in a child process forked from the
+// worker, which isolates the worker from such jobs, but every job starts from
+// the objects of the worker and what it warms up is lost with the child.
+// Jobs always run in process on Windows.
+//
+// The CLI libraries are looked up in --modules-dir, by default the CLI module
+// library directory relative to the directory of the worker executable, in
+// the build tree as in the installed extension.
+
+// STD includes
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+#include "SurfaceToolboxWorkerModules.h"
+
+#ifndef SURFACETOOLBOX_CLI_LIBRARY_DIR
+#define SURFACETOOLBOX_CLI_LIBRARY_DIR "."
+#endif
+#ifndef SURFACETOOLBOX_CLI_LIBRARY_PREFIX
+#define SURFACETOOLBOX_CLI_LIBRARY_PREFIX "lib"
+#endif
+#ifndef SURFACETOOLBOX_CLI_LIBRARY_SUFFIX
+#define SURFACETOOLBOX_CLI_LIBRARY_SUFFIX ".so"
+#endif
+
+namespace
+{
+
+typedef int (*ModuleEntryPoint)(int argc, char* argv[]);
+
+struct Options
+{
+  std::string ModulesDirectory;
+  std::string SocketPath;
+  bool Fork = false;
+};
+
+//----------------------------------------------------------------------------
+// Directory of the worker executable, or an empty string if unknown
+std::string GetExecutableDirectory()
+{
+  std::string path;
+#if defined(_WIN32)
+  char buffer[MAX_PATH];
+  const DWORD size = GetModuleFileNameA(nullptr, buffer, MAX_PATH);
+  if (size > 0 && size < MAX_PATH)
+    {
+    path.assign(buffer, size);
+    }
+#elif defined(__APPLE__)
+  char buffer[PATH_MAX];
+  uint32_t size = sizeof(buffer);
+  char resolved[PATH_MAX];
+  if (_NSGetExecutablePath(buffer, &size) == 0 && realpath(buffer, resolved))
+    {
+    path = resolved;
+    }
+#else
+  char buffer[PATH_MAX];
+  const ssize_t size = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+  if (size > 0)
+    {
+    path.assign(buffer, static_cast<size_t>(size));
+    }
+#endif
+  const size_t separator = path.find_last_of("/\\");
+  return separator == std::string::npos ? std::string() : path.substr(0, separator);
+}
+
+//----------------------------------------------------------------------------
+// Load the entry points of the modules found in the library directory
+std::map<std::string, ModuleEntryPoint> LoadModules(const std::string& directory)
+{
+  std::map<std::string, ModuleEntryPoint> modules;
+  for (const char* name : ModuleNames)
+    {
+    const std::string path = directory + "/" + SURFACETOOLBOX_CLI_LIBRARY_PREFIX + name + "Lib"
+      + SURFACETOOLBOX_CLI_LIBRARY_SUFFIX;
+#ifdef _WIN32
+    HMODULE library = LoadLibraryA(path.c_str());
+    void* entryPoint = library ? reinterpret_cast<void*>(GetProcAddress(library, "ModuleEntryPoint")) : nullptr;
+#else
+    // Local symbols: every library has its own ModuleEntryPoint and its own
+    // copy of SurfaceToolboxCore
+    void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    void* entryPoint = library ? dlsym(library, "ModuleEntryPoint") : nullptr;
+#endif
+    if (!entryPoint)
+      {
+      std::cerr << "SurfaceToolboxWorker: cannot load " << name << " from " << path << std::endl;
+      continue;
+      }
+    modules[name] = reinterpret_cast<ModuleEntryPoint>(entryPoint);
+    }
+  return modules;
+}
+
+//----------------------------------------------------------------------------
+// Split a job line into arguments, honoring double quotes and backslashes
+// inside them.
+std::vector<std::string> SplitArguments(const std::string& line)
+{
+  std::vector<std::string> arguments;
+  std::string argument;
+  bool inArgument = false;
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); ++i)
+    {
+    const char c = line[i];
+    if (quoted)
+      {
+      if (c == '\\' && i + 1 < line.size())
+        {
+        argument += line[++i];
+        }
+      else if (c == '"')
+        {
+        quoted = false;
+        }
+      else
+        {
+        argument += c;
+        }
+      }
+    else if (c == '"')
+      {
+      quoted = true;
+      inArgument = true;
+      }
+    else if (c == ' ' || c == '\t' || c == '\r')
+      {
+      if (inArgument)
+        {
+        arguments.push_back(argument);
+        argument.clear();
+        inArgument = false;
+        }
+      }
+    else
+      {
+      argument += c;
+      inArgument = true;
+      }
+    }
+  if (inArgument)
+    {
+    arguments.push_back(argument);
+    }
+  return arguments;
+}
+
+//----------------------------------------------------------------------------
+int CallModule(ModuleEntryPoint entryPoint, std::vector<std::string> arguments)
+{
+  std::vector<char*> argv;
+  for (std::string& argument : arguments)
+    {
+    argv.push_back(&argument[0]);
+    }
+  argv.push_back(nullptr);
+  return entryPoint(static_cast<int>(arguments.size()), argv.data());
+}
+
+//----------------------------------------------------------------------------
+// Run the job of one line, and return its exit code and duration.
+int RunJob(const std::map<std::string, ModuleEntryPoint>& modules, const std::string& line, const Options& options,
+           double& seconds)
+{
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::string> arguments = SplitArguments(line);
+  auto module = modules.find(arguments[0]);
+  int exitCode = EXIT_FAILURE;
+  if (module == modules.end())
+    {
+    std::cerr << "SurfaceToolboxWorker: unknown module " << arguments[0] << std::endl;
+    }
+#ifndef _WIN32
+  else if (options.Fork)
+    {
+    std::cout.flush();
+    std::cerr.flush();
+    const pid_t child = fork();
+    if (child == 0)
+      {
+      const int childExitCode = CallModule(module->second, arguments);
+      std::cout.flush();
+      std::cerr.flush();
+      _exit(childExitCode);
+      }
+    int status = 0;
+    if (child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status))
+      {
+      exitCode = WEXITSTATUS(status);
+      }
+    }
+#endif
+  else
+    {
+    exitCode = CallModule(module->second, arguments);
+    }
+  std::cout.flush();
+  std::cerr.flush();
+  seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return exitCode;
+}
+
+//----------------------------------------------------------------------------
+int ServeStandardInput(const std::map<std::string, ModuleEntryPoint>& modules, const Options& options)
+{
+  std::string line;
+  while (std::getline(std::cin, line))
+    {
+    if (SplitArguments(line).empty())
+      {
+      continue;
+      }
+    double seconds = 0.0;
+    const int exitCode = RunJob(modules, line, options, seconds);
+    std::cout << "SurfaceToolboxWorker: " << exitCode << " " << seconds << std::endl;
+    }
+  return EXIT_SUCCESS;
+}
+
+#ifndef _WIN32
+
+//----------------------------------------------------------------------------
+// Jobs of one connection, until it is closed
+void ServeConnection(int connection, const std::map<std::string, ModuleEntryPoint>& modules, const Options& options)
+{
+  std::string buffer;
+  char data[4096];
+  ssize_t size = 0;
+  while ((size = read(connection, data, sizeof(data))) > 0)
+    {
+    buffer.append(data, static_cast<size_t>(size));
+    size_t end = 0;
+    while ((end = buffer.find('\n')) != std::string::npos)
+      {
+      const std::string line = buffer.substr(0, end);
+      buffer.erase(0, end + 1);
+      if (SplitArguments(line).empty())
+        {
+        continue;
+        }
+      double seconds = 0.0;
+      const int exitCode = RunJob(modules, line, options, seconds);
+      std::ostringstream reply;
+      reply << exitCode << " " << seconds << "\n";
+      const std::string text = reply.str();
+      if (write(connection, text.data(), text.size()) != static_cast<ssize_t>(text.size()))
+        {
+        return;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int ServeSocket(const std::map<std::string, ModuleEntryPoint>& modules, const Options& options)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (options.SocketPath.size() >= sizeof(address.sun_path))
+    {
+    std::cerr << "SurfaceToolboxWorker: socket path too long: " << options.SocketPath << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::strncpy(address.sun_path, options.SocketPath.c_str(), sizeof(address.sun_path) - 1);
+  const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(options.SocketPath.c_str());
+  if (server < 0 || bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+      || listen(server, 16) != 0)
+    {
+    std::cerr << "SurfaceToolboxWorker: cannot listen on " << options.SocketPath << ": " << std::strerror(errno)
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Jobs run one at a time: connections are served in turn
+  for (;;)
+    {
+    const int connection = accept(server, nullptr, nullptr);
+    if (connection < 0)
+      {
+      if (errno == EINTR)
+        {
+        continue;
+        }
+      break;
+      }
+    ServeConnection(connection, modules, options);
+    close(connection);
+    }
+  close(server);
+  unlink(options.SocketPath.c_str());
+  return EXIT_FAILURE;
+}
+
+#endif
+
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+    {
+    const std::string argument = argv[i];
+    if (argument == "--fork")
+      {
+      options.Fork = true;
+      }
+    else if (argument == "--in-process")
+      {
+      options.Fork = false;
+      }
+    else if (argument == "--modules-dir" && i + 1 < argc)
+      {
+      options.ModulesDirectory = argv[++i];
+      }
+    else if (argument == "--socket" && i + 1 < argc)
+      {
+      options.SocketPath = argv[++i];
+      }
+    else
+      {
+      std::cerr << "Usage: SurfaceToolboxWorker [--modules-dir dir] [--socket path] [--in-process | --fork]"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+#ifdef _WIN32
+  if (options.Fork || !options.SocketPath.empty())
+    {
+    std::cerr << "SurfaceToolboxWorker: --fork and --socket are not supported on Windows" << std::endl;
+    return EXIT_FAILURE;
+    }
+#endif
+
+  if (options.ModulesDirectory.empty())
+    {
+    const std::string executableDirectory = GetExecutableDirectory();
+    options.ModulesDirectory = (executableDirectory.empty() ? std::string(".") : executableDirectory)
+      + "/" + SURFACETOOLBOX_CLI_LIBRARY_DIR;
+    }
+  const std::map<std::string, ModuleEntryPoint> modules = LoadModules(options.ModulesDirectory);
+  if (modules.empty())
+    {
+    std::cerr << "SurfaceToolboxWorker: no module found in " << options.ModulesDirectory << std::endl;
+    return EXIT_FAILURE;
+    }
+
+#ifndef _WIN32
+  if (!options.SocketPath.empty())
+    {
+    return ServeSocket(modules, options);
+    }
+#endif
+  return ServeStandardInput(modules, options);
+}
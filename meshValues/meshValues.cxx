@@ -1,39 +1,22 @@
 #include "meshValuesCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxMeshValues.h"
+
 // VTK Includes
-#include "vtkDecimatePro.h"
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
-#include "vtkSmartPointer.h"
-#include "vtkPolyData.h"
-#include "vtkTriangleFilter.h"
-#include "vtkNew.h"
-#include "vtkCellLocator.h"
+#include "vtkSMPTools.h"
 
 //ITK Includes
 #include "itkMesh.h"
 #include "itkMeshFileReader.h"
-#include "itkMeshFileWriter.h"
-#include "itkLineCell.h"
 #include "itkTriangleCell.h"
-#include "itkImageFileWriter.h"
-#include "itkResampleImageFilter.h"
-#include "itkConstrainedValueAdditionImageFilter.h"
-#include "itkBSplineInterpolateImageFunction.h"
 #include "itkPluginUtilities.h"
-#include <itkDefaultDynamicMeshTraits.h>
-#include <itkMetaMeshConverter.h>
 
 
 int main (int argc, char * argv[])
  {
    PARSE_ARGS;
    try{
-     typedef itk::DefaultDynamicMeshTraits<float, 3, 3, float, float> MeshTraitsType;
-
-
-     typedef MeshTraitsType::PointType                                PointType;
-
      constexpr unsigned int Dimension = 3;
      using InputPixelType = float;
 
@@ -41,61 +24,68 @@ int main (int argc, char * argv[])
      using MeshType = itk::Mesh<InputPixelType, Dimension>;
      using  MeshReaderType = itk::MeshFileReader<MeshType>;
 
-     //using MeshWriterType = itk::MeshFileWriter<MeshType>;
-
      MeshReaderType::Pointer meshReader = MeshReaderType::New();
      meshReader->SetFileName(inputVolume.c_str());
-    // meshReader->Update();
+     meshReader->Update();
      MeshType::Pointer                mesh = meshReader->GetOutput();
      MeshType::PointsContainerPointer Points = mesh->GetPoints();
-     int                              numberOfPoints = Points->Size();
-
-     std::ofstream outfileNor;
-
-     outfileNor.open( valFile );
-     //NUMBER OF POINTS
-     outfileNor << numberOfPoints << "," << std::endl;
-
-     for( unsigned int pointID = 0; pointID < Points->Size(); pointID++ )
-      {
-      PointType curPoint =  Points->GetElement(pointID);
-      // POINTS
-      outfileNor << pointID << "," << curPoint << std::endl;
-      }
+     const vtkIdType                  numberOfPoints = Points->Size();
+
+     // POINTS
+     SurfaceToolbox::MeshValues values;
+     values.Points.resize(3 * numberOfPoints);
+     vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end)
+       {
+       for (vtkIdType pointID = begin; pointID < end; ++pointID)
+         {
+         const MeshType::PointType& curPoint = Points->ElementAt(pointID);
+         values.Points[3 * pointID] = curPoint[0];
+         values.Points[3 * pointID + 1] = curPoint[1];
+         values.Points[3 * pointID + 2] = curPoint[2];
+         }
+       });
 
       typedef MeshType::CellsContainer::ConstIterator CellIterator;
       typedef MeshType::CellType                      CellType;
-      typedef itk::LineCell<CellType>                 LineType;
       typedef itk::TriangleCell<CellType>             TriangleType;
-      // find number&points of cells
-      CellIterator cellIterator = mesh->GetCells()->Begin();
-      CellIterator cellEnd      = mesh->GetCells()->End();
-      PointType    curPoint;
-      int num = 0;
-      while( cellIterator != cellEnd )
+      // TRIANGLES
+      values.Triangles.reserve(3 * mesh->GetNumberOfCells());
+      for (CellIterator cellIterator = mesh->GetCells()->Begin(); cellIterator != mesh->GetCells()->End(); ++cellIterator)
         {
-        CellType *                cell = cellIterator.Value();
-        TriangleType *            line = dynamic_cast<TriangleType *>(cell);
-        LineType::PointIdIterator pit = line->PointIdsBegin();
-        int                       pIndex1, pIndex2, pIndex3;
-
-        pIndex1 = *pit;
-        ++pit;
-        pIndex2 = *pit;
-        ++pit;
-        pIndex3 = *pit;
-
-        outfileNor << num << "," << pIndex1 << "," << pIndex2 << "," << pIndex3 << "," << std::endl;
-
-        ++cellIterator;
-        ++num;
-        
+        TriangleType * triangle = dynamic_cast<TriangleType *>(cellIterator.Value());
+        if (!triangle)
+          {
+          continue;
+          }
+        for (TriangleType::PointIdConstIterator pit = triangle->PointIdsBegin(); pit != triangle->PointIdsEnd(); ++pit)
+          {
+          values.Triangles.push_back(*pit);
+          }
         }
 
-
-     outfileNor.close();
+     if (!valFile.empty() && !SurfaceToolbox::WriteMeshValuesCSV(values, valFile))
+       {
+       return EXIT_FAILURE;
+       }
+     if (!rawFile.empty() && !SurfaceToolbox::WriteMeshValuesRaw(values, rawFile))
+       {
+       return EXIT_FAILURE;
+       }
+     if (!pointsFile.empty() && !SurfaceToolbox::WritePointsNpy(values, pointsFile))
+       {
+       return EXIT_FAILURE;
+       }
+     if (!trianglesFile.empty() && !SurfaceToolbox::WriteTrianglesNpy(values, trianglesFile))
+       {
+       return EXIT_FAILURE;
+       }
 
    }
+   catch (itk::ExceptionObject & e)
+    {
+      std::cerr << e << std::endl;
+      return EXIT_FAILURE;
+    }
    catch (int e)
     {
       cout << "An exception occurred. Exception Nr. " << e << '\n';
@@ -1,15 +1,12 @@
 #include "relaxPolygonsCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 //VTK Includes
-#include "vtkFillHolesFilter.h"
-#include "vtkPolyDataNormals.h"
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkNew.h"
-#include "vtkCleanPolyData.h"
-#include "vtkWindowedSincPolyDataFilter.h"
 
 // Similar Features to Smoothing in surface toolbox, but this is more definite.
 
@@ -20,33 +17,25 @@ int main (int argc, char * argv[])
 
  try{
 
-    vtkSmartPointer<vtkPolyData> polyData;
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkNew<vtkCleanPolyData> meshinC;
-    meshinC->SetInputData(polyData);
-    meshinC->Update();
-
-    vtkNew<vtkWindowedSincPolyDataFilter> smoother;
-    smoother->SetInputConnection(meshinC->GetOutputPort());
-    smoother->SetNumberOfIterations(Iterations);
-    smoother->BoundarySmoothingOff();
-    smoother->FeatureEdgeSmoothingOff();
-    smoother->SetFeatureAngle(120.0);
-    smoother->SetPassBand(0.001);
-    smoother->NonManifoldSmoothingOn();
-    smoother->NormalizeCoordinatesOn();
-    smoother->Update();
-
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(smoother->GetOutput());
-    writer->Update();
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::RelaxParameters parameters;
+    parameters.Iterations = static_cast<int>(Iterations);
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunRelaxPolygons(polyData, parameters);
+
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
   }
 catch (int e)
  {
@@ -1,13 +1,12 @@
 #include "scaleMeshCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 // VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkNew.h"
-#include "vtkTransformFilter.h"
-#include "vtkTransform.h"
 
 
 
@@ -17,30 +16,28 @@ int main (int argc, char * argv[])
 
    try{
 
-    vtkSmartPointer<vtkPolyData> polyData;
-
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkNew<vtkTransform> transform;
-    transform->Scale(dimX,dimY,dimZ);
-
-    vtkNew<vtkTransformFilter> scaler;
-    scaler->SetInputData(polyData);
-    scaler->SetTransform(transform);
-    scaler->Update();
-
-
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::ScaleParameters parameters;
+    parameters.X = dimX;
+    parameters.Y = dimY;
+    parameters.Z = dimZ;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunScaleMesh(polyData, parameters);
 
     //Write to file
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(scaler->GetOutput());
-    writer->Update();
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
   }
   catch (int e)
    {
@@ -1,14 +1,12 @@
 #include "translateMeshCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxStages.h"
+
 // VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkNew.h"
-#include "vtkTransformFilter.h"
-#include "vtkTransform.h"
-#include "vtkPoints.h"
 
 
 
@@ -18,40 +16,28 @@ int main (int argc, char * argv[])
 
    try{
 
-    vtkSmartPointer<vtkPolyData> polyData;
-
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkSmartPointer<vtkPoints> PointsVTK;
-    PointsVTK = polyData->GetPoints();
-
-
-
-    double x[3];
-
-    for( int PointId = 0; PointId < (polyData->GetNumberOfPoints() ); PointId++ )
-        {
-        PointsVTK->GetPoint(PointId, x);
-        double vert[3];
-
-        vert[0] = x[0] + dimX;
-        vert[1] = x[1] + dimY;
-        vert[2] = x[2] + dimZ;
-
-        PointsVTK->SetPoint(PointId, vert);
-        }
-
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::TranslateParameters parameters;
+    parameters.X = dimX;
+    parameters.Y = dimY;
+    parameters.Z = dimZ;
+    vtkSmartPointer<vtkPolyData> surface = SurfaceToolbox::RunTranslateMesh(polyData, parameters);
 
     //Write to file
-    vtkNew<vtkXMLPolyDataWriter> writer;
-    writer->SetFileName(outputVolume.c_str());
-    writer->SetInputData(polyData);
-    writer->Update();
+    SurfaceToolbox::WriteParameters writeParameters;
+    writeParameters.Compression = Compression;
+    writeParameters.CompressionLevel = CompressionLevel;
+    writeParameters.ReportStatistics = true;
+    if (!SurfaceToolbox::WritePolyData(surface, outputVolume, writeParameters))
+      {
+      return EXIT_FAILURE;
+      }
   }
   catch (int e)
    {
@@ -1,12 +1,12 @@
 #include "volumePolyDataCLP.h"
 
+// SurfaceToolboxCore includes
+#include "SurfaceToolboxIO.h"
+#include "SurfaceToolboxMassProperties.h"
+
 //VTK Includes
-#include "vtkXMLPolyDataWriter.h"
-#include "vtkXMLPolyDataReader.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyData.h"
-#include "vtkNew.h"
-#include "vtkMassProperties.h"
 
 
 
@@ -16,25 +16,23 @@ int main (int argc, char * argv[])
 
  try{
 
-    vtkSmartPointer<vtkPolyData> polyData;
-
     // Read the file
-    vtkNew<vtkXMLPolyDataReader> reader;
-    reader->SetFileName(inputVolume.c_str());
-    reader->Update();
-    polyData = reader->GetOutput();
-
-    vtkNew<vtkMassProperties> property;
-    property->SetInputData(polyData);
-    property->Update();
-
-    double volume = property->GetVolume();
-
-    std::ofstream volumeFile;
-    volumeFile.open(outFile.c_str());
-
-    volumeFile << "Volume: " << volume << endl;
-    volumeFile.close();
+    vtkSmartPointer<vtkPolyData> polyData = SurfaceToolbox::ReadPolyData(inputVolume);
+    if (!polyData)
+      {
+      return EXIT_FAILURE;
+      }
+
+    SurfaceToolbox::MassProperties properties;
+    if (!SurfaceToolbox::ComputeMassProperties(polyData, properties))
+      {
+      return EXIT_FAILURE;
+      }
+
+    if (!SurfaceToolbox::WriteMassProperties(properties, outFile))
+      {
+      return EXIT_FAILURE;
+      }
 
   }
 catch (int e)